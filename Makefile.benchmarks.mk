@@ -0,0 +1,32 @@
+# Directories
+SRC := src
+BENCHMARKS := benchmarks
+
+# Compiler
+C := clang
+STD := -std=c99
+C_FLAGS := -Wall -Werror
+I_FLAGS := -I$(SRC) -I$(BENCHMARKS)
+
+# Resolve platform
+OS := $(shell uname -s)
+ifeq ($(OS), Darwin)
+# macOS
+PLATFORM := PLATFORM_MACOS
+FRAMEWORKS := -framework vulkan -framework AppKit -framework QuartzCore
+FRAMEWORK_PATHS := -F$(VULKAN_SDK)/Frameworks -Wl,-rpath,$(VULKAN_SDK)/Frameworks
+PLATFORM_FLAGS := -lobjc $(FRAMEWORK_PATHS) $(FRAMEWORKS)
+PLATFORM_SOURCES := -or -name "*.m"
+OBJC := -ObjC
+else ifeq ($(OS), Linux)
+# Linux, headless only (no window)
+PLATFORM := PLATFORM_LINUX
+PLATFORM_FLAGS := -D_DEFAULT_SOURCE -lvulkan -lpthread -lm
+PLATFORM_SOURCES :=
+OBJC :=
+else
+$(error $(OS) is not supported)
+endif
+
+all:
+	$(C) $(STD) -DGRR_$(PLATFORM) -O2 -DGRR_RELEASE $(C_FLAGS) $(I_FLAGS) $(PLATFORM_FLAGS) -o $(BENCHMARKS)/mainb $(shell find $(BENCHMARKS) -name "*.c") $(shell find $(SRC) -name "*.c" ! -name "*maind.c" $(PLATFORM_SOURCES)) $(OBJC)
\ No newline at end of file
@@ -15,9 +15,18 @@ ifeq ($(OS), Darwin)
 PLATFORM := PLATFORM_MACOS
 FRAMEWORKS := -framework vulkan -framework AppKit -framework QuartzCore
 FRAMEWORK_PATHS := -F$(VULKAN_SDK)/Frameworks -Wl,-rpath,$(VULKAN_SDK)/Frameworks
+PLATFORM_FLAGS := -lobjc $(FRAMEWORK_PATHS) $(FRAMEWORKS)
+PLATFORM_SOURCES := -or -name "*.m"
+OBJC := -ObjC
+else ifeq ($(OS), Linux)
+# Linux, headless only (no window)
+PLATFORM := PLATFORM_LINUX
+PLATFORM_FLAGS := -D_DEFAULT_SOURCE -lvulkan -lpthread -lm
+PLATFORM_SOURCES :=
+OBJC :=
 else
 $(error $(OS) is not supported)
 endif
 
 all:
-	$(C) $(STD) -DGRR_$(PLATFORM) -DGRR_DEBUG $(C_FLAGS) $(I_FLAGS) -lobjc $(FRAMEWORK_PATHS) $(FRAMEWORKS) -o $(TESTS)/maint $(shell find $(TESTS) -name "*.c") $(shell find $(SRC) -name "*.c" ! -name "*maind.c" -or -name "*.m") -ObjC 
\ No newline at end of file
+	$(C) $(STD) -DGRR_$(PLATFORM) -DGRR_DEBUG $(C_FLAGS) $(I_FLAGS) $(PLATFORM_FLAGS) -o $(TESTS)/maint $(shell find $(TESTS) -name "*.c") $(shell find $(SRC) -name "*.c" ! -name "*maind.c" $(PLATFORM_SOURCES)) $(OBJC)
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "bench_commands.h"
+
+void bench_Grr_recordCommandBuffer() {
+  enum { MAX_DRAWS = 65536, FRAMES = 20 };
+  GrrDraw *draws = (GrrDraw *)malloc(sizeof(GrrDraw) * MAX_DRAWS);
+  if (NULL == draws) {
+    GRR_LOG_ERROR("Failed to allocate benchmark draw list\n");
+    return;
+  }
+  // One triangle per draw, recorded but never submitted
+  for (Grr_u32 i = 0; i < MAX_DRAWS; i++) {
+    draws[i].indexCount = 3;
+    draws[i].firstIndex = 0;
+    draws[i].vertexOffset = 0;
+    draws[i].objectIndex = i;
+    draws[i].materialIndex = 0; // Default material
+    Grr_identityMatrix(&draws[i].transform);
+  }
+
+  vkDeviceWaitIdle(device);
+  VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+  Grr_u32 maxThreads = Grr_jobThreadCount();
+  for (Grr_u32 drawCount = 256; drawCount <= MAX_DRAWS; drawCount *= 4) {
+    Grr_setDrawList(draws, drawCount);
+    // 1, 2, 4... threads, then all of them
+    Grr_u32 threads = 1;
+    for (;;) {
+      Grr_setRecordingThreadCount(threads);
+      Grr_f64 start = Grr_seconds();
+      for (Grr_u32 frame = 0; frame < FRAMES; frame++) {
+        vkResetCommandBuffer(commandBuffer, 0);
+        _Grr_recordCommandBuffer(commandBuffer, VK_NULL_HANDLE, 0);
+      }
+      Grr_f64 seconds = (Grr_seconds() - start) / FRAMES;
+      GRR_LOG_INFO("_Grr_recordCommandBuffer %u draws, %u threads: %.3f ms\n",
+                   drawCount, threads, seconds * 1e3);
+      if (threads == maxThreads)
+        break;
+      threads = (threads * 2 < maxThreads ? threads * 2 : maxThreads);
+    }
+  }
+
+  vkResetCommandBuffer(commandBuffer, 0);
+  Grr_setRecordingThreadCount(0);
+  free(draws);
+}
+
+void bench_Grr_drawFrames(Grr_u32 frameCount) {
+  vkDeviceWaitIdle(device);
+  Grr_f64 start = Grr_seconds();
+  Grr_drawFrames(frameCount);
+  vkDeviceWaitIdle(device);
+  Grr_f64 seconds = Grr_seconds() - start;
+  GRR_LOG_INFO("Grr_drawFrames %u frames: %.3f ms per frame\n", frameCount,
+               frameCount > 0 ? seconds * 1e3 / frameCount : 0.0);
+  Grr_logGpuProfile();
+  GrrFrameStatistics statistics;
+  Grr_frameStatistics(&statistics);
+  GRR_LOG_INFO("Frame time avg %.3f p99 %.3f ms, latency avg %.3f p99 %.3f "
+               "ms (%u frames in flight)\n",
+               statistics.frameTime.average, statistics.frameTime.p99,
+               statistics.latency.average, statistics.latency.p99,
+               statistics.framesInFlight);
+
+  // From the submission of the frame read back to its pixels on the host
+  GrrReadback readback;
+  start = Grr_seconds();
+  Grr_requestReadback();
+  Grr_drawFrame();
+  if (!Grr_readback(&readback, true)) {
+    GRR_LOG_ERROR("Failed to read back frame\n");
+    return;
+  }
+  seconds = Grr_seconds() - start;
+  GRR_LOG_INFO("Grr_readback %ux%u: %.3f ms\n", readback.width,
+               readback.height, seconds * 1e3);
+}
\ No newline at end of file
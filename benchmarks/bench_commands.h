@@ -0,0 +1,14 @@
+#ifndef GRR_BENCH_COMMANDS_H
+#define GRR_BENCH_COMMANDS_H
+
+#include "commands.h"
+#include "logging.h"
+#include "utils.h"
+#include "vulkan.h"
+
+void bench_Grr_recordCommandBuffer();
+
+// Headless frames with their GPU profile, then the latency of a readback
+void bench_Grr_drawFrames(Grr_u32 frameCount);
+
+#endif
@@ -0,0 +1,73 @@
+#include "bench_culling.h"
+
+void bench_Grr_cull() {
+  // Random volumes around a camera frustum, about a quarter of them visible
+  enum { COUNT = 1 << 20, ROUNDS = 20 };
+  GrrBoundingSpheres spheres = {0};
+  GrrBoundingBoxes boxes = {0};
+  Grr_u32 *visible = (Grr_u32 *)malloc(sizeof(Grr_u32) * COUNT);
+  if (NULL == visible || !Grr_resizeBoundingSpheres(&spheres, COUNT) ||
+      !Grr_resizeBoundingBoxes(&boxes, COUNT)) {
+    GRR_LOG_ERROR("Failed to allocate benchmark bounding volumes\n");
+    free(visible);
+    Grr_destroyBoundingSpheres(&spheres);
+    Grr_destroyBoundingBoxes(&boxes);
+    return;
+  }
+  Grr_u32 seed = 1;
+  for (Grr_u32 i = 0; i < COUNT; i++) {
+    Grr_f32 random[4];
+    for (Grr_u32 j = 0; j < 4; j++) {
+      seed = seed * 1664525 + 1013904223;
+      random[j] = (Grr_f32)(seed >> 8) / (Grr_f32)(1 << 24);
+    }
+    spheres.x[i] = boxes.centerX[i] = random[0] * 200.0f - 100.0f;
+    spheres.y[i] = boxes.centerY[i] = random[1] * 20.0f - 10.0f;
+    spheres.z[i] = boxes.centerZ[i] = random[2] * -200.0f + 50.0f;
+    spheres.radius[i] = random[3] * 2.0f;
+    boxes.extentX[i] = boxes.extentY[i] = boxes.extentZ[i] = random[3];
+  }
+
+  GrrCamera camera = {0};
+  camera.direction.z = -1.0f;
+  camera.upHint.y = 1.0f;
+  camera.zNear = 0.1f;
+  camera.zFar = 100.0f;
+  camera.aspectRatio = 16.0f / 9.0f;
+  camera.yFOV = 1.0f;
+  GrrMatrix4x4 view, projection, viewProjection;
+  Grr_viewMatrix(&camera, &view);
+  Grr_perspectiveProjectionMatrix(&camera, &projection);
+  Grr_multiplyMatrix(&projection, &view, &viewProjection);
+  GrrVector4 planes[6];
+  Grr_frustumPlanes(&viewProjection, planes);
+
+  const char *names[] = {"spheres", "boxes"};
+  for (Grr_u32 type = 0; type < 2; type++) {
+    for (Grr_u32 parallel = 0; parallel < 2; parallel++) {
+      Grr_u32 visibleCount = 0;
+      Grr_f64 start = Grr_seconds();
+      for (Grr_u32 round = 0; round < ROUNDS; round++) {
+        if (type == 0) {
+          visibleCount =
+              (parallel ? Grr_cullSpheresParallel(planes, &spheres, visible)
+                        : Grr_cullSpheres(planes, &spheres, 0, COUNT,
+                                          visible));
+        } else {
+          visibleCount =
+              (parallel ? Grr_cullBoxesParallel(planes, &boxes, visible)
+                        : Grr_cullBoxes(planes, &boxes, 0, COUNT, visible));
+        }
+      }
+      Grr_f64 seconds = (Grr_seconds() - start) / ROUNDS;
+      GRR_LOG_INFO("Grr_cull %s, %u threads: %.1f objects/us (%u of %u "
+                   "visible)\n",
+                   names[type], parallel ? Grr_jobThreadCount() : 1,
+                   (Grr_f64)COUNT / seconds * 1e-6, visibleCount, COUNT);
+    }
+  }
+
+  free(visible);
+  Grr_destroyBoundingSpheres(&spheres);
+  Grr_destroyBoundingBoxes(&boxes);
+}
@@ -0,0 +1,10 @@
+#ifndef GRR_BENCH_CULLING_H
+#define GRR_BENCH_CULLING_H
+
+#include "culling.h"
+#include "logging.h"
+#include "utils.h"
+
+void bench_Grr_cull();
+
+#endif
@@ -0,0 +1,54 @@
+#include "bench_pipelines.h"
+
+Grr_f64 _bench_Grr_buildPipeline(VkPipelineCache cache) {
+  VkPipeline pipeline;
+  Grr_f64 start = Grr_seconds();
+  if (!_Grr_buildGraphicsPipeline(cache, &pipeline)) {
+    GRR_LOG_ERROR("Failed to create benchmark pipeline\n");
+    return 0.0;
+  }
+  Grr_f64 seconds = Grr_seconds() - start;
+  vkDestroyPipeline(device, pipeline, NULL);
+  return seconds;
+}
+
+void bench_Grr_pipelineCache() {
+  // Cold: empty cache (drivers may still hit their own shader caches)
+  VkPipelineCacheCreateInfo createInfo = {0};
+  createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  VkPipelineCache coldCache;
+  if (vkCreatePipelineCache(device, &createInfo, NULL, &coldCache) !=
+      VK_SUCCESS) {
+    GRR_LOG_ERROR("Failed to create benchmark pipeline cache\n");
+    return;
+  }
+  Grr_f64 cold = _bench_Grr_buildPipeline(coldCache);
+
+  // Warm: cache created from the data of the cold one, as loaded at startup
+  size_t nBytes = 0;
+  vkGetPipelineCacheData(device, coldCache, &nBytes, NULL);
+  Grr_byte *bytes = (Grr_byte *)malloc(nBytes);
+  if (NULL == bytes) {
+    vkDestroyPipelineCache(device, coldCache, NULL);
+    return;
+  }
+  vkGetPipelineCacheData(device, coldCache, &nBytes, bytes);
+  vkDestroyPipelineCache(device, coldCache, NULL);
+
+  createInfo.initialDataSize = nBytes;
+  createInfo.pInitialData = bytes;
+  VkPipelineCache warmCache;
+  VkResult result =
+      vkCreatePipelineCache(device, &createInfo, NULL, &warmCache);
+  free(bytes);
+  if (result != VK_SUCCESS) {
+    GRR_LOG_ERROR("Failed to create benchmark pipeline cache\n");
+    return;
+  }
+  Grr_f64 warm = _bench_Grr_buildPipeline(warmCache);
+  vkDestroyPipelineCache(device, warmCache, NULL);
+
+  GRR_LOG_INFO("Graphics pipeline creation: cold %.2f ms, warm %.2f ms "
+               "(%zu bytes of cache data)\n",
+               cold * 1e3, warm * 1e3, nBytes);
+}
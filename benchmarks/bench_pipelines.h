@@ -0,0 +1,10 @@
+#ifndef GRR_BENCH_PIPELINES_H
+#define GRR_BENCH_PIPELINES_H
+
+#include "logging.h"
+#include "utils.h"
+#include "vulkan.h"
+
+void bench_Grr_pipelineCache();
+
+#endif
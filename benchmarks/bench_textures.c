@@ -0,0 +1,42 @@
+#include "bench_textures.h"
+
+void bench_Grr_encodeBC() {
+  // Synthetic 2048x2048 image: smooth gradients with some high frequency noise
+  enum { SIZE = 2048 };
+  Grr_byte *rgba = (Grr_byte *)malloc((size_t)SIZE * SIZE * 4);
+  Grr_byte *blocks = (Grr_byte *)malloc(Grr_bcImageBytes(GRR_BC7, SIZE, SIZE));
+  if (NULL == rgba || NULL == blocks) {
+    GRR_LOG_ERROR("Failed to allocate benchmark images\n");
+    free(rgba);
+    free(blocks);
+    return;
+  }
+  Grr_u32 seed = 1;
+  for (Grr_u32 y = 0; y < SIZE; y++) {
+    for (Grr_u32 x = 0; x < SIZE; x++) {
+      seed = seed * 1664525 + 1013904223;
+      Grr_byte *texel = &rgba[((size_t)y * SIZE + x) * 4];
+      texel[0] = (Grr_byte)(x >> 3);
+      texel[1] = (Grr_byte)(y >> 3);
+      texel[2] = (Grr_byte)((x + y) >> 4) + (Grr_byte)(seed >> 28);
+      texel[3] = (Grr_byte)(255 - (seed >> 29));
+    }
+  }
+
+  const char *formatNames[] = {"BC1", "BC3", "BC4", "BC5", "BC7"};
+  const char *qualityNames[] = {"fast", "high"};
+  for (Grr_u32 q = GRR_BC_QUALITY_FAST; q <= GRR_BC_QUALITY_HIGH; q++) {
+    for (Grr_u32 f = GRR_BC1; f <= GRR_BC7; f++) {
+      Grr_f64 start = Grr_seconds();
+      Grr_encodeBC(rgba, SIZE, SIZE, f, q, blocks);
+      Grr_f64 seconds = Grr_seconds() - start;
+      GRR_LOG_INFO("Grr_encodeBC %s %s: %.1f MP/s (%u threads)\n",
+                   formatNames[f], qualityNames[q],
+                   (Grr_f64)SIZE * SIZE / seconds * 1e-6,
+                   Grr_jobThreadCount());
+    }
+  }
+
+  free(rgba);
+  free(blocks);
+}
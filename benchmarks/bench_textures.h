@@ -0,0 +1,10 @@
+#ifndef GRR_BENCH_TEXTURES_H
+#define GRR_BENCH_TEXTURES_H
+
+#include "logging.h"
+#include "textures.h"
+#include "utils.h"
+
+void bench_Grr_encodeBC();
+
+#endif
@@ -0,0 +1,27 @@
+#include "bench_commands.h"
+#include "bench_culling.h"
+#include "bench_pipelines.h"
+#include "bench_textures.h"
+#include <stdlib.h>
+
+int main(int argc, char *argv[]) {
+  // Start worker threads before timing anything
+  Grr_initializeJobs(0);
+
+  // Assets
+  bench_Grr_encodeBC();
+
+  // Culling
+  bench_Grr_cull();
+
+  // Renderer, headless so it runs without a display
+  Grr_initializeVulkanHeadless(256, 256);
+  bench_Grr_pipelineCache();
+  bench_Grr_recordCommandBuffer();
+
+  // Frames drawn, optionally given as the first argument
+  Grr_u32 frameCount = argc > 1 ? (Grr_u32)strtoul(argv[1], NULL, 10) : 100;
+  bench_Grr_drawFrames(frameCount);
+
+  return EXIT_SUCCESS;
+}
@@ -60,6 +60,110 @@ Grr_getAtributeDescriptions(Grr_u32 *attributeDescriptionCount) {
   return attributeDescriptions;
 }
 
+VkVertexInputBindingDescription *
+Grr_getQuantizedBindingDescriptions(Grr_u32 *bindingDescriptionCount) {
+  *bindingDescriptionCount = 1;
+
+  VkVertexInputBindingDescription *bindingDescriptions =
+      (VkVertexInputBindingDescription *)malloc(
+          sizeof(VkVertexInputBindingDescription) * (*bindingDescriptionCount));
+  if (bindingDescriptions == NULL) {
+    GRR_LOG_CRITICAL("Failed to allocate memory for binding descriptions\n");
+    return NULL;
+  }
+
+  // Interleaved quantized vertices
+  bindingDescriptions[0].binding = 0;
+  bindingDescriptions[0].stride = sizeof(GrrQuantizedVertex);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  return bindingDescriptions;
+}
+
+VkVertexInputAttributeDescription *
+Grr_getQuantizedAttributeDescriptions(Grr_u32 *attributeDescriptionCount) {
+  *attributeDescriptionCount = 4;
+
+  VkVertexInputAttributeDescription *attributeDescriptions =
+      (VkVertexInputAttributeDescription *)malloc(
+          sizeof(VkVertexInputAttributeDescription) *
+          (*attributeDescriptionCount));
+  if (attributeDescriptions == NULL) {
+    GRR_LOG_CRITICAL("Failed to allocate memory for attribute descriptions\n");
+    return NULL;
+  }
+
+  // Positions (AABB-relative, dequantized by the model matrix)
+  attributeDescriptions[0].binding = 0;
+  attributeDescriptions[0].location = 0;
+  attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+  attributeDescriptions[0].offset = offsetof(GrrQuantizedVertex, position);
+
+  // Octahedral normals
+  attributeDescriptions[1].binding = 0;
+  attributeDescriptions[1].location = 1;
+  attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+  attributeDescriptions[1].offset = offsetof(GrrQuantizedVertex, normal);
+
+  // Octahedral tangents
+  attributeDescriptions[2].binding = 0;
+  attributeDescriptions[2].location = 2;
+  attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+  attributeDescriptions[2].offset = offsetof(GrrQuantizedVertex, tangent);
+
+  // Texture coordinates
+  attributeDescriptions[3].binding = 0;
+  attributeDescriptions[3].location = 3;
+  attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+  attributeDescriptions[3].offset =
+      offsetof(GrrQuantizedVertex, textureCoordinates);
+
+  return attributeDescriptions;
+}
+
+VkVertexInputBindingDescription *
+Grr_getQuantizedPositionBindingDescriptions(Grr_u32 *bindingDescriptionCount) {
+  *bindingDescriptionCount = 1;
+
+  VkVertexInputBindingDescription *bindingDescriptions =
+      (VkVertexInputBindingDescription *)malloc(
+          sizeof(VkVertexInputBindingDescription) * (*bindingDescriptionCount));
+  if (bindingDescriptions == NULL) {
+    GRR_LOG_CRITICAL("Failed to allocate memory for binding descriptions\n");
+    return NULL;
+  }
+
+  // Quantized positions
+  bindingDescriptions[0].binding = 0;
+  bindingDescriptions[0].stride = sizeof(GrrQuantizedPosition);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  return bindingDescriptions;
+}
+
+VkVertexInputAttributeDescription *
+Grr_getQuantizedPositionAttributeDescriptions(
+    Grr_u32 *attributeDescriptionCount) {
+  *attributeDescriptionCount = 1;
+
+  VkVertexInputAttributeDescription *attributeDescriptions =
+      (VkVertexInputAttributeDescription *)malloc(
+          sizeof(VkVertexInputAttributeDescription) *
+          (*attributeDescriptionCount));
+  if (attributeDescriptions == NULL) {
+    GRR_LOG_CRITICAL("Failed to allocate memory for attribute descriptions\n");
+    return NULL;
+  }
+
+  // Positions (AABB-relative, dequantized by the model matrix)
+  attributeDescriptions[0].binding = 0;
+  attributeDescriptions[0].location = 0;
+  attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+  attributeDescriptions[0].offset = offsetof(GrrQuantizedPosition, position);
+
+  return attributeDescriptions;
+}
+
 // PNG decompression
 
 Grr_byte _Grr_reconA(Grr_byte *bytes, Grr_u32 r, Grr_u32 c, Grr_u32 stride,
@@ -333,6 +437,22 @@ Grr_byte *Grr_loadPNG(const Grr_string path, Grr_u32 *nReadBytes, Grr_u32 *w,
 #undef CHUNK_IS_IDA
 }
 
+Grr_byte *Grr_loadImage(const Grr_string path, Grr_u32 *nReadBytes, Grr_u32 *w,
+                        Grr_u32 *h) {
+  // Decoder from the first bytes: JPEG files start with an SOI marker
+  Grr_byte magic[2] = {0};
+  FILE *f = fopen(path, "rb");
+  if (NULL != f) {
+    if (fread(magic, 1, 2, f) != 2)
+      magic[0] = 0;
+    fclose(f);
+  }
+
+  if (magic[0] == 0xFF && magic[1] == 0xD8)
+    return Grr_loadJPEG(path, nReadBytes, w, h);
+  return Grr_loadPNG(path, nReadBytes, w, h);
+}
+
 // * JSON grammar: https://www.rfc-editor.org/rfc/pdfrfc/rfc8259.txt.pdf and
 // https://www.json.org/json-en.html
 // - JSON text encoding UTF-8: https://datatracker.ietf.org/doc/html/rfc3629
@@ -604,6 +724,147 @@ void _Grr_endJSONLiteral(GrrList *stack, GrrList *objStack, Grr_byte value) {
   }
 }
 
+// Buffers without data (EXT_meshopt_compression fallback or uri-less buffers)
+// are filled by decoding compressed buffer views
+Grr_bool _Grr_glTFDecodedBuffer(GrrHashMap *buffer) {
+  GrrHashMapValue *extensions = Grr_hashMapGet(buffer, "extensions", NULL);
+  GrrHashMapValue *meshopt =
+      (extensions ? Grr_hashMapGet(extensions->map, "EXT_meshopt_compression",
+                                   NULL)
+                  : NULL);
+  GrrHashMapValue *fallback =
+      (meshopt ? Grr_hashMapGet(meshopt->map, "fallback", NULL) : NULL);
+  return Grr_hashMapGet(buffer, "uri", NULL) == NULL ||
+         (fallback && fallback->boolean);
+}
+
+// Non-negative integer property of a JSON object, false when it is missing
+Grr_bool _Grr_glTFInteger(GrrHashMap *map, const Grr_string key,
+                          Grr_u64 *integer) {
+  GrrType type;
+  GrrHashMapValue *value = Grr_hashMapGet(map, key, &type);
+  if (NULL == value || type != INT64 || value->i64 < 0) {
+    GRR_LOG_ERROR("glTF: missing or invalid property %s\n", key);
+    return false;
+  }
+  *integer = (Grr_u64)value->i64;
+  return true;
+}
+
+// EXT_meshopt_compression: decodes compressed buffer views into the buffer
+// they point to. Views are independent and decoded in parallel. Views of an
+// unknown mode or filter keep the uncompressed data of their buffer when it
+// has some (no fallback), and fail the load otherwise
+Grr_bool _Grr_glTFDecodeCompressedBufferViews(GrrAssetglTF *glTF,
+                                              GrrList *bufferList,
+                                              GrrList *bufferViewList) {
+  GrrMeshoptCompression *compressions = (GrrMeshoptCompression *)malloc(
+      sizeof(GrrMeshoptCompression) * (bufferViewList->count + 1));
+  if (NULL == compressions) {
+    GRR_LOG_ERROR("glTF: failed to allocate memory for compressed views\n");
+    return false;
+  }
+
+  Grr_u32 count = 0;
+  for (Grr_u32 i = 0; i < bufferViewList->count; i++) {
+    GrrHashMapValue *value = Grr_listGetAtIndex(bufferViewList, i, NULL);
+    GrrHashMapValue *extensions =
+        Grr_hashMapGet(value->map, "extensions", NULL);
+    GrrHashMapValue *meshopt =
+        (extensions ? Grr_hashMapGet(extensions->map, "EXT_meshopt_compression",
+                                     NULL)
+                    : NULL);
+    if (NULL == meshopt)
+      continue;
+
+    Grr_u64 buffer, byteOffset = 0, byteLength, elementCount, byteStride;
+    GrrType type;
+    GrrHashMapValue *modeValue = Grr_hashMapGet(meshopt->map, "mode", &type);
+    if (!_Grr_glTFInteger(meshopt->map, "buffer", &buffer) ||
+        !_Grr_glTFInteger(meshopt->map, "byteLength", &byteLength) ||
+        !_Grr_glTFInteger(meshopt->map, "count", &elementCount) ||
+        !_Grr_glTFInteger(meshopt->map, "byteStride", &byteStride) ||
+        (Grr_hashMapGet(meshopt->map, "byteOffset", NULL) &&
+         !_Grr_glTFInteger(meshopt->map, "byteOffset", &byteOffset)) ||
+        NULL == modeValue || type != STRING) {
+      GRR_LOG_ERROR("glTF: compressed buffer view %u is malformed\n", i);
+      free(compressions);
+      return false;
+    }
+    GrrBufferView *bufferView = &glTF->bufferViews[i];
+    if (buffer >= glTF->bufferCount ||
+        byteOffset + byteLength > glTF->bufferSizes[buffer] ||
+        bufferView->bufferIndex >= glTF->bufferCount ||
+        (size_t)bufferView->offset + bufferView->nBytes >
+            glTF->bufferSizes[bufferView->bufferIndex] ||
+        elementCount * byteStride > bufferView->nBytes) {
+      GRR_LOG_ERROR("glTF: compressed buffer view %u overflows its buffers\n",
+                    i);
+      free(compressions);
+      return false;
+    }
+
+    GrrMeshoptCompression *compression = &compressions[count];
+    compression->source = glTF->buffers[buffer] + byteOffset;
+    compression->sourceBytes = byteLength;
+    compression->destination =
+        glTF->buffers[bufferView->bufferIndex] + bufferView->offset;
+    compression->count = (Grr_u32)elementCount;
+    compression->stride = (Grr_u32)byteStride;
+
+    Grr_bool known = true;
+    Grr_string mode = modeValue->string;
+    if (0 == strcmp(mode, "ATTRIBUTES"))
+      compression->mode = GRR_MESHOPT_MODE_ATTRIBUTES;
+    else if (0 == strcmp(mode, "TRIANGLES"))
+      compression->mode = GRR_MESHOPT_MODE_TRIANGLES;
+    else if (0 == strcmp(mode, "INDICES"))
+      compression->mode = GRR_MESHOPT_MODE_INDICES;
+    else
+      known = false;
+
+    compression->filter = GRR_MESHOPT_FILTER_NONE;
+    GrrHashMapValue *filterValue =
+        Grr_hashMapGet(meshopt->map, "filter", &type);
+    if (filterValue) {
+      if (type != STRING)
+        known = false;
+      else if (0 == strcmp(filterValue->string, "NONE"))
+        compression->filter = GRR_MESHOPT_FILTER_NONE;
+      else if (0 == strcmp(filterValue->string, "OCTAHEDRAL"))
+        compression->filter = GRR_MESHOPT_FILTER_OCTAHEDRAL;
+      else if (0 == strcmp(filterValue->string, "QUATERNION"))
+        compression->filter = GRR_MESHOPT_FILTER_QUATERNION;
+      else if (0 == strcmp(filterValue->string, "EXPONENTIAL"))
+        compression->filter = GRR_MESHOPT_FILTER_EXPONENTIAL;
+      else
+        known = false;
+    }
+
+    if (!known) {
+      GrrHashMapValue *target =
+          Grr_listGetAtIndex(bufferList, bufferView->bufferIndex, NULL);
+      if (_Grr_glTFDecodedBuffer(target->map)) {
+        GRR_LOG_ERROR("glTF: compressed buffer view %u has an unknown mode "
+                      "or filter and no uncompressed data\n",
+                      i);
+        free(compressions);
+        return false;
+      }
+      GRR_LOG_WARNING("glTF: compressed buffer view %u has an unknown mode "
+                      "or filter, keeping its uncompressed data\n",
+                      i);
+      continue;
+    }
+    count++;
+  }
+
+  Grr_bool decoded = Grr_meshoptDecodeAll(compressions, count);
+  GRR_LOG_DEBUG("glTF: decoded %u compressed buffer views\n", count);
+  free(compressions);
+  return decoded;
+}
+
 GrrAssetglTF *_Grr_glTFFromJSON(GrrHashMap *json, Grr_string assetDir) {
   GrrAssetglTF *glTF = (GrrAssetglTF *)malloc(sizeof(GrrAssetglTF));
   if (NULL == glTF) {
@@ -616,10 +877,13 @@ GrrAssetglTF *_Grr_glTFFromJSON(GrrHashMap *json, Grr_string assetDir) {
   assert(type == LIST);
   glTF->buffers =
       (Grr_byte **)malloc(sizeof(Grr_byte *) * buffersList->list->count);
-  if (NULL == glTF->buffers) {
+  glTF->bufferSizes =
+      (size_t *)malloc(sizeof(size_t) * buffersList->list->count);
+  if (NULL == glTF->buffers || NULL == glTF->bufferSizes) {
     GRR_LOG_ERROR("glTF: failed to allocate memory for buffer list\n");
     return NULL;
   }
+  glTF->bufferCount = buffersList->list->count;
 
   GrrHashMapValue *value;
   size_t nBytes;
@@ -636,7 +900,19 @@ GrrAssetglTF *_Grr_glTFFromJSON(GrrHashMap *json, Grr_string assetDir) {
     value = Grr_listGetAtIndex(buffersList->list, i, &type);
     assert(type == HASH_MAP);
     assert(Grr_hashMapGet(value->map, "byteLength", NULL) != NULL);
-    assert(Grr_hashMapGet(value->map, "uri", NULL) != NULL);
+
+    // Filled later by decoding compressed buffer views
+    if (_Grr_glTFDecodedBuffer(value->map)) {
+      nBytes = Grr_hashMapGet(value->map, "byteLength", NULL)->i64;
+      glTF->buffers[i] = (Grr_byte *)calloc(nBytes ? nBytes : 1, 1);
+      if (NULL == glTF->buffers[i]) {
+        GRR_LOG_ERROR("glTF: failed to allocate memory for buffer %u\n", i);
+        return NULL;
+      }
+      glTF->bufferSizes[i] = nBytes;
+      GRR_LOG_DEBUG("glTF: allocated decoding buffer (%zu)\n", nBytes);
+      continue;
+    }
     uri = Grr_hashMapGet(value->map, "uri", NULL)->string;
 
     GRR_LOG_DEBUG("URI %s%s\n", assetDir,
@@ -655,7 +931,12 @@ GrrAssetglTF *_Grr_glTFFromJSON(GrrHashMap *json, Grr_string assetDir) {
       memcpy(pathURI + lenAssetDir, uri, lenURI);
       pathURI[lenAssetDir + lenURI] = '\0';
       glTF->buffers[i] = Grr_readBytesFromFile(pathURI, &nBytes);
+      if (NULL == glTF->buffers[i]) {
+        GRR_LOG_ERROR("glTF: failed to read buffer %u\n", i);
+        return NULL;
+      }
       assert(nBytes == Grr_hashMapGet(value->map, "byteLength", NULL)->i64);
+      glTF->bufferSizes[i] = nBytes;
       GRR_LOG_DEBUG("glTF: read buffer bytes (%llu)\n", nBytes);
     }
   }
@@ -682,6 +963,12 @@ GrrAssetglTF *_Grr_glTFFromJSON(GrrHashMap *json, Grr_string assetDir) {
       if (targetValue)
         glTF->bufferViews[i].target = targetValue->i64;
     }
+
+    if (!_Grr_glTFDecodeCompressedBufferViews(glTF, buffersList->list,
+                                              bufferViewList->list)) {
+      GRR_LOG_ERROR("glTF: failed to decode compressed buffer views\n");
+      return NULL;
+    }
   } else {
     GRR_LOG_ERROR("glTF: failed to allocate memory for buffer views\n");
   }
@@ -796,6 +1083,15 @@ GrrAssetglTF *_Grr_glTFFromJSON(GrrHashMap *json, Grr_string assetDir) {
               Grr_hashMapGet(attributesObj, "POSITION", NULL);
           glTF->meshes[i].primitives[j].verticesAccessorIndex =
               (attribute ? attribute->i64 : -1);
+          attribute = Grr_hashMapGet(attributesObj, "NORMAL", NULL);
+          glTF->meshes[i].primitives[j].normalsAccessorIndex =
+              (attribute ? attribute->i64 : -1);
+          attribute = Grr_hashMapGet(attributesObj, "TANGENT", NULL);
+          glTF->meshes[i].primitives[j].tangentsAccessorIndex =
+              (attribute ? attribute->i64 : -1);
+          attribute = Grr_hashMapGet(attributesObj, "TEXCOORD_0", NULL);
+          glTF->meshes[i].primitives[j].textureCoordinatesAccessorIndex =
+              (attribute ? attribute->i64 : -1);
           // TODO: other attributes
           // Indexed primitive
           GrrHashMapValue *indicesValue =
@@ -1497,25 +1793,85 @@ Grr_bytesPerglTFComponentType(GRR_ACCESSOR_COMPONENT_TYPE componentType) {
   }
 }
 
+// Copy of the elements of components floats each of accessor, tightly packed
+// whatever the stride of its buffer view. NULL when they do not fit in the
+// buffer view
+Grr_f32 *_Grr_packedFloatAttribute(GrrAssetglTF *gltf,
+                                   const GrrAccessor *accessor,
+                                   Grr_u32 components) {
+  GrrBufferView bufferView = gltf->bufferViews[accessor->bufferViewIndex];
+  size_t elementBytes = sizeof(Grr_f32) * components;
+  size_t stride = (bufferView.stride > 0 ? (size_t)bufferView.stride
+                                          : elementBytes);
+  if (stride < elementBytes ||
+      (accessor->count > 0 &&
+       accessor->byteOffset + stride * (accessor->count - 1) + elementBytes >
+           bufferView.nBytes)) {
+    GRR_LOG_ERROR("glTF: vertex attribute overflows its buffer view\n");
+    return NULL;
+  }
+
+  Grr_byte *elements = gltf->buffers[bufferView.bufferIndex] +
+                       bufferView.offset + accessor->byteOffset;
+  Grr_f32 *packed = (Grr_f32 *)malloc(elementBytes * accessor->count);
+  if (NULL == packed) {
+    GRR_LOG_ERROR("glTF: failed to allocate memory for vertex attribute\n");
+    return NULL;
+  }
+  for (Grr_u32 i = 0; i < accessor->count; i++)
+    memcpy(packed + (size_t)i * components, elements + stride * i,
+           elementBytes);
+  return packed;
+}
+
+// Float attribute data for an optional vertex attribute of vertexCount
+// elements of components floats (NULL if absent or not stored as such)
+Grr_f32 *_Grr_floatAttributeFromAsset(GrrAssetglTF *gltf,
+                                      Grr_i32 accessorIndex,
+                                      Grr_u32 components,
+                                      Grr_u32 vertexCount) {
+  if (accessorIndex == -1)
+    return NULL;
+
+  GrrAccessor accessor = gltf->accessors[accessorIndex];
+  // VEC2, VEC3 and VEC4 follow SCALAR
+  if (NULL != accessor.sparseAccessor || accessor.bufferViewIndex == -1 ||
+      accessor.componentType != COMPONENT_TYPE_FLOAT ||
+      accessor.type != (GRR_ACCESSOR_ELEMENT_TYPE)(components - 1)) {
+    // TODO: sparse and normalized integer attributes
+    GRR_LOG_WARNING("glTF: skipping unsupported vertex attribute accessor %d\n",
+                    accessorIndex);
+    return NULL;
+  }
+  if (accessor.count != vertexCount) {
+    GRR_LOG_WARNING("glTF: skipping vertex attribute accessor %d of %u "
+                    "elements for %u vertices\n",
+                    accessorIndex, accessor.count, vertexCount);
+    return NULL;
+  }
+
+  return _Grr_packedFloatAttribute(gltf, &accessor, components);
+}
+
 void Grr_modelFromAsset(GrrModel *model, GrrAssetglTF *gltf, Grr_u32 meshIndex,
                         Grr_u32 primitiveIndex) {
   GrrMesh *mesh = &gltf->meshes[meshIndex];
   GrrMeshPrimitive *primitive = &mesh->primitives[primitiveIndex];
 
-  // TODO: what if vertex data is not tightly packed ?
-
   // Vertices
   GrrAccessor verticesAccessor =
       gltf->accessors[primitive->verticesAccessorIndex];
   if (NULL == verticesAccessor.sparseAccessor) {
-    model->vertexCount = verticesAccessor.count;
-    GrrBufferView bufferView =
-        gltf->bufferViews[verticesAccessor.bufferViewIndex];
-    model->positions =
-        (Grr_f32 *)(gltf->buffers[bufferView.bufferIndex] +
-                    verticesAccessor.byteOffset + bufferView.offset);
-    model->colors = NULL;             // TODO
-    model->textureCoordinates = NULL; // TODO
+    model->positions = _Grr_packedFloatAttribute(gltf, &verticesAccessor, 3);
+    model->vertexCount = (model->positions ? verticesAccessor.count : 0);
+    model->normals = _Grr_floatAttributeFromAsset(
+        gltf, primitive->normalsAccessorIndex, 3, model->vertexCount);
+    model->tangents = _Grr_floatAttributeFromAsset(
+        gltf, primitive->tangentsAccessorIndex, 4, model->vertexCount);
+    model->colors = NULL; // TODO
+    model->textureCoordinates = _Grr_floatAttributeFromAsset(
+        gltf, primitive->textureCoordinatesAccessorIndex, 2,
+        model->vertexCount);
   } else {
     // TODO: handle sparse accessor
     GRR_LOG_CRITICAL("Sparse accessors not supported!");
@@ -1523,6 +1879,8 @@ void Grr_modelFromAsset(GrrModel *model, GrrAssetglTF *gltf, Grr_u32 meshIndex,
   }
 
   // Indices
+  model->indexCount = 0;
+  model->indices = NULL;
   if (primitive->indicesAccessorIndex == -1) {
     // Not indexed TODO
     // When indices property is not defined, attribute accessors' count
@@ -1537,14 +1895,18 @@ void Grr_modelFromAsset(GrrModel *model, GrrAssetglTF *gltf, Grr_u32 meshIndex,
       model->indexCount = indicesAccessor.count;
       GrrBufferView bufferView =
           gltf->bufferViews[indicesAccessor.bufferViewIndex];
+      model->indices = (Grr_u32 *)malloc(sizeof(Grr_u32) * model->indexCount);
+      if (NULL == model->indices) {
+        GRR_LOG_CRITICAL("Failed to allocate memory for indices\n");
+        exit(EXIT_FAILURE);
+      }
       if (indicesAccessor.componentType == COMPONENT_TYPE_UNSIGNED_INT) {
-        model->indices =
-            (Grr_u32 *)(gltf->buffers[bufferView.bufferIndex] +
-                        indicesAccessor.byteOffset + bufferView.offset);
+        memcpy(model->indices,
+               gltf->buffers[bufferView.bufferIndex] +
+                   indicesAccessor.byteOffset + bufferView.offset,
+               sizeof(Grr_u32) * model->indexCount);
       } else {
         // Convert to COMPONENT_TYPE_UNSIGNED_INT
-        model->indices = (Grr_u32 *)malloc(
-            sizeof(Grr_u32) * model->indexCount); // TODO: where to free ?
         size_t bytesPerIndex =
             Grr_bytesPerglTFComponentType(indicesAccessor.componentType);
         if (bytesPerIndex == 1) {
@@ -1569,3 +1931,342 @@ void Grr_modelFromAsset(GrrModel *model, GrrAssetglTF *gltf, Grr_u32 meshIndex,
     }
   }
 }
+
+void Grr_freeModel(GrrModel *model) {
+  free(model->positions);
+  free(model->normals);
+  free(model->tangents);
+  free(model->colors);
+  free(model->textureCoordinates);
+  free(model->indices);
+  model->positions = NULL;
+  model->normals = NULL;
+  model->tangents = NULL;
+  model->colors = NULL;
+  model->textureCoordinates = NULL;
+  model->indices = NULL;
+}
+
+// KTX2
+
+Grr_bool Grr_formatBlockInfo(VkFormat format, Grr_u32 *blockWidth,
+                             Grr_u32 *blockHeight, Grr_u32 *blockBytes) {
+  *blockWidth = 4;
+  *blockHeight = 4;
+  switch (format) {
+  case VK_FORMAT_R8G8B8A8_UNORM:
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    *blockWidth = 1;
+    *blockHeight = 1;
+    *blockBytes = 4;
+    return true;
+  case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+  case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+  case VK_FORMAT_BC4_UNORM_BLOCK:
+  case VK_FORMAT_BC4_SNORM_BLOCK:
+  case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+  case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+  case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+  case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+  case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+  case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+    *blockBytes = 8;
+    return true;
+  case VK_FORMAT_BC2_UNORM_BLOCK:
+  case VK_FORMAT_BC2_SRGB_BLOCK:
+  case VK_FORMAT_BC3_UNORM_BLOCK:
+  case VK_FORMAT_BC3_SRGB_BLOCK:
+  case VK_FORMAT_BC5_UNORM_BLOCK:
+  case VK_FORMAT_BC5_SNORM_BLOCK:
+  case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+  case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+  case VK_FORMAT_BC7_UNORM_BLOCK:
+  case VK_FORMAT_BC7_SRGB_BLOCK:
+  case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+  case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+  case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+  case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+    *blockBytes = 16;
+    return true;
+  default:
+    break;
+  }
+
+  // ASTC LDR formats are contiguous UNORM/SRGB pairs from 4x4 to 12x12
+  if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK &&
+      format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+    const Grr_byte astcBlocks[14][2] = {{4, 4},  {5, 4},   {5, 5},   {6, 5},
+                                        {6, 6},  {8, 5},   {8, 6},   {8, 8},
+                                        {10, 5}, {10, 6},  {10, 8},  {10, 10},
+                                        {12, 10}, {12, 12}};
+    Grr_u32 i = (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2;
+    *blockWidth = astcBlocks[i][0];
+    *blockHeight = astcBlocks[i][1];
+    *blockBytes = 16;
+    return true;
+  }
+
+  return false;
+}
+
+Grr_u32 _Grr_readU32LE(const Grr_byte *bytes) {
+  return (Grr_u32)bytes[0] | ((Grr_u32)bytes[1] << 8) |
+         ((Grr_u32)bytes[2] << 16) | ((Grr_u32)bytes[3] << 24);
+}
+
+Grr_u64 _Grr_readU64LE(const Grr_byte *bytes) {
+  return (Grr_u64)_Grr_readU32LE(bytes) |
+         ((Grr_u64)_Grr_readU32LE(bytes + 4) << 32);
+}
+
+Grr_bool Grr_parseKTX2(Grr_byte *bytes, size_t nBytes, GrrImageKTX2 *image) {
+  const Grr_byte identifier[12] = {0xAB, 'K',  'T',  'X',  ' ',  '2',
+                                   '0',  0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  const size_t headerBytes = 80; // Identifier, header and index
+  const size_t levelIndexEntryBytes = 24;
+
+  memset(image, 0, sizeof(GrrImageKTX2));
+  if (nBytes < headerBytes || 0 != memcmp(bytes, identifier, 12)) {
+    GRR_LOG_ERROR("KTX2: invalid identifier\n");
+    return false;
+  }
+
+  VkFormat format = (VkFormat)_Grr_readU32LE(bytes + 12);
+  Grr_u32 width = _Grr_readU32LE(bytes + 20);
+  Grr_u32 height = _Grr_readU32LE(bytes + 24);
+  Grr_u32 depth = _Grr_readU32LE(bytes + 28);
+  Grr_u32 layerCount = _Grr_readU32LE(bytes + 32);
+  Grr_u32 faceCount = _Grr_readU32LE(bytes + 36);
+  Grr_u32 levelCount = _Grr_readU32LE(bytes + 40);
+  Grr_u32 supercompressionScheme = _Grr_readU32LE(bytes + 44);
+
+  if (width == 0 || height == 0 || depth != 0 || layerCount > 1 ||
+      faceCount != 1) {
+    GRR_LOG_ERROR("KTX2: only 2D textures are supported\n");
+    return false;
+  }
+  if (supercompressionScheme != 0) {
+    GRR_LOG_ERROR("KTX2: supercompression scheme %u not supported\n",
+                  supercompressionScheme);
+    return false;
+  }
+  Grr_u32 blockWidth, blockHeight, blockBytes;
+  if (!Grr_formatBlockInfo(format, &blockWidth, &blockHeight, &blockBytes)) {
+    GRR_LOG_ERROR("KTX2: unsupported format (%u)\n", format);
+    return false;
+  }
+
+  // Level count 0 asks the loader to generate mips: only the base is stored
+  Grr_u32 storedLevels = (levelCount ? levelCount : 1);
+  if (storedLevels > GRR_KTX2_MAX_LEVELS ||
+      ((width | height) >> (storedLevels - 1)) == 0) {
+    GRR_LOG_ERROR("KTX2: invalid level count (%u)\n", levelCount);
+    return false;
+  }
+  if (nBytes < headerBytes + storedLevels * levelIndexEntryBytes) {
+    GRR_LOG_ERROR("KTX2: truncated level index\n");
+    return false;
+  }
+
+  for (Grr_u32 i = 0; i < storedLevels; i++) {
+    const Grr_byte *entry = bytes + headerBytes + i * levelIndexEntryBytes;
+    Grr_u64 offset = _Grr_readU64LE(entry);
+    Grr_u64 length = _Grr_readU64LE(entry + 8);
+
+    Grr_u32 levelWidth = (width >> i ? width >> i : 1);
+    Grr_u32 levelHeight = (height >> i ? height >> i : 1);
+    Grr_u64 expected = (Grr_u64)((levelWidth + blockWidth - 1) / blockWidth) *
+                       ((levelHeight + blockHeight - 1) / blockHeight) *
+                       blockBytes;
+    if (offset > nBytes || length > nBytes - offset || length != expected) {
+      GRR_LOG_ERROR("KTX2: invalid level %u (offset %llu, %llu bytes)\n", i,
+                    (unsigned long long)offset, (unsigned long long)length);
+      return false;
+    }
+    image->levels[i].offset = (size_t)offset;
+    image->levels[i].nBytes = (size_t)length;
+  }
+
+  image->format = format;
+  image->width = width;
+  image->height = height;
+  image->levelCount = storedLevels;
+  image->bytes = bytes;
+  image->nBytes = nBytes;
+  return true;
+}
+
+Grr_bool Grr_loadKTX2(const Grr_string path, GrrImageKTX2 *image) {
+  size_t nBytes;
+  Grr_byte *bytes = Grr_readBytesFromFile(path, &nBytes);
+  if (NULL == bytes)
+    return false;
+
+  if (!Grr_parseKTX2(bytes, nBytes, image)) {
+    GRR_LOG_ERROR("KTX2: failed to parse %s\n", path);
+    free(bytes);
+    return false;
+  }
+  GRR_LOG_DEBUG("KTX2: %s %ux%u format %u, %u levels\n", path, image->width,
+                image->height, image->format, image->levelCount);
+  return true;
+}
+
+void Grr_freeKTX2(GrrImageKTX2 *image) {
+  free(image->bytes);
+  image->bytes = NULL;
+  image->nBytes = 0;
+}
+
+void _Grr_writeU32LE(Grr_byte *bytes, Grr_u32 value) {
+  for (Grr_u32 i = 0; i < 4; i++)
+    bytes[i] = (Grr_byte)(value >> (i * 8));
+}
+
+void _Grr_writeU64LE(Grr_byte *bytes, Grr_u64 value) {
+  _Grr_writeU32LE(bytes, (Grr_u32)value);
+  _Grr_writeU32LE(bytes + 4, (Grr_u32)(value >> 32));
+}
+
+// Basic data format descriptor (KDF 1.3) of the formats the cooker writes.
+// Returns the descriptor size, 0 for unsupported formats
+Grr_u32 _Grr_writeKTX2DFD(VkFormat format, Grr_byte *dfd) {
+  enum { RED = 0, GREEN = 1, BLUE = 2, ALPHA = 15 };
+  Grr_u32 model, srgb = 0, sampleCount, blockBytes;
+  Grr_u32 channels[4] = {0}, sampleBits;
+  switch (format) {
+  case VK_FORMAT_R8G8B8A8_SRGB:
+    srgb = 1; // Fallthrough
+  case VK_FORMAT_R8G8B8A8_UNORM:
+    model = 1; // RGBSDA
+    sampleCount = 4;
+    channels[0] = RED, channels[1] = GREEN, channels[2] = BLUE;
+    channels[3] = ALPHA;
+    sampleBits = 8;
+    blockBytes = 4;
+    break;
+  case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    srgb = 1; // Fallthrough
+  case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    model = 128;
+    sampleCount = 1;
+    sampleBits = 64;
+    blockBytes = 8;
+    break;
+  case VK_FORMAT_BC3_SRGB_BLOCK:
+    srgb = 1; // Fallthrough
+  case VK_FORMAT_BC3_UNORM_BLOCK:
+    model = 130;
+    sampleCount = 2;
+    channels[0] = ALPHA;
+    sampleBits = 64;
+    blockBytes = 16;
+    break;
+  case VK_FORMAT_BC4_UNORM_BLOCK:
+    model = 131;
+    sampleCount = 1;
+    sampleBits = 64;
+    blockBytes = 8;
+    break;
+  case VK_FORMAT_BC5_UNORM_BLOCK:
+    model = 132;
+    sampleCount = 2;
+    channels[1] = GREEN;
+    sampleBits = 64;
+    blockBytes = 16;
+    break;
+  case VK_FORMAT_BC7_SRGB_BLOCK:
+    srgb = 1; // Fallthrough
+  case VK_FORMAT_BC7_UNORM_BLOCK:
+    model = 134;
+    sampleCount = 1;
+    sampleBits = 128;
+    blockBytes = 16;
+    break;
+  default:
+    return 0;
+  }
+
+  Grr_u32 blockSize = 24 + 16 * sampleCount;
+  Grr_bool compressed = (model != 1);
+  memset(dfd, 0, 4 + blockSize);
+  _Grr_writeU32LE(dfd, 4 + blockSize);          // dfdTotalSize
+  _Grr_writeU32LE(dfd + 8, 2 | blockSize << 16); // Version 1.3, block size
+  _Grr_writeU32LE(dfd + 12, model | 1 << 8 | (srgb ? 2 : 1) << 16); // BT709
+  _Grr_writeU32LE(dfd + 16, (compressed ? 3 | 3 << 8 : 0)); // Block 4x4
+  dfd[20] = (Grr_byte)blockBytes;                            // bytesPlane0
+  for (Grr_u32 i = 0; i < sampleCount; i++) {
+    Grr_byte *sample = dfd + 28 + i * 16;
+    _Grr_writeU32LE(sample, (i * sampleBits) | (sampleBits - 1) << 16 |
+                                channels[i] << 24);
+    Grr_u32 upper = (compressed ? 0xFFFFFFFF : 0xFF);
+    _Grr_writeU32LE(sample + 12, upper);
+  }
+  return 4 + blockSize;
+}
+
+Grr_bool Grr_writeKTX2(const Grr_string path, VkFormat format, Grr_u32 width,
+                       Grr_u32 height, Grr_u32 levelCount,
+                       const Grr_byte *const *levelData,
+                       const size_t *levelBytes) {
+  const Grr_byte identifier[12] = {0xAB, 'K',  'T',  'X',  ' ',  '2',
+                                   '0',  0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  const size_t headerBytes = 80;
+  const size_t levelIndexEntryBytes = 24;
+  const size_t alignment = 16; // Multiple of every supported block size
+
+  Grr_byte dfd[4 + 24 + 16 * 4];
+  Grr_u32 dfdBytes = _Grr_writeKTX2DFD(format, dfd);
+  if (dfdBytes == 0 || levelCount == 0 || levelCount > GRR_KTX2_MAX_LEVELS) {
+    GRR_LOG_ERROR("KTX2: cannot write format %u with %u levels\n", format,
+                  levelCount);
+    return false;
+  }
+
+  // Levels are stored from the smallest to the base level
+  size_t dfdOffset = headerBytes + levelCount * levelIndexEntryBytes;
+  size_t levelOffsets[GRR_KTX2_MAX_LEVELS];
+  size_t nBytes = dfdOffset + dfdBytes;
+  for (Grr_u32 i = levelCount; i-- > 0;) {
+    nBytes = (nBytes + alignment - 1) & ~(alignment - 1);
+    levelOffsets[i] = nBytes;
+    nBytes += levelBytes[i];
+  }
+  if (nBytes > UINT32_MAX) {
+    GRR_LOG_ERROR("KTX2: %s too large\n", path);
+    return false;
+  }
+
+  Grr_byte *bytes = (Grr_byte *)calloc(nBytes, 1);
+  if (NULL == bytes) {
+    GRR_LOG_ERROR("KTX2: failed to allocate memory for %s\n", path);
+    return false;
+  }
+  memcpy(bytes, identifier, 12);
+  _Grr_writeU32LE(bytes + 12, format);
+  _Grr_writeU32LE(bytes + 16, 1); // typeSize (8-bit or block compressed)
+  _Grr_writeU32LE(bytes + 20, width);
+  _Grr_writeU32LE(bytes + 24, height);
+  _Grr_writeU32LE(bytes + 36, 1); // faceCount
+  _Grr_writeU32LE(bytes + 40, levelCount);
+  _Grr_writeU32LE(bytes + 48, (Grr_u32)dfdOffset);
+  _Grr_writeU32LE(bytes + 52, dfdBytes);
+  memcpy(bytes + dfdOffset, dfd, dfdBytes);
+  for (Grr_u32 i = 0; i < levelCount; i++) {
+    Grr_byte *entry = bytes + headerBytes + i * levelIndexEntryBytes;
+    _Grr_writeU64LE(entry, levelOffsets[i]);
+    _Grr_writeU64LE(entry + 8, levelBytes[i]);
+    _Grr_writeU64LE(entry + 16, levelBytes[i]);
+    memcpy(bytes + levelOffsets[i], levelData[i], levelBytes[i]);
+  }
+
+  Grr_bool written = Grr_writeBytesToFile(path, bytes, (Grr_u32)nBytes);
+  free(bytes);
+  if (!written) {
+    GRR_LOG_ERROR("KTX2: failed to write %s\n", path);
+    remove(path); // Never leave a truncated file newer than its source
+  }
+  return written;
+}
@@ -1,7 +1,10 @@
 #ifndef GRR_ASSETS_H
 #define GRR_ASSETS_H
 
+#include "jpeg.h"
 #include "logging.h"
+#include "math/quantize.h"
+#include "meshopt.h"
 #include "types.h"
 #include "utils.h"
 #include <assert.h>
@@ -73,10 +76,24 @@ Grr_getBindingDescriptions(Grr_u32 *bindingDescriptionCount);
 VkVertexInputAttributeDescription *
 Grr_getAtributeDescriptions(Grr_u32 *attributeDescriptionCount);
 
+// Vertex input for GrrQuantizedVertex (single interleaved binding)
+VkVertexInputBindingDescription *
+Grr_getQuantizedBindingDescriptions(Grr_u32 *bindingDescriptionCount);
+VkVertexInputAttributeDescription *
+Grr_getQuantizedAttributeDescriptions(Grr_u32 *attributeDescriptionCount);
+// Vertex input for GrrQuantizedPosition, read by the f32 position shader
+VkVertexInputBindingDescription *
+Grr_getQuantizedPositionBindingDescriptions(Grr_u32 *bindingDescriptionCount);
+VkVertexInputAttributeDescription *
+Grr_getQuantizedPositionAttributeDescriptions(
+    Grr_u32 *attributeDescriptionCount);
+
 typedef struct GrrModel {
   // Vertex data
   Grr_u32 vertexCount;
   Grr_f32 *positions;          // Vertex XYZ
+  Grr_f32 *normals;            // Vertex normal XYZ
+  Grr_f32 *tangents;           // Vertex tangent XYZW (W is handedness)
   Grr_f32 *colors;             // Vertex RGB
   Grr_f32 *textureCoordinates; // Vertex UV
 
@@ -149,7 +166,8 @@ typedef struct GrrMeshPrimitive {
   Grr_i32 verticesAccessorIndex; // POSITION
   Grr_i32 normalsAccessorIndex;  // NORMAL
   Grr_i32 tangentsAccessorIndex; // TANGNET
-  // TODO: TEXCOORD_n, COLOR_n, JOINTS_n, WEIGHTS_n
+  Grr_i32 textureCoordinatesAccessorIndex; // TEXCOORD_0
+  // TODO: TEXCOORD_n (n > 0), COLOR_n, JOINTS_n, WEIGHTS_n
   Grr_i32
       indicesAccessorIndex; // For indexed primitives: useful for cutting number
                             // of vertices to render by reusing their indices
@@ -164,6 +182,8 @@ typedef struct GrrMesh {
 // glTF
 typedef struct GrrAssetglTF {
   Grr_byte **buffers;         // Array of data buffers
+  size_t *bufferSizes;        // Bytes of each buffer
+  Grr_u32 bufferCount;
   GrrBufferView *bufferViews; // Buffer views
   GrrAccessor *accessors;     // Buffer view accessors
   GrrMesh *meshes;            // List of meshes
@@ -173,11 +193,57 @@ typedef struct GrrAssetglTF {
 GrrAssetglTF *Grr_glTFLoad(const Grr_string path);
 // TODO: Grr_freeglTF(GrrAssetglTF *glTF);
 
+// Vertex attributes and indices of the model are copies, freed with
+// Grr_freeModel
 void Grr_modelFromAsset(GrrModel *model, GrrAssetglTF *gltf, Grr_u32 meshIndex,
                         Grr_u32 primitiveIndex);
+// Frees the arrays of the model, its vertex and index counts are kept
+void Grr_freeModel(GrrModel *model);
 
 // Images
 Grr_byte *Grr_loadPNG(const Grr_string path, Grr_u32 *nReadbytes, Grr_u32 *w,
                       Grr_u32 *h);
+// PNG or JPEG (see jpeg.h), detected from the file contents
+Grr_byte *Grr_loadImage(const Grr_string path, Grr_u32 *nReadBytes, Grr_u32 *w,
+                        Grr_u32 *h);
+
+// Khronos KTX 2.0: https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+// Only 2D, single layer, single face textures without supercompression are
+// supported. Level data is kept in the file bytes and uploaded as is
+
+#define GRR_KTX2_MAX_LEVELS 16
+
+typedef struct GrrKTX2Level {
+  size_t offset; // Offset in file bytes
+  size_t nBytes;
+} GrrKTX2Level;
+
+typedef struct GrrImageKTX2 {
+  VkFormat format;
+  Grr_u32 width;
+  Grr_u32 height;
+  Grr_u32 levelCount;
+  GrrKTX2Level levels[GRR_KTX2_MAX_LEVELS]; // Level 0 is the base level
+  Grr_byte *bytes;                          // File bytes
+  size_t nBytes;
+} GrrImageKTX2;
+
+// Texel block dimensions and size of formats accepted in KTX2 files (block
+// compressed BCn, ETC2/EAC, ASTC LDR and uncompressed 8-bit RGBA). Returns
+// false for other formats
+Grr_bool Grr_formatBlockInfo(VkFormat format, Grr_u32 *blockWidth,
+                             Grr_u32 *blockHeight, Grr_u32 *blockBytes);
+
+// Parses KTX2 file bytes, image keeps a reference to bytes
+Grr_bool Grr_parseKTX2(Grr_byte *bytes, size_t nBytes, GrrImageKTX2 *image);
+Grr_bool Grr_loadKTX2(const Grr_string path, GrrImageKTX2 *image);
+void Grr_freeKTX2(GrrImageKTX2 *image);
+
+// Writes a KTX2 file (8-bit RGBA or the BC1/3/4/5/7 formats of the texture
+// cooker). levelData[0] is the base level
+Grr_bool Grr_writeKTX2(const Grr_string path, VkFormat format, Grr_u32 width,
+                       Grr_u32 height, Grr_u32 levelCount,
+                       const Grr_byte *const *levelData,
+                       const size_t *levelBytes);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include "bindless.h"
+#include "vulkan.h"
+
+VkDescriptorSetLayout bindlessSetLayout;
+VkDescriptorPool bindlessPool;
+VkDescriptorSet bindlessSet;
+Grr_u32 bindlessCounts[4]; // Array sizes per binding, within device limits
+
+GrrIndexAllocator bindlessImages;
+GrrIndexAllocator bindlessSamplers;
+GrrIndexAllocator bindlessBuffers;
+GrrIndexAllocator bindlessMaterials;
+Grr_u64 bindlessFrame = 0;
+
+VkBuffer materialBuffer;
+GrrGpuAllocation materialBufferMemory;
+
+Grr_bool Grr_initializeIndexAllocator(GrrIndexAllocator *allocator,
+                                      Grr_u32 capacity) {
+  *allocator = (GrrIndexAllocator){0};
+  allocator->capacity = capacity;
+  allocator->freeIndices = (Grr_u32 *)malloc(sizeof(Grr_u32) * capacity);
+  allocator->retiredIndices = (Grr_u32 *)malloc(sizeof(Grr_u32) * capacity);
+  allocator->retiredFrames = (Grr_u64 *)malloc(sizeof(Grr_u64) * capacity);
+  if (NULL == allocator->freeIndices || NULL == allocator->retiredIndices ||
+      NULL == allocator->retiredFrames) {
+    Grr_destroyIndexAllocator(allocator);
+    return false;
+  }
+  return true;
+}
+
+void Grr_destroyIndexAllocator(GrrIndexAllocator *allocator) {
+  free(allocator->freeIndices);
+  free(allocator->retiredIndices);
+  free(allocator->retiredFrames);
+  *allocator = (GrrIndexAllocator){0};
+}
+
+Grr_u32 Grr_allocateIndex(GrrIndexAllocator *allocator) {
+  if (allocator->freeCount > 0)
+    return allocator->freeIndices[--allocator->freeCount];
+  if (allocator->next < allocator->capacity)
+    return allocator->next++;
+  return GRR_BINDLESS_INVALID;
+}
+
+void Grr_releaseIndex(GrrIndexAllocator *allocator, Grr_u32 index,
+                      Grr_u64 frame) {
+  if (index >= allocator->next ||
+      allocator->retiredCount >= allocator->capacity)
+    return;
+  allocator->retiredIndices[allocator->retiredCount] = index;
+  allocator->retiredFrames[allocator->retiredCount] = frame;
+  allocator->retiredCount++;
+}
+
+void Grr_recycleIndices(GrrIndexAllocator *allocator, Grr_u64 completedFrame) {
+  // Retired in release order, so frames never decrease
+  Grr_u32 recycled = 0;
+  while (recycled < allocator->retiredCount &&
+         allocator->retiredFrames[recycled] <= completedFrame) {
+    allocator->freeIndices[allocator->freeCount++] =
+        allocator->retiredIndices[recycled];
+    recycled++;
+  }
+  if (recycled == 0)
+    return;
+
+  allocator->retiredCount -= recycled;
+  memmove(allocator->retiredIndices, allocator->retiredIndices + recycled,
+          sizeof(Grr_u32) * allocator->retiredCount);
+  memmove(allocator->retiredFrames, allocator->retiredFrames + recycled,
+          sizeof(Grr_u64) * allocator->retiredCount);
+}
+
+Grr_bool _Grr_bindlessFeatures(
+    const VkPhysicalDeviceDescriptorIndexingFeaturesEXT *supported,
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT *enabled) {
+  *enabled = (VkPhysicalDeviceDescriptorIndexingFeaturesEXT){0};
+  enabled->sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+  enabled->shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+  enabled->shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+  enabled->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  enabled->descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+  enabled->descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+  enabled->descriptorBindingPartiallyBound = VK_TRUE;
+  enabled->runtimeDescriptorArray = VK_TRUE;
+
+  return supported->shaderSampledImageArrayNonUniformIndexing &&
+         supported->shaderStorageBufferArrayNonUniformIndexing &&
+         supported->descriptorBindingSampledImageUpdateAfterBind &&
+         supported->descriptorBindingStorageBufferUpdateAfterBind &&
+         supported->descriptorBindingUpdateUnusedWhilePending &&
+         supported->descriptorBindingPartiallyBound &&
+         supported->runtimeDescriptorArray;
+}
+
+void _Grr_destroyBindless() {
+  GRR_LOG_INFO("Free bindless descriptors\n");
+  // Destroying the pool frees the set
+  vkDestroyDescriptorPool(device, bindlessPool, NULL);
+  vkDestroyDescriptorSetLayout(device, bindlessSetLayout, NULL);
+  _Grr_deferBuffer(materialBuffer, &materialBufferMemory);
+  Grr_destroyIndexAllocator(&bindlessImages);
+  Grr_destroyIndexAllocator(&bindlessSamplers);
+  Grr_destroyIndexAllocator(&bindlessBuffers);
+  Grr_destroyIndexAllocator(&bindlessMaterials);
+}
+
+Grr_u32 _Grr_minU32(Grr_u32 a, Grr_u32 b) { return a < b ? a : b; }
+
+// Array sizes, clamped to the update after bind limits of the device
+void _Grr_bindlessCounts() {
+  bindlessCounts[GRR_BINDLESS_IMAGES_BINDING] = GRR_BINDLESS_MAX_IMAGES;
+  bindlessCounts[GRR_BINDLESS_SAMPLERS_BINDING] = GRR_BINDLESS_MAX_SAMPLERS;
+  bindlessCounts[GRR_BINDLESS_BUFFERS_BINDING] = GRR_BINDLESS_MAX_BUFFERS;
+  bindlessCounts[GRR_BINDLESS_MATERIALS_BINDING] = 1;
+
+  PFN_vkGetPhysicalDeviceProperties2KHR fpGetPhysicalDeviceProperties2KHR =
+      (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(
+          instance, "vkGetPhysicalDeviceProperties2KHR");
+  if (!fpGetPhysicalDeviceProperties2KHR)
+    return;
+
+  VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties = {0};
+  indexingProperties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+  VkPhysicalDeviceProperties2 properties = {0};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+  properties.pNext = &indexingProperties;
+  fpGetPhysicalDeviceProperties2KHR(physicalDevice, &properties);
+
+  bindlessCounts[GRR_BINDLESS_IMAGES_BINDING] = _Grr_minU32(
+      GRR_BINDLESS_MAX_IMAGES,
+      indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+  bindlessCounts[GRR_BINDLESS_SAMPLERS_BINDING] = _Grr_minU32(
+      GRR_BINDLESS_MAX_SAMPLERS,
+      indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+  // Leave room for the material table
+  bindlessCounts[GRR_BINDLESS_BUFFERS_BINDING] = _Grr_minU32(
+      GRR_BINDLESS_MAX_BUFFERS,
+      indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers -
+          1);
+}
+
+Grr_bool _Grr_initializeBindless() {
+  _Grr_bindlessCounts();
+  GRR_LOG_DEBUG("Bindless arrays: %u images, %u samplers, %u buffers\n",
+                bindlessCounts[GRR_BINDLESS_IMAGES_BINDING],
+                bindlessCounts[GRR_BINDLESS_SAMPLERS_BINDING],
+                bindlessCounts[GRR_BINDLESS_BUFFERS_BINDING]);
+
+  if (!Grr_initializeIndexAllocator(
+          &bindlessImages, bindlessCounts[GRR_BINDLESS_IMAGES_BINDING]) ||
+      !Grr_initializeIndexAllocator(
+          &bindlessSamplers, bindlessCounts[GRR_BINDLESS_SAMPLERS_BINDING]) ||
+      !Grr_initializeIndexAllocator(
+          &bindlessBuffers, bindlessCounts[GRR_BINDLESS_BUFFERS_BINDING]) ||
+      !Grr_initializeIndexAllocator(&bindlessMaterials,
+                                    GRR_BINDLESS_MAX_MATERIALS)) {
+    GRR_LOG_ERROR("Failed to allocate memory for bindless IDs\n");
+    return false;
+  }
+
+  // Layout
+  VkDescriptorType types[] = {
+      VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER,
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+  VkDescriptorSetLayoutBinding bindings[4] = {0};
+  VkDescriptorBindingFlagsEXT bindingFlags[4];
+  VkDescriptorPoolSize poolSizes[4] = {0};
+  for (Grr_u32 i = 0; i < 4; i++) {
+    bindings[i].binding = i;
+    bindings[i].descriptorType = types[i];
+    bindings[i].descriptorCount = bindlessCounts[i];
+    bindings[i].stageFlags =
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT |
+        VK_SHADER_STAGE_COMPUTE_BIT;
+    bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                      VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                      VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    poolSizes[i].type = types[i];
+    poolSizes[i].descriptorCount = bindlessCounts[i];
+  }
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {0};
+  bindingFlagsInfo.sType =
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+  bindingFlagsInfo.bindingCount = 4;
+  bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo = {0};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.pNext = &bindingFlagsInfo;
+  layoutInfo.flags =
+      VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+  layoutInfo.bindingCount = 4;
+  layoutInfo.pBindings = bindings;
+  if (vkCreateDescriptorSetLayout(device, &layoutInfo, NULL,
+                                  &bindlessSetLayout) != VK_SUCCESS)
+    return false;
+
+  // Pool and set
+  VkDescriptorPoolCreateInfo poolInfo = {0};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+  poolInfo.maxSets = 1;
+  poolInfo.poolSizeCount = 4;
+  poolInfo.pPoolSizes = poolSizes;
+  if (vkCreateDescriptorPool(device, &poolInfo, NULL, &bindlessPool) !=
+      VK_SUCCESS) {
+    vkDestroyDescriptorSetLayout(device, bindlessSetLayout, NULL);
+    return false;
+  }
+
+  VkDescriptorSetAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = bindlessPool;
+  allocInfo.descriptorSetCount = 1;
+  allocInfo.pSetLayouts = &bindlessSetLayout;
+  if (vkAllocateDescriptorSets(device, &allocInfo, &bindlessSet) !=
+      VK_SUCCESS) {
+    vkDestroyDescriptorPool(device, bindlessPool, NULL);
+    vkDestroyDescriptorSetLayout(device, bindlessSetLayout, NULL);
+    return false;
+  }
+
+  // Material table, host visible: materials are written in place
+  if (!_Grr_createBuffer(sizeof(GrrMaterial) * GRR_BINDLESS_MAX_MATERIALS,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         GRR_GPU_MEMORY_PERSISTENT, &materialBuffer,
+                         &materialBufferMemory)) {
+    vkDestroyDescriptorPool(device, bindlessPool, NULL);
+    vkDestroyDescriptorSetLayout(device, bindlessSetLayout, NULL);
+    return false;
+  }
+  atexit(_Grr_destroyBindless);
+
+  VkDescriptorBufferInfo bufferInfo = {0};
+  bufferInfo.buffer = materialBuffer;
+  bufferInfo.offset = 0;
+  bufferInfo.range = VK_WHOLE_SIZE;
+
+  VkWriteDescriptorSet write = {0};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstSet = bindlessSet;
+  write.dstBinding = GRR_BINDLESS_MATERIALS_BINDING;
+  write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  write.descriptorCount = 1;
+  write.pBufferInfo = &bufferInfo;
+  vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+
+  return true;
+}
+
+VkDescriptorSetLayout Grr_bindlessSetLayout() { return bindlessSetLayout; }
+
+VkDescriptorSet Grr_bindlessSet() { return bindlessSet; }
+
+void _Grr_beginBindlessFrame(Grr_u64 frame, Grr_u64 completedFrame) {
+  bindlessFrame = frame;
+  Grr_recycleIndices(&bindlessImages, completedFrame);
+  Grr_recycleIndices(&bindlessSamplers, completedFrame);
+  Grr_recycleIndices(&bindlessBuffers, completedFrame);
+  Grr_recycleIndices(&bindlessMaterials, completedFrame);
+}
+
+// Writes one element of a bindless array, the element is not used by pending
+// command buffers (free IDs are never referenced)
+void _Grr_writeBindless(Grr_u32 binding, Grr_u32 element,
+                        const VkDescriptorImageInfo *imageInfo,
+                        const VkDescriptorBufferInfo *bufferInfo) {
+  VkDescriptorType types[] = {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                              VK_DESCRIPTOR_TYPE_SAMPLER,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+  VkWriteDescriptorSet write = {0};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstSet = bindlessSet;
+  write.dstBinding = binding;
+  write.dstArrayElement = element;
+  write.descriptorType = types[binding];
+  write.descriptorCount = 1;
+  write.pImageInfo = imageInfo;
+  write.pBufferInfo = bufferInfo;
+  vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+}
+
+Grr_u32 Grr_registerImage(VkImageView imageView) {
+  Grr_u32 image = Grr_allocateIndex(&bindlessImages);
+  if (image == GRR_BINDLESS_INVALID) {
+    GRR_LOG_ERROR("No bindless image left\n");
+    return image;
+  }
+  VkDescriptorImageInfo imageInfo = {0};
+  imageInfo.imageView = imageView;
+  imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  _Grr_writeBindless(GRR_BINDLESS_IMAGES_BINDING, image, &imageInfo, NULL);
+  return image;
+}
+
+Grr_u32 Grr_registerSampler(VkSampler sampler) {
+  Grr_u32 index = Grr_allocateIndex(&bindlessSamplers);
+  if (index == GRR_BINDLESS_INVALID) {
+    GRR_LOG_ERROR("No bindless sampler left\n");
+    return index;
+  }
+  VkDescriptorImageInfo imageInfo = {0};
+  imageInfo.sampler = sampler;
+  _Grr_writeBindless(GRR_BINDLESS_SAMPLERS_BINDING, index, &imageInfo, NULL);
+  return index;
+}
+
+Grr_u32 Grr_registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                  VkDeviceSize range) {
+  Grr_u32 index = Grr_allocateIndex(&bindlessBuffers);
+  if (index == GRR_BINDLESS_INVALID) {
+    GRR_LOG_ERROR("No bindless storage buffer left\n");
+    return index;
+  }
+  VkDescriptorBufferInfo bufferInfo = {0};
+  bufferInfo.buffer = buffer;
+  bufferInfo.offset = offset;
+  bufferInfo.range = range;
+  _Grr_writeBindless(GRR_BINDLESS_BUFFERS_BINDING, index, NULL, &bufferInfo);
+  return index;
+}
+
+Grr_u32 Grr_createMaterial(const GrrMaterial *material) {
+  Grr_u32 index = Grr_allocateIndex(&bindlessMaterials);
+  if (index == GRR_BINDLESS_INVALID) {
+    GRR_LOG_ERROR("No material left\n");
+    return index;
+  }
+  // The GPU does not read free materials, no synchronization needed
+  memcpy((GrrMaterial *)materialBufferMemory.mapped + index, material,
+         sizeof(GrrMaterial));
+  return index;
+}
+
+void Grr_releaseImage(Grr_u32 image) {
+  Grr_releaseIndex(&bindlessImages, image, bindlessFrame);
+}
+
+void Grr_releaseSampler(Grr_u32 sampler) {
+  Grr_releaseIndex(&bindlessSamplers, sampler, bindlessFrame);
+}
+
+void Grr_releaseStorageBuffer(Grr_u32 buffer) {
+  Grr_releaseIndex(&bindlessBuffers, buffer, bindlessFrame);
+}
+
+void Grr_releaseMaterial(Grr_u32 material) {
+  Grr_releaseIndex(&bindlessMaterials, material, bindlessFrame);
+}
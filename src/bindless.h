@@ -0,0 +1,92 @@
+#ifndef GRR_BINDLESS_H
+#define GRR_BINDLESS_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "types.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <vulkan/vulkan.h>
+
+// Bindless resources (VK_EXT_descriptor_indexing): one global descriptor set
+// of large, partially bound arrays of sampled images, samplers and storage
+// buffers, plus the material table. Resources are registered once and written
+// into a free array element (update after bind, so the set stays bound while
+// other elements change); shaders index them with the IDs stored in
+// materials. Every draw of a frame shares the same bind of the set.
+// Released IDs are reused once the frames that could still read them are done
+
+#define GRR_BINDLESS_SET 1 // Set index in pipeline layouts
+#define GRR_BINDLESS_MAX_IMAGES 4096
+#define GRR_BINDLESS_MAX_SAMPLERS 64
+#define GRR_BINDLESS_MAX_BUFFERS 1024
+#define GRR_BINDLESS_MAX_MATERIALS 4096
+#define GRR_BINDLESS_INVALID UINT32_MAX
+
+enum {
+  GRR_BINDLESS_IMAGES_BINDING = 0,  // texture2D images[]
+  GRR_BINDLESS_SAMPLERS_BINDING = 1, // sampler samplers[]
+  GRR_BINDLESS_BUFFERS_BINDING = 2,  // buffer buffers[]
+  GRR_BINDLESS_MATERIALS_BINDING = 3 // GrrMaterial materials[]
+};
+
+// std430 layout, mirrored in shader.frag
+typedef struct GrrMaterial {
+  Grr_f32 baseColorFactor[4];
+  Grr_u32 baseColorImage;   // GRR_BINDLESS_INVALID for no texture
+  Grr_u32 baseColorSampler;
+  Grr_u32 padding[2];
+} GrrMaterial;
+
+// IDs of one array: never used IDs are handed out in order, released ones
+// wait until the frame they were released in is complete
+typedef struct GrrIndexAllocator {
+  Grr_u32 capacity;
+  Grr_u32 next; // First never used ID
+  Grr_u32 *freeIndices;
+  Grr_u32 freeCount;
+  Grr_u32 *retiredIndices;
+  Grr_u64 *retiredFrames; // Frame number each retired ID was released in
+  Grr_u32 retiredCount;
+} GrrIndexAllocator;
+
+Grr_bool Grr_initializeIndexAllocator(GrrIndexAllocator *allocator,
+                                      Grr_u32 capacity);
+void Grr_destroyIndexAllocator(GrrIndexAllocator *allocator);
+// GRR_BINDLESS_INVALID when all IDs are in use
+Grr_u32 Grr_allocateIndex(GrrIndexAllocator *allocator);
+void Grr_releaseIndex(GrrIndexAllocator *allocator, Grr_u32 index,
+                      Grr_u64 frame);
+// IDs released in frames up to completedFrame become free
+void Grr_recycleIndices(GrrIndexAllocator *allocator, Grr_u64 completedFrame);
+
+// Checks the descriptor indexing features bindless resources need and fills
+// enabled (to chain in VkDeviceCreateInfo) with them
+Grr_bool _Grr_bindlessFeatures(
+    const VkPhysicalDeviceDescriptorIndexingFeaturesEXT *supported,
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT *enabled);
+
+// Called once the logical device and memory allocator exist, before pipeline
+// layouts are created
+Grr_bool _Grr_initializeBindless();
+
+VkDescriptorSetLayout Grr_bindlessSetLayout();
+VkDescriptorSet Grr_bindlessSet();
+
+// Frame numbers: frame is the one being recorded, completedFrame the last one
+// whose commands completed
+void _Grr_beginBindlessFrame(Grr_u64 frame, Grr_u64 completedFrame);
+
+// image must be in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when used
+Grr_u32 Grr_registerImage(VkImageView imageView);
+Grr_u32 Grr_registerSampler(VkSampler sampler);
+Grr_u32 Grr_registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                  VkDeviceSize range);
+Grr_u32 Grr_createMaterial(const GrrMaterial *material);
+
+void Grr_releaseImage(Grr_u32 image);
+void Grr_releaseSampler(Grr_u32 sampler);
+void Grr_releaseStorageBuffer(Grr_u32 buffer);
+void Grr_releaseMaterial(Grr_u32 material);
+
+#endif
@@ -0,0 +1,184 @@
+#include "commands.h"
+#include "vulkan.h"
+
+// Pool of one job thread for one frame, only touched by that thread while
+// recording
+typedef struct GrrThreadCommandPool {
+  VkCommandPool pool;
+  VkCommandBuffer *secondaries; // Allocated on demand, reused every frame
+  Grr_u32 secondaryCount;
+  Grr_u32 secondariesUsed;
+} GrrThreadCommandPool;
+
+GrrThreadCommandPool *threadCommandPools = NULL; // [frame][thread]
+Grr_u32 commandPoolFrames = 0;
+Grr_u32 commandPoolThreads = 0;
+Grr_u32 recordingThreadCount = 0;
+
+typedef struct GrrRecordingJob {
+  Grr_u32 frame;
+  const VkCommandBufferInheritanceInfo *inheritance;
+  Grr_u32 count;
+  Grr_u32 sliceCount;
+  Grr_recordSliceFunction record;
+  void *data;
+  VkCommandBuffer slices[GRR_MAX_JOB_THREADS + 1];
+  Grr_bool failed[GRR_MAX_JOB_THREADS + 1];
+} GrrRecordingJob;
+
+void _Grr_destroyCommandRecording() {
+  GRR_LOG_INFO("Free recording command pools\n");
+  for (Grr_u32 i = 0; i < commandPoolFrames * commandPoolThreads; i++) {
+    // Destroying a pool frees its command buffers
+    vkDestroyCommandPool(device, threadCommandPools[i].pool, NULL);
+    free(threadCommandPools[i].secondaries);
+  }
+  free(threadCommandPools);
+}
+
+Grr_bool _Grr_initializeCommandRecording(Grr_u32 framesInFlight) {
+  commandPoolFrames = framesInFlight;
+  commandPoolThreads = Grr_jobThreadCount();
+  threadCommandPools = (GrrThreadCommandPool *)calloc(
+      (size_t)commandPoolFrames * commandPoolThreads,
+      sizeof(GrrThreadCommandPool));
+  if (NULL == threadCommandPools) {
+    GRR_LOG_ERROR("Failed to allocate memory for recording command pools\n");
+    return false;
+  }
+  atexit(_Grr_destroyCommandRecording);
+
+  // Command buffers are reset with their pool once per frame
+  VkCommandPoolCreateInfo poolInfo = {0};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamilyIndex;
+  for (Grr_u32 i = 0; i < commandPoolFrames * commandPoolThreads; i++) {
+    if (vkCreateCommandPool(device, &poolInfo, NULL,
+                            &threadCommandPools[i].pool) != VK_SUCCESS) {
+      GRR_LOG_ERROR("Failed to create recording command pool\n");
+      return false;
+    }
+  }
+
+  GRR_LOG_DEBUG("Command recording: %u threads, %u frames\n",
+                commandPoolThreads, commandPoolFrames);
+  return true;
+}
+
+void Grr_setRecordingThreadCount(Grr_u32 threadCount) {
+  recordingThreadCount = threadCount;
+}
+
+Grr_u32 Grr_recordingThreadCount() {
+  Grr_u32 threadCount = Grr_jobThreadCount();
+  if (recordingThreadCount > 0 && recordingThreadCount < threadCount)
+    threadCount = recordingThreadCount;
+  return threadCount;
+}
+
+Grr_u32 Grr_recordingSliceCount(Grr_u32 count) {
+  Grr_u32 sliceCount = count / GRR_MIN_ITEMS_PER_SLICE;
+  Grr_u32 threadCount = Grr_recordingThreadCount();
+  if (sliceCount > threadCount)
+    sliceCount = threadCount;
+  return sliceCount > 0 ? sliceCount : 1;
+}
+
+void Grr_recordingSlice(Grr_u32 count, Grr_u32 sliceCount, Grr_u32 sliceIndex,
+                        Grr_u32 *first, Grr_u32 *sliceItems) {
+  Grr_u32 base = count / sliceCount;
+  Grr_u32 remainder = count % sliceCount;
+  // The first remainder slices get one more item
+  *first =
+      sliceIndex * base + (sliceIndex < remainder ? sliceIndex : remainder);
+  *sliceItems = base + (sliceIndex < remainder ? 1 : 0);
+}
+
+Grr_bool _Grr_acquireSecondary(GrrThreadCommandPool *pool,
+                               VkCommandBuffer *secondary) {
+  if (pool->secondariesUsed == pool->secondaryCount) {
+    VkCommandBuffer *secondaries = (VkCommandBuffer *)realloc(
+        pool->secondaries,
+        sizeof(VkCommandBuffer) * (pool->secondaryCount + 1));
+    if (NULL == secondaries)
+      return false;
+    pool->secondaries = secondaries;
+
+    VkCommandBufferAllocateInfo allocInfo = {0};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = pool->pool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device, &allocInfo,
+                                 &secondaries[pool->secondaryCount]) !=
+        VK_SUCCESS)
+      return false;
+    pool->secondaryCount++;
+  }
+
+  *secondary = pool->secondaries[pool->secondariesUsed++];
+  return true;
+}
+
+void _Grr_recordSliceJob(void *data, Grr_u32 index, Grr_u32 threadIndex) {
+  GrrRecordingJob *job = (GrrRecordingJob *)data;
+  GrrThreadCommandPool *pool =
+      &threadCommandPools[job->frame * commandPoolThreads + threadIndex];
+
+  VkCommandBuffer secondary;
+  if (!_Grr_acquireSecondary(pool, &secondary)) {
+    job->failed[index] = true;
+    return;
+  }
+
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                    VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = job->inheritance;
+  if (vkBeginCommandBuffer(secondary, &beginInfo) != VK_SUCCESS) {
+    job->failed[index] = true;
+    return;
+  }
+
+  Grr_u32 first, sliceItems;
+  Grr_recordingSlice(job->count, job->sliceCount, index, &first, &sliceItems);
+  job->record(secondary, job->data, first, sliceItems);
+
+  job->failed[index] = vkEndCommandBuffer(secondary) != VK_SUCCESS;
+  job->slices[index] = secondary;
+}
+
+Grr_bool _Grr_recordSecondaryCommandBuffers(
+    VkCommandBuffer primary, Grr_u32 frame,
+    const VkCommandBufferInheritanceInfo *inheritance, Grr_u32 count,
+    Grr_recordSliceFunction record, void *data) {
+  // The GPU is done with the frame's previous command buffers
+  for (Grr_u32 i = 0; i < commandPoolThreads; i++) {
+    GrrThreadCommandPool *pool =
+        &threadCommandPools[frame * commandPoolThreads + i];
+    if (pool->secondariesUsed == 0)
+      continue;
+    vkResetCommandPool(device, pool->pool, 0);
+    pool->secondariesUsed = 0;
+  }
+
+  GrrRecordingJob job;
+  job.frame = frame;
+  job.inheritance = inheritance;
+  job.count = count;
+  job.sliceCount = Grr_recordingSliceCount(count);
+  job.record = record;
+  job.data = data;
+  Grr_parallelFor(job.sliceCount, _Grr_recordSliceJob, &job);
+
+  for (Grr_u32 i = 0; i < job.sliceCount; i++) {
+    if (job.failed[i]) {
+      GRR_LOG_ERROR("Failed to record secondary command buffer\n");
+      return false;
+    }
+  }
+  vkCmdExecuteCommands(primary, job.sliceCount, job.slices);
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef GRR_COMMANDS_H
+#define GRR_COMMANDS_H
+
+#include "jobs.h"
+#include "logging.h"
+#include "types.h"
+#include <stdlib.h>
+#include <vulkan/vulkan.h>
+
+// Parallel command recording: a list of items (draws) is split into
+// contiguous slices recorded on the job system into secondary command buffers,
+// which the primary command buffer executes in slice order. Every job thread
+// owns one command pool per frame in flight, so threads never share a pool
+// and a frame's pools are reset at once when it is recorded again.
+// Called from the main thread only (not from inside a job)
+
+// Fewer items per slice cost more in secondary command buffer overhead than
+// parallel recording saves
+#define GRR_MIN_ITEMS_PER_SLICE 64
+
+// Records the items [first, first + count) into commandBuffer, which already
+// has the render pass state inherited
+typedef void (*Grr_recordSliceFunction)(VkCommandBuffer commandBuffer,
+                                        void *data, Grr_u32 first,
+                                        Grr_u32 count);
+
+// Pools for framesInFlight frames and every job thread, freed at exit
+Grr_bool _Grr_initializeCommandRecording(Grr_u32 framesInFlight);
+
+// Limits recording to threadCount job threads (0 uses all of them)
+void Grr_setRecordingThreadCount(Grr_u32 threadCount);
+Grr_u32 Grr_recordingThreadCount();
+
+// Number of slices count items are split into: 1 means the items should be
+// recorded inline in the primary command buffer
+Grr_u32 Grr_recordingSliceCount(Grr_u32 count);
+
+// Items of slice sliceIndex, sizes differ by at most one item
+void Grr_recordingSlice(Grr_u32 count, Grr_u32 sliceCount, Grr_u32 sliceIndex,
+                        Grr_u32 *first, Grr_u32 *sliceItems);
+
+// Resets the pools of frame, records Grr_recordingSliceCount(count) secondary
+// command buffers in parallel and executes them into primary, which must be
+// inside a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+// matching inheritance
+Grr_bool _Grr_recordSecondaryCommandBuffers(
+    VkCommandBuffer primary, Grr_u32 frame,
+    const VkCommandBufferInheritanceInfo *inheritance, Grr_u32 count,
+    Grr_recordSliceFunction record, void *data);
+
+#endif
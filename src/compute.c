@@ -0,0 +1,333 @@
+#include "compute.h"
+#include "vulkan.h"
+
+// Transfers released to a queue (the index), not acquired yet
+typedef struct GrrPendingTransfers {
+  GrrQueueTransfer transfers[GRR_COMPUTE_MAX_TRANSFERS];
+  Grr_u32 count;
+  GRR_QUEUE from;
+  Grr_u64 value; // Of the releasing submission, 0 until it is submitted
+} GrrPendingTransfers;
+
+Grr_bool asyncComputeSupported = false;
+Grr_bool asyncComputeEnabled = true;
+VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+VkCommandBuffer computeCommandBuffers[GRR_MAX_FRAMES_IN_FLIGHT];
+VkCommandBuffer frameTailCommandBuffers[GRR_MAX_FRAMES_IN_FLIGHT];
+GrrPendingTransfers pendingTransfers[GRR_QUEUE_COUNT];
+GrrPendingTransfers savedTransfers[GRR_QUEUE_COUNT];
+
+Grr_u32 Grr_uniqueQueueFamilies(const Grr_u32 *families, Grr_u32 count,
+                                Grr_u32 *unique) {
+  Grr_u32 uniqueCount = 0;
+  for (Grr_u32 i = 0; i < count; i++) {
+    if (families[i] == -1)
+      continue;
+    Grr_u32 j = 0;
+    while (j < uniqueCount && unique[j] != families[i])
+      j++;
+    if (j == uniqueCount)
+      unique[uniqueCount++] = families[i];
+  }
+  return uniqueCount;
+}
+
+void Grr_queueTransferBarriers(const GrrQueueTransfer *transfers,
+                               Grr_u32 count, Grr_u32 srcFamily,
+                               Grr_u32 dstFamily, Grr_bool acquire,
+                               VkBufferMemoryBarrier *buffers,
+                               Grr_u32 *bufferCount,
+                               VkImageMemoryBarrier *images,
+                               Grr_u32 *imageCount) {
+  *bufferCount = 0;
+  *imageCount = 0;
+  for (Grr_u32 i = 0; i < count; i++) {
+    const GrrQueueTransfer *transfer = &transfers[i];
+    // Writes are made available by the release, visible by the acquire
+    VkAccessFlags srcAccess = acquire ? 0 : transfer->srcAccess;
+    VkAccessFlags dstAccess = acquire ? transfer->dstAccess : 0;
+    if (VK_NULL_HANDLE != transfer->buffer) {
+      VkBufferMemoryBarrier *barrier = &buffers[(*bufferCount)++];
+      *barrier = (VkBufferMemoryBarrier){0};
+      barrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      barrier->srcAccessMask = srcAccess;
+      barrier->dstAccessMask = dstAccess;
+      barrier->srcQueueFamilyIndex = srcFamily;
+      barrier->dstQueueFamilyIndex = dstFamily;
+      barrier->buffer = transfer->buffer;
+      barrier->offset = 0;
+      barrier->size = VK_WHOLE_SIZE;
+      continue;
+    }
+    VkImageMemoryBarrier *barrier = &images[(*imageCount)++];
+    *barrier = (VkImageMemoryBarrier){0};
+    barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier->srcAccessMask = srcAccess;
+    barrier->dstAccessMask = dstAccess;
+    barrier->oldLayout = transfer->layout;
+    barrier->newLayout = transfer->layout;
+    barrier->srcQueueFamilyIndex = srcFamily;
+    barrier->dstQueueFamilyIndex = dstFamily;
+    barrier->image = transfer->image;
+    barrier->subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier->subresourceRange.baseMipLevel = 0;
+    barrier->subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier->subresourceRange.baseArrayLayer = 0;
+    barrier->subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+  }
+}
+
+// Tail command buffers are freed with the graphics command pool
+void _Grr_destroyAsyncCompute() {
+  GRR_LOG_INFO("Free async compute\n");
+  _Grr_deferCommandPool(computeCommandPool);
+  computeCommandPool = VK_NULL_HANDLE;
+  asyncComputeSupported = false;
+}
+
+Grr_bool _Grr_initializeAsyncCompute() {
+  // A compute queue of the graphics family is the graphics queue itself, and
+  // waits without timeline semaphores would block the host
+  if (VK_NULL_HANDLE == computeQueue ||
+      queueFamilyIndices.computeFamilyIndex ==
+          queueFamilyIndices.graphicsFamilyIndex ||
+      !_Grr_gpuTimelineWaits(GRR_QUEUE_COMPUTE)) {
+    GRR_LOG_DEBUG("Async compute is not available\n");
+    return true;
+  }
+
+  VkCommandPoolCreateInfo poolInfo = {0};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = queueFamilyIndices.computeFamilyIndex;
+  if (vkCreateCommandPool(device, &poolInfo, NULL, &computeCommandPool) !=
+      VK_SUCCESS)
+    return false;
+
+  VkCommandBufferAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = computeCommandPool;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = GRR_MAX_FRAMES_IN_FLIGHT;
+  if (vkAllocateCommandBuffers(device, &allocInfo, computeCommandBuffers) !=
+      VK_SUCCESS) {
+    vkDestroyCommandPool(device, computeCommandPool, NULL);
+    return false;
+  }
+  allocInfo.commandPool = commandPool;
+  if (vkAllocateCommandBuffers(device, &allocInfo, frameTailCommandBuffers) !=
+      VK_SUCCESS) {
+    vkDestroyCommandPool(device, computeCommandPool, NULL);
+    return false;
+  }
+
+  asyncComputeSupported = true;
+  GRR_LOG_DEBUG("Async compute on queue family %u\n",
+                queueFamilyIndices.computeFamilyIndex);
+  atexit(_Grr_destroyAsyncCompute);
+  return true;
+}
+
+Grr_bool Grr_asyncComputeSupported() { return asyncComputeSupported; }
+
+void Grr_setAsyncCompute(Grr_bool enabled) { asyncComputeEnabled = enabled; }
+
+Grr_bool Grr_asyncComputeEnabled() {
+  return asyncComputeSupported && asyncComputeEnabled;
+}
+
+Grr_u32 _Grr_queueFamily(GRR_QUEUE queue) {
+  switch (queue) {
+  case GRR_QUEUE_COMPUTE:
+    return queueFamilyIndices.computeFamilyIndex;
+  case GRR_QUEUE_TRANSFER:
+    return queueFamilyIndices.transferFamilyIndex;
+  default:
+    return queueFamilyIndices.graphicsFamilyIndex;
+  }
+}
+
+Grr_u32 _Grr_sharedQueueFamilies(Grr_u32 *families) {
+  if (!asyncComputeSupported) {
+    families[0] = queueFamilyIndices.graphicsFamilyIndex;
+    return 1;
+  }
+  // Uploads write them from the transfer queue
+  Grr_u32 queueFamilies[] = {queueFamilyIndices.graphicsFamilyIndex,
+                             queueFamilyIndices.computeFamilyIndex,
+                             queueFamilyIndices.transferFamilyIndex};
+  return Grr_uniqueQueueFamilies(
+      queueFamilies, sizeof(queueFamilies) / sizeof(queueFamilies[0]),
+      families);
+}
+
+VkCommandBuffer _Grr_beginComputeCommands(Grr_u32 frame) {
+  VkCommandBuffer commandBuffer = computeCommandBuffers[frame];
+  vkResetCommandBuffer(commandBuffer, 0);
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+  return commandBuffer;
+}
+
+Grr_u64 _Grr_submitComputeCommands(Grr_u32 frame, const GrrTimelineWait *waits,
+                                   Grr_u32 waitCount) {
+  if (vkEndCommandBuffer(computeCommandBuffers[frame]) != VK_SUCCESS)
+    return 0;
+  VkSubmitInfo submitInfo = {0};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &computeCommandBuffers[frame];
+  return _Grr_submit(GRR_QUEUE_COMPUTE, &submitInfo, waits, waitCount);
+}
+
+VkCommandBuffer _Grr_frameTailCommandBuffer(Grr_u32 frame) {
+  return frameTailCommandBuffers[frame];
+}
+
+// Releases are followed by the semaphore signal of their submission, acquires
+// follow the semaphore wait at stages
+void _Grr_recordQueueTransfers(VkCommandBuffer commandBuffer, GRR_QUEUE from,
+                               GRR_QUEUE to, const GrrQueueTransfer *transfers,
+                               Grr_u32 count, Grr_bool acquire,
+                               VkPipelineStageFlags stages) {
+  VkBufferMemoryBarrier buffers[GRR_COMPUTE_MAX_TRANSFERS];
+  VkImageMemoryBarrier images[GRR_COMPUTE_MAX_TRANSFERS];
+  Grr_u32 bufferCount;
+  Grr_u32 imageCount;
+  Grr_queueTransferBarriers(transfers, count, _Grr_queueFamily(from),
+                            _Grr_queueFamily(to), acquire, buffers,
+                            &bufferCount, images, &imageCount);
+  vkCmdPipelineBarrier(commandBuffer, stages,
+                       acquire ? stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                       0, 0, NULL, bufferCount, buffers, imageCount, images);
+}
+
+void _Grr_releaseQueueTransfers(VkCommandBuffer commandBuffer, GRR_QUEUE from,
+                                GRR_QUEUE to, const GrrQueueTransfer *transfers,
+                                Grr_u32 count, VkPipelineStageFlags stages) {
+  GrrPendingTransfers *pending = &pendingTransfers[to];
+  if (pending->count + count > GRR_COMPUTE_MAX_TRANSFERS ||
+      (pending->count > 0 && pending->from != from)) {
+    GRR_LOG_ERROR("Too many resources released to queue %u\n", (Grr_u32)to);
+    return;
+  }
+  _Grr_recordQueueTransfers(commandBuffer, from, to, transfers, count, false,
+                            stages);
+  memcpy(pending->transfers + pending->count, transfers,
+         sizeof(GrrQueueTransfer) * count);
+  pending->count += count;
+  pending->from = from;
+  pending->value = 0;
+}
+
+void _Grr_submittedQueueTransfers(GRR_QUEUE queue, Grr_u64 value) {
+  for (Grr_u32 q = 0; q < GRR_QUEUE_COUNT; q++) {
+    GrrPendingTransfers *pending = &pendingTransfers[q];
+    if (pending->count > 0 && pending->from == queue && pending->value == 0)
+      pending->value = value;
+  }
+}
+
+Grr_bool _Grr_queueTransfersPending(GRR_QUEUE queue,
+                                    const GrrQueueTransfer *transfers,
+                                    Grr_u32 count) {
+  const GrrPendingTransfers *pending = &pendingTransfers[queue];
+  if (pending->count != count || pending->value == 0)
+    return false;
+  for (Grr_u32 i = 0; i < count; i++) {
+    Grr_u32 j = 0;
+    while (j < pending->count &&
+           (pending->transfers[j].buffer != transfers[i].buffer ||
+            pending->transfers[j].image != transfers[i].image))
+      j++;
+    if (j == pending->count)
+      return false;
+  }
+  return true;
+}
+
+void _Grr_acquireQueueTransfers(VkCommandBuffer commandBuffer, GRR_QUEUE queue,
+                                VkPipelineStageFlags stages,
+                                GrrTimelineWait *wait) {
+  GrrPendingTransfers *pending = &pendingTransfers[queue];
+  *wait = (GrrTimelineWait){pending->from, 0, stages};
+  if (pending->count == 0)
+    return;
+  if (pending->value == 0) {
+    GRR_LOG_ERROR("Acquire of resources released by an unsubmitted batch\n");
+    return;
+  }
+  _Grr_recordQueueTransfers(commandBuffer, pending->from, queue,
+                            pending->transfers, pending->count, true, stages);
+  wait->value = pending->value;
+  pending->count = 0;
+}
+
+VkCommandBuffer _Grr_recordGraphicsAcquires(Grr_u32 frame,
+                                            GrrTimelineWait *wait) {
+  *wait = (GrrTimelineWait){GRR_QUEUE_COMPUTE, 0, 0};
+  if (pendingTransfers[GRR_QUEUE_GRAPHICS].count == 0)
+    return VK_NULL_HANDLE;
+
+  VkCommandBuffer commandBuffer = frameTailCommandBuffers[frame];
+  vkResetCommandBuffer(commandBuffer, 0);
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+  _Grr_acquireQueueTransfers(commandBuffer, GRR_QUEUE_GRAPHICS,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, wait);
+  vkEndCommandBuffer(commandBuffer);
+  return commandBuffer;
+}
+
+void _Grr_saveQueueTransfers() {
+  memcpy(savedTransfers, pendingTransfers, sizeof(pendingTransfers));
+}
+
+void _Grr_restoreQueueTransfers() {
+  memcpy(pendingTransfers, savedTransfers, sizeof(pendingTransfers));
+}
+
+void _Grr_returnQueueTransfers(Grr_u32 frame) {
+  GrrPendingTransfers *pending = &pendingTransfers[GRR_QUEUE_COMPUTE];
+  if (pending->count == 0)
+    return;
+
+  // Accessed by nothing in between, whatever the graphics queue does first
+  Grr_u32 count = pending->count;
+  GrrQueueTransfer transfers[GRR_COMPUTE_MAX_TRANSFERS];
+  for (Grr_u32 i = 0; i < count; i++) {
+    transfers[i] = pending->transfers[i];
+    transfers[i].srcAccess = 0;
+    transfers[i].dstAccess = VK_ACCESS_MEMORY_READ_BIT |
+                             VK_ACCESS_MEMORY_WRITE_BIT;
+  }
+
+  VkCommandBuffer commandBuffer = _Grr_beginComputeCommands(frame);
+  GrrTimelineWait wait;
+  _Grr_acquireQueueTransfers(commandBuffer, GRR_QUEUE_COMPUTE,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, &wait);
+  _Grr_releaseQueueTransfers(commandBuffer, GRR_QUEUE_COMPUTE,
+                             GRR_QUEUE_GRAPHICS, transfers, count,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  Grr_u64 value = _Grr_submitComputeCommands(frame, &wait, 1);
+  if (value == 0) {
+    GRR_LOG_CRITICAL("Failed to submit compute commands\n");
+    exit(EXIT_FAILURE);
+  }
+  _Grr_submittedQueueTransfers(GRR_QUEUE_COMPUTE, value);
+
+  // Acquired ahead of the frame's command buffer, which may be cached
+  commandBuffer = _Grr_recordGraphicsAcquires(frame, &wait);
+  VkSubmitInfo submitInfo = {0};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = commandBuffer != VK_NULL_HANDLE ? 1 : 0;
+  submitInfo.pCommandBuffers = &commandBuffer;
+  if (_Grr_submit(GRR_QUEUE_GRAPHICS, &submitInfo, &wait, 1) == 0) {
+    GRR_LOG_CRITICAL("Failed to submit queue ownership acquires\n");
+    exit(EXIT_FAILURE);
+  }
+}
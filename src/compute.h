@@ -0,0 +1,113 @@
+#ifndef GRR_COMPUTE_H
+#define GRR_COMPUTE_H
+
+#include "logging.h"
+#include "sync.h"
+#include "types.h"
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Async compute: when the device has a compute queue family apart from the
+// graphics one, and timeline semaphores to wait across queues on the GPU,
+// compute work of a frame is submitted to the compute queue on its own
+// timeline and runs while the graphics queue rasterizes. Resources handed
+// from a queue to the other are released by the first (queue family ownership
+// transfer) and acquired by the second, whose submission waits for the
+// releasing one. Buffers both queues only read (uploaded or written by the
+// host) are shared concurrently by the families instead.
+// Frames that compute work feeds are submitted to the graphics queue in two
+// parts, a head and a tail, so the compute queue can start on the next frame
+// as soon as the head released what it needs, while the tail still draws
+
+#define GRR_COMPUTE_MAX_TRANSFERS 4 // Released to a queue, not acquired yet
+
+// Resource handed from a queue family to another, with its accesses before
+// the release and after the acquire
+typedef struct GrrQueueTransfer {
+  VkBuffer buffer;      // Whole buffer, VK_NULL_HANDLE for an image
+  VkImage image;        // Every level and layer of a color image
+  VkImageLayout layout; // Of the image, kept by the transfer
+  VkAccessFlags srcAccess;
+  VkAccessFlags dstAccess;
+} GrrQueueTransfer;
+
+// Families of count (-1 ones are skipped) once each, in their order. Returns
+// the number of unique families
+Grr_u32 Grr_uniqueQueueFamilies(const Grr_u32 *families, Grr_u32 count,
+                                Grr_u32 *unique);
+
+// Barriers of the release (acquire false, recorded on a queue of srcFamily)
+// or of the acquire (on a queue of dstFamily) of transfers. Buffer and image
+// barriers are written in the order of transfers
+void Grr_queueTransferBarriers(const GrrQueueTransfer *transfers,
+                               Grr_u32 count, Grr_u32 srcFamily,
+                               Grr_u32 dstFamily, Grr_bool acquire,
+                               VkBufferMemoryBarrier *buffers,
+                               Grr_u32 *bufferCount,
+                               VkImageMemoryBarrier *images,
+                               Grr_u32 *imageCount);
+
+// Called once the queues, their timelines and the graphics command pool exist.
+// Devices without async compute are not a failure
+Grr_bool _Grr_initializeAsyncCompute();
+
+Grr_bool Grr_asyncComputeSupported();
+
+// Enabled by default where supported. Frames keep their compute work on the
+// graphics queue while disabled
+void Grr_setAsyncCompute(Grr_bool enabled);
+Grr_bool Grr_asyncComputeEnabled();
+
+// Family of the queue of a timeline
+Grr_u32 _Grr_queueFamily(GRR_QUEUE queue);
+
+// Families buffers read by several queues are shared by, concurrently when
+// there are more than one
+Grr_u32 _Grr_sharedQueueFamilies(Grr_u32 *families);
+
+// Compute command buffer of frame, reset and begun
+VkCommandBuffer _Grr_beginComputeCommands(Grr_u32 frame);
+// Ends and submits it once the waits are reached, returns its compute
+// timeline value, 0 on failure
+Grr_u64 _Grr_submitComputeCommands(Grr_u32 frame, const GrrTimelineWait *waits,
+                                   Grr_u32 waitCount);
+
+// Second graphics command buffer of frame, for the tail of split frames
+VkCommandBuffer _Grr_frameTailCommandBuffer(Grr_u32 frame);
+
+// Records the release of transfers from queue from to queue to, at the given
+// stages of their last uses. Acquired by the next submission to queue to
+// after _Grr_submittedQueueTransfers
+void _Grr_releaseQueueTransfers(VkCommandBuffer commandBuffer, GRR_QUEUE from,
+                                GRR_QUEUE to, const GrrQueueTransfer *transfers,
+                                Grr_u32 count, VkPipelineStageFlags stages);
+// The releases recorded on queue were submitted with timeline value
+void _Grr_submittedQueueTransfers(GRR_QUEUE queue, Grr_u64 value);
+
+// Whether the transfers (by buffer and image) are released to queue
+Grr_bool _Grr_queueTransfersPending(GRR_QUEUE queue,
+                                    const GrrQueueTransfer *transfers,
+                                    Grr_u32 count);
+
+// Records the acquires of what was released to queue, for its first uses at
+// stages. The submission waits for wait, of value 0 when nothing was released
+void _Grr_acquireQueueTransfers(VkCommandBuffer commandBuffer, GRR_QUEUE queue,
+                                VkPipelineStageFlags stages,
+                                GrrTimelineWait *wait);
+
+// Tail command buffer of frame with only the acquires of what was released to
+// the graphics queue, ended, VK_NULL_HANDLE when nothing was. Its submission
+// waits for wait
+VkCommandBuffer _Grr_recordGraphicsAcquires(Grr_u32 frame,
+                                            GrrTimelineWait *wait);
+
+// Releases and acquires recorded after a save are forgotten by the restore,
+// for command buffers that are not submitted
+void _Grr_saveQueueTransfers();
+void _Grr_restoreQueueTransfers();
+
+// Hands what was released to the compute queue back to the graphics queue,
+// ahead of a frame that keeps its compute work on the graphics queue
+void _Grr_returnQueueTransfers(Grr_u32 frame);
+
+#endif
@@ -0,0 +1,302 @@
+#include "culling.h"
+
+// Grows every array of count floats, arrays keep their values on failure
+Grr_bool _Grr_growArrays(Grr_f32 **arrays, Grr_u32 arrayCount,
+                         Grr_u32 capacity) {
+  for (Grr_u32 i = 0; i < arrayCount; i++) {
+    Grr_f32 *grown =
+        (Grr_f32 *)realloc(arrays[i], sizeof(Grr_f32) * (size_t)capacity);
+    if (NULL == grown) {
+      GRR_LOG_ERROR("Failed to allocate memory for bounding volumes\n");
+      return false;
+    }
+    arrays[i] = grown;
+  }
+  return true;
+}
+
+Grr_bool Grr_resizeBoundingSpheres(GrrBoundingSpheres *spheres,
+                                   Grr_u32 count) {
+  if (count > spheres->capacity) {
+    Grr_f32 *arrays[] = {spheres->x, spheres->y, spheres->z, spheres->radius};
+    Grr_bool grown = _Grr_growArrays(arrays, 4, count);
+    spheres->x = arrays[0];
+    spheres->y = arrays[1];
+    spheres->z = arrays[2];
+    spheres->radius = arrays[3];
+    if (!grown)
+      return false;
+    spheres->capacity = count;
+  }
+  spheres->count = count;
+  return true;
+}
+
+void Grr_destroyBoundingSpheres(GrrBoundingSpheres *spheres) {
+  free(spheres->x);
+  free(spheres->y);
+  free(spheres->z);
+  free(spheres->radius);
+  memset(spheres, 0, sizeof(GrrBoundingSpheres));
+}
+
+Grr_bool Grr_resizeBoundingBoxes(GrrBoundingBoxes *boxes, Grr_u32 count) {
+  if (count > boxes->capacity) {
+    Grr_f32 *arrays[] = {boxes->centerX, boxes->centerY, boxes->centerZ,
+                         boxes->extentX, boxes->extentY, boxes->extentZ};
+    Grr_bool grown = _Grr_growArrays(arrays, 6, count);
+    boxes->centerX = arrays[0];
+    boxes->centerY = arrays[1];
+    boxes->centerZ = arrays[2];
+    boxes->extentX = arrays[3];
+    boxes->extentY = arrays[4];
+    boxes->extentZ = arrays[5];
+    if (!grown)
+      return false;
+    boxes->capacity = count;
+  }
+  boxes->count = count;
+  return true;
+}
+
+void Grr_destroyBoundingBoxes(GrrBoundingBoxes *boxes) {
+  free(boxes->centerX);
+  free(boxes->centerY);
+  free(boxes->centerZ);
+  free(boxes->extentX);
+  free(boxes->extentY);
+  free(boxes->extentZ);
+  memset(boxes, 0, sizeof(GrrBoundingBoxes));
+}
+
+// Plane components splatted across lanes: [plane][x, y, z, w]. Box tests also
+// use the absolute values of the normals
+void _Grr_splatPlanes(const GrrVector4 planes[6], GrrF32x4 splat[6][4],
+                      GrrF32x4 absolute[6][3]) {
+  for (Grr_u32 p = 0; p < 6; p++) {
+    splat[p][0] = Grr_f32x4Splat(planes[p].x);
+    splat[p][1] = Grr_f32x4Splat(planes[p].y);
+    splat[p][2] = Grr_f32x4Splat(planes[p].z);
+    splat[p][3] = Grr_f32x4Splat(planes[p].w);
+    if (NULL != absolute) {
+      for (Grr_u32 j = 0; j < 3; j++)
+        absolute[p][j] = Grr_f32x4Abs(splat[p][j]);
+    }
+  }
+}
+
+// Appends index + lane for the lanes set in mask. Every lane is written and
+// only visible ones advance, so there is no branch per volume
+Grr_u32 _Grr_appendVisible(Grr_u32 mask, Grr_u32 index, Grr_u32 *visible,
+                           Grr_u32 visibleCount) {
+  for (Grr_u32 lane = 0; lane < 4; lane++) {
+    visible[visibleCount] = index + lane;
+    visibleCount += (mask >> lane) & 1;
+  }
+  return visibleCount;
+}
+
+// Visible lanes of spheres [i, i + 4): the sphere is outside when its center
+// is farther than its radius behind any plane
+Grr_u32 _Grr_visibleSpheres4(GrrF32x4 planes[6][4],
+                             const GrrBoundingSpheres *spheres, Grr_u32 i) {
+  GrrF32x4 x = Grr_f32x4Load(&spheres->x[i]);
+  GrrF32x4 y = Grr_f32x4Load(&spheres->y[i]);
+  GrrF32x4 z = Grr_f32x4Load(&spheres->z[i]);
+  GrrF32x4 radius = Grr_f32x4Load(&spheres->radius[i]);
+
+  // Smallest signed distance to a plane, pushed out by the radius
+  GrrF32x4 nearest = Grr_f32x4Splat(INFINITY);
+  for (Grr_u32 p = 0; p < 6; p++) {
+    GrrF32x4 distance = Grr_f32x4Add(
+        Grr_f32x4Add(Grr_f32x4Mul(planes[p][0], x),
+                     Grr_f32x4Mul(planes[p][1], y)),
+        Grr_f32x4Add(Grr_f32x4Mul(planes[p][2], z), planes[p][3]));
+    nearest = Grr_f32x4Min(nearest, Grr_f32x4Add(distance, radius));
+  }
+  return ~Grr_f32x4LessMask(nearest, Grr_f32x4Splat(0.0f)) & 0xF;
+}
+
+Grr_bool _Grr_isSphereVisible(const GrrVector4 planes[6],
+                              const GrrBoundingSpheres *spheres, Grr_u32 i) {
+  for (Grr_u32 p = 0; p < 6; p++) {
+    if (planes[p].x * spheres->x[i] + planes[p].y * spheres->y[i] +
+            planes[p].z * spheres->z[i] + planes[p].w + spheres->radius[i] <
+        0.0f)
+      return false;
+  }
+  return true;
+}
+
+Grr_u32 Grr_cullSpheres(const GrrVector4 planes[6],
+                        const GrrBoundingSpheres *spheres, Grr_u32 first,
+                        Grr_u32 count, Grr_u32 *visible) {
+  GrrF32x4 splat[6][4];
+  _Grr_splatPlanes(planes, splat, NULL);
+
+  Grr_u32 visibleCount = 0;
+  Grr_u32 end = first + count;
+  Grr_u32 i = first;
+  // Two independent vectors per iteration keep more loads in flight
+  for (; i + 8 <= end; i += 8) {
+    Grr_u32 low = _Grr_visibleSpheres4(splat, spheres, i);
+    Grr_u32 high = _Grr_visibleSpheres4(splat, spheres, i + 4);
+    visibleCount = _Grr_appendVisible(low, i, visible, visibleCount);
+    visibleCount = _Grr_appendVisible(high, i + 4, visible, visibleCount);
+  }
+  for (; i + 4 <= end; i += 4) {
+    visibleCount = _Grr_appendVisible(_Grr_visibleSpheres4(splat, spheres, i),
+                                      i, visible, visibleCount);
+  }
+  for (; i < end; i++) {
+    if (_Grr_isSphereVisible(planes, spheres, i))
+      visible[visibleCount++] = i;
+  }
+  return visibleCount;
+}
+
+// Visible lanes of boxes [i, i + 4): the box is outside when its corner
+// farthest along a plane normal is behind that plane
+Grr_u32 _Grr_visibleBoxes4(GrrF32x4 planes[6][4], GrrF32x4 absolute[6][3],
+                           const GrrBoundingBoxes *boxes, Grr_u32 i) {
+  GrrF32x4 x = Grr_f32x4Load(&boxes->centerX[i]);
+  GrrF32x4 y = Grr_f32x4Load(&boxes->centerY[i]);
+  GrrF32x4 z = Grr_f32x4Load(&boxes->centerZ[i]);
+  GrrF32x4 ex = Grr_f32x4Load(&boxes->extentX[i]);
+  GrrF32x4 ey = Grr_f32x4Load(&boxes->extentY[i]);
+  GrrF32x4 ez = Grr_f32x4Load(&boxes->extentZ[i]);
+
+  GrrF32x4 nearest = Grr_f32x4Splat(INFINITY);
+  for (Grr_u32 p = 0; p < 6; p++) {
+    GrrF32x4 distance = Grr_f32x4Add(
+        Grr_f32x4Add(Grr_f32x4Mul(planes[p][0], x),
+                     Grr_f32x4Mul(planes[p][1], y)),
+        Grr_f32x4Add(Grr_f32x4Mul(planes[p][2], z), planes[p][3]));
+    // Projected radius of the box on the normal
+    GrrF32x4 radius = Grr_f32x4Add(
+        Grr_f32x4Add(Grr_f32x4Mul(absolute[p][0], ex),
+                     Grr_f32x4Mul(absolute[p][1], ey)),
+        Grr_f32x4Mul(absolute[p][2], ez));
+    nearest = Grr_f32x4Min(nearest, Grr_f32x4Add(distance, radius));
+  }
+  return ~Grr_f32x4LessMask(nearest, Grr_f32x4Splat(0.0f)) & 0xF;
+}
+
+Grr_bool _Grr_isBoxVisible(const GrrVector4 planes[6],
+                           const GrrBoundingBoxes *boxes, Grr_u32 i) {
+  for (Grr_u32 p = 0; p < 6; p++) {
+    Grr_f32 distance = planes[p].x * boxes->centerX[i] +
+                       planes[p].y * boxes->centerY[i] +
+                       planes[p].z * boxes->centerZ[i] + planes[p].w;
+    Grr_f32 radius = fabsf(planes[p].x) * boxes->extentX[i] +
+                     fabsf(planes[p].y) * boxes->extentY[i] +
+                     fabsf(planes[p].z) * boxes->extentZ[i];
+    if (distance + radius < 0.0f)
+      return false;
+  }
+  return true;
+}
+
+Grr_u32 Grr_cullBoxes(const GrrVector4 planes[6], const GrrBoundingBoxes *boxes,
+                      Grr_u32 first, Grr_u32 count, Grr_u32 *visible) {
+  GrrF32x4 splat[6][4];
+  GrrF32x4 absolute[6][3];
+  _Grr_splatPlanes(planes, splat, absolute);
+
+  Grr_u32 visibleCount = 0;
+  Grr_u32 end = first + count;
+  Grr_u32 i = first;
+  for (; i + 8 <= end; i += 8) {
+    Grr_u32 low = _Grr_visibleBoxes4(splat, absolute, boxes, i);
+    Grr_u32 high = _Grr_visibleBoxes4(splat, absolute, boxes, i + 4);
+    visibleCount = _Grr_appendVisible(low, i, visible, visibleCount);
+    visibleCount = _Grr_appendVisible(high, i + 4, visible, visibleCount);
+  }
+  for (; i + 4 <= end; i += 4) {
+    visibleCount =
+        _Grr_appendVisible(_Grr_visibleBoxes4(splat, absolute, boxes, i), i,
+                           visible, visibleCount);
+  }
+  for (; i < end; i++) {
+    if (_Grr_isBoxVisible(planes, boxes, i))
+      visible[visibleCount++] = i;
+  }
+  return visibleCount;
+}
+
+typedef struct _GrrCullJob {
+  const GrrVector4 *planes;
+  const GrrBoundingSpheres *spheres; // One of spheres or boxes
+  const GrrBoundingBoxes *boxes;
+  Grr_u32 count;
+  Grr_u32 chunkSize;
+  Grr_u32 *visible;
+  Grr_u32 chunkVisible[GRR_MAX_JOB_THREADS + 1];
+} _GrrCullJob;
+
+// Culls one chunk into its own range of visible
+void _Grr_cullChunk(void *data, Grr_u32 chunk, Grr_u32 threadIndex) {
+  _GrrCullJob *job = (_GrrCullJob *)data;
+  Grr_u32 first = chunk * job->chunkSize;
+  Grr_u32 count = job->count - first;
+  if (count > job->chunkSize)
+    count = job->chunkSize;
+  job->chunkVisible[chunk] =
+      (NULL != job->spheres
+           ? Grr_cullSpheres(job->planes, job->spheres, first, count,
+                             job->visible + first)
+           : Grr_cullBoxes(job->planes, job->boxes, first, count,
+                           job->visible + first));
+}
+
+Grr_u32 _Grr_cullParallel(_GrrCullJob *job) {
+  // One chunk per thread (the work per volume is uniform), chunks start on a
+  // multiple of 8 volumes
+  Grr_u32 chunkCount = job->count / GRR_CULL_MIN_ITEMS_PER_JOB;
+  if (chunkCount > Grr_jobThreadCount())
+    chunkCount = Grr_jobThreadCount();
+  if (chunkCount == 0)
+    chunkCount = 1;
+  job->chunkSize = ((job->count + chunkCount - 1) / chunkCount + 7) & ~7u;
+  chunkCount = (job->count + job->chunkSize - 1) / job->chunkSize;
+  if (chunkCount <= 1) {
+    _Grr_cullChunk(job, 0, 0);
+    return job->chunkVisible[0];
+  }
+  Grr_parallelFor(chunkCount, _Grr_cullChunk, job);
+
+  // Chunks are compacted in order, indices stay sorted
+  Grr_u32 visibleCount = job->chunkVisible[0];
+  for (Grr_u32 chunk = 1; chunk < chunkCount; chunk++) {
+    memmove(job->visible + visibleCount, job->visible + chunk * job->chunkSize,
+            sizeof(Grr_u32) * job->chunkVisible[chunk]);
+    visibleCount += job->chunkVisible[chunk];
+  }
+  return visibleCount;
+}
+
+Grr_u32 Grr_cullSpheresParallel(const GrrVector4 planes[6],
+                                const GrrBoundingSpheres *spheres,
+                                Grr_u32 *visible) {
+  if (spheres->count == 0)
+    return 0;
+  _GrrCullJob job = {0};
+  job.planes = planes;
+  job.spheres = spheres;
+  job.count = spheres->count;
+  job.visible = visible;
+  return _Grr_cullParallel(&job);
+}
+
+Grr_u32 Grr_cullBoxesParallel(const GrrVector4 planes[6],
+                              const GrrBoundingBoxes *boxes,
+                              Grr_u32 *visible) {
+  if (boxes->count == 0)
+    return 0;
+  _GrrCullJob job = {0};
+  job.planes = planes;
+  job.boxes = boxes;
+  job.count = boxes->count;
+  job.visible = visible;
+  return _Grr_cullParallel(&job);
+}
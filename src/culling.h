@@ -0,0 +1,66 @@
+#ifndef GRR_CULLING_H
+#define GRR_CULLING_H
+
+#include "jobs.h"
+#include "logging.h"
+#include "math/linear.h"
+#include "math/simd.h"
+#include "types.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// CPU frustum culling: bounding volumes are stored as structure of arrays so
+// the kernels test 8 volumes per iteration (two 4-wide vectors) against the 6
+// planes of Grr_frustumPlanes, and write the indices of the visible ones in
+// increasing order. Large sets are split across the job system.
+// A zero initialized set is empty, arrays are written directly once sized
+
+// Fewer volumes per job cost more in scheduling than they save
+#define GRR_CULL_MIN_ITEMS_PER_JOB 4096
+
+typedef struct GrrBoundingSpheres {
+  Grr_f32 *x; // Centers
+  Grr_f32 *y;
+  Grr_f32 *z;
+  Grr_f32 *radius;
+  Grr_u32 count;
+  Grr_u32 capacity;
+} GrrBoundingSpheres;
+
+// Axis aligned boxes
+typedef struct GrrBoundingBoxes {
+  Grr_f32 *centerX;
+  Grr_f32 *centerY;
+  Grr_f32 *centerZ;
+  Grr_f32 *extentX; // Half sizes
+  Grr_f32 *extentY;
+  Grr_f32 *extentZ;
+  Grr_u32 count;
+  Grr_u32 capacity;
+} GrrBoundingBoxes;
+
+// Sets the number of volumes, growing the arrays (values of existing volumes
+// are kept, new ones are undefined)
+Grr_bool Grr_resizeBoundingSpheres(GrrBoundingSpheres *spheres, Grr_u32 count);
+void Grr_destroyBoundingSpheres(GrrBoundingSpheres *spheres);
+Grr_bool Grr_resizeBoundingBoxes(GrrBoundingBoxes *boxes, Grr_u32 count);
+void Grr_destroyBoundingBoxes(GrrBoundingBoxes *boxes);
+
+// Indices of the visible volumes of [first, first + count), returns their
+// number. visible has room for count indices
+Grr_u32 Grr_cullSpheres(const GrrVector4 planes[6],
+                        const GrrBoundingSpheres *spheres, Grr_u32 first,
+                        Grr_u32 count, Grr_u32 *visible);
+Grr_u32 Grr_cullBoxes(const GrrVector4 planes[6], const GrrBoundingBoxes *boxes,
+                      Grr_u32 first, Grr_u32 count, Grr_u32 *visible);
+
+// Every volume of the set, split across the job threads. visible has room for
+// the count of the set
+Grr_u32 Grr_cullSpheresParallel(const GrrVector4 planes[6],
+                                const GrrBoundingSpheres *spheres,
+                                Grr_u32 *visible);
+Grr_u32 Grr_cullBoxesParallel(const GrrVector4 planes[6],
+                              const GrrBoundingBoxes *boxes, Grr_u32 *visible);
+
+#endif
@@ -0,0 +1,213 @@
+#include "deletion.h"
+#include "vulkan.h"
+
+GrrDeletionQueue deletionQueue;
+Grr_bool deletionsImmediate = false;
+
+void Grr_destroyDeletionQueue(GrrDeletionQueue *queue) {
+  free(queue->deletions);
+  *queue = (GrrDeletionQueue){0};
+}
+
+Grr_bool Grr_pushDeletion(GrrDeletionQueue *queue,
+                          const GrrDeletion *deletion) {
+  if (queue->count == queue->capacity) {
+    Grr_u32 capacity = queue->capacity > 0 ? 2 * queue->capacity : 64;
+    GrrDeletion *deletions = (GrrDeletion *)realloc(
+        queue->deletions, sizeof(GrrDeletion) * capacity);
+    if (NULL == deletions)
+      return false;
+    queue->deletions = deletions;
+    queue->capacity = capacity;
+  }
+
+  // Usually queued by the current frame, after every other deletion
+  Grr_u32 index = queue->count;
+  while (index > 0 && queue->deletions[index - 1].frame > deletion->frame)
+    index--;
+  memmove(queue->deletions + index + 1, queue->deletions + index,
+          sizeof(GrrDeletion) * (queue->count - index));
+  queue->deletions[index] = *deletion;
+  queue->count++;
+  return true;
+}
+
+Grr_u32 Grr_completedDeletions(const GrrDeletionQueue *queue,
+                               Grr_u64 completedFrame) {
+  Grr_u32 count = 0;
+  while (count < queue->count &&
+         queue->deletions[count].frame <= completedFrame)
+    count++;
+  return count;
+}
+
+void Grr_popDeletions(GrrDeletionQueue *queue, Grr_u32 count) {
+  if (count == 0)
+    return;
+  queue->count -= count;
+  memmove(queue->deletions, queue->deletions + count,
+          sizeof(GrrDeletion) * queue->count);
+}
+
+// The object only, not its memory
+void _Grr_destroyDeletion(GrrDeletion *deletion) {
+  switch (deletion->type) {
+  case GRR_DELETION_SWAPCHAIN:
+    vkDestroySwapchainKHR(device, deletion->handle.swapchain, NULL);
+    break;
+  case GRR_DELETION_BUFFER:
+    vkDestroyBuffer(device, deletion->handle.buffer, NULL);
+    break;
+  case GRR_DELETION_IMAGE:
+    vkDestroyImage(device, deletion->handle.image, NULL);
+    break;
+  case GRR_DELETION_IMAGE_VIEW:
+    vkDestroyImageView(device, deletion->handle.imageView, NULL);
+    break;
+  case GRR_DELETION_SAMPLER:
+    vkDestroySampler(device, deletion->handle.sampler, NULL);
+    break;
+  case GRR_DELETION_FRAMEBUFFER:
+    vkDestroyFramebuffer(device, deletion->handle.framebuffer, NULL);
+    break;
+  case GRR_DELETION_COMMAND_BUFFER:
+    vkFreeCommandBuffers(device, deletion->commandPool, 1,
+                         &deletion->handle.commandBuffer);
+    break;
+  case GRR_DELETION_COMMAND_POOL:
+    vkDestroyCommandPool(device, deletion->handle.commandPool, NULL);
+    break;
+  case GRR_DELETION_DESCRIPTOR_SET:
+    vkFreeDescriptorSets(device, deletion->descriptorPool, 1,
+                         &deletion->handle.descriptorSet);
+    break;
+  case GRR_DELETION_DESCRIPTOR_POOL:
+    vkDestroyDescriptorPool(device, deletion->handle.descriptorPool, NULL);
+    break;
+  case GRR_DELETION_MEMORY:
+    break;
+  }
+}
+
+void _Grr_deferDeletion(GrrDeletion *deletion) {
+  if (deletion->frame == 0)
+    deletion->frame = frameNumber;
+  if (deletionsImmediate) {
+    _Grr_destroyDeletion(deletion);
+    _Grr_freeGpuMemory(&deletion->memory);
+  } else if (!Grr_pushDeletion(&deletionQueue, deletion)) {
+    GRR_LOG_WARNING("Deletion queue is full, waiting for the device\n");
+    vkDeviceWaitIdle(device);
+    _Grr_destroyDeletion(deletion);
+    _Grr_freeGpuMemory(&deletion->memory);
+  }
+}
+
+void _Grr_deferSwapchain(VkSwapchainKHR swapchain) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_SWAPCHAIN;
+  deletion.handle.swapchain = swapchain;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferBuffer(VkBuffer buffer, const GrrGpuAllocation *memory) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_BUFFER;
+  deletion.handle.buffer = buffer;
+  if (NULL != memory)
+    deletion.memory = *memory;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferImage(VkImage image, const GrrGpuAllocation *memory) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_IMAGE;
+  deletion.handle.image = image;
+  if (NULL != memory)
+    deletion.memory = *memory;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferImageView(VkImageView view) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_IMAGE_VIEW;
+  deletion.handle.imageView = view;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferSampler(VkSampler sampler) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_SAMPLER;
+  deletion.handle.sampler = sampler;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferFramebuffer(VkFramebuffer framebuffer) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_FRAMEBUFFER;
+  deletion.handle.framebuffer = framebuffer;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferCommandBuffer(VkCommandPool pool, VkCommandBuffer buffer) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_COMMAND_BUFFER;
+  deletion.handle.commandBuffer = buffer;
+  deletion.commandPool = pool;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferCommandPool(VkCommandPool pool) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_COMMAND_POOL;
+  deletion.handle.commandPool = pool;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferDescriptorSet(VkDescriptorPool pool, VkDescriptorSet set) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_DESCRIPTOR_SET;
+  deletion.handle.descriptorSet = set;
+  deletion.descriptorPool = pool;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferDescriptorPool(VkDescriptorPool pool) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_DESCRIPTOR_POOL;
+  deletion.handle.descriptorPool = pool;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_deferMemory(const GrrGpuAllocation *memory) {
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_MEMORY;
+  deletion.memory = *memory;
+  _Grr_deferDeletion(&deletion);
+}
+
+void _Grr_flushDeletions(Grr_u64 completedFrame) {
+  Grr_u32 count = Grr_completedDeletions(&deletionQueue, completedFrame);
+  GrrGpuAllocation batch[GRR_DELETION_BATCH];
+  Grr_u32 batchCount = 0;
+  for (Grr_u32 i = 0; i < count; i++) {
+    GrrDeletion *deletion = &deletionQueue.deletions[i];
+    _Grr_destroyDeletion(deletion);
+    if (deletion->memory.memory == VK_NULL_HANDLE)
+      continue;
+    batch[batchCount++] = deletion->memory;
+    if (batchCount == GRR_DELETION_BATCH) {
+      _Grr_freeGpuMemoryBatch(batch, batchCount);
+      batchCount = 0;
+    }
+  }
+  _Grr_freeGpuMemoryBatch(batch, batchCount);
+  Grr_popDeletions(&deletionQueue, count);
+}
+
+void _Grr_destroyDeletions() {
+  GRR_LOG_INFO("Free deferred deletions (%u)\n", deletionQueue.count);
+  _Grr_flushDeletions(UINT64_MAX);
+  Grr_destroyDeletionQueue(&deletionQueue);
+  deletionsImmediate = true;
+}
@@ -0,0 +1,102 @@
+#ifndef GRR_DELETION_H
+#define GRR_DELETION_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "types.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Deferred deletion: objects that frames in flight may still use are queued
+// with the number of the last frame that used them, and destroyed once that
+// frame is complete (frames complete in submission order), so resources can
+// be freed at any time without waiting for the device. The memory of the
+// objects destroyed together is returned to the allocator in one batch.
+// Teardown at exit queues every object too: the queue is flushed once after
+// the device is idle and the last module released its objects, before device
+// memory and the device are destroyed. Objects of the same frame are destroyed
+// in the order they were queued (command buffers before their pool)
+
+#define GRR_DELETION_BATCH 64 // Allocations freed together
+
+typedef enum GRR_DELETION {
+  GRR_DELETION_SWAPCHAIN = 0,
+  GRR_DELETION_BUFFER, // And its memory
+  GRR_DELETION_IMAGE,  // And its memory
+  GRR_DELETION_IMAGE_VIEW,
+  GRR_DELETION_SAMPLER,
+  GRR_DELETION_FRAMEBUFFER,
+  GRR_DELETION_COMMAND_BUFFER, // Freed to its pool
+  GRR_DELETION_COMMAND_POOL,
+  GRR_DELETION_DESCRIPTOR_SET, // Freed to its pool, which allows it
+  GRR_DELETION_DESCRIPTOR_POOL,
+  GRR_DELETION_MEMORY // Memory only, of objects destroyed separately
+} GRR_DELETION;
+
+typedef struct GrrDeletion {
+  GRR_DELETION type;
+  Grr_u64 frame; // Last frame that used the object, 0 for the current one
+  union {
+    VkSwapchainKHR swapchain;
+    VkBuffer buffer;
+    VkImage image;
+    VkImageView imageView;
+    VkSampler sampler;
+    VkFramebuffer framebuffer;
+    VkCommandBuffer commandBuffer;
+    VkCommandPool commandPool;
+    VkDescriptorSet descriptorSet;
+    VkDescriptorPool descriptorPool;
+  } handle;
+  VkCommandPool commandPool;       // Of command buffers
+  VkDescriptorPool descriptorPool; // Of descriptor sets
+  GrrGpuAllocation memory;
+} GrrDeletion;
+
+// Ordered by frame, then by push
+typedef struct GrrDeletionQueue {
+  GrrDeletion *deletions;
+  Grr_u32 count;
+  Grr_u32 capacity;
+} GrrDeletionQueue;
+
+// A zeroed queue is empty
+void Grr_destroyDeletionQueue(GrrDeletionQueue *queue);
+// Grows the queue, false when out of memory
+Grr_bool Grr_pushDeletion(GrrDeletionQueue *queue,
+                          const GrrDeletion *deletion);
+// Number of deletions, from the oldest, of frames up to completedFrame
+Grr_u32 Grr_completedDeletions(const GrrDeletionQueue *queue,
+                               Grr_u64 completedFrame);
+// Removes the count oldest deletions
+void Grr_popDeletions(GrrDeletionQueue *queue, Grr_u32 count);
+
+// Queues the object of deletion (and its memory). Without memory to queue it,
+// waits for the device to be idle and destroys it
+void _Grr_deferDeletion(GrrDeletion *deletion);
+
+// The current frame (frameNumber) may use the object. memory is NULL for
+// buffers and images bound to memory freed separately
+void _Grr_deferSwapchain(VkSwapchainKHR swapchain);
+void _Grr_deferBuffer(VkBuffer buffer, const GrrGpuAllocation *memory);
+void _Grr_deferImage(VkImage image, const GrrGpuAllocation *memory);
+void _Grr_deferImageView(VkImageView view);
+void _Grr_deferSampler(VkSampler sampler);
+void _Grr_deferFramebuffer(VkFramebuffer framebuffer);
+void _Grr_deferCommandBuffer(VkCommandPool pool, VkCommandBuffer buffer);
+void _Grr_deferCommandPool(VkCommandPool pool);
+void _Grr_deferDescriptorSet(VkDescriptorPool pool, VkDescriptorSet set);
+void _Grr_deferDescriptorPool(VkDescriptorPool pool);
+void _Grr_deferMemory(const GrrGpuAllocation *memory);
+
+// Destroys the objects of frames up to completedFrame, called once they are
+// complete
+void _Grr_flushDeletions(Grr_u64 completedFrame);
+
+// Registered at exit once device memory exists: destroys every queued object,
+// later deletions are immediate
+void _Grr_destroyDeletions();
+
+#endif
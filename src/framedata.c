@@ -0,0 +1,81 @@
+#include "framedata.h"
+#include "vulkan.h"
+
+VkBuffer frameDataBuffer;
+GrrGpuAllocation frameDataMemory;
+GrrFrameAllocator *frameAllocators = NULL; // One per frame in flight
+Grr_u32 frameDataFrame = 0;
+
+void *Grr_frameAllocate(GrrFrameAllocator *allocator, VkDeviceSize size,
+                        VkDeviceSize *offset) {
+  VkDeviceSize head = (allocator->head + allocator->alignment - 1) &
+                      ~(allocator->alignment - 1);
+  if (head > allocator->size || size > allocator->size - head)
+    return NULL;
+
+  allocator->head = head + size;
+  *offset = allocator->base + head;
+  return allocator->mapped + head;
+}
+
+void _Grr_destroyFrameData() {
+  GRR_LOG_INFO("Free frame data\n");
+  _Grr_deferBuffer(frameDataBuffer, &frameDataMemory);
+  free(frameAllocators);
+}
+
+Grr_bool _Grr_initializeFrameData(Grr_u32 framesInFlight) {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+  if (properties.limits.minStorageBufferOffsetAlignment > alignment)
+    alignment = properties.limits.minStorageBufferOffsetAlignment;
+  if (alignment < 16)
+    alignment = 16;
+
+  frameAllocators = (GrrFrameAllocator *)calloc(framesInFlight,
+                                                sizeof(GrrFrameAllocator));
+  if (NULL == frameAllocators) {
+    GRR_LOG_ERROR("Failed to allocate memory for frame allocators\n");
+    return false;
+  }
+
+  // Compute passes on the compute queue read the frame's uniform data too
+  if (!_Grr_createSharedBuffer(GRR_FRAME_DATA_SIZE * framesInFlight,
+                               VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                               GRR_GPU_MEMORY_PERSISTENT, &frameDataBuffer,
+                               &frameDataMemory)) {
+    free(frameAllocators);
+    return false;
+  }
+  atexit(_Grr_destroyFrameData);
+
+  // Blocks of host visible memory stay mapped
+  for (Grr_u32 i = 0; i < framesInFlight; i++) {
+    frameAllocators[i].base = GRR_FRAME_DATA_SIZE * i;
+    frameAllocators[i].size = GRR_FRAME_DATA_SIZE;
+    frameAllocators[i].alignment = alignment;
+    frameAllocators[i].mapped =
+        (Grr_byte *)frameDataMemory.mapped + frameAllocators[i].base;
+  }
+  return true;
+}
+
+void _Grr_beginFrameData(Grr_u32 frame) {
+  frameDataFrame = frame;
+  frameAllocators[frame].head = 0;
+}
+
+void *Grr_allocateFrameData(VkDeviceSize size, VkDeviceSize *offset) {
+  void *data =
+      Grr_frameAllocate(&frameAllocators[frameDataFrame], size, offset);
+  if (NULL == data)
+    GRR_LOG_ERROR("Frame data full (%llu bytes requested)\n",
+                  (unsigned long long)size);
+  return data;
+}
+
+VkBuffer Grr_frameDataBuffer() { return frameDataBuffer; }
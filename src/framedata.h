@@ -0,0 +1,43 @@
+#ifndef GRR_FRAMEDATA_H
+#define GRR_FRAMEDATA_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "types.h"
+#include <vulkan/vulkan.h>
+
+// Transient per frame uniform and storage data: one persistently mapped buffer
+// split in a region per frame in flight. Data is bump allocated in the region
+// of the current frame and addressed with dynamic descriptor offsets, the
+// region is rewound once the frame is complete. Nothing is freed
+// individually: data lives for exactly one frame
+
+#define GRR_FRAME_DATA_SIZE (4ull << 20) // Per frame in flight
+
+// Bump allocator over the region [base, base + size) of a mapped buffer
+typedef struct GrrFrameAllocator {
+  VkDeviceSize base;
+  VkDeviceSize size;
+  VkDeviceSize head;      // Relative to base
+  VkDeviceSize alignment; // Power of two
+  Grr_byte *mapped;       // Host address of base
+} GrrFrameAllocator;
+
+// Host address of size bytes, offset receives their offset in the buffer.
+// NULL when the region is full
+void *Grr_frameAllocate(GrrFrameAllocator *allocator, VkDeviceSize size,
+                        VkDeviceSize *offset);
+
+// Called once the logical device and memory allocator exist
+Grr_bool _Grr_initializeFrameData(Grr_u32 framesInFlight);
+
+// Rewinds the region of frame, whose previous submission must be complete
+void _Grr_beginFrameData(Grr_u32 frame);
+
+// Allocates from the region of the frame last passed to _Grr_beginFrameData,
+// aligned for both uniform and storage buffer descriptors
+void *Grr_allocateFrameData(VkDeviceSize size, VkDeviceSize *offset);
+
+VkBuffer Grr_frameDataBuffer();
+
+#endif
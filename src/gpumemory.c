@@ -0,0 +1,476 @@
+#include "gpumemory.h"
+
+struct GrrGpuMemoryBlock {
+  VkDeviceMemory memory;
+  VkDeviceSize size;
+  void *mapped;
+  GRR_GPU_MEMORY_USAGE usage;
+  GrrBuddyAllocator buddy;   // Persistent blocks
+  GrrLinearAllocator linear; // Transient blocks
+  Grr_u32 allocationCount;
+  VkDeviceSize usedBytes;
+  GrrGpuMemoryBlock *next;
+};
+
+typedef struct GrrGpuMemoryType {
+  GrrGpuMemoryBlock *blocks;
+  VkDeviceSize blockSize;
+  // Dedicated allocations
+  Grr_u32 dedicatedCount;
+  VkDeviceSize dedicatedBytes;
+} GrrGpuMemoryType;
+
+VkDevice gpuMemoryDevice;
+VkPhysicalDeviceMemoryProperties gpuMemoryProperties;
+VkDeviceSize bufferImageGranularity = 1;
+GrrGpuMemoryType gpuMemoryTypes[VK_MAX_MEMORY_TYPES];
+
+Grr_u32 _Grr_log2(VkDeviceSize x) {
+  Grr_u32 n = 0;
+  while (x > 1) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+}
+
+VkDeviceSize _Grr_nextPowerOfTwo(VkDeviceSize x) {
+  VkDeviceSize p = 1;
+  while (p < x)
+    p <<= 1;
+  return p;
+}
+
+VkDeviceSize _Grr_alignUp(VkDeviceSize x, VkDeviceSize alignment) {
+  return alignment > 1 ? (x + alignment - 1) / alignment * alignment : x;
+}
+
+Grr_bool Grr_initializeBuddyAllocator(GrrBuddyAllocator *buddy,
+                                      VkDeviceSize size, VkDeviceSize minSize) {
+  if (minSize == 0 || size < minSize || (size & (size - 1)) ||
+      (minSize & (minSize - 1))) {
+    GRR_LOG_ERROR("Buddy allocator sizes must be powers of two\n");
+    return false;
+  }
+
+  buddy->minSize = minSize;
+  buddy->maxOrder = _Grr_log2(size / minSize);
+  buddy->allocatedBytes = 0;
+  buddy->longest = (Grr_byte *)malloc(((size_t)2 << buddy->maxOrder) - 1);
+  if (NULL == buddy->longest) {
+    GRR_LOG_ERROR("Failed to allocate memory for buddy allocator\n");
+    return false;
+  }
+
+  // Everything is free: nodes at depth d hold order maxOrder - d
+  size_t node = 0;
+  for (Grr_u32 depth = 0; depth <= buddy->maxOrder; depth++) {
+    size_t count = (size_t)1 << depth;
+    memset(buddy->longest + node, (int)(buddy->maxOrder - depth + 1), count);
+    node += count;
+  }
+
+  return true;
+}
+
+void Grr_destroyBuddyAllocator(GrrBuddyAllocator *buddy) {
+  free(buddy->longest);
+  buddy->longest = NULL;
+}
+
+Grr_bool Grr_buddyAllocate(GrrBuddyAllocator *buddy, VkDeviceSize size,
+                           VkDeviceSize alignment, VkDeviceSize *offset) {
+  // Ranges are aligned to their size
+  VkDeviceSize rangeSize = size > alignment ? size : alignment;
+  if (rangeSize < buddy->minSize)
+    rangeSize = buddy->minSize;
+  rangeSize = _Grr_nextPowerOfTwo(rangeSize);
+  Grr_u32 order = _Grr_log2(rangeSize / buddy->minSize);
+  if (order > buddy->maxOrder || buddy->longest[0] < order + 1)
+    return false;
+
+  // Descend to a free node of the requested order, preferring the left child
+  size_t node = 0;
+  Grr_u32 nodeOrder = buddy->maxOrder;
+  while (nodeOrder != order) {
+    node = (buddy->longest[2 * node + 1] >= order + 1 ? 2 * node + 1
+                                                      : 2 * node + 2);
+    nodeOrder--;
+  }
+  buddy->longest[node] = 0;
+
+  size_t depth = buddy->maxOrder - order;
+  *offset = (VkDeviceSize)(node + 1 - ((size_t)1 << depth)) * rangeSize;
+  buddy->allocatedBytes += rangeSize;
+
+  while (node) {
+    node = (node - 1) / 2;
+    Grr_byte left = buddy->longest[2 * node + 1];
+    Grr_byte right = buddy->longest[2 * node + 2];
+    buddy->longest[node] = left > right ? left : right;
+  }
+
+  return true;
+}
+
+VkDeviceSize Grr_buddyFree(GrrBuddyAllocator *buddy, VkDeviceSize offset) {
+  // Walk up from the leaf at offset to the allocated node (the first full one,
+  // nodes below an allocation keep their free state)
+  size_t node = ((size_t)1 << buddy->maxOrder) - 1 +
+                (size_t)(offset / buddy->minSize);
+  Grr_u32 order = 0;
+  while (buddy->longest[node] != 0) {
+    if (node == 0) {
+      GRR_LOG_ERROR("Buddy free of unallocated offset %llu\n",
+                    (unsigned long long)offset);
+      return 0;
+    }
+    node = (node - 1) / 2;
+    order++;
+  }
+
+  buddy->longest[node] = (Grr_byte)(order + 1);
+  VkDeviceSize rangeSize = buddy->minSize << order;
+  buddy->allocatedBytes -= rangeSize;
+
+  // Merge with free buddies
+  while (node) {
+    node = (node - 1) / 2;
+    order++;
+    Grr_byte left = buddy->longest[2 * node + 1];
+    Grr_byte right = buddy->longest[2 * node + 2];
+    if (left == order && right == order)
+      buddy->longest[node] = (Grr_byte)(order + 1);
+    else
+      buddy->longest[node] = left > right ? left : right;
+  }
+
+  return rangeSize;
+}
+
+VkDeviceSize Grr_buddyLargestFree(const GrrBuddyAllocator *buddy) {
+  return buddy->longest[0] ? buddy->minSize << (buddy->longest[0] - 1) : 0;
+}
+
+void Grr_initializeLinearAllocator(GrrLinearAllocator *linear,
+                                   VkDeviceSize size,
+                                   VkDeviceSize granularity) {
+  linear->size = size;
+  linear->head = 0;
+  linear->allocationCount = 0;
+  linear->granularity = granularity;
+  linear->lastOptimal = false;
+}
+
+Grr_bool Grr_linearAllocate(GrrLinearAllocator *linear, VkDeviceSize size,
+                            VkDeviceSize alignment, Grr_bool optimal,
+                            VkDeviceSize *offset) {
+  VkDeviceSize start = linear->head;
+  // Start on a new page when the previous allocation is of the other kind
+  if (linear->allocationCount > 0 && linear->lastOptimal != optimal)
+    start = _Grr_alignUp(start, linear->granularity);
+  start = _Grr_alignUp(start, alignment);
+  if (start > linear->size || size > linear->size - start)
+    return false;
+
+  *offset = start;
+  linear->head = start + size;
+  linear->allocationCount++;
+  linear->lastOptimal = optimal;
+  return true;
+}
+
+void Grr_linearFree(GrrLinearAllocator *linear) {
+  if (linear->allocationCount > 0 && --linear->allocationCount == 0)
+    linear->head = 0;
+}
+
+Grr_bool _Grr_allocateDeviceMemory(VkDeviceSize size, Grr_u32 memoryTypeIndex,
+                                   VkDeviceMemory *memory, void **mapped) {
+  VkMemoryAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize = size;
+  allocInfo.memoryTypeIndex = memoryTypeIndex;
+  if (vkAllocateMemory(gpuMemoryDevice, &allocInfo, NULL, memory) !=
+      VK_SUCCESS) {
+    GRR_LOG_ERROR("Failed to allocate %llu bytes of device memory (type %u)\n",
+                  (unsigned long long)size, memoryTypeIndex);
+    return false;
+  }
+
+  *mapped = NULL;
+  if (gpuMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags &
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    if (vkMapMemory(gpuMemoryDevice, *memory, 0, VK_WHOLE_SIZE, 0, mapped) !=
+        VK_SUCCESS) {
+      GRR_LOG_ERROR("Failed to map device memory (type %u)\n",
+                    memoryTypeIndex);
+      vkFreeMemory(gpuMemoryDevice, *memory, NULL);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+GrrGpuMemoryBlock *_Grr_createGpuMemoryBlock(Grr_u32 memoryTypeIndex,
+                                             GRR_GPU_MEMORY_USAGE usage) {
+  GrrGpuMemoryType *type = &gpuMemoryTypes[memoryTypeIndex];
+  GrrGpuMemoryBlock *block =
+      (GrrGpuMemoryBlock *)calloc(1, sizeof(GrrGpuMemoryBlock));
+  if (NULL == block) {
+    GRR_LOG_ERROR("Failed to allocate memory for device memory block\n");
+    return NULL;
+  }
+
+  block->size = type->blockSize;
+  block->usage = usage;
+  if (usage == GRR_GPU_MEMORY_PERSISTENT) {
+    if (!Grr_initializeBuddyAllocator(&block->buddy, block->size,
+                                      GRR_GPU_MEMORY_MIN_SIZE)) {
+      free(block);
+      return NULL;
+    }
+  } else {
+    Grr_initializeLinearAllocator(&block->linear, block->size,
+                                  bufferImageGranularity);
+  }
+
+  if (!_Grr_allocateDeviceMemory(block->size, memoryTypeIndex, &block->memory,
+                                 &block->mapped)) {
+    Grr_destroyBuddyAllocator(&block->buddy);
+    free(block);
+    return NULL;
+  }
+
+  GRR_LOG_DEBUG("Device memory block of %llu bytes (type %u)\n",
+                (unsigned long long)block->size, memoryTypeIndex);
+  block->next = type->blocks;
+  type->blocks = block;
+  return block;
+}
+
+void _Grr_destroyGpuMemoryBlock(GrrGpuMemoryBlock *block) {
+  vkFreeMemory(gpuMemoryDevice, block->memory, NULL);
+  Grr_destroyBuddyAllocator(&block->buddy);
+  free(block);
+}
+
+void _Grr_destroyGpuMemory() {
+  GRR_LOG_INFO("Free device memory blocks\n");
+  for (Grr_u32 i = 0; i < gpuMemoryProperties.memoryTypeCount; i++) {
+    GrrGpuMemoryType *type = &gpuMemoryTypes[i];
+    if (type->dedicatedCount > 0)
+      GRR_LOG_WARNING("%u dedicated device allocations leaked (type %u)\n",
+                      type->dedicatedCount, i);
+    while (type->blocks != NULL) {
+      GrrGpuMemoryBlock *next = type->blocks->next;
+      if (type->blocks->allocationCount > 0)
+        GRR_LOG_WARNING("%u device sub-allocations leaked (type %u)\n",
+                        type->blocks->allocationCount, i);
+      _Grr_destroyGpuMemoryBlock(type->blocks);
+      type->blocks = next;
+    }
+  }
+}
+
+Grr_bool _Grr_initializeGpuMemory(VkPhysicalDevice physicalDevice,
+                                  VkDevice device) {
+  gpuMemoryDevice = device;
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &gpuMemoryProperties);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  bufferImageGranularity = properties.limits.bufferImageGranularity;
+  if (bufferImageGranularity == 0)
+    bufferImageGranularity = 1;
+
+  // Small heaps (e.g. host visible device local memory) get smaller blocks
+  for (Grr_u32 i = 0; i < gpuMemoryProperties.memoryTypeCount; i++) {
+    VkDeviceSize heapSize =
+        gpuMemoryProperties
+            .memoryHeaps[gpuMemoryProperties.memoryTypes[i].heapIndex]
+            .size;
+    VkDeviceSize blockSize = GRR_GPU_MEMORY_BLOCK_SIZE;
+    while (blockSize > heapSize / 8 && blockSize > (1 << 20))
+      blockSize >>= 1;
+    gpuMemoryTypes[i] = (GrrGpuMemoryType){0};
+    gpuMemoryTypes[i].blockSize = blockSize;
+  }
+
+  atexit(_Grr_destroyGpuMemory);
+  return true;
+}
+
+Grr_bool _Grr_allocateGpuMemory(const VkMemoryRequirements *requirements,
+                                Grr_u32 memoryTypeIndex,
+                                GRR_GPU_MEMORY_USAGE usage, Grr_bool optimal,
+                                GrrGpuAllocation *allocation) {
+  GrrGpuMemoryType *type = &gpuMemoryTypes[memoryTypeIndex];
+  VkDeviceSize size = requirements->size;
+  VkDeviceSize alignment =
+      requirements->alignment ? requirements->alignment : 1;
+
+  *allocation = (GrrGpuAllocation){0};
+  allocation->size = size;
+  allocation->memoryTypeIndex = memoryTypeIndex;
+
+  // Buddy ranges are aligned to their size: images covering whole
+  // granularity pages never share one with a buffer
+  if (usage == GRR_GPU_MEMORY_PERSISTENT && optimal) {
+    if (size < bufferImageGranularity)
+      size = bufferImageGranularity;
+    if (alignment < bufferImageGranularity)
+      alignment = bufferImageGranularity;
+  }
+
+  if (_Grr_alignUp(size, alignment) > type->blockSize / 2) {
+    if (!_Grr_allocateDeviceMemory(requirements->size, memoryTypeIndex,
+                                   &allocation->memory, &allocation->mapped))
+      return false;
+    type->dedicatedCount++;
+    type->dedicatedBytes += requirements->size;
+    return true;
+  }
+
+  VkDeviceSize offset;
+  GrrGpuMemoryBlock *block = type->blocks;
+  for (; block != NULL; block = block->next) {
+    if (block->usage != usage)
+      continue;
+    if (usage == GRR_GPU_MEMORY_PERSISTENT
+            ? Grr_buddyAllocate(&block->buddy, size, alignment, &offset)
+            : Grr_linearAllocate(&block->linear, size, alignment, optimal,
+                                 &offset))
+      break;
+  }
+
+  if (NULL == block) {
+    block = _Grr_createGpuMemoryBlock(memoryTypeIndex, usage);
+    if (NULL == block)
+      return false;
+    if (!(usage == GRR_GPU_MEMORY_PERSISTENT
+              ? Grr_buddyAllocate(&block->buddy, size, alignment, &offset)
+              : Grr_linearAllocate(&block->linear, size, alignment, optimal,
+                                   &offset))) {
+      GRR_LOG_ERROR("Failed to sub-allocate %llu bytes in a new block\n",
+                    (unsigned long long)size);
+      // New blocks are linked first
+      type->blocks = block->next;
+      _Grr_destroyGpuMemoryBlock(block);
+      return false;
+    }
+  }
+
+  block->allocationCount++;
+  block->usedBytes += requirements->size;
+  allocation->memory = block->memory;
+  allocation->offset = offset;
+  allocation->block = block;
+  if (block->mapped != NULL)
+    allocation->mapped = (Grr_byte *)block->mapped + offset;
+  return true;
+}
+
+// Returns the allocation to its block, empty blocks are kept
+void _Grr_releaseGpuMemory(GrrGpuAllocation *allocation) {
+  GrrGpuMemoryType *type = &gpuMemoryTypes[allocation->memoryTypeIndex];
+  GrrGpuMemoryBlock *block = allocation->block;
+  if (NULL == block) {
+    vkFreeMemory(gpuMemoryDevice, allocation->memory, NULL);
+    type->dedicatedCount--;
+    type->dedicatedBytes -= allocation->size;
+    *allocation = (GrrGpuAllocation){0};
+    return;
+  }
+
+  if (block->usage == GRR_GPU_MEMORY_PERSISTENT)
+    Grr_buddyFree(&block->buddy, allocation->offset);
+  else
+    Grr_linearFree(&block->linear);
+  block->allocationCount--;
+  block->usedBytes -= allocation->size;
+  *allocation = (GrrGpuAllocation){0};
+}
+
+// Empty blocks are freed unless they are the only block of their usage, to
+// avoid reallocating on the next request
+void _Grr_trimGpuMemoryType(GrrGpuMemoryType *type) {
+  Grr_u32 blockCounts[2] = {0, 0};
+  for (GrrGpuMemoryBlock *block = type->blocks; block != NULL;
+       block = block->next)
+    blockCounts[block->usage]++;
+  GrrGpuMemoryBlock **link = &type->blocks;
+  while (*link != NULL) {
+    GrrGpuMemoryBlock *block = *link;
+    if (block->allocationCount == 0 && blockCounts[block->usage] > 1) {
+      *link = block->next;
+      blockCounts[block->usage]--;
+      _Grr_destroyGpuMemoryBlock(block);
+    } else {
+      link = &block->next;
+    }
+  }
+}
+
+void _Grr_freeGpuMemory(GrrGpuAllocation *allocation) {
+  if (allocation->memory == VK_NULL_HANDLE)
+    return;
+  GrrGpuMemoryType *type = &gpuMemoryTypes[allocation->memoryTypeIndex];
+  _Grr_releaseGpuMemory(allocation);
+  _Grr_trimGpuMemoryType(type);
+}
+
+void _Grr_freeGpuMemoryBatch(GrrGpuAllocation *allocations, Grr_u32 count) {
+  Grr_bool released[VK_MAX_MEMORY_TYPES] = {false};
+  for (Grr_u32 i = 0; i < count; i++) {
+    if (allocations[i].memory == VK_NULL_HANDLE)
+      continue;
+    released[allocations[i].memoryTypeIndex] = true;
+    _Grr_releaseGpuMemory(&allocations[i]);
+  }
+  for (Grr_u32 t = 0; t < VK_MAX_MEMORY_TYPES; t++) {
+    if (released[t])
+      _Grr_trimGpuMemoryType(&gpuMemoryTypes[t]);
+  }
+}
+
+void Grr_gpuMemoryStatistics(Grr_u32 memoryTypeIndex,
+                             GrrGpuMemoryStatistics *statistics) {
+  *statistics = (GrrGpuMemoryStatistics){0};
+  VkDeviceSize freeBytes = 0;
+  for (Grr_u32 i = 0; i < gpuMemoryProperties.memoryTypeCount; i++) {
+    if (memoryTypeIndex != GRR_GPU_MEMORY_ALL_TYPES && memoryTypeIndex != i)
+      continue;
+    const GrrGpuMemoryType *type = &gpuMemoryTypes[i];
+    statistics->deviceAllocationCount += type->dedicatedCount;
+    statistics->allocationCount += type->dedicatedCount;
+    statistics->reservedBytes += type->dedicatedBytes;
+    statistics->allocatedBytes += type->dedicatedBytes;
+    statistics->usedBytes += type->dedicatedBytes;
+
+    for (const GrrGpuMemoryBlock *block = type->blocks; block != NULL;
+         block = block->next) {
+      VkDeviceSize allocated, largestFree;
+      if (block->usage == GRR_GPU_MEMORY_PERSISTENT) {
+        allocated = block->buddy.allocatedBytes;
+        largestFree = Grr_buddyLargestFree(&block->buddy);
+      } else {
+        allocated = block->linear.head;
+        largestFree = block->size - block->linear.head;
+      }
+      statistics->deviceAllocationCount++;
+      statistics->allocationCount += block->allocationCount;
+      statistics->reservedBytes += block->size;
+      statistics->allocatedBytes += allocated;
+      statistics->usedBytes += block->usedBytes;
+      if (largestFree > statistics->largestFreeBytes)
+        statistics->largestFreeBytes = largestFree;
+      freeBytes += block->size - allocated;
+    }
+  }
+
+  if (freeBytes > 0)
+    statistics->fragmentation =
+        1.0f - (Grr_f32)statistics->largestFreeBytes / (Grr_f32)freeBytes;
+}
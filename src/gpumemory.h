@@ -0,0 +1,112 @@
+#ifndef GRR_GPUMEMORY_H
+#define GRR_GPUMEMORY_H
+
+#include "logging.h"
+#include "types.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Device memory sub-allocation: memory is allocated in large blocks per memory
+// type and handed out in pieces, keeping the number of vkAllocateMemory calls
+// far below maxMemoryAllocationCount.
+// * Persistent allocations (long lived buffers and images) come from buddy
+// allocated blocks.
+// * Transient allocations (staging buffers) come from linear blocks, which
+// reset once all their allocations are freed.
+// * Requests larger than half a block get a dedicated device allocation.
+// * Host visible blocks are persistently mapped.
+// Not thread safe: resources are created and destroyed on the main thread
+
+#define GRR_GPU_MEMORY_BLOCK_SIZE (64ull << 20) // Largest block size
+#define GRR_GPU_MEMORY_MIN_SIZE 256             // Smallest buddy allocation
+#define GRR_GPU_MEMORY_ALL_TYPES VK_MAX_MEMORY_TYPES
+
+// Buddy allocator over [0, minSize << maxOrder): allocations are power of two
+// ranges aligned to their size
+typedef struct GrrBuddyAllocator {
+  VkDeviceSize minSize; // Power of two
+  Grr_u32 maxOrder;
+  // Per node of the implicit binary tree (children of n are 2n+1, 2n+2):
+  // order of the largest free range in its subtree + 1, 0 when full
+  Grr_byte *longest;
+  VkDeviceSize allocatedBytes;
+} GrrBuddyAllocator;
+
+// Bump allocator over [0, size), rewinds when its last allocation is freed
+typedef struct GrrLinearAllocator {
+  VkDeviceSize size;
+  VkDeviceSize head;
+  Grr_u32 allocationCount;
+  // Linear (buffers) and optimal (images) resources may not share a page of
+  // bufferImageGranularity bytes
+  VkDeviceSize granularity;
+  Grr_bool lastOptimal;
+} GrrLinearAllocator;
+
+// size and minSize must be powers of two
+Grr_bool Grr_initializeBuddyAllocator(GrrBuddyAllocator *buddy,
+                                      VkDeviceSize size, VkDeviceSize minSize);
+void Grr_destroyBuddyAllocator(GrrBuddyAllocator *buddy);
+// alignment must be a power of two
+Grr_bool Grr_buddyAllocate(GrrBuddyAllocator *buddy, VkDeviceSize size,
+                           VkDeviceSize alignment, VkDeviceSize *offset);
+// Returns the size of the range that was freed
+VkDeviceSize Grr_buddyFree(GrrBuddyAllocator *buddy, VkDeviceSize offset);
+VkDeviceSize Grr_buddyLargestFree(const GrrBuddyAllocator *buddy);
+
+void Grr_initializeLinearAllocator(GrrLinearAllocator *linear,
+                                   VkDeviceSize size, VkDeviceSize granularity);
+Grr_bool Grr_linearAllocate(GrrLinearAllocator *linear, VkDeviceSize size,
+                            VkDeviceSize alignment, Grr_bool optimal,
+                            VkDeviceSize *offset);
+void Grr_linearFree(GrrLinearAllocator *linear);
+
+typedef enum GRR_GPU_MEMORY_USAGE {
+  GRR_GPU_MEMORY_PERSISTENT, // Buddy allocated
+  GRR_GPU_MEMORY_TRANSIENT   // Linear allocated, free soon after use
+} GRR_GPU_MEMORY_USAGE;
+
+typedef struct GrrGpuMemoryBlock GrrGpuMemoryBlock;
+
+typedef struct GrrGpuAllocation {
+  VkDeviceMemory memory;
+  VkDeviceSize offset;
+  VkDeviceSize size;
+  void *mapped; // Host address of offset for host visible memory, else NULL
+  Grr_u32 memoryTypeIndex;
+  GrrGpuMemoryBlock *block; // NULL for dedicated allocations
+} GrrGpuAllocation;
+
+typedef struct GrrGpuMemoryStatistics {
+  Grr_u32 deviceAllocationCount; // Live vkAllocateMemory allocations
+  Grr_u32 allocationCount;       // Live GrrGpuAllocations
+  VkDeviceSize reservedBytes;    // Size of all device allocations
+  VkDeviceSize allocatedBytes;   // Reserved bytes handed out, with padding
+  VkDeviceSize usedBytes;        // Bytes requested by live allocations
+  VkDeviceSize largestFreeBytes; // Largest free range in a block
+  // 1 - largest free range / free bytes of blocks: 0 when the free memory is
+  // a single range, close to 1 when it is scattered in small ranges
+  Grr_f32 fragmentation;
+} GrrGpuMemoryStatistics;
+
+// Called once the logical device exists, blocks are freed at exit
+Grr_bool _Grr_initializeGpuMemory(VkPhysicalDevice physicalDevice,
+                                  VkDevice device);
+
+// requirements from vkGet{Buffer,Image}MemoryRequirements, memoryTypeIndex
+// from _Grr_findMemoryType. optimal is true for optimal tiling images
+Grr_bool _Grr_allocateGpuMemory(const VkMemoryRequirements *requirements,
+                                Grr_u32 memoryTypeIndex,
+                                GRR_GPU_MEMORY_USAGE usage, Grr_bool optimal,
+                                GrrGpuAllocation *allocation);
+void _Grr_freeGpuMemory(GrrGpuAllocation *allocation);
+// Frees count allocations, then the blocks they left empty (in one pass per
+// memory type instead of one per allocation)
+void _Grr_freeGpuMemoryBatch(GrrGpuAllocation *allocations, Grr_u32 count);
+
+// Statistics of one memory type or of all of them (GRR_GPU_MEMORY_ALL_TYPES)
+void Grr_gpuMemoryStatistics(Grr_u32 memoryTypeIndex,
+                             GrrGpuMemoryStatistics *statistics);
+
+#endif
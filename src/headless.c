@@ -0,0 +1,162 @@
+#include "headless.h"
+#include "vulkan.h"
+
+VkImage offscreenImages[GRR_MAX_FRAMES_IN_FLIGHT];
+GrrGpuAllocation offscreenMemory[GRR_MAX_FRAMES_IN_FLIGHT];
+Grr_u32 offscreenCount = 0;
+Grr_u32 offscreenWidth = 0;
+Grr_u32 offscreenHeight = 0;
+
+// Per frame in flight, command buffers are recorded once and freed with the
+// command pool
+VkBuffer readbackTargets[GRR_MAX_FRAMES_IN_FLIGHT]; // Host visible
+GrrGpuAllocation readbackTargetMemory[GRR_MAX_FRAMES_IN_FLIGHT];
+VkCommandBuffer readbackCommandBuffers[GRR_MAX_FRAMES_IN_FLIGHT];
+Grr_bool readbackRequested = false;
+Grr_u32 readbackSlot = 0;   // Frame in flight of the last readback
+Grr_u64 readbackNumber = 0; // Its frame number, 0 before the first one
+
+void _Grr_destroyOffscreenTargets() {
+  GRR_LOG_INFO("Free offscreen targets\n");
+  for (Grr_u32 i = 0; i < offscreenCount; i++) {
+    _Grr_deferImage(offscreenImages[i], &offscreenMemory[i]);
+    _Grr_deferBuffer(readbackTargets[i], &readbackTargetMemory[i]);
+  }
+  offscreenCount = 0;
+  readbackNumber = 0;
+}
+
+Grr_bool _Grr_createOffscreenTargets(Grr_u32 width, Grr_u32 height,
+                                     Grr_u32 count, VkImage *images) {
+  if (count > GRR_MAX_FRAMES_IN_FLIGHT) {
+    GRR_LOG_ERROR("Too many offscreen targets (%u)\n", count);
+    return false;
+  }
+  offscreenWidth = width;
+  offscreenHeight = height;
+  VkDeviceSize size = (VkDeviceSize)width * height * 4;
+  for (Grr_u32 i = 0; i < count; i++) {
+    if (!_Grr_createImage(width, height, 1, GRR_HEADLESS_FORMAT,
+                          VK_IMAGE_TILING_OPTIMAL,
+                          VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                              VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                          &offscreenImages[i], &offscreenMemory[i])) {
+      _Grr_destroyOffscreenTargets();
+      return false;
+    }
+    if (!_Grr_createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                           GRR_GPU_MEMORY_PERSISTENT, &readbackTargets[i],
+                           &readbackTargetMemory[i])) {
+      vkDestroyImage(device, offscreenImages[i], NULL);
+      _Grr_freeGpuMemory(&offscreenMemory[i]);
+      _Grr_destroyOffscreenTargets();
+      return false;
+    }
+    images[i] = offscreenImages[i];
+    readbackCommandBuffers[i] = VK_NULL_HANDLE;
+    offscreenCount++;
+  }
+  return true;
+}
+
+// Copy of the image of frame into its readback buffer, after the frame's render
+// graph that left it in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+Grr_bool _Grr_recordReadback(Grr_u32 frame) {
+  VkCommandBufferAllocateInfo allocateInfo = {0};
+  allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocateInfo.commandPool = commandPool;
+  allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocateInfo.commandBufferCount = 1;
+  VkCommandBuffer commandBuffer;
+  if (vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) !=
+      VK_SUCCESS)
+    return false;
+
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+  VkImageMemoryBarrier imageBarrier = {0};
+  imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  imageBarrier.image = offscreenImages[frame];
+  imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  imageBarrier.subresourceRange.levelCount = 1;
+  imageBarrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(commandBuffer,
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                       &imageBarrier);
+
+  VkBufferImageCopy region = {0};
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.layerCount = 1;
+  region.imageExtent.width = offscreenWidth;
+  region.imageExtent.height = offscreenHeight;
+  region.imageExtent.depth = 1;
+  vkCmdCopyImageToBuffer(commandBuffer, offscreenImages[frame],
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         readbackTargets[frame], 1, &region);
+
+  // Host reads once the frame is complete
+  VkBufferMemoryBarrier bufferBarrier = {0};
+  bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.buffer = readbackTargets[frame];
+  bufferBarrier.size = VK_WHOLE_SIZE;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1,
+                       &bufferBarrier, 0, NULL);
+
+  if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    return false;
+  }
+  readbackCommandBuffers[frame] = commandBuffer;
+  return true;
+}
+
+void Grr_requestReadback() { readbackRequested = true; }
+
+VkCommandBuffer _Grr_readbackCommandBuffer(Grr_u32 frame,
+                                           Grr_u64 frameNumber) {
+  if (!readbackRequested || frame >= offscreenCount)
+    return VK_NULL_HANDLE;
+  if (readbackCommandBuffers[frame] == VK_NULL_HANDLE &&
+      !_Grr_recordReadback(frame)) {
+    GRR_LOG_ERROR("Failed to record readback commands\n");
+    return VK_NULL_HANDLE;
+  }
+  readbackRequested = false;
+  readbackSlot = frame;
+  readbackNumber = frameNumber;
+  return readbackCommandBuffers[frame];
+}
+
+Grr_bool Grr_readback(GrrReadback *readback, Grr_bool wait) {
+  if (readbackNumber == 0)
+    return false;
+
+  if (wait)
+    Grr_waitForFrame(readbackNumber);
+  else if (Grr_completedFrame() < readbackNumber)
+    return false;
+
+  readback->pixels =
+      (const Grr_byte *)readbackTargetMemory[readbackSlot].mapped;
+  readback->width = offscreenWidth;
+  readback->height = offscreenHeight;
+  readback->frame = readbackNumber;
+  return true;
+}
@@ -0,0 +1,47 @@
+#ifndef GRR_HEADLESS_H
+#define GRR_HEADLESS_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "types.h"
+#include <stdlib.h>
+#include <vulkan/vulkan.h>
+
+// Headless rendering: frames are drawn into offscreen color images, one per
+// frame in flight, in place of swapchain images, so neither a window nor a
+// surface is needed (machines without a display, software rasterizers such
+// as lavapipe). A frame can be read back: a command buffer submitted after
+// the frame's own copies its image into a host visible buffer, and the pixels
+// are available once the frame is complete, without stalling the frames drawn
+// meanwhile
+
+#define GRR_HEADLESS_FORMAT VK_FORMAT_R8G8B8A8_SRGB
+
+typedef struct GrrReadback {
+  const Grr_byte *pixels; // RGBA8 rows of width texels, tightly packed
+  Grr_u32 width;
+  Grr_u32 height;
+  Grr_u64 frame; // Number of the frame drawn into it
+} GrrReadback;
+
+// count images of GRR_HEADLESS_FORMAT (written into images) with a readback
+// buffer each. Images are left in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL by the
+// frame's render graph
+Grr_bool _Grr_createOffscreenTargets(Grr_u32 width, Grr_u32 height,
+                                     Grr_u32 count, VkImage *images);
+void _Grr_destroyOffscreenTargets();
+
+// The next frame drawn is read back
+void Grr_requestReadback();
+
+// Pixels of the last frame read back, valid until another frame is read back
+// in the same frame in flight. False when no frame was read back yet and,
+// unless wait is set, while the frame is still in flight
+Grr_bool Grr_readback(GrrReadback *readback, Grr_bool wait);
+
+// Command buffer reading back the image of frame (frame in flight), drawn as
+// frame number frameNumber, or VK_NULL_HANDLE when no readback was requested.
+// Submitted after the frame's commands, in the same submission
+VkCommandBuffer _Grr_readbackCommandBuffer(Grr_u32 frame, Grr_u64 frameNumber);
+
+#endif
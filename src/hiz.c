@@ -0,0 +1,423 @@
+#include "hiz.h"
+#include "vulkan.h"
+
+VkShaderModule hiZShaderModule;
+VkDescriptorSetLayout hiZBuildSetLayout; // Source sampler, destination image
+VkDescriptorSetLayout hiZSetLayout;      // Pyramid sampler for culling
+VkPipelineLayout hiZPipelineLayout;
+VkPipeline hiZPipeline;
+VkSampler hiZSampler;
+VkDescriptorPool hiZPool; // Sets of the pyramids still in use by frames
+
+VkImage hiZImage = VK_NULL_HANDLE;
+GrrGpuAllocation hiZMemory;
+VkImageView hiZView;                          // Every level, for sampling
+VkImageView hiZLevelViews[GRR_HIZ_MAX_LEVELS]; // Storage image per level
+VkDescriptorSet hiZBuildSets[GRR_HIZ_MAX_LEVELS];
+VkDescriptorSet hiZSet;
+Grr_u32 hiZLevelCount = 0;
+Grr_u32 hiZWidth = 0;
+Grr_u32 hiZHeight = 0;
+
+Grr_u32 Grr_hiZPyramidSize(Grr_u32 depthWidth, Grr_u32 depthHeight,
+                           Grr_u32 *width, Grr_u32 *height) {
+  *width = 0;
+  *height = 0;
+  if (depthWidth == 0 || depthHeight == 0)
+    return 0;
+
+  // Largest powers of two not above the attachment size
+  *width = 1;
+  while (*width <= depthWidth / 2)
+    *width *= 2;
+  *height = 1;
+  while (*height <= depthHeight / 2)
+    *height *= 2;
+
+  Grr_u32 levelCount = 1;
+  for (Grr_u32 size = *width > *height ? *width : *height; size > 1;
+       size /= 2)
+    levelCount++;
+  return levelCount < GRR_HIZ_MAX_LEVELS ? levelCount : GRR_HIZ_MAX_LEVELS;
+}
+
+void _Grr_destroyHiZ() {
+  GRR_LOG_INFO("Free Hi-Z pipeline\n");
+  vkDestroyPipeline(device, hiZPipeline, NULL);
+  vkDestroyPipelineLayout(device, hiZPipelineLayout, NULL);
+  vkDestroyShaderModule(device, hiZShaderModule, NULL);
+  // After the sets of the last pyramids
+  _Grr_deferDescriptorPool(hiZPool);
+  _Grr_deferSampler(hiZSampler);
+  vkDestroyDescriptorSetLayout(device, hiZSetLayout, NULL);
+  vkDestroyDescriptorSetLayout(device, hiZBuildSetLayout, NULL);
+}
+
+Grr_bool _Grr_createHiZSetLayouts() {
+  VkDescriptorSetLayoutBinding bindings[2] = {{0}};
+  bindings[0].binding = 0;
+  bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  bindings[0].descriptorCount = 1;
+  bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  bindings[1].binding = 1;
+  bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  bindings[1].descriptorCount = 1;
+  bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo = {0};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.bindingCount = 2;
+  layoutInfo.pBindings = bindings;
+  if (vkCreateDescriptorSetLayout(device, &layoutInfo, NULL,
+                                  &hiZBuildSetLayout) != VK_SUCCESS)
+    return false;
+
+  layoutInfo.bindingCount = 1;
+  if (vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &hiZSetLayout) !=
+      VK_SUCCESS) {
+    vkDestroyDescriptorSetLayout(device, hiZBuildSetLayout, NULL);
+    return false;
+  }
+  return true;
+}
+
+Grr_bool _Grr_createHiZPipeline(VkPipelineCache cache) {
+  size_t nBytes;
+  Grr_byte *shaderBytes = Grr_readBytesFromFile("src/shaders/hiz.spv", &nBytes);
+  if (NULL == shaderBytes)
+    return false;
+  Grr_bool created =
+      _Grr_createShaderModule(shaderBytes, nBytes, &hiZShaderModule);
+  free(shaderBytes);
+  if (!created)
+    return false;
+
+  VkPipelineLayoutCreateInfo layoutInfo = {0};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  layoutInfo.setLayoutCount = 1;
+  layoutInfo.pSetLayouts = &hiZBuildSetLayout;
+  if (vkCreatePipelineLayout(device, &layoutInfo, NULL, &hiZPipelineLayout) !=
+      VK_SUCCESS) {
+    vkDestroyShaderModule(device, hiZShaderModule, NULL);
+    return false;
+  }
+
+  VkComputePipelineCreateInfo pipelineInfo = {0};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module = hiZShaderModule;
+  pipelineInfo.stage.pName = "main";
+  pipelineInfo.layout = hiZPipelineLayout;
+  if (vkCreateComputePipelines(device, cache, 1, &pipelineInfo, NULL,
+                               &hiZPipeline) != VK_SUCCESS) {
+    vkDestroyPipelineLayout(device, hiZPipelineLayout, NULL);
+    vkDestroyShaderModule(device, hiZShaderModule, NULL);
+    return false;
+  }
+  return true;
+}
+
+Grr_bool _Grr_initializeHiZ(VkFormat depthFormat, VkPipelineCache cache) {
+  VkFormatProperties depthProperties;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, depthFormat,
+                                      &depthProperties);
+  VkFormatProperties pyramidProperties;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R32_SFLOAT,
+                                      &pyramidProperties);
+  if (!(depthProperties.optimalTilingFeatures &
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) ||
+      !(pyramidProperties.optimalTilingFeatures &
+        VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+    GRR_LOG_WARNING("Depth format can not be sampled for Hi-Z culling\n");
+    return false;
+  }
+
+  if (!_Grr_createHiZSetLayouts())
+    return false;
+
+  // Texels are fetched, never filtered
+  VkSamplerCreateInfo samplerInfo = {0};
+  samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  samplerInfo.magFilter = VK_FILTER_NEAREST;
+  samplerInfo.minFilter = VK_FILTER_NEAREST;
+  samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+  if (vkCreateSampler(device, &samplerInfo, NULL, &hiZSampler) != VK_SUCCESS) {
+    vkDestroyDescriptorSetLayout(device, hiZSetLayout, NULL);
+    vkDestroyDescriptorSetLayout(device, hiZBuildSetLayout, NULL);
+    return false;
+  }
+
+  // One build set per level and the culling set, per pyramid: the current one
+  // and those retired by swapchain recreations while frames still use them
+  VkDescriptorPoolSize poolSizes[2] = {{0}};
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  poolSizes[0].descriptorCount =
+      (GRR_HIZ_MAX_LEVELS + 1) * GRR_HIZ_MAX_PYRAMIDS;
+  poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  poolSizes[1].descriptorCount = GRR_HIZ_MAX_LEVELS * GRR_HIZ_MAX_PYRAMIDS;
+  VkDescriptorPoolCreateInfo poolInfo = {0};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+  poolInfo.maxSets = (GRR_HIZ_MAX_LEVELS + 1) * GRR_HIZ_MAX_PYRAMIDS;
+  poolInfo.poolSizeCount = 2;
+  poolInfo.pPoolSizes = poolSizes;
+  if (vkCreateDescriptorPool(device, &poolInfo, NULL, &hiZPool) !=
+      VK_SUCCESS) {
+    vkDestroySampler(device, hiZSampler, NULL);
+    vkDestroyDescriptorSetLayout(device, hiZSetLayout, NULL);
+    vkDestroyDescriptorSetLayout(device, hiZBuildSetLayout, NULL);
+    return false;
+  }
+
+  if (!_Grr_createHiZPipeline(cache)) {
+    vkDestroyDescriptorPool(device, hiZPool, NULL);
+    vkDestroySampler(device, hiZSampler, NULL);
+    vkDestroyDescriptorSetLayout(device, hiZSetLayout, NULL);
+    vkDestroyDescriptorSetLayout(device, hiZBuildSetLayout, NULL);
+    return false;
+  }
+
+  atexit(_Grr_destroyHiZ);
+  return true;
+}
+
+VkDescriptorSetLayout _Grr_hiZSetLayout() { return hiZSetLayout; }
+
+VkDescriptorSet _Grr_hiZSet() { return hiZSet; }
+
+void _Grr_destroyHiZPyramid() {
+  if (hiZImage == VK_NULL_HANDLE)
+    return;
+  if (hiZSet != VK_NULL_HANDLE) {
+    for (Grr_u32 i = 0; i < hiZLevelCount; i++)
+      _Grr_deferDescriptorSet(hiZPool, hiZBuildSets[i]);
+    _Grr_deferDescriptorSet(hiZPool, hiZSet);
+  }
+  for (Grr_u32 i = 0; i < hiZLevelCount; i++)
+    _Grr_deferImageView(hiZLevelViews[i]);
+  _Grr_deferImageView(hiZView);
+  _Grr_deferImage(hiZImage, &hiZMemory);
+  hiZImage = VK_NULL_HANDLE;
+  hiZSet = VK_NULL_HANDLE;
+  hiZLevelCount = 0;
+}
+
+Grr_bool _Grr_createHiZView(Grr_u32 baseLevel, Grr_u32 levelCount,
+                            VkImageView *view) {
+  VkImageViewCreateInfo viewInfo = {0};
+  viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  viewInfo.image = hiZImage;
+  viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  viewInfo.format = VK_FORMAT_R32_SFLOAT;
+  viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  viewInfo.subresourceRange.baseMipLevel = baseLevel;
+  viewInfo.subresourceRange.levelCount = levelCount;
+  viewInfo.subresourceRange.baseArrayLayer = 0;
+  viewInfo.subresourceRange.layerCount = 1;
+  return vkCreateImageView(device, &viewInfo, NULL, view) == VK_SUCCESS;
+}
+
+// Level 0 reads the depth attachment, the others the level above
+void _Grr_writeHiZSets(VkImageView depthView) {
+  VkDescriptorImageInfo imageInfos[2 * GRR_HIZ_MAX_LEVELS + 1] = {{0}};
+  VkWriteDescriptorSet writes[2 * GRR_HIZ_MAX_LEVELS + 1] = {{0}};
+  Grr_u32 writeCount = 0;
+  for (Grr_u32 level = 0; level < hiZLevelCount; level++) {
+    VkDescriptorImageInfo *source = &imageInfos[writeCount];
+    source->sampler = hiZSampler;
+    source->imageView = level == 0 ? depthView : hiZLevelViews[level - 1];
+    source->imageLayout = level == 0
+                              ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                              : VK_IMAGE_LAYOUT_GENERAL;
+    VkDescriptorImageInfo *destination = &imageInfos[writeCount + 1];
+    destination->imageView = hiZLevelViews[level];
+    destination->imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    for (Grr_u32 binding = 0; binding < 2; binding++) {
+      VkWriteDescriptorSet *write = &writes[writeCount];
+      write->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      write->dstSet = hiZBuildSets[level];
+      write->dstBinding = binding;
+      write->descriptorType = binding == 0
+                                  ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+                                  : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+      write->descriptorCount = 1;
+      write->pImageInfo = &imageInfos[writeCount];
+      writeCount++;
+    }
+  }
+
+  VkDescriptorImageInfo *pyramid = &imageInfos[writeCount];
+  pyramid->sampler = hiZSampler;
+  pyramid->imageView = hiZView;
+  pyramid->imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  writes[writeCount].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  writes[writeCount].dstSet = hiZSet;
+  writes[writeCount].dstBinding = 0;
+  writes[writeCount].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  writes[writeCount].descriptorCount = 1;
+  writes[writeCount].pImageInfo = pyramid;
+  writeCount++;
+
+  vkUpdateDescriptorSets(device, writeCount, writes, 0, NULL);
+}
+
+// Moves the pyramid to VK_IMAGE_LAYOUT_GENERAL, cleared to the far depth
+Grr_bool _Grr_clearHiZPyramid() {
+  VkCommandBufferAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  VkCommandBuffer commandBuffer;
+  if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) !=
+      VK_SUCCESS)
+    return false;
+
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+  VkImageMemoryBarrier barrier = {0};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = hiZImage;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = hiZLevelCount;
+  barrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                       &barrier);
+
+  VkClearColorValue far = {{1.0f, 1.0f, 1.0f, 1.0f}};
+  vkCmdClearColorImage(commandBuffer, hiZImage, VK_IMAGE_LAYOUT_GENERAL, &far,
+                       1, &barrier.subresourceRange);
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0,
+                       NULL, 1, &barrier);
+  vkEndCommandBuffer(commandBuffer);
+
+  VkSubmitInfo submitInfo = {0};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+  // Submitted ahead of the next frame, whose culling the barrier covers
+  Grr_bool submitted =
+      _Grr_submit(GRR_QUEUE_GRAPHICS, &submitInfo, NULL, 0) != 0;
+  _Grr_deferCommandBuffer(commandPool, commandBuffer);
+  return submitted;
+}
+
+Grr_bool _Grr_createHiZPyramid(VkImageView depthView, Grr_u32 width,
+                               Grr_u32 height) {
+  hiZLevelCount = Grr_hiZPyramidSize(width, height, &hiZWidth, &hiZHeight);
+  if (hiZLevelCount == 0)
+    return false;
+  if (!_Grr_createImage(hiZWidth, hiZHeight, hiZLevelCount,
+                        VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_STORAGE_BIT |
+                            VK_IMAGE_USAGE_SAMPLED_BIT |
+                            VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &hiZImage,
+                        &hiZMemory)) {
+    hiZImage = VK_NULL_HANDLE;
+    hiZLevelCount = 0;
+    return false;
+  }
+  // Views created so far are destroyed with the pyramid
+  Grr_u32 levelCount = hiZLevelCount;
+  hiZLevelCount = 0;
+  if (!_Grr_createHiZView(0, levelCount, &hiZView)) {
+    vkDestroyImage(device, hiZImage, NULL);
+    _Grr_freeGpuMemory(&hiZMemory);
+    hiZImage = VK_NULL_HANDLE;
+    return false;
+  }
+  for (; hiZLevelCount < levelCount; hiZLevelCount++) {
+    if (!_Grr_createHiZView(hiZLevelCount, 1,
+                            &hiZLevelViews[hiZLevelCount])) {
+      _Grr_destroyHiZPyramid();
+      return false;
+    }
+  }
+
+  VkDescriptorSetLayout setLayouts[GRR_HIZ_MAX_LEVELS + 1];
+  for (Grr_u32 i = 0; i < hiZLevelCount; i++)
+    setLayouts[i] = hiZBuildSetLayout;
+  setLayouts[hiZLevelCount] = hiZSetLayout;
+  VkDescriptorSet sets[GRR_HIZ_MAX_LEVELS + 1];
+  VkDescriptorSetAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = hiZPool;
+  allocInfo.descriptorSetCount = hiZLevelCount + 1;
+  allocInfo.pSetLayouts = setLayouts;
+  if (vkAllocateDescriptorSets(device, &allocInfo, sets) != VK_SUCCESS) {
+    _Grr_destroyHiZPyramid();
+    return false;
+  }
+  for (Grr_u32 i = 0; i < hiZLevelCount; i++)
+    hiZBuildSets[i] = sets[i];
+  hiZSet = sets[hiZLevelCount];
+  _Grr_writeHiZSets(depthView);
+
+  if (!_Grr_clearHiZPyramid()) {
+    _Grr_destroyHiZPyramid();
+    return false;
+  }
+
+  GRR_LOG_DEBUG("Hi-Z pyramid %ux%u, %u levels\n", hiZWidth, hiZHeight,
+                hiZLevelCount);
+  return true;
+}
+
+void _Grr_recordHiZ(VkCommandBuffer commandBuffer) {
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    hiZPipeline);
+
+  // Each level waits for the one above
+  VkImageMemoryBarrier levelBarrier = {0};
+  levelBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  levelBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+  levelBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+  levelBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  levelBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  levelBarrier.image = hiZImage;
+  levelBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  levelBarrier.subresourceRange.levelCount = 1;
+  levelBarrier.subresourceRange.layerCount = 1;
+  for (Grr_u32 level = 0; level < hiZLevelCount; level++) {
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            hiZPipelineLayout, 0, 1, &hiZBuildSets[level], 0,
+                            NULL);
+    Grr_u32 width = hiZWidth >> level > 0 ? hiZWidth >> level : 1;
+    Grr_u32 height = hiZHeight >> level > 0 ? hiZHeight >> level : 1;
+    vkCmdDispatch(commandBuffer,
+                  (width + GRR_HIZ_GROUP_SIZE - 1) / GRR_HIZ_GROUP_SIZE,
+                  (height + GRR_HIZ_GROUP_SIZE - 1) / GRR_HIZ_GROUP_SIZE, 1);
+
+    levelBarrier.subresourceRange.baseMipLevel = level;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0,
+                         NULL, 1, &levelBarrier);
+  }
+}
+
+VkImage _Grr_hiZImage() { return hiZImage; }
@@ -0,0 +1,57 @@
+#ifndef GRR_HIZ_H
+#define GRR_HIZ_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "types.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <vulkan/vulkan.h>
+
+// Hierarchical depth (Hi-Z) pyramid for occlusion culling: a mip chain of the
+// depth attachment where each texel holds the farthest depth of the area it
+// covers, built by compute. Level 0 is the largest power of two size that fits
+// in the attachment, so every following level halves it exactly. A bounding
+// volume whose nearest depth is farther than the pyramid over its screen
+// rectangle (read at the level where it spans at most 2x2 texels) is hidden.
+// The pyramid stays in VK_IMAGE_LAYOUT_GENERAL: written as storage image
+// levels and sampled by culling
+
+#define GRR_HIZ_GROUP_SIZE 8 // local_size_x and local_size_y of hiz.comp
+#define GRR_HIZ_MAX_LEVELS 16
+// The current pyramid and those retired while frames in flight use them
+#define GRR_HIZ_MAX_PYRAMIDS (GRR_MAX_FRAMES_IN_FLIGHT + 1)
+
+// Size of level 0 of the pyramid of a depthWidth x depthHeight attachment,
+// returns the number of levels (0 for an empty attachment)
+Grr_u32 Grr_hiZPyramidSize(Grr_u32 depthWidth, Grr_u32 depthHeight,
+                           Grr_u32 *width, Grr_u32 *height);
+
+// Called once the logical device exists. Fails when depthFormat can not be
+// sampled by compute shaders
+Grr_bool _Grr_initializeHiZ(VkFormat depthFormat, VkPipelineCache cache);
+
+// Set of the pyramid for culling shaders: a sampler2D at binding 0 (texelFetch
+// with explicit levels)
+VkDescriptorSetLayout _Grr_hiZSetLayout();
+VkDescriptorSet _Grr_hiZSet();
+
+// With the depth attachment (created with VK_IMAGE_USAGE_SAMPLED_BIT,
+// depthView has the depth aspect only) and recreated with it. The pyramid
+// starts at the far depth: nothing is occluded until it is first built, the
+// clear is submitted to the graphics queue ahead of the next frame
+Grr_bool _Grr_createHiZPyramid(VkImageView depthView, Grr_u32 width,
+                               Grr_u32 height);
+// Destroyed once the frames in flight that use it are complete
+void _Grr_destroyHiZPyramid();
+
+// Builds the pyramid from the depth attachment, in a render graph pass that
+// reads the attachment in VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL and
+// writes the pyramid from compute shaders: only the levels are synchronized
+// here
+void _Grr_recordHiZ(VkCommandBuffer commandBuffer);
+
+// Pyramid image, VK_NULL_HANDLE before it is created
+VkImage _Grr_hiZImage();
+
+#endif
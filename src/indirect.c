@@ -0,0 +1,353 @@
+#include "indirect.h"
+#include "vulkan.h"
+
+VkShaderModule cullShaderModule;
+VkPipelineLayout cullPipelineLayout;
+VkPipeline cullPipeline;
+
+Grr_bool compactIndirectDraws = false; // VK_KHR_draw_indirect_count
+PFN_vkCmdDrawIndexedIndirectCountKHR fpCmdDrawIndexedIndirectCountKHR = NULL;
+Grr_u32 maxDrawIndirectCount = 1;
+
+VkBuffer gpuObjectBuffer = VK_NULL_HANDLE;
+GrrGpuAllocation gpuObjectMemory;
+Grr_u32 gpuObjectBufferId = GRR_BINDLESS_INVALID;
+Grr_u32 gpuObjectCount = 0;
+Grr_u32 gpuObjectCapacity = 0;
+
+// Visibility of the objects, written by both culling phases of every frame
+VkBuffer visibilityBuffer = VK_NULL_HANDLE;
+GrrGpuAllocation visibilityMemory;
+Grr_u32 visibilityBufferId = GRR_BINDLESS_INVALID;
+Grr_u32 *gpuObjectVisibility = NULL; // Copy of the last completed frame's
+
+// One per frame in flight: culling of a frame never writes commands the
+// previous frame may still be drawing, nor visibility it is reading back
+VkBuffer indirectBuffers[GRR_MAX_FRAMES_IN_FLIGHT];
+GrrGpuAllocation indirectMemory[GRR_MAX_FRAMES_IN_FLIGHT];
+Grr_u32 indirectBufferIds[GRR_MAX_FRAMES_IN_FLIGHT];
+VkBuffer readbackBuffers[GRR_MAX_FRAMES_IN_FLIGHT]; // Host visible
+GrrGpuAllocation readbackMemory[GRR_MAX_FRAMES_IN_FLIGHT];
+Grr_bool readbackRecorded[GRR_MAX_FRAMES_IN_FLIGHT];
+Grr_u32 indirectBufferCount = 0;
+
+// Destroyed once the frames in flight that use them are complete
+void _Grr_destroyGpuObjectBuffers() {
+  for (Grr_u32 i = 0; i < indirectBufferCount; i++) {
+    Grr_releaseStorageBuffer(indirectBufferIds[i]);
+    _Grr_deferBuffer(indirectBuffers[i], &indirectMemory[i]);
+    _Grr_deferBuffer(readbackBuffers[i], &readbackMemory[i]);
+  }
+  indirectBufferCount = 0;
+  if (visibilityBuffer != VK_NULL_HANDLE) {
+    Grr_releaseStorageBuffer(visibilityBufferId);
+    _Grr_deferBuffer(visibilityBuffer, &visibilityMemory);
+  }
+  visibilityBuffer = VK_NULL_HANDLE;
+  visibilityBufferId = GRR_BINDLESS_INVALID;
+  free(gpuObjectVisibility);
+  gpuObjectVisibility = NULL;
+  if (gpuObjectBuffer != VK_NULL_HANDLE) {
+    Grr_releaseStorageBuffer(gpuObjectBufferId);
+    _Grr_deferBuffer(gpuObjectBuffer, &gpuObjectMemory);
+  }
+  gpuObjectBuffer = VK_NULL_HANDLE;
+  gpuObjectBufferId = GRR_BINDLESS_INVALID;
+  gpuObjectCapacity = 0;
+}
+
+void _Grr_destroyIndirectDraws() {
+  GRR_LOG_INFO("Free indirect draws\n");
+  _Grr_destroyGpuObjectBuffers();
+  vkDestroyPipeline(device, cullPipeline, NULL);
+  vkDestroyPipelineLayout(device, cullPipelineLayout, NULL);
+  vkDestroyShaderModule(device, cullShaderModule, NULL);
+}
+
+Grr_bool _Grr_initializeIndirectDraws(VkDescriptorSetLayout frameSetLayout,
+                                      VkPipelineCache cache,
+                                      Grr_bool drawIndirectCount) {
+  if (drawIndirectCount) {
+    fpCmdDrawIndexedIndirectCountKHR =
+        (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(
+            device, "vkCmdDrawIndexedIndirectCountKHR");
+  }
+  compactIndirectDraws = fpCmdDrawIndexedIndirectCountKHR != NULL;
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  maxDrawIndirectCount = properties.limits.maxDrawIndirectCount;
+
+  size_t nBytes;
+  Grr_byte *shaderBytes =
+      Grr_readBytesFromFile("src/shaders/cull.spv", &nBytes);
+  if (NULL == shaderBytes)
+    return false;
+  Grr_bool created =
+      _Grr_createShaderModule(shaderBytes, nBytes, &cullShaderModule);
+  free(shaderBytes);
+  if (!created)
+    return false;
+
+  // Same sets as the graphics pipeline: frame uniforms and bindless buffers,
+  // then the Hi-Z pyramid
+  VkDescriptorSetLayout setLayouts[] = {
+      frameSetLayout, Grr_bindlessSetLayout(), _Grr_hiZSetLayout()};
+  VkPushConstantRange pushConstantRange = {0};
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(GrrCullConstants);
+
+  VkPipelineLayoutCreateInfo layoutInfo = {0};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  layoutInfo.setLayoutCount = sizeof(setLayouts) / sizeof(setLayouts[0]);
+  layoutInfo.pSetLayouts = setLayouts;
+  layoutInfo.pushConstantRangeCount = 1;
+  layoutInfo.pPushConstantRanges = &pushConstantRange;
+  if (vkCreatePipelineLayout(device, &layoutInfo, NULL, &cullPipelineLayout) !=
+      VK_SUCCESS) {
+    vkDestroyShaderModule(device, cullShaderModule, NULL);
+    return false;
+  }
+
+  VkComputePipelineCreateInfo pipelineInfo = {0};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module = cullShaderModule;
+  pipelineInfo.stage.pName = "main";
+  pipelineInfo.layout = cullPipelineLayout;
+  if (vkCreateComputePipelines(device, cache, 1, &pipelineInfo, NULL,
+                               &cullPipeline) != VK_SUCCESS) {
+    vkDestroyPipelineLayout(device, cullPipelineLayout, NULL);
+    vkDestroyShaderModule(device, cullShaderModule, NULL);
+    return false;
+  }
+
+  GRR_LOG_DEBUG("Indirect draws %s\n",
+                compactIndirectDraws ? "compacted with a draw count"
+                                     : "with one command per object");
+  atexit(_Grr_destroyIndirectDraws);
+  return true;
+}
+
+Grr_bool _Grr_createGpuObjectBuffers(Grr_u32 capacity) {
+  // Read by culling on the compute queue and by the vertex shaders
+  if (!_Grr_createSharedBuffer(sizeof(GrrGpuObject) * capacity,
+                               VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               GRR_GPU_MEMORY_PERSISTENT, &gpuObjectBuffer,
+                               &gpuObjectMemory)) {
+    gpuObjectBuffer = VK_NULL_HANDLE;
+    return false;
+  }
+  gpuObjectBufferId =
+      Grr_registerStorageBuffer(gpuObjectBuffer, 0, VK_WHOLE_SIZE);
+
+  VkDeviceSize visibilitySize = sizeof(Grr_u32) * (VkDeviceSize)capacity;
+  gpuObjectVisibility = (Grr_u32 *)malloc(visibilitySize);
+  if (NULL == gpuObjectVisibility ||
+      !_Grr_createBuffer(visibilitySize,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         GRR_GPU_MEMORY_PERSISTENT, &visibilityBuffer,
+                         &visibilityMemory)) {
+    visibilityBuffer = VK_NULL_HANDLE;
+    _Grr_destroyGpuObjectBuffers();
+    return false;
+  }
+  visibilityBufferId =
+      Grr_registerStorageBuffer(visibilityBuffer, 0, VK_WHOLE_SIZE);
+
+  // Commands of the early phase, then of the late one
+  VkDeviceSize indirectSize =
+      GRR_INDIRECT_COMMANDS_OFFSET +
+      sizeof(VkDrawIndexedIndirectCommand) * 2 * (VkDeviceSize)capacity;
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++) {
+    if (!_Grr_createBuffer(indirectSize,
+                           VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           GRR_GPU_MEMORY_PERSISTENT, &indirectBuffers[i],
+                           &indirectMemory[i])) {
+      _Grr_destroyGpuObjectBuffers();
+      return false;
+    }
+    if (!_Grr_createBuffer(visibilitySize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                           GRR_GPU_MEMORY_PERSISTENT, &readbackBuffers[i],
+                           &readbackMemory[i])) {
+      vkDestroyBuffer(device, indirectBuffers[i], NULL);
+      _Grr_freeGpuMemory(&indirectMemory[i]);
+      _Grr_destroyGpuObjectBuffers();
+      return false;
+    }
+    indirectBufferIds[i] =
+        Grr_registerStorageBuffer(indirectBuffers[i], 0, VK_WHOLE_SIZE);
+    indirectBufferCount++;
+  }
+  gpuObjectCapacity = capacity;
+  return true;
+}
+
+Grr_bool Grr_setGpuObjects(const GrrGpuObject *objects, Grr_u32 count) {
+  if (cullPipeline == VK_NULL_HANDLE) {
+    GRR_LOG_ERROR("GPU driven draws are not supported\n");
+    return false;
+  }
+
+  gpuObjectCount = 0;
+  _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_DRAW_LIST);
+  if (count == 0)
+    return true;
+
+  // Larger buffers replace the ones frames in flight use (destroyed once they
+  // are complete), buffers updated in place wait for them
+  if (count > gpuObjectCapacity) {
+    _Grr_destroyGpuObjectBuffers();
+    if (!_Grr_createGpuObjectBuffers(count)) {
+      GRR_LOG_ERROR("Failed to create GPU object buffers\n");
+      return false;
+    }
+  } else {
+    vkDeviceWaitIdle(device);
+  }
+
+  if (!_Grr_uploadSharedBuffer(gpuObjectBuffer, 0, objects,
+                               sizeof(GrrGpuObject) * count,
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                   VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                               VK_ACCESS_SHADER_READ_BIT)) {
+    GRR_LOG_ERROR("Failed to upload GPU objects\n");
+    return false;
+  }
+  // Submitted ahead of the next frame, its graphics and compute queue
+  // submissions wait for it
+  Grr_submitUploads();
+
+  // Nothing read back yet
+  memset(gpuObjectVisibility, 0, sizeof(Grr_u32) * count);
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++)
+    readbackRecorded[i] = false;
+
+  gpuObjectCount = count;
+  return true;
+}
+
+Grr_u32 Grr_gpuObjectCount() { return gpuObjectCount; }
+
+Grr_u32 Grr_gpuObjectBuffer() { return gpuObjectBufferId; }
+
+const Grr_u32 *Grr_gpuObjectVisibility() { return gpuObjectVisibility; }
+
+void _Grr_readGpuObjectVisibility(Grr_u32 frame) {
+  if (gpuObjectCount == 0 || !readbackRecorded[frame])
+    return;
+  memcpy(gpuObjectVisibility, readbackMemory[frame].mapped,
+         sizeof(Grr_u32) * gpuObjectCount);
+}
+
+void _Grr_recordCulling(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                        VkDescriptorSet frameSet, Grr_u32 frameOffset,
+                        GRR_CULL_PHASE phase) {
+  VkBufferMemoryBarrier barrier = {0};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.offset = 0;
+  barrier.size = VK_WHOLE_SIZE;
+
+  // Compacted commands of both phases are counted from 0
+  if (compactIndirectDraws && phase == GRR_CULL_PHASE_EARLY) {
+    vkCmdFillBuffer(commandBuffer, indirectBuffers[frame], 0,
+                    2 * sizeof(Grr_u32), 0);
+    barrier.buffer = indirectBuffers[frame];
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 1,
+                         &barrier, 0, NULL);
+  }
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    cullPipeline);
+  VkDescriptorSet sets[] = {frameSet, Grr_bindlessSet(), _Grr_hiZSet()};
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          cullPipelineLayout, 0,
+                          sizeof(sets) / sizeof(sets[0]), sets, 1,
+                          &frameOffset);
+
+  GrrCullConstants constants;
+  constants.objectCount = gpuObjectCount;
+  constants.objectBuffer = gpuObjectBufferId;
+  constants.indirectBuffer = indirectBufferIds[frame];
+  constants.compact = compactIndirectDraws;
+  constants.visibilityBuffer = visibilityBufferId;
+  constants.phase = phase;
+  constants.phaseCommands = phase * gpuObjectCapacity;
+  vkCmdPushConstants(commandBuffer, cullPipelineLayout,
+                     VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants),
+                     &constants);
+  vkCmdDispatch(commandBuffer,
+                (gpuObjectCount + GRR_CULL_GROUP_SIZE - 1) /
+                    GRR_CULL_GROUP_SIZE,
+                1, 1);
+
+  // The visibility of the frame is read back once the late phase is done
+  if (phase != GRR_CULL_PHASE_LATE)
+    return;
+  barrier.buffer = visibilityBuffer;
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 1, &barrier,
+                       0, NULL);
+
+  VkBufferCopy copy = {0};
+  copy.size = sizeof(Grr_u32) * gpuObjectCount;
+  vkCmdCopyBuffer(commandBuffer, visibilityBuffer, readbackBuffers[frame], 1,
+                  &copy);
+  barrier.buffer = readbackBuffers[frame];
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &barrier, 0,
+                       NULL);
+  readbackRecorded[frame] = true;
+}
+
+VkBuffer _Grr_indirectBuffer(Grr_u32 frame) { return indirectBuffers[frame]; }
+
+VkBuffer _Grr_visibilityBuffer() { return visibilityBuffer; }
+
+void _Grr_recordIndirectDraws(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                              GRR_CULL_PHASE phase) {
+  const Grr_u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+  VkDeviceSize commandsOffset =
+      GRR_INDIRECT_COMMANDS_OFFSET +
+      (VkDeviceSize)stride * phase * gpuObjectCapacity;
+  if (compactIndirectDraws) {
+    fpCmdDrawIndexedIndirectCountKHR(
+        commandBuffer, indirectBuffers[frame], commandsOffset,
+        indirectBuffers[frame], sizeof(Grr_u32) * phase, gpuObjectCount,
+        stride);
+    return;
+  }
+
+  // Culled objects draw no instance
+  for (Grr_u32 first = 0; first < gpuObjectCount;
+       first += maxDrawIndirectCount) {
+    Grr_u32 count = gpuObjectCount - first;
+    if (count > maxDrawIndirectCount)
+      count = maxDrawIndirectCount;
+    vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffers[frame],
+                             commandsOffset + (VkDeviceSize)stride * first,
+                             count, stride);
+  }
+}
@@ -0,0 +1,123 @@
+#ifndef GRR_INDIRECT_H
+#define GRR_INDIRECT_H
+
+#include "bindless.h"
+#include "gpumemory.h"
+#include "hiz.h"
+#include "logging.h"
+#include "math/linear.h"
+#include "types.h"
+#include "upload.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// GPU driven draws: the bounds and draw arguments of every object are uploaded
+// once to a storage buffer. Each frame a compute pass frustum culls all the
+// objects against the planes of the frame's uniform data and writes the
+// indexed indirect commands of the visible ones, compacted, with their count:
+// the render pass draws them with one vkCmdDrawIndexedIndirectCountKHR
+// (VK_KHR_draw_indirect_count). Without the extension every object keeps its
+// command slot, culled ones with an instance count of 0, drawn with
+// vkCmdDrawIndexedIndirect. Either way the CPU cost of a frame does not grow
+// with the number of objects.
+// The first instance of a command is its object index: vertex shaders fetch
+// the transform and material of the object with gl_InstanceIndex.
+// Occlusion culling against the Hi-Z pyramid (see hiz.h) takes two phases.
+// The early phase tests the objects in the frustum against the pyramid of the
+// previous frame, projected with the previous view and projection, and the
+// render pass draws the ones it does not hide. The pyramid is then built from
+// that depth, and the late phase tests the objects the early phase rejected
+// against it: a second render pass draws the ones it reveals. Each frame
+// leaves the visibility of every object in a buffer read back by the CPU.
+// With async compute (see compute.h) the early phase runs on the compute
+// queue, while the late render pass of the previous frame draws
+
+#define GRR_CULL_GROUP_SIZE 64 // local_size_x of cull.comp
+
+// Indirect buffer of a frame: draw count per phase, then one command per
+// object for each phase
+#define GRR_INDIRECT_COMMANDS_OFFSET 16
+
+typedef enum GRR_CULL_PHASE {
+  GRR_CULL_PHASE_EARLY = 0, // Before the pyramid of the frame is built
+  GRR_CULL_PHASE_LATE = 1
+} GRR_CULL_PHASE;
+
+// Visibility of an object in a frame, mirrored in cull.comp
+typedef enum GRR_GPU_OBJECT_VISIBILITY {
+  GRR_GPU_OBJECT_OUTSIDE = 0, // Outside of the frustum
+  GRR_GPU_OBJECT_VISIBLE = 1,
+  GRR_GPU_OBJECT_OCCLUDED = 2 // In the frustum, hidden by nearer depth
+} GRR_GPU_OBJECT_VISIBILITY;
+
+// std430 layout, mirrored in cull.comp and the vertex shaders
+typedef struct GrrGpuObject {
+  GrrMatrix4x4 transform;    // Applied after the model matrix of the UBO
+  GrrVector4 boundingSphere; // Center (xyz) and radius (w) in world space
+  Grr_u32 indexCount;        // Range of the model index buffer
+  Grr_u32 firstIndex;
+  Grr_i32 vertexOffset;
+  Grr_u32 materialIndex;
+} GrrGpuObject;
+
+// Push constants of cull.comp
+typedef struct GrrCullConstants {
+  Grr_u32 objectCount;
+  Grr_u32 objectBuffer;     // Bindless ID of the objects
+  Grr_u32 indirectBuffer;   // Bindless ID of the frame's indirect buffer
+  Grr_u32 compact;          // Commands are compacted behind a draw count
+  Grr_u32 visibilityBuffer; // Bindless ID of the object visibilities
+  Grr_u32 phase;            // GRR_CULL_PHASE
+  Grr_u32 phaseCommands;    // Index of the first command of the phase
+} GrrCullConstants;
+
+// Called once the frame descriptor set layout, bindless resources and Hi-Z
+// pipeline exist. Needs the multiDrawIndirect and drawIndirectFirstInstance
+// features, drawIndirectCount tells whether VK_KHR_draw_indirect_count is
+// enabled
+Grr_bool _Grr_initializeIndirectDraws(VkDescriptorSetLayout frameSetLayout,
+                                      VkPipelineCache cache,
+                                      Grr_bool drawIndirectCount);
+
+// Replaces the GPU driven objects (copied): frames draw them instead of the
+// draw list while count > 0. Waits for the device to be idle, it is meant for
+// scene loading rather than per frame updates
+Grr_bool Grr_setGpuObjects(const GrrGpuObject *objects, Grr_u32 count);
+Grr_u32 Grr_gpuObjectCount();
+
+// Bindless storage buffer ID of the objects, GRR_BINDLESS_INVALID when none
+Grr_u32 Grr_gpuObjectBuffer();
+
+// GRR_GPU_OBJECT_VISIBILITY of every object in the last completed frame, for
+// streaming decisions. All GRR_GPU_OBJECT_OUTSIDE until a frame drawing the
+// objects completed, valid until the next Grr_setGpuObjects
+const Grr_u32 *Grr_gpuObjectVisibility();
+
+// Copies the visibility frame read back, once its commands completed
+void _Grr_readGpuObjectVisibility(Grr_u32 frame);
+
+// Culls the objects for a phase of frame, outside of a render pass. frameSet
+// and frameOffset bind the frame's uniform data (set 0, dynamic offset). The
+// late phase follows _Grr_recordHiZ and also records the visibility readback.
+// Recorded in a render graph pass that writes the frame's indirect buffer
+// (with transfers and compute shaders) and the visibility buffer (also read
+// by transfers in the late phase), and reads the Hi-Z pyramid, or for the
+// early phase on the compute queue between the ownership transfers of these
+void _Grr_recordCulling(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                        VkDescriptorSet frameSet, Grr_u32 frameOffset,
+                        GRR_CULL_PHASE phase);
+
+// Commands and draw counts of frame, read by indirect draws
+VkBuffer _Grr_indirectBuffer(Grr_u32 frame);
+
+// Visibility of every object, kept from a frame to the next
+VkBuffer _Grr_visibilityBuffer();
+
+// Draws the commands culling wrote for a phase of frame, inside a render pass
+// once the graphics pipeline, vertex and index buffers and descriptor sets are
+// bound
+void _Grr_recordIndirectDraws(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                              GRR_CULL_PHASE phase);
+
+#endif
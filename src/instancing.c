@@ -0,0 +1,287 @@
+#include "instancing.h"
+#include "vulkan.h"
+
+GrrInstancedMesh *instancedMeshes = NULL;
+Grr_u32 instancedMeshCount = 0;
+Grr_u32 instancedMeshCapacity = 0;
+GrrInstanceQueue instanceQueue;
+
+// The frame data buffer holds the instances of every frame: shaders address
+// them in 16 byte units from the start of the buffer
+Grr_u32 instanceBufferId = GRR_BINDLESS_INVALID;
+Grr_u32 frameInstanceBase = 0;
+Grr_bool frameHasInstances = false;
+
+// Grows an array of elementSize bytes elements to hold count of them, the
+// array is kept on failure
+Grr_bool _Grr_growInstanceArray(void **array, Grr_u32 *capacity,
+                                Grr_u32 count, size_t elementSize) {
+  if (count <= *capacity)
+    return true;
+  Grr_u32 grownCapacity = *capacity > 0 ? *capacity : 16;
+  while (grownCapacity < count)
+    grownCapacity =
+        grownCapacity > UINT32_MAX / 2 ? count : grownCapacity * 2;
+  void *grown = realloc(*array, elementSize * (size_t)grownCapacity);
+  if (NULL == grown) {
+    GRR_LOG_ERROR("Failed to allocate memory for instances\n");
+    return false;
+  }
+  *array = grown;
+  *capacity = grownCapacity;
+  return true;
+}
+
+Grr_bool Grr_queueInstances(GrrInstanceQueue *queue, Grr_u32 mesh,
+                            const GrrInstancedMesh *meshData, Grr_u32 material,
+                            const GrrInstance *instances, Grr_u32 count) {
+  if (count == 0)
+    return true;
+  if (count > UINT32_MAX - queue->instanceCount) {
+    GRR_LOG_ERROR("Too many instances queued\n");
+    return false;
+  }
+
+  // Per instance arrays share the instance capacity
+  Grr_u32 total = queue->instanceCount + count;
+  Grr_u32 capacity = queue->instanceCapacity;
+  if (!_Grr_growInstanceArray((void **)&queue->instances, &capacity, total,
+                              sizeof(GrrInstance)))
+    return false;
+  if (capacity != queue->instanceCapacity) {
+    Grr_u32 *visible =
+        (Grr_u32 *)realloc(queue->visible, sizeof(Grr_u32) * capacity);
+    if (NULL != visible)
+      queue->visible = visible;
+    Grr_byte *isVisible = (Grr_byte *)realloc(queue->isVisible, capacity);
+    if (NULL != isVisible)
+      queue->isVisible = isVisible;
+    if (NULL == visible || NULL == isVisible) {
+      GRR_LOG_ERROR("Failed to allocate memory for instances\n");
+      return false;
+    }
+    queue->instanceCapacity = capacity;
+  }
+  Grr_u32 submissionCount = queue->submissionCount + 1;
+  if (!_Grr_growInstanceArray((void **)&queue->submissions,
+                              &queue->submissionCapacity, submissionCount,
+                              sizeof(GrrInstanceSubmission)) ||
+      !Grr_resizeBoundingSpheres(&queue->bounds, total))
+    return false;
+
+  GrrInstanceSubmission *submission =
+      &queue->submissions[queue->submissionCount];
+  submission->mesh = mesh;
+  submission->material = material;
+  submission->first = queue->instanceCount;
+  submission->count = count;
+  memcpy(queue->instances + queue->instanceCount, instances,
+         sizeof(GrrInstance) * count);
+
+  // Bounds of the mesh through each transform: the center is transformed, the
+  // radius scaled by the largest axis scale
+  const GrrVector4 *sphere = &meshData->boundingSphere;
+  for (Grr_u32 i = 0; i < count; i++) {
+    const Grr_f32 *m = instances[i].transform.data;
+    Grr_u32 b = queue->instanceCount + i;
+    queue->bounds.x[b] = m[0] * sphere->x + m[4] * sphere->y +
+                         m[8] * sphere->z + m[12];
+    queue->bounds.y[b] = m[1] * sphere->x + m[5] * sphere->y +
+                         m[9] * sphere->z + m[13];
+    queue->bounds.z[b] = m[2] * sphere->x + m[6] * sphere->y +
+                         m[10] * sphere->z + m[14];
+    if (sphere->w > 0.0f) {
+      Grr_f32 scale = 0.0f;
+      for (Grr_u32 axis = 0; axis < 3; axis++) {
+        const Grr_f32 *column = m + axis * 4;
+        Grr_f32 squared = column[0] * column[0] + column[1] * column[1] +
+                          column[2] * column[2];
+        scale = squared > scale ? squared : scale;
+      }
+      queue->bounds.radius[b] = sphere->w * sqrtf(scale);
+    } else {
+      queue->bounds.radius[b] = INFINITY;
+    }
+  }
+
+  queue->instanceCount = total;
+  queue->submissionCount = submissionCount;
+  return true;
+}
+
+// Mesh, then material, then submission order
+int _Grr_compareSubmissions(const void *a, const void *b) {
+  const GrrInstanceSubmission *first = (const GrrInstanceSubmission *)a;
+  const GrrInstanceSubmission *second = (const GrrInstanceSubmission *)b;
+  if (first->mesh != second->mesh)
+    return first->mesh < second->mesh ? -1 : 1;
+  if (first->material != second->material)
+    return first->material < second->material ? -1 : 1;
+  if (first->first != second->first)
+    return first->first < second->first ? -1 : 1;
+  return 0;
+}
+
+Grr_u32 Grr_batchInstances(GrrInstanceQueue *queue,
+                           const GrrVector4 planes[6]) {
+  queue->batchCount = 0;
+  queue->visibleCount = 0;
+  if (queue->instanceCount == 0)
+    return 0;
+
+  if (NULL != planes) {
+    Grr_u32 visibleCount =
+        Grr_cullSpheresParallel(planes, &queue->bounds, queue->visible);
+    memset(queue->isVisible, 0, queue->instanceCount);
+    for (Grr_u32 i = 0; i < visibleCount; i++)
+      queue->isVisible[queue->visible[i]] = 1;
+  } else {
+    memset(queue->isVisible, 1, queue->instanceCount);
+  }
+
+  qsort(queue->submissions, queue->submissionCount,
+        sizeof(GrrInstanceSubmission), _Grr_compareSubmissions);
+
+  // Consecutive submissions of the same mesh and material share a batch
+  GrrInstanceBatch *batch = NULL;
+  for (Grr_u32 s = 0; s < queue->submissionCount; s++) {
+    const GrrInstanceSubmission *submission = &queue->submissions[s];
+    Grr_u32 visibleCount = 0;
+    for (Grr_u32 i = submission->first;
+         i < submission->first + submission->count; i++)
+      visibleCount += queue->isVisible[i];
+    if (visibleCount == 0)
+      continue;
+
+    if (NULL == batch || batch->mesh != submission->mesh ||
+        batch->material != submission->material) {
+      if (!_Grr_growInstanceArray((void **)&queue->batches,
+                                  &queue->batchCapacity, queue->batchCount + 1,
+                                  sizeof(GrrInstanceBatch)))
+        break;
+      batch = &queue->batches[queue->batchCount++];
+      batch->mesh = submission->mesh;
+      batch->material = submission->material;
+      batch->firstInstance = queue->visibleCount;
+      batch->instanceCount = 0;
+    }
+    batch->instanceCount += visibleCount;
+    queue->visibleCount += visibleCount;
+  }
+  return queue->batchCount;
+}
+
+void Grr_writeInstances(GrrInstanceQueue *queue, GrrInstance *instances) {
+  // Submissions are in batch order since Grr_batchInstances, which may have
+  // batched only some of them
+  Grr_u32 written = 0;
+  for (Grr_u32 s = 0; s < queue->submissionCount; s++) {
+    const GrrInstanceSubmission *submission = &queue->submissions[s];
+    for (Grr_u32 i = submission->first;
+         i < submission->first + submission->count; i++) {
+      if (queue->isVisible[i] && written < queue->visibleCount)
+        instances[written++] = queue->instances[i];
+    }
+  }
+  queue->instanceCount = 0;
+  queue->submissionCount = 0;
+  queue->bounds.count = 0;
+}
+
+void Grr_destroyInstanceQueue(GrrInstanceQueue *queue) {
+  free(queue->instances);
+  Grr_destroyBoundingSpheres(&queue->bounds);
+  free(queue->submissions);
+  free(queue->visible);
+  free(queue->isVisible);
+  free(queue->batches);
+  memset(queue, 0, sizeof(GrrInstanceQueue));
+}
+
+void _Grr_destroyInstancing() {
+  GRR_LOG_INFO("Free instancing\n");
+  Grr_releaseStorageBuffer(instanceBufferId);
+  Grr_destroyInstanceQueue(&instanceQueue);
+  free(instancedMeshes);
+}
+
+Grr_bool _Grr_initializeInstancing() {
+  instanceBufferId =
+      Grr_registerStorageBuffer(Grr_frameDataBuffer(), 0, VK_WHOLE_SIZE);
+  if (instanceBufferId == GRR_BINDLESS_INVALID)
+    return false;
+  atexit(_Grr_destroyInstancing);
+  return true;
+}
+
+Grr_u32 Grr_registerMesh(const GrrInstancedMesh *mesh) {
+  if (!_Grr_growInstanceArray((void **)&instancedMeshes,
+                              &instancedMeshCapacity, instancedMeshCount + 1,
+                              sizeof(GrrInstancedMesh)))
+    return GRR_INSTANCING_INVALID_MESH;
+  instancedMeshes[instancedMeshCount] = *mesh;
+  return instancedMeshCount++;
+}
+
+Grr_bool Grr_drawInstances(Grr_u32 mesh, Grr_u32 material,
+                           const GrrInstance *instances, Grr_u32 count) {
+  if (mesh >= instancedMeshCount) {
+    GRR_LOG_ERROR("Instances of unknown mesh %u\n", mesh);
+    return false;
+  }
+  return Grr_queueInstances(&instanceQueue, mesh, &instancedMeshes[mesh],
+                            material, instances, count);
+}
+
+void _Grr_prepareInstances(const GrrVector4 planes[6]) {
+  // Batches refer to this frame's data, cached command buffers with instances
+  // are recorded again
+  Grr_bool hadInstances = frameHasInstances;
+  frameHasInstances = Grr_batchInstances(&instanceQueue, planes) > 0;
+  if (hadInstances || frameHasInstances)
+    _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_DRAW_LIST);
+
+  VkDeviceSize offset = 0;
+  GrrInstance *instances = NULL;
+  if (frameHasInstances) {
+    // Frame data is aligned to at least 16 bytes
+    instances = (GrrInstance *)Grr_allocateFrameData(
+        sizeof(GrrInstance) * (VkDeviceSize)instanceQueue.visibleCount,
+        &offset);
+  }
+  if (NULL == instances) {
+    frameHasInstances = false;
+    instanceQueue.batchCount = 0;
+    instanceQueue.instanceCount = 0;
+    instanceQueue.submissionCount = 0;
+    instanceQueue.bounds.count = 0;
+    return;
+  }
+  Grr_writeInstances(&instanceQueue, instances);
+  frameInstanceBase = (Grr_u32)(offset / 16);
+}
+
+Grr_u32 _Grr_instanceBatchCount() {
+  return frameHasInstances ? instanceQueue.batchCount : 0;
+}
+
+void _Grr_recordInstanceBatches(VkCommandBuffer commandBuffer,
+                                VkPipelineLayout layout, Grr_u32 first,
+                                Grr_u32 count) {
+  GrrDrawConstants constants = {0};
+  Grr_identityMatrix(&constants.transform);
+  constants.objectBuffer = GRR_BINDLESS_INVALID;
+  constants.instanceBuffer = instanceBufferId;
+  constants.instanceBase = frameInstanceBase;
+  for (Grr_u32 i = first; i < first + count; i++) {
+    const GrrInstanceBatch *batch = &instanceQueue.batches[i];
+    const GrrInstancedMesh *mesh = &instancedMeshes[batch->mesh];
+    constants.materialIndex = batch->material;
+    vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(constants), &constants);
+    // gl_InstanceIndex starts at the first instance of the batch
+    vkCmdDrawIndexed(commandBuffer, mesh->indexCount, batch->instanceCount,
+                     mesh->firstIndex, mesh->vertexOffset,
+                     batch->firstInstance);
+  }
+}
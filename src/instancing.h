@@ -0,0 +1,116 @@
+#ifndef GRR_INSTANCING_H
+#define GRR_INSTANCING_H
+
+#include "bindless.h"
+#include "culling.h"
+#include "framedata.h"
+#include "logging.h"
+#include "math/linear.h"
+#include "types.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Instanced draws: meshes (ranges of the model index buffer) are registered
+// once, then every frame the application queues instances of a mesh with a
+// material. Queued instances are frustum culled on the CPU, grouped by mesh
+// and material, and the visible ones are written into the frame's data
+// buffer: each group is one vkCmdDrawIndexed with an instance count, whose
+// vertex shader reads the instance data from the storage buffer with
+// gl_InstanceIndex. Instances are queued for the next frame only, and cached
+// command buffers are recorded again on every frame that draws instances
+
+#define GRR_INSTANCING_INVALID_MESH UINT32_MAX
+
+// Index range of the model drawn by instances
+typedef struct GrrInstancedMesh {
+  Grr_u32 indexCount;
+  Grr_u32 firstIndex;
+  Grr_i32 vertexOffset;
+  // Center (xyz) and radius (w) in the space instance transforms apply to. A
+  // radius of 0 or less is never culled
+  GrrVector4 boundingSphere;
+} GrrInstancedMesh;
+
+// std430 layout, mirrored in the vertex shaders
+typedef struct GrrInstance {
+  GrrMatrix4x4 transform; // Applied after the model matrix of the UBO
+  GrrVector4 color;       // Vertex color (rgb) of the instance
+} GrrInstance;
+
+// Instances of [firstInstance, firstInstance + instanceCount) of a frame
+// drawn with one call
+typedef struct GrrInstanceBatch {
+  Grr_u32 mesh;
+  Grr_u32 material;
+  Grr_u32 firstInstance;
+  Grr_u32 instanceCount;
+} GrrInstanceBatch;
+
+// Instances queued with the same mesh and material by one call
+typedef struct GrrInstanceSubmission {
+  Grr_u32 mesh;
+  Grr_u32 material;
+  Grr_u32 first; // In the queue's instances
+  Grr_u32 count;
+} GrrInstanceSubmission;
+
+// Instances of a frame in submission order, with their world bounds. A zero
+// initialized queue is empty
+typedef struct GrrInstanceQueue {
+  GrrInstance *instances;
+  GrrBoundingSpheres bounds;
+  Grr_u32 instanceCount;
+  Grr_u32 instanceCapacity;
+  GrrInstanceSubmission *submissions;
+  Grr_u32 submissionCount;
+  Grr_u32 submissionCapacity;
+  Grr_u32 *visible;    // Indices of the instances left by culling
+  Grr_byte *isVisible; // Per instance
+  GrrInstanceBatch *batches;
+  Grr_u32 batchCount;
+  Grr_u32 batchCapacity;
+  Grr_u32 visibleCount;
+} GrrInstanceQueue;
+
+// Copies count instances of mesh (its bounds are those of meshData)
+Grr_bool Grr_queueInstances(GrrInstanceQueue *queue, Grr_u32 mesh,
+                            const GrrInstancedMesh *meshData, Grr_u32 material,
+                            const GrrInstance *instances, Grr_u32 count);
+
+// Culls the queued instances (every one is visible when planes is NULL) and
+// groups the visible ones in batches sorted by mesh then material, returns
+// their number
+Grr_u32 Grr_batchInstances(GrrInstanceQueue *queue,
+                           const GrrVector4 planes[6]);
+
+// Writes the visible instances in batch order, then empties the queue (the
+// batches stay until the next Grr_batchInstances)
+void Grr_writeInstances(GrrInstanceQueue *queue, GrrInstance *instances);
+
+void Grr_destroyInstanceQueue(GrrInstanceQueue *queue);
+
+// Returns the ID of the mesh, GRR_INSTANCING_INVALID_MESH on failure
+Grr_u32 Grr_registerMesh(const GrrInstancedMesh *mesh);
+
+// Queues instances of mesh, drawn with material by the next Grr_drawFrame
+// (instances are copied)
+Grr_bool Grr_drawInstances(Grr_u32 mesh, Grr_u32 material,
+                           const GrrInstance *instances, Grr_u32 count);
+
+// Called once the frame data buffer and bindless descriptors exist
+Grr_bool _Grr_initializeInstancing();
+
+// Batches the instances queued for the frame against its frustum planes and
+// writes them into its data. Called after the frame data of the frame begun
+void _Grr_prepareInstances(const GrrVector4 planes[6]);
+
+Grr_u32 _Grr_instanceBatchCount();
+
+// Records batches [first, first + count) of the frame, with the draw state
+// (pipeline, vertex and index buffers, descriptor sets) already bound
+void _Grr_recordInstanceBatches(VkCommandBuffer commandBuffer,
+                                VkPipelineLayout layout, Grr_u32 first,
+                                Grr_u32 count);
+
+#endif
@@ -0,0 +1,185 @@
+#include "jobs.h"
+
+typedef struct GrrJobPool {
+  pthread_t threads[GRR_MAX_JOB_THREADS];
+  Grr_u32 workerCount;
+  Grr_bool initialized;
+  Grr_bool quit;
+
+  pthread_mutex_t mutex;    // Guards the fields below
+  pthread_cond_t wake;      // Signaled when a new loop is published
+  pthread_cond_t done;      // Signaled when a worker leaves a loop
+  pthread_mutex_t dispatch; // Held by the thread running a loop
+  Grr_u64 generation;       // Incremented for each published loop
+  Grr_u32 active;           // Workers currently executing the loop
+
+  // Current loop
+  Grr_jobFunction function;
+  void *data;
+  Grr_u32 count;
+  Grr_u32 next;      // Next index to claim (atomic)
+  Grr_u32 completed; // Finished indices (atomic)
+} GrrJobPool;
+
+GrrJobPool jobPool = {0};
+// Thread index + 1 of job threads (workers, and the dispatching thread while
+// it runs a loop), NULL for other threads
+pthread_key_t jobThreadKey;
+
+void _Grr_runJobs(Grr_u32 threadIndex) {
+  Grr_u32 finished = 0;
+  for (;;) {
+    Grr_u32 i = __atomic_fetch_add(&jobPool.next, 1, __ATOMIC_ACQ_REL);
+    if (i >= jobPool.count)
+      break;
+    jobPool.function(jobPool.data, i, threadIndex);
+    finished++;
+  }
+  if (finished)
+    __atomic_add_fetch(&jobPool.completed, finished, __ATOMIC_ACQ_REL);
+}
+
+void *_Grr_jobWorker(void *arg) {
+  Grr_u32 threadIndex = (Grr_u32)(uintptr_t)arg;
+  Grr_u64 seenGeneration = 0;
+  pthread_setspecific(jobThreadKey, (void *)(uintptr_t)(threadIndex + 1));
+
+  pthread_mutex_lock(&jobPool.mutex);
+  for (;;) {
+    while (!jobPool.quit && jobPool.generation == seenGeneration)
+      pthread_cond_wait(&jobPool.wake, &jobPool.mutex);
+    if (jobPool.quit)
+      break;
+    seenGeneration = jobPool.generation;
+    jobPool.active++;
+    pthread_mutex_unlock(&jobPool.mutex);
+
+    _Grr_runJobs(threadIndex);
+
+    pthread_mutex_lock(&jobPool.mutex);
+    jobPool.active--;
+    pthread_cond_broadcast(&jobPool.done);
+  }
+  pthread_mutex_unlock(&jobPool.mutex);
+
+  return NULL;
+}
+
+void _Grr_destroyJobs() {
+  if (!jobPool.initialized)
+    return;
+  GRR_LOG_INFO("Free job threads\n");
+
+  pthread_mutex_lock(&jobPool.mutex);
+  jobPool.quit = true;
+  pthread_cond_broadcast(&jobPool.wake);
+  pthread_mutex_unlock(&jobPool.mutex);
+  for (Grr_u32 i = 0; i < jobPool.workerCount; i++)
+    pthread_join(jobPool.threads[i], NULL);
+
+  pthread_cond_destroy(&jobPool.wake);
+  pthread_cond_destroy(&jobPool.done);
+  pthread_mutex_destroy(&jobPool.mutex);
+  pthread_mutex_destroy(&jobPool.dispatch);
+  pthread_key_delete(jobThreadKey);
+  jobPool.initialized = false;
+}
+
+Grr_bool Grr_initializeJobs(Grr_u32 workerCount) {
+  if (jobPool.initialized)
+    return true;
+
+  if (workerCount == 0) {
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    workerCount = (cpuCount > 1 ? (Grr_u32)cpuCount - 1 : 0);
+  }
+  if (workerCount > GRR_MAX_JOB_THREADS)
+    workerCount = GRR_MAX_JOB_THREADS;
+
+  if (pthread_key_create(&jobThreadKey, NULL) != 0) {
+    GRR_LOG_ERROR("Failed to create job thread key\n");
+    return false;
+  }
+  pthread_mutex_init(&jobPool.mutex, NULL);
+  pthread_mutex_init(&jobPool.dispatch, NULL);
+  pthread_cond_init(&jobPool.wake, NULL);
+  pthread_cond_init(&jobPool.done, NULL);
+  jobPool.quit = false;
+  jobPool.generation = 0;
+  jobPool.active = 0;
+  jobPool.count = 0;
+  jobPool.next = 0;
+  jobPool.workerCount = 0;
+
+  for (Grr_u32 i = 0; i < workerCount; i++) {
+    if (pthread_create(&jobPool.threads[i], NULL, _Grr_jobWorker,
+                       (void *)(uintptr_t)(i + 1)) != 0) {
+      GRR_LOG_WARNING("Failed to create job thread %u\n", i + 1);
+      break;
+    }
+    jobPool.workerCount++;
+  }
+
+  jobPool.initialized = true;
+  atexit(_Grr_destroyJobs);
+  GRR_LOG_INFO("Job system started with %u worker threads\n",
+               jobPool.workerCount);
+
+  return true;
+}
+
+Grr_u32 Grr_jobThreadCount() {
+  if (!jobPool.initialized)
+    Grr_initializeJobs(0);
+  return jobPool.workerCount + 1;
+}
+
+void Grr_parallelFor(Grr_u32 count, Grr_jobFunction function, void *data) {
+  if (count == 0)
+    return;
+  if (!jobPool.initialized)
+    Grr_initializeJobs(0);
+
+  // Nested calls run serially on the job thread, with its own index
+  Grr_u32 threadIndex = (Grr_u32)(uintptr_t)pthread_getspecific(jobThreadKey);
+  if (threadIndex > 0) {
+    for (Grr_u32 i = 0; i < count; i++)
+      function(data, i, threadIndex - 1);
+    return;
+  }
+
+  // Other threads take index 0 in turns, waiting for the running loop
+  pthread_mutex_lock(&jobPool.dispatch);
+  pthread_setspecific(jobThreadKey, (void *)(uintptr_t)1);
+  if (count == 1 || jobPool.workerCount == 0) {
+    for (Grr_u32 i = 0; i < count; i++)
+      function(data, i, 0);
+    pthread_setspecific(jobThreadKey, NULL);
+    pthread_mutex_unlock(&jobPool.dispatch);
+    return;
+  }
+
+  // Publish loop once late workers from the previous loop have left it
+  pthread_mutex_lock(&jobPool.mutex);
+  while (jobPool.active > 0)
+    pthread_cond_wait(&jobPool.done, &jobPool.mutex);
+  jobPool.function = function;
+  jobPool.data = data;
+  jobPool.count = count;
+  __atomic_store_n(&jobPool.completed, 0, __ATOMIC_RELEASE);
+  __atomic_store_n(&jobPool.next, 0, __ATOMIC_RELEASE);
+  jobPool.generation++;
+  pthread_cond_broadcast(&jobPool.wake);
+  pthread_mutex_unlock(&jobPool.mutex);
+
+  _Grr_runJobs(0);
+
+  // Wait for the remaining iterations to finish
+  pthread_mutex_lock(&jobPool.mutex);
+  while (__atomic_load_n(&jobPool.completed, __ATOMIC_ACQUIRE) < count)
+    pthread_cond_wait(&jobPool.done, &jobPool.mutex);
+  pthread_mutex_unlock(&jobPool.mutex);
+
+  pthread_setspecific(jobThreadKey, NULL);
+  pthread_mutex_unlock(&jobPool.dispatch);
+}
@@ -0,0 +1,36 @@
+#ifndef GRR_JOBS_H
+#define GRR_JOBS_H
+
+#include "logging.h"
+#include "types.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Minimal fork/join job system: a fixed pool of worker threads executing
+// parallel-for loops. The calling thread participates, so a pool of N workers
+// runs loops N + 1 wide.
+
+#define GRR_MAX_JOB_THREADS 64
+
+// index: loop iteration, threadIndex: 0 for the calling thread, 1..N for
+// workers (stable for the lifetime of the pool, usable to index per-thread
+// resources)
+typedef void (*Grr_jobFunction)(void *data, Grr_u32 index,
+                                Grr_u32 threadIndex);
+
+// Starts workerCount worker threads (0 picks online CPU count - 1). Called
+// implicitly with 0 by the first Grr_parallelFor if needed
+Grr_bool Grr_initializeJobs(Grr_u32 workerCount);
+
+// Number of threads that can execute jobs (workers + calling thread)
+Grr_u32 Grr_jobThreadCount();
+
+// Runs function for every index in [0, count) and returns once all are done.
+// Nested calls run serially on the calling job thread, with its thread index.
+// Concurrent calls from other threads wait for the running loop to finish, so
+// a thread index is never used by two threads at once
+void Grr_parallelFor(Grr_u32 count, Grr_jobFunction function, void *data);
+
+#endif
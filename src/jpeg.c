@@ -0,0 +1,982 @@
+#include "jpeg.h"
+
+#define GRR_JPEG_FAST_BITS 9
+#define GRR_JPEG_MAX_COMPONENTS 3
+
+// Natural (row-major) position of the n-th coefficient in zigzag order
+static const Grr_byte jpegZigzag[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+// IDCT basis: c(k) / 2 * cos((2n + 1) k pi / 16), c(0) = 1 / sqrt(2)
+Grr_f32 jpegIDCTBasis[8][8];
+Grr_bool jpegIDCTBasisInitialized = false;
+
+typedef struct _GrrJPEGHuffman {
+  Grr_u16 fast[1 << GRR_JPEG_FAST_BITS]; // (length << 8) | symbol, 0 if longer
+  Grr_u32 firstCode[17];                 // Canonical codes per length
+  Grr_u32 firstIndex[17];
+  Grr_u32 counts[17];
+  Grr_byte symbols[256];
+  Grr_bool defined;
+} _GrrJPEGHuffman;
+
+typedef struct _GrrJPEGComponent {
+  Grr_u32 id;
+  Grr_u32 h; // Sampling factors
+  Grr_u32 v;
+  Grr_u32 quantTable;
+  Grr_u32 width; // Samples
+  Grr_u32 height;
+  Grr_u32 blocksPerLine; // Padded to whole MCUs
+  Grr_u32 blocksPerColumn;
+  Grr_i16 *coefficients; // 64 per block, natural order
+  Grr_byte *samples;     // blocksPerLine * 8 samples per line
+} _GrrJPEGComponent;
+
+typedef struct _GrrJPEG {
+  Grr_u32 width;
+  Grr_u32 height;
+  Grr_bool frame; // Frame header parsed
+  Grr_bool progressive;
+  Grr_u32 componentCount;
+  _GrrJPEGComponent components[GRR_JPEG_MAX_COMPONENTS];
+  Grr_u32 hMax;
+  Grr_u32 vMax;
+  Grr_u32 mcusPerLine;
+  Grr_u32 mcusPerColumn;
+  Grr_u16 quantTables[4][64]; // Natural order
+  Grr_bool quantDefined[4];
+  _GrrJPEGHuffman dcTables[4];
+  _GrrJPEGHuffman acTables[4];
+  Grr_u32 restartInterval; // MCUs, 0 without restart markers
+  Grr_i32 adobeTransform;  // -1 without an Adobe marker
+} _GrrJPEG;
+
+typedef struct _GrrJPEGScan {
+  const _GrrJPEG *jpeg;
+  Grr_u32 componentCount;
+  Grr_u32 components[GRR_JPEG_MAX_COMPONENTS]; // Frame component indices
+  const _GrrJPEGHuffman *dcTables[GRR_JPEG_MAX_COMPONENTS];
+  const _GrrJPEGHuffman *acTables[GRR_JPEG_MAX_COMPONENTS];
+  Grr_u32 spectralStart;
+  Grr_u32 spectralEnd;
+  Grr_u32 approximationHigh;
+  Grr_u32 approximationLow;
+  Grr_u32 mcusPerLine; // Blocks of the component for non-interleaved scans
+  Grr_u32 mcuCount;
+  Grr_u32 mcusPerSegment;
+  const Grr_byte *data; // Entropy coded data
+  size_t *segmentOffsets; // segmentCount + 1 offsets in data
+  Grr_u32 segmentCount;
+  Grr_bool failed;
+} _GrrJPEGScan;
+
+// Entropy decoder state of one segment
+typedef struct _GrrJPEGBits {
+  const Grr_byte *bytes;
+  size_t position;
+  size_t nBytes;
+  Grr_u32 buffer; // MSB aligned
+  Grr_i32 count;
+  Grr_i32 dcPredictions[GRR_JPEG_MAX_COMPONENTS];
+  Grr_u32 eobRun;
+  Grr_bool failed;
+} _GrrJPEGBits;
+
+// Entropy decoding
+
+// Past the end of the segment (marker) the buffer is padded with zeros
+void _Grr_jpegFill(_GrrJPEGBits *bits) {
+  while (bits->count <= 24) {
+    Grr_u32 byte = 0;
+    if (bits->position < bits->nBytes) {
+      byte = bits->bytes[bits->position];
+      if (byte != 0xFF) {
+        bits->position++;
+      } else if (bits->position + 1 < bits->nBytes &&
+                 bits->bytes[bits->position + 1] == 0x00) {
+        bits->position += 2; // Stuffed zero
+      } else {
+        byte = 0;
+        bits->position = bits->nBytes;
+      }
+    }
+    bits->buffer |= byte << (24 - bits->count);
+    bits->count += 8;
+  }
+}
+
+Grr_u32 _Grr_jpegGetBits(_GrrJPEGBits *bits, Grr_u32 n) {
+  if (n == 0)
+    return 0;
+  if (bits->count < (Grr_i32)n)
+    _Grr_jpegFill(bits);
+  Grr_u32 value = bits->buffer >> (32 - n);
+  bits->buffer <<= n;
+  bits->count -= n;
+  return value;
+}
+
+// Receives n bits and extends their sign (T.81 F.2.2.1)
+Grr_i32 _Grr_jpegReceiveExtend(_GrrJPEGBits *bits, Grr_u32 n) {
+  Grr_i32 value = (Grr_i32)_Grr_jpegGetBits(bits, n);
+  if (n > 0 && value < (1 << (n - 1)))
+    value += 1 - (1 << n);
+  return value;
+}
+
+Grr_u32 _Grr_jpegDecodeHuffman(_GrrJPEGBits *bits,
+                               const _GrrJPEGHuffman *table) {
+  if (bits->count < 16)
+    _Grr_jpegFill(bits);
+
+  Grr_u32 fast = table->fast[bits->buffer >> (32 - GRR_JPEG_FAST_BITS)];
+  if (fast) {
+    bits->buffer <<= fast >> 8;
+    bits->count -= fast >> 8;
+    return fast & 0xFF;
+  }
+
+  for (Grr_u32 length = GRR_JPEG_FAST_BITS + 1; length <= 16; length++) {
+    Grr_u32 offset = (bits->buffer >> (32 - length)) - table->firstCode[length];
+    if (offset < table->counts[length]) {
+      bits->buffer <<= length;
+      bits->count -= length;
+      return table->symbols[table->firstIndex[length] + offset];
+    }
+  }
+  bits->failed = true;
+  return 0;
+}
+
+Grr_bool _Grr_jpegBuildHuffman(_GrrJPEGHuffman *table, const Grr_byte *counts,
+                               const Grr_byte *symbols) {
+  memset(table, 0, sizeof(_GrrJPEGHuffman));
+  Grr_u32 code = 0, index = 0;
+  for (Grr_u32 length = 1; length <= 16; length++) {
+    table->counts[length] = counts[length - 1];
+    table->firstCode[length] = code;
+    table->firstIndex[length] = index;
+    for (Grr_u32 i = 0; i < counts[length - 1]; i++, code++, index++) {
+      if (length > GRR_JPEG_FAST_BITS)
+        continue;
+      Grr_u32 shift = GRR_JPEG_FAST_BITS - length;
+      for (Grr_u32 j = 0; j < (1u << shift); j++)
+        table->fast[(code << shift) | j] =
+            (Grr_u16)((length << 8) | symbols[index]);
+    }
+    if (code > (1u << length))
+      return false;
+    code <<= 1;
+  }
+  memcpy(table->symbols, symbols, index);
+  table->defined = true;
+  return true;
+}
+
+void _Grr_jpegDecodeBlockBaseline(_GrrJPEGBits *bits,
+                                  const _GrrJPEGHuffman *dcTable,
+                                  const _GrrJPEGHuffman *acTable,
+                                  Grr_i32 *prediction, Grr_i16 *block) {
+  Grr_u32 t = _Grr_jpegDecodeHuffman(bits, dcTable);
+  if (t > 16) {
+    bits->failed = true;
+    return;
+  }
+  *prediction += _Grr_jpegReceiveExtend(bits, t);
+  block[0] = (Grr_i16)*prediction;
+
+  for (Grr_u32 k = 1; k < 64;) {
+    Grr_u32 rs = _Grr_jpegDecodeHuffman(bits, acTable);
+    Grr_u32 r = rs >> 4, s = rs & 15;
+    if (s == 0) {
+      if (r != 15)
+        break; // End of block
+      k += 16;
+      continue;
+    }
+    k += r;
+    if (k > 63) {
+      bits->failed = true;
+      return;
+    }
+    block[jpegZigzag[k++]] = (Grr_i16)_Grr_jpegReceiveExtend(bits, s);
+  }
+}
+
+// Progressive scans (T.81 G.1.2)
+
+void _Grr_jpegDecodeBlockDCFirst(_GrrJPEGBits *bits,
+                                 const _GrrJPEGHuffman *dcTable,
+                                 Grr_u32 approximationLow, Grr_i32 *prediction,
+                                 Grr_i16 *block) {
+  Grr_u32 t = _Grr_jpegDecodeHuffman(bits, dcTable);
+  if (t > 16) {
+    bits->failed = true;
+    return;
+  }
+  *prediction += _Grr_jpegReceiveExtend(bits, t);
+  block[0] = (Grr_i16)(*prediction * (1 << approximationLow));
+}
+
+void _Grr_jpegDecodeBlockDCRefine(_GrrJPEGBits *bits,
+                                  Grr_u32 approximationLow, Grr_i16 *block) {
+  if (_Grr_jpegGetBits(bits, 1))
+    block[0] |= (Grr_i16)(1 << approximationLow);
+}
+
+void _Grr_jpegDecodeBlockACFirst(_GrrJPEGBits *bits, const _GrrJPEGScan *scan,
+                                 const _GrrJPEGHuffman *acTable,
+                                 Grr_i16 *block) {
+  if (bits->eobRun > 0) {
+    bits->eobRun--;
+    return;
+  }
+
+  for (Grr_u32 k = scan->spectralStart; k <= scan->spectralEnd;) {
+    Grr_u32 rs = _Grr_jpegDecodeHuffman(bits, acTable);
+    Grr_u32 r = rs >> 4, s = rs & 15;
+    if (s == 0) {
+      if (r < 15) { // End of band run
+        bits->eobRun = (1u << r) - 1 + _Grr_jpegGetBits(bits, r);
+        break;
+      }
+      k += 16;
+      continue;
+    }
+    k += r;
+    if (k > scan->spectralEnd) {
+      bits->failed = true;
+      return;
+    }
+    block[jpegZigzag[k++]] = (Grr_i16)(_Grr_jpegReceiveExtend(bits, s) *
+                                       (1 << scan->approximationLow));
+  }
+}
+
+// Refines a non-zero coefficient by one bit
+void _Grr_jpegRefineCoefficient(_GrrJPEGBits *bits, Grr_i16 *coefficient,
+                                Grr_i32 bit) {
+  if (_Grr_jpegGetBits(bits, 1) && (*coefficient & bit) == 0)
+    *coefficient += (Grr_i16)(*coefficient > 0 ? bit : -bit);
+}
+
+void _Grr_jpegDecodeBlockACRefine(_GrrJPEGBits *bits,
+                                  const _GrrJPEGScan *scan,
+                                  const _GrrJPEGHuffman *acTable,
+                                  Grr_i16 *block) {
+  Grr_i32 bit = 1 << scan->approximationLow;
+  Grr_u32 k = scan->spectralStart;
+
+  if (bits->eobRun == 0) {
+    for (; k <= scan->spectralEnd;) {
+      Grr_u32 rs = _Grr_jpegDecodeHuffman(bits, acTable);
+      Grr_i32 r = rs >> 4, s = rs & 15, value = 0;
+      if (s == 0) {
+        if (r < 15) { // End of band run, this block refines up to the end
+          bits->eobRun = (1u << r) + _Grr_jpegGetBits(bits, r);
+          break;
+        }
+        // 16 zero coefficients (skipping the non-zero ones)
+      } else {
+        if (s != 1) {
+          bits->failed = true;
+          return;
+        }
+        value = (_Grr_jpegGetBits(bits, 1) ? bit : -bit);
+      }
+
+      // Skip r zero coefficients, refining the non-zero ones on the way
+      for (; k <= scan->spectralEnd; k++) {
+        Grr_i16 *coefficient = &block[jpegZigzag[k]];
+        if (*coefficient != 0) {
+          _Grr_jpegRefineCoefficient(bits, coefficient, bit);
+        } else if (r-- == 0) {
+          *coefficient = (Grr_i16)value;
+          k++;
+          break;
+        }
+      }
+    }
+  }
+
+  if (bits->eobRun > 0) {
+    for (; k <= scan->spectralEnd; k++) {
+      Grr_i16 *coefficient = &block[jpegZigzag[k]];
+      if (*coefficient != 0)
+        _Grr_jpegRefineCoefficient(bits, coefficient, bit);
+    }
+    bits->eobRun--;
+  }
+}
+
+void _Grr_jpegDecodeBlock(const _GrrJPEGScan *scan, _GrrJPEGBits *bits,
+                          Grr_u32 scanComponent, Grr_u32 bx, Grr_u32 by) {
+  const _GrrJPEGComponent *component =
+      &scan->jpeg->components[scan->components[scanComponent]];
+  Grr_i16 *block =
+      component->coefficients +
+      ((size_t)by * component->blocksPerLine + bx) * 64;
+  Grr_i32 *prediction = &bits->dcPredictions[scanComponent];
+
+  if (!scan->jpeg->progressive)
+    _Grr_jpegDecodeBlockBaseline(bits, scan->dcTables[scanComponent],
+                                 scan->acTables[scanComponent], prediction,
+                                 block);
+  else if (scan->spectralStart == 0 && scan->approximationHigh == 0)
+    _Grr_jpegDecodeBlockDCFirst(bits, scan->dcTables[scanComponent],
+                                scan->approximationLow, prediction, block);
+  else if (scan->spectralStart == 0)
+    _Grr_jpegDecodeBlockDCRefine(bits, scan->approximationLow, block);
+  else if (scan->approximationHigh == 0)
+    _Grr_jpegDecodeBlockACFirst(bits, scan, scan->acTables[scanComponent],
+                                block);
+  else
+    _Grr_jpegDecodeBlockACRefine(bits, scan, scan->acTables[scanComponent],
+                                 block);
+}
+
+// Decodes the MCUs of one restart interval
+void _Grr_jpegDecodeSegment(void *data, Grr_u32 segment, Grr_u32 threadIndex) {
+  _GrrJPEGScan *scan = (_GrrJPEGScan *)data;
+  _GrrJPEGBits bits = {0};
+  bits.bytes = scan->data + scan->segmentOffsets[segment];
+  bits.nBytes =
+      scan->segmentOffsets[segment + 1] - scan->segmentOffsets[segment];
+
+  Grr_u32 first = segment * scan->mcusPerSegment;
+  Grr_u32 last = first + scan->mcusPerSegment;
+  last = (last < scan->mcuCount ? last : scan->mcuCount);
+  for (Grr_u32 mcu = first; mcu < last && !bits.failed; mcu++) {
+    Grr_u32 mx = mcu % scan->mcusPerLine, my = mcu / scan->mcusPerLine;
+    if (scan->componentCount == 1) {
+      _Grr_jpegDecodeBlock(scan, &bits, 0, mx, my);
+      continue;
+    }
+    for (Grr_u32 i = 0; i < scan->componentCount; i++) {
+      const _GrrJPEGComponent *component =
+          &scan->jpeg->components[scan->components[i]];
+      for (Grr_u32 v = 0; v < component->v; v++)
+        for (Grr_u32 h = 0; h < component->h; h++)
+          _Grr_jpegDecodeBlock(scan, &bits, i, mx * component->h + h,
+                               my * component->v + v);
+    }
+  }
+
+  if (bits.failed) {
+    GRR_LOG_ERROR("JPEG: corrupt entropy coded segment %u\n", segment);
+    __atomic_store_n(&scan->failed, true, __ATOMIC_RELAXED);
+  }
+}
+
+// Splits the entropy coded data at restart markers. Returns the size of the
+// data (up to the next marker) or 0 when segments don't match the MCU count
+size_t _Grr_jpegFindSegments(_GrrJPEGScan *scan, size_t nBytes) {
+  const Grr_byte *data = scan->data;
+  Grr_u32 expected =
+      (scan->mcuCount + scan->mcusPerSegment - 1) / scan->mcusPerSegment;
+  Grr_u32 found = 1;
+  scan->segmentOffsets[0] = 0;
+
+  size_t i = 0;
+  while (i + 1 < nBytes) {
+    if (data[i] != 0xFF) {
+      i++;
+    } else if (data[i + 1] == 0x00 || data[i + 1] == 0xFF) {
+      i += (data[i + 1] == 0x00 ? 2 : 1); // Stuffed zero, fill byte
+    } else if (data[i + 1] >= 0xD0 && data[i + 1] <= 0xD7) {
+      i += 2;
+      if (found == expected)
+        return 0;
+      scan->segmentOffsets[found++] = i;
+    } else {
+      break;
+    }
+  }
+  if (i + 1 >= nBytes)
+    i = nBytes; // Truncated file, missing end of image
+  if (found != expected)
+    return 0;
+
+  scan->segmentOffsets[found] = i;
+  scan->segmentCount = found;
+  return i;
+}
+
+// Markers
+
+Grr_u32 _Grr_jpegReadU16(const Grr_byte *bytes) {
+  return ((Grr_u32)bytes[0] << 8) | bytes[1];
+}
+
+Grr_bool _Grr_jpegParseQuantTables(_GrrJPEG *jpeg, const Grr_byte *bytes,
+                                   size_t nBytes) {
+  size_t i = 0;
+  while (i < nBytes) {
+    Grr_u32 precision = bytes[i] >> 4, table = bytes[i] & 15;
+    size_t tableBytes = (precision ? 128 : 64);
+    if (precision > 1 || table > 3 || i + 1 + tableBytes > nBytes) {
+      GRR_LOG_ERROR("JPEG: invalid quantization table\n");
+      return false;
+    }
+    i++;
+    for (Grr_u32 k = 0; k < 64; k++) {
+      jpeg->quantTables[table][jpegZigzag[k]] =
+          (Grr_u16)(precision ? _Grr_jpegReadU16(bytes + i + k * 2)
+                              : bytes[i + k]);
+    }
+    jpeg->quantDefined[table] = true;
+    i += tableBytes;
+  }
+  return true;
+}
+
+Grr_bool _Grr_jpegParseHuffmanTables(_GrrJPEG *jpeg, const Grr_byte *bytes,
+                                     size_t nBytes) {
+  size_t i = 0;
+  while (i < nBytes) {
+    Grr_u32 tableClass = bytes[i] >> 4, table = bytes[i] & 15;
+    if (tableClass > 1 || table > 3 || i + 17 > nBytes) {
+      GRR_LOG_ERROR("JPEG: invalid Huffman table\n");
+      return false;
+    }
+    const Grr_byte *counts = bytes + i + 1;
+    Grr_u32 symbolCount = 0;
+    for (Grr_u32 length = 0; length < 16; length++)
+      symbolCount += counts[length];
+    i += 17;
+    if (symbolCount > 256 || i + symbolCount > nBytes) {
+      GRR_LOG_ERROR("JPEG: invalid Huffman table\n");
+      return false;
+    }
+
+    _GrrJPEGHuffman *huffman =
+        (tableClass ? &jpeg->acTables[table] : &jpeg->dcTables[table]);
+    if (!_Grr_jpegBuildHuffman(huffman, counts, bytes + i)) {
+      GRR_LOG_ERROR("JPEG: invalid Huffman code lengths\n");
+      return false;
+    }
+    i += symbolCount;
+  }
+  return true;
+}
+
+Grr_bool _Grr_jpegParseFrame(_GrrJPEG *jpeg, const Grr_byte *bytes,
+                             size_t nBytes) {
+  if (jpeg->frame || nBytes < 6) {
+    GRR_LOG_ERROR("JPEG: invalid frame header\n");
+    return false;
+  }
+  Grr_u32 precision = bytes[0];
+  jpeg->height = _Grr_jpegReadU16(bytes + 1);
+  jpeg->width = _Grr_jpegReadU16(bytes + 3);
+  jpeg->componentCount = bytes[5];
+  if (precision != 8 || jpeg->width == 0 || jpeg->height == 0 ||
+      (jpeg->componentCount != 1 && jpeg->componentCount != 3) ||
+      nBytes < 6 + jpeg->componentCount * 3) {
+    GRR_LOG_ERROR("JPEG: unsupported frame (%u-bit, %ux%u, %u components)\n",
+                  precision, jpeg->width, jpeg->height, jpeg->componentCount);
+    return false;
+  }
+
+  jpeg->hMax = jpeg->vMax = 1;
+  for (Grr_u32 i = 0; i < jpeg->componentCount; i++) {
+    _GrrJPEGComponent *component = &jpeg->components[i];
+    const Grr_byte *specification = bytes + 6 + i * 3;
+    component->id = specification[0];
+    component->h = specification[1] >> 4;
+    component->v = specification[1] & 15;
+    component->quantTable = specification[2];
+    if (component->h < 1 || component->h > 4 || component->v < 1 ||
+        component->v > 4 || component->quantTable > 3) {
+      GRR_LOG_ERROR("JPEG: invalid component %u\n", component->id);
+      return false;
+    }
+    jpeg->hMax = (component->h > jpeg->hMax ? component->h : jpeg->hMax);
+    jpeg->vMax = (component->v > jpeg->vMax ? component->v : jpeg->vMax);
+  }
+
+  jpeg->mcusPerLine = (jpeg->width + 8 * jpeg->hMax - 1) / (8 * jpeg->hMax);
+  jpeg->mcusPerColumn = (jpeg->height + 8 * jpeg->vMax - 1) / (8 * jpeg->vMax);
+  for (Grr_u32 i = 0; i < jpeg->componentCount; i++) {
+    _GrrJPEGComponent *component = &jpeg->components[i];
+    component->width =
+        (jpeg->width * component->h + jpeg->hMax - 1) / jpeg->hMax;
+    component->height =
+        (jpeg->height * component->v + jpeg->vMax - 1) / jpeg->vMax;
+    component->blocksPerLine = jpeg->mcusPerLine * component->h;
+    component->blocksPerColumn = jpeg->mcusPerColumn * component->v;
+    component->coefficients = (Grr_i16 *)calloc(
+        (size_t)component->blocksPerLine * component->blocksPerColumn * 64,
+        sizeof(Grr_i16));
+    if (NULL == component->coefficients) {
+      GRR_LOG_ERROR("JPEG: failed to allocate memory for coefficients\n");
+      return false;
+    }
+  }
+  jpeg->frame = true;
+  return true;
+}
+
+// Parses a scan header and decodes its entropy coded data. Returns the
+// number of bytes (header and data) consumed, 0 on failure
+size_t _Grr_jpegDecodeScan(_GrrJPEG *jpeg, const Grr_byte *bytes,
+                           size_t nBytes) {
+  size_t headerBytes = _Grr_jpegReadU16(bytes);
+  _GrrJPEGScan scan = {0};
+  scan.jpeg = jpeg;
+  scan.componentCount = (nBytes > 2 ? bytes[2] : 0);
+  if (!jpeg->frame || scan.componentCount < 1 ||
+      scan.componentCount > jpeg->componentCount ||
+      headerBytes != 6 + 2 * scan.componentCount || headerBytes > nBytes) {
+    GRR_LOG_ERROR("JPEG: invalid scan header\n");
+    return 0;
+  }
+
+  const Grr_byte *specification = bytes + 3 + scan.componentCount * 2;
+  scan.spectralStart = specification[0];
+  scan.spectralEnd = specification[1];
+  scan.approximationHigh = specification[2] >> 4;
+  scan.approximationLow = specification[2] & 15;
+  Grr_bool dcScan = (scan.spectralStart == 0);
+  if (jpeg->progressive
+          ? (scan.spectralEnd > 63 || scan.spectralStart > scan.spectralEnd ||
+             (dcScan && scan.spectralEnd != 0) ||
+             (!dcScan && scan.componentCount != 1) ||
+             scan.approximationLow > 13)
+          : (scan.spectralStart != 0 || scan.spectralEnd != 63 ||
+             scan.approximationHigh != 0 || scan.approximationLow != 0)) {
+    GRR_LOG_ERROR("JPEG: invalid spectral selection or approximation\n");
+    return 0;
+  }
+
+  for (Grr_u32 i = 0; i < scan.componentCount; i++) {
+    Grr_u32 id = bytes[3 + i * 2], tables = bytes[4 + i * 2];
+    Grr_u32 c = 0;
+    while (c < jpeg->componentCount && jpeg->components[c].id != id)
+      c++;
+    Grr_bool needsDC = dcScan && scan.approximationHigh == 0;
+    Grr_bool needsAC = scan.spectralEnd > 0;
+    if (c == jpeg->componentCount || (tables >> 4) > 3 || (tables & 15) > 3 ||
+        (needsDC && !jpeg->dcTables[tables >> 4].defined) ||
+        (needsAC && !jpeg->acTables[tables & 15].defined)) {
+      GRR_LOG_ERROR("JPEG: invalid scan component %u\n", id);
+      return 0;
+    }
+    scan.components[i] = c;
+    scan.dcTables[i] = &jpeg->dcTables[tables >> 4];
+    scan.acTables[i] = &jpeg->acTables[tables & 15];
+  }
+
+  // Non-interleaved scans code the component's blocks, not whole MCUs
+  if (scan.componentCount == 1) {
+    const _GrrJPEGComponent *component = &jpeg->components[scan.components[0]];
+    scan.mcusPerLine = (component->width + 7) / 8;
+    scan.mcuCount = scan.mcusPerLine * ((component->height + 7) / 8);
+  } else {
+    scan.mcusPerLine = jpeg->mcusPerLine;
+    scan.mcuCount = jpeg->mcusPerLine * jpeg->mcusPerColumn;
+  }
+  scan.mcusPerSegment =
+      (jpeg->restartInterval ? jpeg->restartInterval : scan.mcuCount);
+
+  Grr_u32 segmentCount =
+      (scan.mcuCount + scan.mcusPerSegment - 1) / scan.mcusPerSegment;
+  scan.segmentOffsets =
+      (size_t *)malloc((segmentCount + 1) * sizeof(size_t));
+  if (NULL == scan.segmentOffsets) {
+    GRR_LOG_ERROR("JPEG: failed to allocate memory for segments\n");
+    return 0;
+  }
+  scan.data = bytes + headerBytes;
+  size_t dataBytes = _Grr_jpegFindSegments(&scan, nBytes - headerBytes);
+  if (dataBytes == 0) {
+    GRR_LOG_ERROR("JPEG: restart markers do not match the restart interval\n");
+    free(scan.segmentOffsets);
+    return 0;
+  }
+
+  Grr_parallelFor(scan.segmentCount, _Grr_jpegDecodeSegment, &scan);
+  free(scan.segmentOffsets);
+  return (scan.failed ? 0 : headerBytes + dataBytes);
+}
+
+// IDCT
+
+void _Grr_jpegInitializeIDCTBasis() {
+  if (jpegIDCTBasisInitialized)
+    return;
+  for (Grr_u32 n = 0; n < 8; n++)
+    for (Grr_u32 k = 0; k < 8; k++)
+      jpegIDCTBasis[n][k] = (k == 0 ? sqrtf(0.5f) : 1.0f) * 0.5f *
+                            cosf((2 * n + 1) * k * 3.14159265f / 16.0f);
+  jpegIDCTBasisInitialized = true;
+}
+
+// 1D IDCT of 4 columns: outputs n and 7 - n share the even (symmetric) and
+// odd (antisymmetric) halves of the basis
+void _Grr_jpegIDCT1D(GrrF32x4 *values) {
+  GrrF32x4 input[8];
+  memcpy(input, values, sizeof(input));
+  for (Grr_u32 n = 0; n < 4; n++) {
+    GrrF32x4 even = Grr_f32x4Splat(0.0f);
+    GrrF32x4 odd = Grr_f32x4Splat(0.0f);
+    for (Grr_u32 k = 0; k < 8; k += 2) {
+      even = Grr_f32x4Add(
+          even, Grr_f32x4Mul(input[k], Grr_f32x4Splat(jpegIDCTBasis[n][k])));
+      odd = Grr_f32x4Add(odd, Grr_f32x4Mul(input[k + 1],
+                                           Grr_f32x4Splat(
+                                               jpegIDCTBasis[n][k + 1])));
+    }
+    values[n] = Grr_f32x4Add(even, odd);
+    values[7 - n] = Grr_f32x4Sub(even, odd);
+  }
+}
+
+// 8x8 block as [row][left/right half] vectors
+void _Grr_jpegTranspose(GrrF32x4 block[8][2]) {
+  GrrF32x4 *halves[4][4] = {
+      {&block[0][0], &block[1][0], &block[2][0], &block[3][0]},
+      {&block[0][1], &block[1][1], &block[2][1], &block[3][1]},
+      {&block[4][0], &block[5][0], &block[6][0], &block[7][0]},
+      {&block[4][1], &block[5][1], &block[6][1], &block[7][1]}};
+  for (Grr_u32 i = 0; i < 4; i++)
+    Grr_f32x4Transpose(halves[i][0], halves[i][1], halves[i][2],
+                       halves[i][3]);
+  for (Grr_u32 i = 0; i < 4; i++) {
+    GrrF32x4 swap = block[i][1];
+    block[i][1] = block[4 + i][0];
+    block[4 + i][0] = swap;
+  }
+}
+
+void _Grr_jpegIDCT(const Grr_i16 *coefficients, const Grr_u16 *quant,
+                   Grr_byte *samples, Grr_u32 stride) {
+  GrrF32x4 block[8][2];
+  GrrF32x4 columns[8];
+  Grr_f32 dequantized[4];
+  for (Grr_u32 r = 0; r < 8; r++) {
+    for (Grr_u32 half = 0; half < 2; half++) {
+      for (Grr_u32 i = 0; i < 4; i++) {
+        Grr_u32 k = r * 8 + half * 4 + i;
+        dequantized[i] = (Grr_f32)coefficients[k] * quant[k];
+      }
+      block[r][half] = Grr_f32x4Load(dequantized);
+    }
+  }
+
+  // Columns, then rows (transposed)
+  for (Grr_u32 pass = 0; pass < 2; pass++) {
+    for (Grr_u32 half = 0; half < 2; half++) {
+      for (Grr_u32 r = 0; r < 8; r++)
+        columns[r] = block[r][half];
+      _Grr_jpegIDCT1D(columns);
+      for (Grr_u32 r = 0; r < 8; r++)
+        block[r][half] = columns[r];
+    }
+    _Grr_jpegTranspose(block);
+  }
+
+  const GrrF32x4 shift = Grr_f32x4Splat(128.0f);
+  const GrrF32x4 lo = Grr_f32x4Splat(0.0f), hi = Grr_f32x4Splat(255.0f);
+  Grr_i32 values[4];
+  for (Grr_u32 r = 0; r < 8; r++) {
+    for (Grr_u32 half = 0; half < 2; half++) {
+      GrrF32x4 v = Grr_f32x4Add(block[r][half], shift);
+      v = Grr_f32x4Min(Grr_f32x4Max(v, lo), hi);
+      Grr_i32x4Store(values, Grr_f32x4RoundToI32(v));
+      for (Grr_u32 i = 0; i < 4; i++)
+        samples[r * stride + half * 4 + i] = (Grr_byte)values[i];
+    }
+  }
+}
+
+// Dequantizes and transforms one row of blocks, rows of all components are
+// numbered one after the other
+void _Grr_jpegTransformRow(void *data, Grr_u32 row, Grr_u32 threadIndex) {
+  const _GrrJPEG *jpeg = (const _GrrJPEG *)data;
+  Grr_u32 c = 0;
+  while (row >= jpeg->components[c].blocksPerColumn)
+    row -= jpeg->components[c++].blocksPerColumn;
+
+  const _GrrJPEGComponent *component = &jpeg->components[c];
+  Grr_u32 stride = component->blocksPerLine * 8;
+  for (Grr_u32 bx = 0; bx < component->blocksPerLine; bx++)
+    _Grr_jpegIDCT(component->coefficients +
+                      ((size_t)row * component->blocksPerLine + bx) * 64,
+                  jpeg->quantTables[component->quantTable],
+                  component->samples + (size_t)row * 8 * stride + bx * 8,
+                  stride);
+}
+
+// Color conversion
+
+typedef struct _GrrJPEGOutput {
+  const _GrrJPEG *jpeg;
+  Grr_byte *rgba;
+  // Horizontal upsampling: samples x0, x1 and weight of x1 per output pixel
+  // (rounded up to a multiple of 4)
+  Grr_u32 *x0[GRR_JPEG_MAX_COMPONENTS];
+  Grr_u32 *x1[GRR_JPEG_MAX_COMPONENTS];
+  Grr_f32 *wx[GRR_JPEG_MAX_COMPONENTS];
+} _GrrJPEGOutput;
+
+// Centered sample position of an output pixel at a lower resolution
+Grr_f32 _Grr_jpegSamplePosition(Grr_u32 x, Grr_u32 factor, Grr_u32 maxFactor,
+                                Grr_u32 size, Grr_u32 *x0, Grr_u32 *x1) {
+  Grr_f32 position = ((Grr_f32)x + 0.5f) * factor / maxFactor - 0.5f;
+  position = fminf(fmaxf(position, 0.0f), (Grr_f32)(size - 1));
+  *x0 = (Grr_u32)position;
+  *x1 = (*x0 + 1 < size ? *x0 + 1 : *x0);
+  return position - (Grr_f32)*x0;
+}
+
+void _Grr_jpegConvertRow(void *data, Grr_u32 y, Grr_u32 threadIndex) {
+  const _GrrJPEGOutput *output = (const _GrrJPEGOutput *)data;
+  const _GrrJPEG *jpeg = output->jpeg;
+  const Grr_byte *rows[GRR_JPEG_MAX_COMPONENTS][2];
+  GrrF32x4 wy[GRR_JPEG_MAX_COMPONENTS];
+  for (Grr_u32 c = 0; c < jpeg->componentCount; c++) {
+    const _GrrJPEGComponent *component = &jpeg->components[c];
+    Grr_u32 y0, y1;
+    wy[c] = Grr_f32x4Splat(_Grr_jpegSamplePosition(
+        y, component->v, jpeg->vMax, component->height, &y0, &y1));
+    size_t stride = (size_t)component->blocksPerLine * 8;
+    rows[c][0] = component->samples + y0 * stride;
+    rows[c][1] = component->samples + y1 * stride;
+  }
+
+  Grr_bool ycbcr = (jpeg->componentCount == 3 && jpeg->adobeTransform != 0);
+  const GrrF32x4 half = Grr_f32x4Splat(128.0f);
+  const GrrF32x4 lo = Grr_f32x4Splat(0.0f), hi = Grr_f32x4Splat(255.0f);
+  Grr_byte *out = output->rgba + (size_t)y * jpeg->width * 4;
+  Grr_f32 s00[4], s01[4], s10[4], s11[4]; // Samples around 4 pixels
+  Grr_i32 channels[3][4];
+
+  for (Grr_u32 x = 0; x < jpeg->width; x += 4) {
+    GrrF32x4 values[GRR_JPEG_MAX_COMPONENTS];
+    for (Grr_u32 k = 0; k < jpeg->componentCount; k++) {
+      const Grr_u32 *x0 = output->x0[k] + x, *x1 = output->x1[k] + x;
+      for (Grr_u32 i = 0; i < 4; i++) {
+        s00[i] = rows[k][0][x0[i]];
+        s01[i] = rows[k][0][x1[i]];
+        s10[i] = rows[k][1][x0[i]];
+        s11[i] = rows[k][1][x1[i]];
+      }
+      GrrF32x4 wx = Grr_f32x4Load(output->wx[k] + x);
+      GrrF32x4 top = Grr_f32x4Load(s00), bottom = Grr_f32x4Load(s10);
+      top = Grr_f32x4Add(
+          top, Grr_f32x4Mul(Grr_f32x4Sub(Grr_f32x4Load(s01), top), wx));
+      bottom = Grr_f32x4Add(
+          bottom, Grr_f32x4Mul(Grr_f32x4Sub(Grr_f32x4Load(s11), bottom), wx));
+      values[k] = Grr_f32x4Add(
+          top, Grr_f32x4Mul(Grr_f32x4Sub(bottom, top), wy[k]));
+    }
+
+    GrrF32x4 rgb[3];
+    if (jpeg->componentCount == 1) {
+      rgb[0] = rgb[1] = rgb[2] = values[0];
+    } else if (ycbcr) { // JFIF (full range BT.601)
+      GrrF32x4 cb = Grr_f32x4Sub(values[1], half);
+      GrrF32x4 cr = Grr_f32x4Sub(values[2], half);
+      rgb[0] = Grr_f32x4Add(values[0],
+                            Grr_f32x4Mul(cr, Grr_f32x4Splat(1.402f)));
+      rgb[1] = Grr_f32x4Sub(
+          values[0],
+          Grr_f32x4Add(Grr_f32x4Mul(cb, Grr_f32x4Splat(0.344136f)),
+                       Grr_f32x4Mul(cr, Grr_f32x4Splat(0.714136f))));
+      rgb[2] = Grr_f32x4Add(values[0],
+                            Grr_f32x4Mul(cb, Grr_f32x4Splat(1.772f)));
+    } else {
+      rgb[0] = values[0], rgb[1] = values[1], rgb[2] = values[2];
+    }
+    for (Grr_u32 k = 0; k < 3; k++)
+      Grr_i32x4Store(channels[k], Grr_f32x4RoundToI32(Grr_f32x4Min(
+                                      Grr_f32x4Max(rgb[k], lo), hi)));
+
+    Grr_u32 count = (jpeg->width - x < 4 ? jpeg->width - x : 4);
+    for (Grr_u32 i = 0; i < count; i++) {
+      Grr_byte *pixel = out + (x + i) * 4;
+      pixel[0] = (Grr_byte)channels[0][i];
+      pixel[1] = (Grr_byte)channels[1][i];
+      pixel[2] = (Grr_byte)channels[2][i];
+      pixel[3] = 255;
+    }
+  }
+}
+
+// Transforms all blocks and converts them to RGBA8
+Grr_byte *_Grr_jpegOutput(_GrrJPEG *jpeg) {
+  Grr_u32 blockRows = 0;
+  for (Grr_u32 c = 0; c < jpeg->componentCount; c++) {
+    _GrrJPEGComponent *component = &jpeg->components[c];
+    if (!jpeg->quantDefined[component->quantTable]) {
+      GRR_LOG_ERROR("JPEG: missing quantization table %u\n",
+                    component->quantTable);
+      return NULL;
+    }
+    component->samples = (Grr_byte *)malloc(
+        (size_t)component->blocksPerLine * component->blocksPerColumn * 64);
+    if (NULL == component->samples) {
+      GRR_LOG_ERROR("JPEG: failed to allocate memory for samples\n");
+      return NULL;
+    }
+    blockRows += component->blocksPerColumn;
+  }
+  _Grr_jpegInitializeIDCTBasis();
+  Grr_parallelFor(blockRows, _Grr_jpegTransformRow, jpeg);
+
+  _GrrJPEGOutput output = {0};
+  output.jpeg = jpeg;
+  output.rgba = (Grr_byte *)malloc((size_t)jpeg->width * jpeg->height * 4);
+  Grr_u32 paddedWidth = (jpeg->width + 3) & ~3u;
+  Grr_bool allocated = (NULL != output.rgba);
+  for (Grr_u32 c = 0; allocated && c < jpeg->componentCount; c++) {
+    output.x0[c] = (Grr_u32 *)malloc(paddedWidth * sizeof(Grr_u32));
+    output.x1[c] = (Grr_u32 *)malloc(paddedWidth * sizeof(Grr_u32));
+    output.wx[c] = (Grr_f32 *)malloc(paddedWidth * sizeof(Grr_f32));
+    allocated = output.x0[c] && output.x1[c] && output.wx[c];
+    for (Grr_u32 x = 0; allocated && x < paddedWidth; x++)
+      output.wx[c][x] = _Grr_jpegSamplePosition(
+          x, jpeg->components[c].h, jpeg->hMax, jpeg->components[c].width,
+          &output.x0[c][x], &output.x1[c][x]);
+  }
+
+  if (allocated) {
+    Grr_parallelFor(jpeg->height, _Grr_jpegConvertRow, &output);
+  } else {
+    GRR_LOG_ERROR("JPEG: failed to allocate memory for output\n");
+    free(output.rgba);
+    output.rgba = NULL;
+  }
+  for (Grr_u32 c = 0; c < jpeg->componentCount; c++) {
+    free(output.x0[c]);
+    free(output.x1[c]);
+    free(output.wx[c]);
+  }
+  return output.rgba;
+}
+
+Grr_byte *Grr_decodeJPEG(const Grr_byte *bytes, size_t nBytes, Grr_u32 *w,
+                         Grr_u32 *h) {
+  if (nBytes < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+    GRR_LOG_ERROR("JPEG: missing start of image marker\n");
+    return NULL;
+  }
+
+  _GrrJPEG *jpeg = (_GrrJPEG *)calloc(1, sizeof(_GrrJPEG));
+  if (NULL == jpeg) {
+    GRR_LOG_ERROR("JPEG: failed to allocate decoder\n");
+    return NULL;
+  }
+  jpeg->adobeTransform = -1;
+
+  Grr_bool ok = true, end = false;
+  size_t position = 2;
+  while (ok && !end) {
+    // Markers may be preceded by fill bytes
+    while (position < nBytes && bytes[position] == 0xFF &&
+           position + 1 < nBytes && bytes[position + 1] == 0xFF)
+      position++;
+    if (position + 2 > nBytes || bytes[position] != 0xFF) {
+      GRR_LOG_ERROR("JPEG: expected marker at %zu\n", position);
+      ok = false;
+      break;
+    }
+    Grr_u32 marker = bytes[position + 1];
+    position += 2;
+    if (marker == 0xD9) { // End of image
+      end = true;
+      break;
+    }
+    if (marker >= 0xD0 && marker <= 0xD7) // Stray restart marker
+      continue;
+
+    if (position + 2 > nBytes || _Grr_jpegReadU16(bytes + position) < 2 ||
+        position + _Grr_jpegReadU16(bytes + position) > nBytes) {
+      GRR_LOG_ERROR("JPEG: truncated marker segment (0x%02x)\n", marker);
+      ok = false;
+      break;
+    }
+    size_t length = _Grr_jpegReadU16(bytes + position);
+    const Grr_byte *segment = bytes + position + 2;
+
+    switch (marker) {
+    case 0xC0: // Baseline
+    case 0xC1: // Extended sequential, Huffman
+    case 0xC2: // Progressive, Huffman
+      jpeg->progressive = (marker == 0xC2);
+      ok = _Grr_jpegParseFrame(jpeg, segment, length - 2);
+      break;
+    case 0xC4:
+      ok = _Grr_jpegParseHuffmanTables(jpeg, segment, length - 2);
+      break;
+    case 0xDB:
+      ok = _Grr_jpegParseQuantTables(jpeg, segment, length - 2);
+      break;
+    case 0xDD:
+      if (length != 4) {
+        GRR_LOG_ERROR("JPEG: invalid restart interval\n");
+        ok = false;
+      }
+      jpeg->restartInterval = _Grr_jpegReadU16(segment);
+      break;
+    case 0xEE: // Adobe
+      if (length >= 14 && 0 == memcmp(segment, "Adobe", 5))
+        jpeg->adobeTransform = segment[11];
+      break;
+    case 0xDA: {
+      size_t scanBytes =
+          _Grr_jpegDecodeScan(jpeg, bytes + position, nBytes - position);
+      ok = (scanBytes != 0);
+      position += scanBytes;
+      continue;
+    }
+    default:
+      if ((marker >= 0xC3 && marker <= 0xCF) || marker == 0xDC) {
+        GRR_LOG_ERROR("JPEG: unsupported coding process (0x%02x)\n", marker);
+        ok = false;
+      }
+      break; // APPn, COM...
+    }
+    position += length;
+  }
+
+  Grr_byte *rgba = NULL;
+  if (ok && !jpeg->frame)
+    GRR_LOG_ERROR("JPEG: missing frame header\n");
+  else if (ok)
+    rgba = _Grr_jpegOutput(jpeg);
+  if (NULL != rgba) {
+    *w = jpeg->width;
+    *h = jpeg->height;
+  }
+
+  for (Grr_u32 c = 0; c < GRR_JPEG_MAX_COMPONENTS; c++) {
+    free(jpeg->components[c].coefficients);
+    free(jpeg->components[c].samples);
+  }
+  free(jpeg);
+  return rgba;
+}
+
+Grr_byte *Grr_loadJPEG(const Grr_string path, Grr_u32 *nReadBytes, Grr_u32 *w,
+                       Grr_u32 *h) {
+  *nReadBytes = 0;
+  size_t nBytes;
+  Grr_byte *bytes = Grr_readBytesFromFile(path, &nBytes);
+  if (NULL == bytes)
+    return NULL;
+
+  Grr_byte *rgba = Grr_decodeJPEG(bytes, nBytes, w, h);
+  free(bytes);
+  if (NULL == rgba) {
+    GRR_LOG_ERROR("JPEG: failed to decode %s\n", path);
+    return NULL;
+  }
+  *nReadBytes = *w * *h * 4;
+  return rgba;
+}
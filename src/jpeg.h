@@ -0,0 +1,32 @@
+#ifndef GRR_JPEG_H
+#define GRR_JPEG_H
+
+#include "jobs.h"
+#include "logging.h"
+#include "math/simd.h"
+#include "types.h"
+#include "utils.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// JPEG (ITU T.81): https://www.w3.org/Graphics/JPEG/itu-t81.pdf
+
+// * Baseline and progressive Huffman coded frames, 8-bit samples, 1
+// (grayscale) or 3 (YCbCr, or RGB with an Adobe transform of 0) components
+// with any sampling factors. Arithmetic coding, lossless and hierarchical
+// frames are not supported.
+// * Entropy coded segments between restart markers are decoded in parallel on
+// the job system, as are the IDCT and the color conversion (rows of blocks /
+// rows of pixels).
+// * Chroma is upsampled with a (centered) linear filter.
+
+// Decodes JPEG file bytes to RGBA8, returns NULL on failure
+Grr_byte *Grr_decodeJPEG(const Grr_byte *bytes, size_t nBytes, Grr_u32 *w,
+                         Grr_u32 *h);
+
+// Same interface as Grr_loadPNG
+Grr_byte *Grr_loadJPEG(const Grr_string path, Grr_u32 *nReadBytes, Grr_u32 *w,
+                       Grr_u32 *h);
+
+#endif
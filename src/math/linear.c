@@ -10,7 +10,7 @@ void Grr_normalize3(GrrVector3 *v) {
 void Grr_scale3(GrrVector3 *v, Grr_f32 s) {
   v->x *= s;
   v->y *= s;
-  v->y *= s;
+  v->z *= s;
 }
 
 void Grr_setLength3(GrrVector3 *v, Grr_f32 length) {
@@ -32,22 +32,93 @@ void Grr_identityMatrix(GrrMatrix4x4 *matrix) {
   matrix->data[15] = 1.0f;
 }
 
+// c = a * b
+void Grr_multiplyMatrix(const GrrMatrix4x4 *a, const GrrMatrix4x4 *b,
+                        GrrMatrix4x4 *c) {
+  GrrF32x4 columns[4];
+  for (Grr_u32 k = 0; k < 4; k++)
+    columns[k] = Grr_f32x4Load(&a->data[k * 4]);
+
+  // Column j of c is a linear combination of the columns of a
+  for (Grr_u32 j = 0; j < 4; j++) {
+    GrrF32x4 column = Grr_f32x4Mul(columns[0], Grr_f32x4Splat(b->data[j * 4]));
+    for (Grr_u32 k = 1; k < 4; k++)
+      column = Grr_f32x4Add(
+          column, Grr_f32x4Mul(columns[k], Grr_f32x4Splat(b->data[j * 4 + k])));
+    Grr_f32x4Store(&c->data[j * 4], column);
+  }
+}
+
 // Matrix to transform from local space (mesh) to world space
 // void Grr_modelMatrix(GrrMesh *mesh, GrrMatrix4x4 *matrix) {}
 
 // Transform from world space to camera's view space
-// void Grr_viewMatrix(GrrCamera *camera, GrrMatrix4x4 *matrix) {}
+void Grr_viewMatrix(GrrCamera *camera, GrrMatrix4x4 *matrix) {
+  // Camera axes in world space
+  GrrVector3 z = camera->direction;
+  Grr_scale3(&z, -1.0f);
+  Grr_normalize3(&z);
+  GrrVector3 x;
+  Grr_crossProduct(&camera->upHint, &z, &x);
+  Grr_normalize3(&x);
+  GrrVector3 y;
+  Grr_crossProduct(&z, &x, &y);
+
+  // Rows are the axes, translation moves the origin to the camera
+  const GrrVector3 *axes[3] = {&x, &y, &z};
+  const GrrVector3 *o = &camera->origin;
+  memset(matrix->data, 0, sizeof(matrix->data));
+  for (Grr_u32 i = 0; i < 3; i++) {
+    matrix->data[i] = axes[i]->x;
+    matrix->data[4 + i] = axes[i]->y;
+    matrix->data[8 + i] = axes[i]->z;
+    matrix->data[12 + i] =
+        -(axes[i]->x * o->x + axes[i]->y * o->y + axes[i]->z * o->z);
+  }
+  matrix->data[15] = 1.0f;
+}
 
 // Projects vertices to clip space and performs perspective divide
 // Clip space uses left-to-right x-axis, downwards y-axis and the z-axis goes
-// from near clipping plane to far clipping plane
+// from near clipping plane to far clipping plane. w is the (positive) distance
+// in front of the camera, as Vulkan clipping expects
 void Grr_perspectiveProjectionMatrix(GrrCamera *camera, GrrMatrix4x4 *matrix) {
   memset(matrix->data, 0, sizeof(matrix->data));
   Grr_f32 t = tanf(camera->yFOV * 0.5);
-  matrix->data[0] = -1.0 / (camera->aspectRatio * t);
+  matrix->data[0] = 1.0 / (camera->aspectRatio * t);
   matrix->data[5] = -1.0 / t;
-  matrix->data[10] = -camera->zFar / (camera->zNear - camera->zFar);
-  matrix->data[11] = 1.0;
+  matrix->data[10] = camera->zFar / (camera->zNear - camera->zFar);
+  matrix->data[11] = -1.0;
   matrix->data[14] =
-      (-camera->zNear * camera->zFar) / (camera->zNear - camera->zFar);
-}
\ No newline at end of file
+      (camera->zNear * camera->zFar) / (camera->zNear - camera->zFar);
+}
+
+// Rows of the matrix combined as in Gribb & Hartmann, "Fast Extraction of
+// Viewing Frustum Planes from the World-View-Projection Matrix"
+void Grr_frustumPlanes(const GrrMatrix4x4 *viewProjection,
+                       GrrVector4 planes[6]) {
+  const Grr_f32 *m = viewProjection->data;
+  Grr_f32 rows[4][4];
+  for (Grr_u32 i = 0; i < 4; i++)
+    for (Grr_u32 j = 0; j < 4; j++)
+      rows[i][j] = m[j * 4 + i];
+
+  // Row 3 +/- row 0 (x), row 3 +/- row 1 (y), row 2 and row 3 - row 2 (z)
+  const Grr_u32 axes[6] = {0, 0, 1, 1, 2, 2};
+  const Grr_f32 signs[6] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f};
+  Grr_f32 plane[4];
+  for (Grr_u32 p = 0; p < 6; p++) {
+    for (Grr_u32 j = 0; j < 4; j++) {
+      plane[j] = signs[p] * rows[axes[p]][j];
+      if (p != 4) // Near plane is z >= 0, not z >= -w
+        plane[j] += rows[3][j];
+    }
+    Grr_f32 length =
+        sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    Grr_f32 inverse = length > 0.0f ? 1.0f / length : 0.0f;
+    planes[p].x = plane[0] * inverse;
+    planes[p].y = plane[1] * inverse;
+    planes[p].z = plane[2] * inverse;
+    planes[p].w = plane[3] * inverse;
+  }
+}
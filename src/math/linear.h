@@ -2,6 +2,7 @@
 #define GRR_MATH_H
 
 #include "string.h" // memcpy
+#include "simd.h"
 #include "types.h"
 #include <math.h>
 
@@ -49,6 +50,15 @@ void Grr_scale3(GrrVector3 *v, Grr_f32 s);
 void Grr_setLength3(GrrVector3 *v, Grr_f32 length);
 void Grr_crossProduct(GrrVector3 *v, GrrVector3 *w, GrrVector3 *c);
 void Grr_identityMatrix(GrrMatrix4x4 *matrix);
+void Grr_multiplyMatrix(const GrrMatrix4x4 *a, const GrrMatrix4x4 *b,
+                        GrrMatrix4x4 *c);
+void Grr_viewMatrix(GrrCamera *camera, GrrMatrix4x4 *matrix);
 void Grr_perspectiveProjectionMatrix(GrrCamera *camera, GrrMatrix4x4 *matrix);
 
+// Frustum planes (left, right, bottom, top, near, far) of a view-projection
+// matrix for Vulkan clip space (0 <= z <= w). xyz is the unit normal pointing
+// inside, a point p is inside a plane when dot(xyz, p) + w >= 0
+void Grr_frustumPlanes(const GrrMatrix4x4 *viewProjection,
+                       GrrVector4 planes[6]);
+
 #endif
\ No newline at end of file
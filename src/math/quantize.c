@@ -0,0 +1,189 @@
+#include "quantize.h"
+
+typedef union _GrrF32Bits {
+  Grr_f32 f;
+  Grr_u32 u;
+} _GrrF32Bits;
+
+Grr_u16 Grr_f32ToF16(Grr_f32 f) {
+  _GrrF32Bits bits = {f};
+  Grr_u16 sign = (bits.u >> 16) & 0x8000;
+  Grr_u32 magnitude = bits.u & 0x7FFFFFFF;
+
+  if (magnitude >= 0x7F800000) // Inf or NaN
+    return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x0200 : 0);
+  if (magnitude >= 0x477FF000) // Rounds above largest half: +/- Inf
+    return sign | 0x7C00;
+  if (magnitude < 0x38800000) { // Half subnormal (or zero)
+    bits.u = magnitude;
+    return sign | (Grr_u16)rintf(bits.f * 16777216.0f); // Units of 2^-24
+  }
+
+  // Rebias exponent (127 -> 15) and round mantissa to nearest even
+  magnitude += 0xC8000FFF + ((magnitude >> 13) & 1);
+  return sign | (Grr_u16)(magnitude >> 13);
+}
+
+Grr_f32 Grr_f16ToF32(Grr_u16 h) {
+  Grr_u32 exponent = (h >> 10) & 0x1F;
+  Grr_u32 mantissa = h & 0x3FF;
+  Grr_f32 value;
+  if (exponent == 0)
+    value = ldexpf((Grr_f32)mantissa, -24);
+  else if (exponent == 31)
+    value = (mantissa ? NAN : INFINITY);
+  else
+    value = ldexpf((Grr_f32)(mantissa | 0x400), (Grr_i32)exponent - 25);
+  return (h & 0x8000 ? -value : value);
+}
+
+void Grr_octahedralEncode(const Grr_f32 *vectors, Grr_u32 stride,
+                          Grr_u32 count, Grr_i16 *out, Grr_u32 outStride) {
+  const GrrF32x4 zero = Grr_f32x4Splat(0.0f);
+  const GrrF32x4 one = Grr_f32x4Splat(1.0f);
+  const GrrF32x4 epsilon = Grr_f32x4Splat(1e-20f);
+  const GrrF32x4 snormScale = Grr_f32x4Splat(32767.0f);
+  Grr_i32 x[4], y[4];
+
+  // 4 vectors at a time in SoA form
+  for (Grr_u32 i = 0; i < count; i += 4) {
+    Grr_u32 n = (count - i < 4 ? count - i : 4);
+    GrrF32x4 r[4];
+    for (Grr_u32 j = 0; j < 4; j++) {
+      const Grr_f32 *v = vectors + (size_t)(i + (j < n ? j : 0)) * stride;
+      r[j] = Grr_f32x4Set(v[0], v[1], v[2], 0.0f);
+    }
+    Grr_f32x4Transpose(&r[0], &r[1], &r[2], &r[3]);
+
+    // Project onto the octahedron |x| + |y| + |z| = 1
+    GrrF32x4 l1 = Grr_f32x4Add(
+        Grr_f32x4Add(Grr_f32x4Abs(r[0]), Grr_f32x4Abs(r[1])),
+        Grr_f32x4Abs(r[2]));
+    l1 = Grr_f32x4Max(l1, epsilon);
+    GrrF32x4 px = Grr_f32x4Div(r[0], l1);
+    GrrF32x4 py = Grr_f32x4Div(r[1], l1);
+
+    // Fold the lower hemisphere over the diagonals
+    GrrF32x4 fx = Grr_f32x4CopySign(Grr_f32x4Sub(one, Grr_f32x4Abs(py)), px);
+    GrrF32x4 fy = Grr_f32x4CopySign(Grr_f32x4Sub(one, Grr_f32x4Abs(px)), py);
+    px = Grr_f32x4SelectLess(r[2], zero, fx, px);
+    py = Grr_f32x4SelectLess(r[2], zero, fy, py);
+
+    Grr_i32x4Store(x, Grr_f32x4RoundToI32(Grr_f32x4Mul(px, snormScale)));
+    Grr_i32x4Store(y, Grr_f32x4RoundToI32(Grr_f32x4Mul(py, snormScale)));
+    for (Grr_u32 j = 0; j < n; j++) {
+      out[(size_t)(i + j) * outStride] = (Grr_i16)x[j];
+      out[(size_t)(i + j) * outStride + 1] = (Grr_i16)y[j];
+    }
+  }
+}
+
+void Grr_octahedralDecode(const Grr_i16 *encoded, GrrVector3 *v) {
+  Grr_f32 x = fmaxf(encoded[0] / 32767.0f, -1.0f);
+  Grr_f32 y = fmaxf(encoded[1] / 32767.0f, -1.0f);
+  Grr_f32 z = 1.0f - fabsf(x) - fabsf(y);
+  Grr_f32 t = fmaxf(-z, 0.0f);
+  v->x = x + (x >= 0.0f ? -t : t);
+  v->y = y + (y >= 0.0f ? -t : t);
+  v->z = z;
+  Grr_normalize3(v);
+}
+
+// Loads XYZ of the ith vector, the W lane is unspecified
+GrrF32x4 _Grr_loadVector3(const Grr_f32 *vectors, Grr_u32 i, Grr_u32 count) {
+  const Grr_f32 *v = vectors + (size_t)i * 3;
+  if (i + 1 < count)
+    return Grr_f32x4Load(v); // Safe to read one float past this vector
+  return Grr_f32x4Set(v[0], v[1], v[2], 0.0f);
+}
+
+void Grr_quantizePositions(Grr_u32 vertexCount, const Grr_f32 *positions,
+                           Grr_u16 *out, Grr_u32 outStride,
+                           GrrVector3 *aabbMin, GrrVector3 *aabbExtent) {
+  // Mesh AABB
+  GrrF32x4 lo = Grr_f32x4Splat(vertexCount ? INFINITY : 0.0f);
+  GrrF32x4 hi = Grr_f32x4Splat(vertexCount ? -INFINITY : 0.0f);
+  for (Grr_u32 i = 0; i < vertexCount; i++) {
+    GrrF32x4 p = _Grr_loadVector3(positions, i, vertexCount);
+    lo = Grr_f32x4Min(lo, p);
+    hi = Grr_f32x4Max(hi, p);
+  }
+  Grr_f32 minimum[4], maximum[4];
+  Grr_f32x4Store(minimum, lo);
+  Grr_f32x4Store(maximum, hi);
+  aabbMin->x = minimum[0];
+  aabbMin->y = minimum[1];
+  aabbMin->z = minimum[2];
+  aabbExtent->x = maximum[0] - minimum[0];
+  aabbExtent->y = maximum[1] - minimum[1];
+  aabbExtent->z = maximum[2] - minimum[2];
+
+  // Positions to UNORM16 within the AABB (flat axes map to 0)
+  GrrF32x4 scale = Grr_f32x4Set(
+      (aabbExtent->x > 0.0f ? 65535.0f / aabbExtent->x : 0.0f),
+      (aabbExtent->y > 0.0f ? 65535.0f / aabbExtent->y : 0.0f),
+      (aabbExtent->z > 0.0f ? 65535.0f / aabbExtent->z : 0.0f), 0.0f);
+  const GrrF32x4 zero = Grr_f32x4Splat(0.0f);
+  const GrrF32x4 unormMax = Grr_f32x4Splat(65535.0f);
+  Grr_i32 q[4];
+  for (Grr_u32 i = 0; i < vertexCount; i++) {
+    GrrF32x4 p = _Grr_loadVector3(positions, i, vertexCount);
+    p = Grr_f32x4Mul(Grr_f32x4Sub(p, lo), scale);
+    p = Grr_f32x4Min(Grr_f32x4Max(p, zero), unormMax);
+    Grr_i32x4Store(q, Grr_f32x4RoundToI32(p));
+    Grr_u16 *position = out + (size_t)i * outStride;
+    position[0] = (Grr_u16)q[0];
+    position[1] = (Grr_u16)q[1];
+    position[2] = (Grr_u16)q[2];
+    position[3] = 65535;
+  }
+}
+
+void Grr_quantizeVertices(Grr_u32 vertexCount, const Grr_f32 *positions,
+                          const Grr_f32 *normals, const Grr_f32 *tangents,
+                          const Grr_f32 *textureCoordinates,
+                          GrrQuantizedVertex *vertices, GrrVector3 *aabbMin,
+                          GrrVector3 *aabbExtent) {
+  memset(vertices, 0, sizeof(GrrQuantizedVertex) * vertexCount);
+
+  // Positions, W stores the tangent handedness
+  const Grr_u32 vertexStride = sizeof(GrrQuantizedVertex) / sizeof(Grr_i16);
+  Grr_quantizePositions(vertexCount, positions, &vertices[0].position[0],
+                        vertexStride, aabbMin, aabbExtent);
+  if (tangents != NULL) {
+    for (Grr_u32 i = 0; i < vertexCount; i++) {
+      if (tangents[(size_t)i * 4 + 3] < 0.0f)
+        vertices[i].position[3] = 0;
+    }
+  }
+
+  // Unit vectors
+  if (normals != NULL)
+    Grr_octahedralEncode(normals, 3, vertexCount, &vertices[0].normal[0],
+                         vertexStride);
+  if (tangents != NULL)
+    Grr_octahedralEncode(tangents, 4, vertexCount, &vertices[0].tangent[0],
+                         vertexStride);
+
+  // Texture coordinates
+  if (textureCoordinates != NULL) {
+    for (Grr_u32 i = 0; i < vertexCount; i++) {
+      vertices[i].textureCoordinates[0] =
+          Grr_f32ToF16(textureCoordinates[(size_t)i * 2]);
+      vertices[i].textureCoordinates[1] =
+          Grr_f32ToF16(textureCoordinates[(size_t)i * 2 + 1]);
+    }
+  }
+}
+
+void Grr_dequantizationMatrix(const GrrVector3 *aabbMin,
+                              const GrrVector3 *aabbExtent,
+                              GrrMatrix4x4 *matrix) {
+  Grr_identityMatrix(matrix);
+  matrix->data[0] = aabbExtent->x;
+  matrix->data[5] = aabbExtent->y;
+  matrix->data[10] = aabbExtent->z;
+  matrix->data[12] = aabbMin->x;
+  matrix->data[13] = aabbMin->y;
+  matrix->data[14] = aabbMin->z;
+}
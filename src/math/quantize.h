@@ -0,0 +1,57 @@
+#ifndef GRR_QUANTIZE_H
+#define GRR_QUANTIZE_H
+
+#include "linear.h"
+#include "simd.h"
+#include "types.h"
+#include <math.h>
+#include <stddef.h>
+
+// Compact vertex layout (20 bytes instead of 48 bytes for the same attributes
+// stored as 32-bit floats)
+typedef struct GrrQuantizedVertex {
+  Grr_u16 position[4]; // UNORM16 XYZ relative to the mesh AABB, W stores the
+                       // tangent handedness (0 is -1, 65535 is +1)
+  Grr_i16 normal[2];   // Octahedral-encoded unit normal (SNORM16)
+  Grr_i16 tangent[2];  // Octahedral-encoded unit tangent (SNORM16)
+  Grr_u16 textureCoordinates[2]; // Half floats
+} GrrQuantizedVertex;
+
+// Positions alone (8 bytes instead of 12), for vertex layouts that stream no
+// other attribute
+typedef struct GrrQuantizedPosition {
+  Grr_u16 position[4]; // UNORM16 XYZ relative to the mesh AABB, W is 65535
+} GrrQuantizedPosition;
+
+// Half float conversion (round to nearest even)
+Grr_u16 Grr_f32ToF16(Grr_f32 f);
+Grr_f32 Grr_f16ToF32(Grr_u16 h);
+
+// Octahedral encoding of count unit vectors read every stride floats. Output
+// is 2 SNORM16 values per vector written every outStride int16s
+void Grr_octahedralEncode(const Grr_f32 *vectors, Grr_u32 stride,
+                          Grr_u32 count, Grr_i16 *out, Grr_u32 outStride);
+void Grr_octahedralDecode(const Grr_i16 *encoded, GrrVector3 *v);
+
+// Quantizes tightly packed positions XYZ to UNORM16 XYZW (W is 65535) within
+// the mesh AABB, written every outStride uint16s. Returns the AABB
+void Grr_quantizePositions(Grr_u32 vertexCount, const Grr_f32 *positions,
+                           Grr_u16 *out, Grr_u32 outStride,
+                           GrrVector3 *aabbMin, GrrVector3 *aabbExtent);
+
+// Quantizes tightly packed vertex attributes (positions XYZ, normals XYZ,
+// tangents XYZW, texture coordinates UV). Attributes other than positions may
+// be NULL. Returns the mesh AABB used for position quantization
+void Grr_quantizeVertices(Grr_u32 vertexCount, const Grr_f32 *positions,
+                          const Grr_f32 *normals, const Grr_f32 *tangents,
+                          const Grr_f32 *textureCoordinates,
+                          GrrQuantizedVertex *vertices, GrrVector3 *aabbMin,
+                          GrrVector3 *aabbExtent);
+
+// Matrix mapping UNORM16 positions back to mesh space, to be folded into the
+// model matrix
+void Grr_dequantizationMatrix(const GrrVector3 *aabbMin,
+                              const GrrVector3 *aabbExtent,
+                              GrrMatrix4x4 *matrix);
+
+#endif
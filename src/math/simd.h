@@ -0,0 +1,288 @@
+#ifndef GRR_SIMD_H
+#define GRR_SIMD_H
+
+#include "types.h"
+#include <math.h>
+
+// 4-wide float/int vectors used by the CPU-side hot loops (asset import,
+// decoding, culling). Maps to SSE2 on x86-64, NEON on Apple Silicon and falls
+// back to plain C elsewhere. Define GRR_SIMD_SCALAR to force the fallback.
+
+#if !defined(GRR_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+#define GRR_SIMD_SSE
+#include <emmintrin.h>
+typedef __m128 GrrF32x4;
+typedef __m128i GrrI32x4;
+#elif !defined(GRR_SIMD_SCALAR) && defined(__ARM_NEON) && defined(__aarch64__)
+#define GRR_SIMD_NEON
+#include <arm_neon.h>
+typedef float32x4_t GrrF32x4;
+typedef int32x4_t GrrI32x4;
+#else
+#ifndef GRR_SIMD_SCALAR
+#define GRR_SIMD_SCALAR
+#endif
+typedef struct GrrF32x4 {
+  Grr_f32 v[4];
+} GrrF32x4;
+typedef struct GrrI32x4 {
+  Grr_i32 v[4];
+} GrrI32x4;
+#endif
+
+#if defined(GRR_SIMD_SCALAR)
+#define _GRR_SIMD_MAP(op)                                                      \
+  GrrF32x4 r;                                                                  \
+  for (Grr_u32 i = 0; i < 4; i++)                                              \
+    r.v[i] = (op);                                                             \
+  return r;
+#endif
+
+static inline GrrF32x4 Grr_f32x4Load(const Grr_f32 *p) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_loadu_ps(p);
+#elif defined(GRR_SIMD_NEON)
+  return vld1q_f32(p);
+#else
+  _GRR_SIMD_MAP(p[i])
+#endif
+}
+
+static inline void Grr_f32x4Store(Grr_f32 *p, GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  _mm_storeu_ps(p, a);
+#elif defined(GRR_SIMD_NEON)
+  vst1q_f32(p, a);
+#else
+  for (Grr_u32 i = 0; i < 4; i++)
+    p[i] = a.v[i];
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Set(Grr_f32 x, Grr_f32 y, Grr_f32 z,
+                                    Grr_f32 w) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_setr_ps(x, y, z, w);
+#elif defined(GRR_SIMD_NEON)
+  Grr_f32 p[4] = {x, y, z, w};
+  return vld1q_f32(p);
+#else
+  GrrF32x4 r = {{x, y, z, w}};
+  return r;
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Splat(Grr_f32 s) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_set1_ps(s);
+#elif defined(GRR_SIMD_NEON)
+  return vdupq_n_f32(s);
+#else
+  _GRR_SIMD_MAP(s)
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Add(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_add_ps(a, b);
+#elif defined(GRR_SIMD_NEON)
+  return vaddq_f32(a, b);
+#else
+  _GRR_SIMD_MAP(a.v[i] + b.v[i])
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Sub(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_sub_ps(a, b);
+#elif defined(GRR_SIMD_NEON)
+  return vsubq_f32(a, b);
+#else
+  _GRR_SIMD_MAP(a.v[i] - b.v[i])
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Mul(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_mul_ps(a, b);
+#elif defined(GRR_SIMD_NEON)
+  return vmulq_f32(a, b);
+#else
+  _GRR_SIMD_MAP(a.v[i] * b.v[i])
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Div(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_div_ps(a, b);
+#elif defined(GRR_SIMD_NEON)
+  return vdivq_f32(a, b);
+#else
+  _GRR_SIMD_MAP(a.v[i] / b.v[i])
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Sqrt(GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_sqrt_ps(a);
+#elif defined(GRR_SIMD_NEON)
+  return vsqrtq_f32(a);
+#else
+  _GRR_SIMD_MAP(sqrtf(a.v[i]))
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Min(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_min_ps(a, b);
+#elif defined(GRR_SIMD_NEON)
+  return vminq_f32(a, b);
+#else
+  _GRR_SIMD_MAP(a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Max(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_max_ps(a, b);
+#elif defined(GRR_SIMD_NEON)
+  return vmaxq_f32(a, b);
+#else
+  _GRR_SIMD_MAP(a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+#endif
+}
+
+static inline GrrF32x4 Grr_f32x4Abs(GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+#elif defined(GRR_SIMD_NEON)
+  return vabsq_f32(a);
+#else
+  _GRR_SIMD_MAP(fabsf(a.v[i]))
+#endif
+}
+
+// Magnitude of a with the sign bit of b
+static inline GrrF32x4 Grr_f32x4CopySign(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  __m128 signMask = _mm_set1_ps(-0.0f);
+  return _mm_or_ps(_mm_andnot_ps(signMask, a), _mm_and_ps(signMask, b));
+#elif defined(GRR_SIMD_NEON)
+  return vbslq_f32(vdupq_n_u32(0x80000000u), b, a);
+#else
+  _GRR_SIMD_MAP(copysignf(a.v[i], b.v[i]))
+#endif
+}
+
+// Per-lane a < b ? ifTrue : ifFalse
+static inline GrrF32x4 Grr_f32x4SelectLess(GrrF32x4 a, GrrF32x4 b,
+                                           GrrF32x4 ifTrue, GrrF32x4 ifFalse) {
+#if defined(GRR_SIMD_SSE)
+  __m128 mask = _mm_cmplt_ps(a, b);
+  return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+#elif defined(GRR_SIMD_NEON)
+  return vbslq_f32(vcltq_f32(a, b), ifTrue, ifFalse);
+#else
+  _GRR_SIMD_MAP(a.v[i] < b.v[i] ? ifTrue.v[i] : ifFalse.v[i])
+#endif
+}
+
+// Bit i is set when lane i of a < b
+static inline Grr_u32 Grr_f32x4LessMask(GrrF32x4 a, GrrF32x4 b) {
+#if defined(GRR_SIMD_SSE)
+  return (Grr_u32)_mm_movemask_ps(_mm_cmplt_ps(a, b));
+#elif defined(GRR_SIMD_NEON)
+  const uint32x4_t bits = {1, 2, 4, 8};
+  return vaddvq_u32(vandq_u32(vcltq_f32(a, b), bits));
+#else
+  Grr_u32 mask = 0;
+  for (Grr_u32 i = 0; i < 4; i++)
+    mask |= (Grr_u32)(a.v[i] < b.v[i]) << i;
+  return mask;
+#endif
+}
+
+// Round to nearest (ties to even) and convert to 32-bit integers
+static inline GrrI32x4 Grr_f32x4RoundToI32(GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  return _mm_cvtps_epi32(a);
+#elif defined(GRR_SIMD_NEON)
+  return vcvtnq_s32_f32(a);
+#else
+  GrrI32x4 r;
+  for (Grr_u32 i = 0; i < 4; i++)
+    r.v[i] = (Grr_i32)rintf(a.v[i]);
+  return r;
+#endif
+}
+
+static inline void Grr_i32x4Store(Grr_i32 *p, GrrI32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  _mm_storeu_si128((__m128i *)p, a);
+#elif defined(GRR_SIMD_NEON)
+  vst1q_s32(p, a);
+#else
+  for (Grr_u32 i = 0; i < 4; i++)
+    p[i] = a.v[i];
+#endif
+}
+
+// Sum of the 4 lanes
+static inline Grr_f32 Grr_f32x4Sum(GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  __m128 pairs = _mm_add_ps(a, _mm_movehl_ps(a, a));
+  return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+#elif defined(GRR_SIMD_NEON)
+  return vaddvq_f32(a);
+#else
+  return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]);
+#endif
+}
+
+// Smallest and largest of the 4 lanes
+static inline Grr_f32 Grr_f32x4MinLane(GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  __m128 pairs = _mm_min_ps(a, _mm_movehl_ps(a, a));
+  return _mm_cvtss_f32(_mm_min_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+#elif defined(GRR_SIMD_NEON)
+  return vminvq_f32(a);
+#else
+  return fminf(fminf(a.v[0], a.v[1]), fminf(a.v[2], a.v[3]));
+#endif
+}
+
+static inline Grr_f32 Grr_f32x4MaxLane(GrrF32x4 a) {
+#if defined(GRR_SIMD_SSE)
+  __m128 pairs = _mm_max_ps(a, _mm_movehl_ps(a, a));
+  return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+#elif defined(GRR_SIMD_NEON)
+  return vmaxvq_f32(a);
+#else
+  return fmaxf(fmaxf(a.v[0], a.v[1]), fmaxf(a.v[2], a.v[3]));
+#endif
+}
+
+// Transpose 4 vectors in place (AoS <-> SoA)
+static inline void Grr_f32x4Transpose(GrrF32x4 *r0, GrrF32x4 *r1, GrrF32x4 *r2,
+                                      GrrF32x4 *r3) {
+#if defined(GRR_SIMD_SSE)
+  _MM_TRANSPOSE4_PS(*r0, *r1, *r2, *r3);
+#elif defined(GRR_SIMD_NEON)
+  float32x4x2_t t01 = vtrnq_f32(*r0, *r1);
+  float32x4x2_t t23 = vtrnq_f32(*r2, *r3);
+  *r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+  *r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+  *r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+  *r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+  GrrF32x4 m[4] = {*r0, *r1, *r2, *r3};
+  for (Grr_u32 i = 0; i < 4; i++) {
+    r0->v[i] = m[i].v[0];
+    r1->v[i] = m[i].v[1];
+    r2->v[i] = m[i].v[2];
+    r3->v[i] = m[i].v[3];
+  }
+#endif
+}
+
+#endif
@@ -0,0 +1,522 @@
+#include "meshopt.h"
+
+#define GRR_MESHOPT_VERTEX_HEADER 0xa0
+#define GRR_MESHOPT_INDEX_HEADER 0xe0
+#define GRR_MESHOPT_SEQUENCE_HEADER 0xd0
+
+#define GRR_MESHOPT_BYTE_GROUP_SIZE 16
+#define GRR_MESHOPT_BYTE_GROUP_DECODE_LIMIT 24 // Largest encoded group
+#define GRR_MESHOPT_VERTEX_BLOCK_BYTES 8192
+#define GRR_MESHOPT_VERTEX_BLOCK_MAX 256
+#define GRR_MESHOPT_TAIL_MAX 32
+
+// Vertex codec
+
+Grr_byte _Grr_meshoptUnzigzag8(Grr_byte v) {
+  return (Grr_byte)(-(v & 1) ^ (v >> 1));
+}
+
+// One group of 16 bytes, stored with 0, 2, 4 or 8 bits per byte. 2 and 4 bit
+// values equal to the largest representable value are escapes for a full
+// byte stored after the packed bits
+const Grr_byte *_Grr_meshoptDecodeBytesGroup(const Grr_byte *data,
+                                             Grr_byte *out, Grr_u32 bitslog2) {
+  switch (bitslog2) {
+  case 0:
+    memset(out, 0, GRR_MESHOPT_BYTE_GROUP_SIZE);
+    return data;
+  case 1:
+  case 2: {
+    Grr_u32 bits = 1u << bitslog2;
+    Grr_u32 escape = (1u << bits) - 1;
+    const Grr_byte *dataVar = data + bits * 2; // After 16 * bits / 8 bytes
+    for (Grr_u32 i = 0; i < GRR_MESHOPT_BYTE_GROUP_SIZE; i++) {
+      Grr_u32 shift = 8 - bits - (i * bits) % 8;
+      Grr_u32 encoded = (data[i * bits / 8] >> shift) & escape;
+      out[i] = (encoded == escape ? *dataVar++ : (Grr_byte)encoded);
+    }
+    return dataVar;
+  }
+  default:
+    memcpy(out, data, GRR_MESHOPT_BYTE_GROUP_SIZE);
+    return data + GRR_MESHOPT_BYTE_GROUP_SIZE;
+  }
+}
+
+const Grr_byte *_Grr_meshoptDecodeBytes(const Grr_byte *data,
+                                        const Grr_byte *end, Grr_byte *out,
+                                        Grr_u32 nBytes) {
+  // 2 bit header per group
+  Grr_u32 headerBytes = (nBytes / GRR_MESHOPT_BYTE_GROUP_SIZE + 3) / 4;
+  if ((size_t)(end - data) < headerBytes)
+    return NULL;
+  const Grr_byte *header = data;
+  data += headerBytes;
+
+  for (Grr_u32 i = 0; i < nBytes; i += GRR_MESHOPT_BYTE_GROUP_SIZE) {
+    if ((size_t)(end - data) < GRR_MESHOPT_BYTE_GROUP_DECODE_LIMIT)
+      return NULL;
+    Grr_u32 group = i / GRR_MESHOPT_BYTE_GROUP_SIZE;
+    Grr_u32 bitslog2 = (header[group / 4] >> ((group % 4) * 2)) & 3;
+    data = _Grr_meshoptDecodeBytesGroup(data, out + i, bitslog2);
+  }
+  return data;
+}
+
+// Each byte channel of the block is stored separately as deltas against the
+// previous vertex
+const Grr_byte *_Grr_meshoptDecodeVertexBlock(const Grr_byte *data,
+                                              const Grr_byte *end,
+                                              Grr_byte *vertices,
+                                              Grr_u32 count, Grr_u32 stride,
+                                              Grr_byte *lastVertex) {
+  Grr_byte channel[GRR_MESHOPT_VERTEX_BLOCK_MAX];
+  Grr_u32 countAligned = (count + GRR_MESHOPT_BYTE_GROUP_SIZE - 1) &
+                         ~(GRR_MESHOPT_BYTE_GROUP_SIZE - 1);
+
+  for (Grr_u32 k = 0; k < stride; k++) {
+    data = _Grr_meshoptDecodeBytes(data, end, channel, countAligned);
+    if (NULL == data)
+      return NULL;
+
+    Grr_byte previous = lastVertex[k];
+    for (Grr_u32 i = 0; i < count; i++) {
+      previous += _Grr_meshoptUnzigzag8(channel[i]);
+      vertices[(size_t)i * stride + k] = previous;
+    }
+    lastVertex[k] = previous;
+  }
+  return data;
+}
+
+Grr_bool Grr_meshoptDecodeVertexBuffer(Grr_byte *destination, Grr_u32 count,
+                                       Grr_u32 stride, const Grr_byte *source,
+                                       size_t sourceBytes) {
+  if (stride == 0 || stride > 256 || stride % 4 != 0) {
+    GRR_LOG_ERROR("meshopt: invalid vertex stride (%u)\n", stride);
+    return false;
+  }
+  if (sourceBytes < 1 + stride)
+    return false;
+
+  const Grr_byte *data = source;
+  const Grr_byte *end = source + sourceBytes;
+  if ((*data & 0xf0) != GRR_MESHOPT_VERTEX_HEADER || (*data & 0x0f) > 0) {
+    GRR_LOG_ERROR("meshopt: unsupported vertex codec header (0x%02x)\n",
+                  *data);
+    return false;
+  }
+  data++;
+
+  // The first vertex is delta-encoded against the tail
+  Grr_byte lastVertex[256];
+  memcpy(lastVertex, end - stride, stride);
+
+  Grr_u32 blockSize = (GRR_MESHOPT_VERTEX_BLOCK_BYTES / stride) &
+                      ~(GRR_MESHOPT_BYTE_GROUP_SIZE - 1);
+  if (blockSize > GRR_MESHOPT_VERTEX_BLOCK_MAX)
+    blockSize = GRR_MESHOPT_VERTEX_BLOCK_MAX;
+
+  for (Grr_u32 offset = 0; offset < count; offset += blockSize) {
+    Grr_u32 n = (count - offset < blockSize ? count - offset : blockSize);
+    data = _Grr_meshoptDecodeVertexBlock(
+        data, end, destination + (size_t)offset * stride, n, stride,
+        lastVertex);
+    if (NULL == data)
+      return false;
+  }
+
+  size_t tailBytes =
+      (stride < GRR_MESHOPT_TAIL_MAX ? GRR_MESHOPT_TAIL_MAX : stride);
+  return (size_t)(end - data) == tailBytes;
+}
+
+// Index codecs
+
+Grr_u32 _Grr_meshoptDecodeVByte(const Grr_byte **data) {
+  Grr_byte lead = *(*data)++;
+  if (lead < 128)
+    return lead;
+
+  Grr_u32 result = lead & 127;
+  Grr_u32 shift = 7;
+  for (Grr_u32 i = 0; i < 4; i++) {
+    Grr_byte group = *(*data)++;
+    result |= (Grr_u32)(group & 127) << shift;
+    shift += 7;
+    if (group < 128)
+      break;
+  }
+  return result;
+}
+
+Grr_u32 _Grr_meshoptDecodeIndex(const Grr_byte **data, Grr_u32 last) {
+  Grr_u32 v = _Grr_meshoptDecodeVByte(data);
+  return last + ((v >> 1) ^ -(v & 1));
+}
+
+void _Grr_meshoptWriteIndex(Grr_byte *destination, Grr_u32 i,
+                            Grr_u32 indexSize, Grr_u32 index) {
+  if (indexSize == 2)
+    ((Grr_u16 *)destination)[i] = (Grr_u16)index;
+  else
+    ((Grr_u32 *)destination)[i] = index;
+}
+
+void _Grr_meshoptWriteTriangle(Grr_byte *destination, Grr_u32 i,
+                               Grr_u32 indexSize, Grr_u32 a, Grr_u32 b,
+                               Grr_u32 c) {
+  _Grr_meshoptWriteIndex(destination, i, indexSize, a);
+  _Grr_meshoptWriteIndex(destination, i + 1, indexSize, b);
+  _Grr_meshoptWriteIndex(destination, i + 2, indexSize, c);
+}
+
+// FIFO updates must mirror the encoder exactly
+void _Grr_meshoptPushEdge(Grr_u32 edges[16][2], Grr_u32 *offset, Grr_u32 a,
+                          Grr_u32 b) {
+  edges[*offset][0] = a;
+  edges[*offset][1] = b;
+  *offset = (*offset + 1) & 15;
+}
+
+void _Grr_meshoptPushVertex(Grr_u32 vertices[16], Grr_u32 *offset, Grr_u32 v,
+                            Grr_bool advance) {
+  vertices[*offset] = v;
+  *offset = (*offset + advance) & 15;
+}
+
+Grr_bool Grr_meshoptDecodeIndexBuffer(Grr_byte *destination, Grr_u32 count,
+                                      Grr_u32 indexSize,
+                                      const Grr_byte *source,
+                                      size_t sourceBytes) {
+  if (count % 3 != 0 || (indexSize != 2 && indexSize != 4)) {
+    GRR_LOG_ERROR("meshopt: invalid triangle index buffer (%u x %u bytes)\n",
+                  count, indexSize);
+    return false;
+  }
+  // Header, 1 code byte per triangle and the 16 byte auxiliary code table
+  if (sourceBytes < 1 + count / 3 + 16)
+    return false;
+  Grr_u32 version = source[0] & 0x0f;
+  if ((source[0] & 0xf0) != GRR_MESHOPT_INDEX_HEADER || version > 1) {
+    GRR_LOG_ERROR("meshopt: unsupported index codec header (0x%02x)\n",
+                  source[0]);
+    return false;
+  }
+
+  Grr_u32 edgeFifo[16][2];
+  Grr_u32 vertexFifo[16];
+  memset(edgeFifo, -1, sizeof(edgeFifo));
+  memset(vertexFifo, -1, sizeof(vertexFifo));
+  Grr_u32 edgeOffset = 0;
+  Grr_u32 vertexOffset = 0;
+  Grr_u32 next = 0;
+  Grr_u32 last = 0;
+  Grr_u32 fecMax = (version >= 1 ? 13 : 15);
+
+  const Grr_byte *code = source + 1;
+  const Grr_byte *data = code + count / 3;
+  const Grr_byte *dataSafeEnd = source + sourceBytes - 16;
+  const Grr_byte *codeAuxTable = dataSafeEnd;
+
+  for (Grr_u32 i = 0; i < count; i += 3) {
+    // A triangle reads at most 16 bytes (codeaux + 3 varints of 5 bytes),
+    // covered by the code table at the end of the stream
+    if (data > dataSafeEnd)
+      return false;
+
+    Grr_byte codeTri = *code++;
+    if (codeTri < 0xf0) {
+      // Edge from the edge FIFO + vertex from the FIFO, new or encoded
+      Grr_u32 fe = codeTri >> 4;
+      Grr_u32 a = edgeFifo[(edgeOffset - 1 - fe) & 15][0];
+      Grr_u32 b = edgeFifo[(edgeOffset - 1 - fe) & 15][1];
+      Grr_u32 fec = codeTri & 15;
+
+      if (fec < fecMax) {
+        Grr_u32 c = (fec == 0 ? next : vertexFifo[(vertexOffset - 1 - fec) & 15]);
+        next += (fec == 0);
+        _Grr_meshoptWriteTriangle(destination, i, indexSize, a, b, c);
+        _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, c, fec == 0);
+        _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, c, b);
+        _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, a, c);
+      } else {
+        // 13, 14: last -/+ 1, 15: delta-encoded against last
+        Grr_u32 c = (fec != 15 ? last + (fec - (fec ^ 3))
+                               : _Grr_meshoptDecodeIndex(&data, last));
+        last = c;
+        _Grr_meshoptWriteTriangle(destination, i, indexSize, a, b, c);
+        _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, c, true);
+        _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, c, b);
+        _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, a, c);
+      }
+    } else if (codeTri < 0xfe) {
+      // Free triangle, b and c layout from the code table
+      Grr_byte codeAux = codeAuxTable[codeTri & 15];
+      Grr_u32 feb = codeAux >> 4;
+      Grr_u32 fec = codeAux & 15;
+
+      Grr_u32 a = next++;
+      Grr_u32 b = (feb == 0 ? next : vertexFifo[(vertexOffset - feb) & 15]);
+      next += (feb == 0);
+      Grr_u32 c = (fec == 0 ? next : vertexFifo[(vertexOffset - fec) & 15]);
+      next += (fec == 0);
+
+      _Grr_meshoptWriteTriangle(destination, i, indexSize, a, b, c);
+      _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, a, true);
+      _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, b, feb == 0);
+      _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, c, fec == 0);
+      _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, b, a);
+      _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, c, b);
+      _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, a, c);
+    } else {
+      // Free triangle with an explicit code byte
+      Grr_byte codeAux = *data++;
+      Grr_u32 fea = (codeTri == 0xfe ? 0 : 15);
+      Grr_u32 feb = codeAux >> 4;
+      Grr_u32 fec = codeAux & 15;
+
+      if (codeAux == 0) // Reset
+        next = 0;
+
+      Grr_u32 a = (fea == 0 ? next++ : 0);
+      Grr_u32 b = (feb == 0 ? next++ : vertexFifo[(vertexOffset - feb) & 15]);
+      Grr_u32 c = (fec == 0 ? next++ : vertexFifo[(vertexOffset - fec) & 15]);
+      if (fea == 15)
+        last = a = _Grr_meshoptDecodeIndex(&data, last);
+      if (feb == 15)
+        last = b = _Grr_meshoptDecodeIndex(&data, last);
+      if (fec == 15)
+        last = c = _Grr_meshoptDecodeIndex(&data, last);
+
+      _Grr_meshoptWriteTriangle(destination, i, indexSize, a, b, c);
+      _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, a, true);
+      _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, b,
+                             feb == 0 || feb == 15);
+      _Grr_meshoptPushVertex(vertexFifo, &vertexOffset, c,
+                             fec == 0 || fec == 15);
+      _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, b, a);
+      _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, c, b);
+      _Grr_meshoptPushEdge(edgeFifo, &edgeOffset, a, c);
+    }
+  }
+
+  // All data consumed up to the code table
+  return data == dataSafeEnd;
+}
+
+Grr_bool Grr_meshoptDecodeIndexSequence(Grr_byte *destination, Grr_u32 count,
+                                        Grr_u32 indexSize,
+                                        const Grr_byte *source,
+                                        size_t sourceBytes) {
+  if (indexSize != 2 && indexSize != 4) {
+    GRR_LOG_ERROR("meshopt: invalid index size (%u)\n", indexSize);
+    return false;
+  }
+  // Header, at least 1 byte per index and a 4 byte tail
+  if (sourceBytes < 1 + (size_t)count + 4)
+    return false;
+  if ((source[0] & 0xf0) != GRR_MESHOPT_SEQUENCE_HEADER ||
+      (source[0] & 0x0f) > 1) {
+    GRR_LOG_ERROR("meshopt: unsupported index sequence header (0x%02x)\n",
+                  source[0]);
+    return false;
+  }
+
+  const Grr_byte *data = source + 1;
+  const Grr_byte *dataSafeEnd = source + sourceBytes - 4;
+  Grr_u32 last[2] = {0, 0};
+
+  for (Grr_u32 i = 0; i < count; i++) {
+    if (data >= dataSafeEnd)
+      return false;
+
+    // Low bit selects the baseline, the rest is a zigzag delta against it
+    Grr_u32 v = _Grr_meshoptDecodeVByte(&data);
+    Grr_u32 baseline = v & 1;
+    v >>= 1;
+    last[baseline] += (v >> 1) ^ -(v & 1);
+    _Grr_meshoptWriteIndex(destination, i, indexSize, last[baseline]);
+  }
+
+  return data == dataSafeEnd;
+}
+
+// Filters
+
+void Grr_meshoptFilterOctahedral(Grr_byte *data, Grr_u32 count,
+                                 Grr_u32 stride) {
+  Grr_bool wide = (stride == 8); // int16 components, int8 otherwise
+  const GrrF32x4 zero = Grr_f32x4Splat(0.0f);
+  const GrrF32x4 maximum = Grr_f32x4Splat(wide ? 32767.0f : 127.0f);
+  Grr_f32 c[3][4];
+  Grr_i32 r[3][4];
+
+  // 4 vectors at a time in SoA form
+  for (Grr_u32 i = 0; i < count; i += 4) {
+    Grr_u32 n = (count - i < 4 ? count - i : 4);
+    for (Grr_u32 j = 0; j < 4; j++) {
+      Grr_u32 e = i + (j < n ? j : 0);
+      for (Grr_u32 k = 0; k < 3; k++)
+        c[k][j] = (wide ? ((Grr_i16 *)data)[(size_t)e * 4 + k]
+                        : ((int8_t *)data)[(size_t)e * 4 + k]);
+    }
+    GrrF32x4 x = Grr_f32x4Load(c[0]);
+    GrrF32x4 y = Grr_f32x4Load(c[1]);
+
+    // Z is stored as the encoded value of 1.0
+    GrrF32x4 z = Grr_f32x4Sub(Grr_f32x4Load(c[2]),
+                              Grr_f32x4Add(Grr_f32x4Abs(x), Grr_f32x4Abs(y)));
+
+    // Unfold the lower hemisphere
+    GrrF32x4 t = Grr_f32x4Min(z, zero);
+    x = Grr_f32x4Add(x, Grr_f32x4SelectLess(x, zero, Grr_f32x4Sub(zero, t), t));
+    y = Grr_f32x4Add(y, Grr_f32x4SelectLess(y, zero, Grr_f32x4Sub(zero, t), t));
+
+    // Normalize to the full integer range
+    GrrF32x4 length = Grr_f32x4Sqrt(Grr_f32x4Add(
+        Grr_f32x4Add(Grr_f32x4Mul(x, x), Grr_f32x4Mul(y, y)),
+        Grr_f32x4Mul(z, z)));
+    GrrF32x4 s = Grr_f32x4Div(maximum, length);
+    Grr_i32x4Store(r[0], Grr_f32x4RoundToI32(Grr_f32x4Mul(x, s)));
+    Grr_i32x4Store(r[1], Grr_f32x4RoundToI32(Grr_f32x4Mul(y, s)));
+    Grr_i32x4Store(r[2], Grr_f32x4RoundToI32(Grr_f32x4Mul(z, s)));
+
+    // W is left untouched
+    for (Grr_u32 j = 0; j < n; j++) {
+      for (Grr_u32 k = 0; k < 3; k++) {
+        if (wide)
+          ((Grr_i16 *)data)[(size_t)(i + j) * 4 + k] = (Grr_i16)r[k][j];
+        else
+          ((int8_t *)data)[(size_t)(i + j) * 4 + k] = (int8_t)r[k][j];
+      }
+    }
+  }
+}
+
+void Grr_meshoptFilterQuaternion(Grr_i16 *data, Grr_u32 count) {
+  const GrrF32x4 zero = Grr_f32x4Splat(0.0f);
+  const GrrF32x4 one = Grr_f32x4Splat(1.0f);
+  const GrrF32x4 snormScale = Grr_f32x4Splat(32767.0f);
+  Grr_f32 c[4][4];
+  Grr_i32 r[4][4];
+
+  for (Grr_u32 i = 0; i < count; i += 4) {
+    Grr_u32 n = (count - i < 4 ? count - i : 4);
+    for (Grr_u32 j = 0; j < 4; j++) {
+      const Grr_i16 *q = data + (size_t)(i + (j < n ? j : 0)) * 4;
+      for (Grr_u32 k = 0; k < 3; k++)
+        c[k][j] = q[k];
+      // Component range is stored in the high bits of the 4th value
+      c[3][j] = 0.70710678f / (Grr_f32)(q[3] | 3);
+    }
+    GrrF32x4 scale = Grr_f32x4Load(c[3]);
+    GrrF32x4 x = Grr_f32x4Mul(Grr_f32x4Load(c[0]), scale);
+    GrrF32x4 y = Grr_f32x4Mul(Grr_f32x4Load(c[1]), scale);
+    GrrF32x4 z = Grr_f32x4Mul(Grr_f32x4Load(c[2]), scale);
+
+    // Largest component, dropped by the encoder
+    GrrF32x4 ww = Grr_f32x4Sub(
+        one, Grr_f32x4Add(Grr_f32x4Add(Grr_f32x4Mul(x, x), Grr_f32x4Mul(y, y)),
+                          Grr_f32x4Mul(z, z)));
+    GrrF32x4 w = Grr_f32x4Sqrt(Grr_f32x4Max(ww, zero));
+
+    Grr_i32x4Store(r[0], Grr_f32x4RoundToI32(Grr_f32x4Mul(x, snormScale)));
+    Grr_i32x4Store(r[1], Grr_f32x4RoundToI32(Grr_f32x4Mul(y, snormScale)));
+    Grr_i32x4Store(r[2], Grr_f32x4RoundToI32(Grr_f32x4Mul(z, snormScale)));
+    Grr_i32x4Store(r[3], Grr_f32x4RoundToI32(Grr_f32x4Mul(w, snormScale)));
+
+    // Low 2 bits of the 4th value give the index of the dropped component
+    for (Grr_u32 j = 0; j < n; j++) {
+      Grr_i16 *q = data + (size_t)(i + j) * 4;
+      Grr_u32 qc = q[3] & 3;
+      q[(qc + 1) & 3] = (Grr_i16)r[0][j];
+      q[(qc + 2) & 3] = (Grr_i16)r[1][j];
+      q[(qc + 3) & 3] = (Grr_i16)r[2][j];
+      q[qc] = (Grr_i16)r[3][j];
+    }
+  }
+}
+
+void Grr_meshoptFilterExponential(Grr_u32 *data, Grr_u32 valueCount) {
+  union {
+    Grr_f32 f;
+    Grr_u32 u;
+  } bits;
+  for (Grr_u32 i = 0; i < valueCount; i++) {
+    Grr_i32 mantissa = (Grr_i32)(data[i] << 8) >> 8;
+    Grr_i32 exponent = (Grr_i32)data[i] >> 24;
+    bits.u = (Grr_u32)(exponent + 127) << 23; // 2^exponent
+    bits.f *= (Grr_f32)mantissa;
+    data[i] = bits.u;
+  }
+}
+
+Grr_bool Grr_meshoptDecode(const GrrMeshoptCompression *compression) {
+  Grr_bool decoded = false;
+  switch (compression->mode) {
+  case GRR_MESHOPT_MODE_ATTRIBUTES:
+    decoded = Grr_meshoptDecodeVertexBuffer(
+        compression->destination, compression->count, compression->stride,
+        compression->source, compression->sourceBytes);
+    break;
+  case GRR_MESHOPT_MODE_TRIANGLES:
+    decoded = Grr_meshoptDecodeIndexBuffer(
+        compression->destination, compression->count, compression->stride,
+        compression->source, compression->sourceBytes);
+    break;
+  case GRR_MESHOPT_MODE_INDICES:
+    decoded = Grr_meshoptDecodeIndexSequence(
+        compression->destination, compression->count, compression->stride,
+        compression->source, compression->sourceBytes);
+    break;
+  }
+  if (!decoded)
+    return false;
+
+  switch (compression->filter) {
+  case GRR_MESHOPT_FILTER_NONE:
+    break;
+  case GRR_MESHOPT_FILTER_OCTAHEDRAL:
+    if (compression->stride != 4 && compression->stride != 8)
+      return false;
+    Grr_meshoptFilterOctahedral(compression->destination, compression->count,
+                                compression->stride);
+    break;
+  case GRR_MESHOPT_FILTER_QUATERNION:
+    if (compression->stride != 8)
+      return false;
+    Grr_meshoptFilterQuaternion((Grr_i16 *)compression->destination,
+                                compression->count);
+    break;
+  case GRR_MESHOPT_FILTER_EXPONENTIAL:
+    if (compression->stride % 4 != 0)
+      return false;
+    Grr_meshoptFilterExponential((Grr_u32 *)compression->destination,
+                                 compression->count * compression->stride /
+                                     4);
+    break;
+  }
+  return true;
+}
+
+typedef struct _GrrMeshoptJobs {
+  const GrrMeshoptCompression *compressions;
+  Grr_bool failed;
+} _GrrMeshoptJobs;
+
+void _Grr_meshoptDecodeJob(void *data, Grr_u32 index, Grr_u32 threadIndex) {
+  _GrrMeshoptJobs *jobs = (_GrrMeshoptJobs *)data;
+  if (!Grr_meshoptDecode(&jobs->compressions[index])) {
+    GRR_LOG_ERROR("meshopt: failed to decode compressed buffer view %u\n",
+                  index);
+    __atomic_store_n(&jobs->failed, true, __ATOMIC_RELAXED);
+  }
+}
+
+Grr_bool Grr_meshoptDecodeAll(const GrrMeshoptCompression *compressions,
+                              Grr_u32 count) {
+  _GrrMeshoptJobs jobs = {compressions, false};
+  Grr_parallelFor(count, _Grr_meshoptDecodeJob, &jobs);
+  return !jobs.failed;
+}
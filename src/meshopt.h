@@ -0,0 +1,72 @@
+#ifndef GRR_MESHOPT_H
+#define GRR_MESHOPT_H
+
+#include "jobs.h"
+#include "logging.h"
+#include "math/simd.h"
+#include "types.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+// glTF EXT_meshopt_compression:
+// https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Vendor/EXT_meshopt_compression
+
+// * Compressed buffer views store a byte stream in a (typically uri-less or
+// fallback) buffer, decoded at load time into the buffer the view points to.
+// - ATTRIBUTES: vertex codec, count elements of byteStride bytes (multiple of
+// 4, at most 256)
+// - TRIANGLES: index codec, count indices (multiple of 3) of 2 or 4 bytes
+// - INDICES: index sequence codec, count indices of 2 or 4 bytes
+// * Filters are applied to the decoded ATTRIBUTES data in place.
+
+typedef enum GRR_MESHOPT_MODE {
+  GRR_MESHOPT_MODE_ATTRIBUTES,
+  GRR_MESHOPT_MODE_TRIANGLES,
+  GRR_MESHOPT_MODE_INDICES
+} GRR_MESHOPT_MODE;
+
+typedef enum GRR_MESHOPT_FILTER {
+  GRR_MESHOPT_FILTER_NONE,
+  GRR_MESHOPT_FILTER_OCTAHEDRAL,  // 4 x int8 or 4 x int16 unit vectors
+  GRR_MESHOPT_FILTER_QUATERNION,  // 4 x int16 unit quaternions
+  GRR_MESHOPT_FILTER_EXPONENTIAL, // 32-bit values, 24-bit mantissa 8-bit exp
+} GRR_MESHOPT_FILTER;
+
+typedef struct GrrMeshoptCompression {
+  const Grr_byte *source; // Compressed stream
+  size_t sourceBytes;
+  Grr_byte *destination; // count * stride bytes
+  Grr_u32 count;
+  Grr_u32 stride;
+  GRR_MESHOPT_MODE mode;
+  GRR_MESHOPT_FILTER filter;
+} GrrMeshoptCompression;
+
+// Codecs, return false on malformed input
+Grr_bool Grr_meshoptDecodeVertexBuffer(Grr_byte *destination, Grr_u32 count,
+                                       Grr_u32 stride, const Grr_byte *source,
+                                       size_t sourceBytes);
+Grr_bool Grr_meshoptDecodeIndexBuffer(Grr_byte *destination, Grr_u32 count,
+                                      Grr_u32 indexSize,
+                                      const Grr_byte *source,
+                                      size_t sourceBytes);
+Grr_bool Grr_meshoptDecodeIndexSequence(Grr_byte *destination, Grr_u32 count,
+                                        Grr_u32 indexSize,
+                                        const Grr_byte *source,
+                                        size_t sourceBytes);
+
+// Filters (in place)
+void Grr_meshoptFilterOctahedral(Grr_byte *data, Grr_u32 count,
+                                 Grr_u32 stride);
+void Grr_meshoptFilterQuaternion(Grr_i16 *data, Grr_u32 count);
+void Grr_meshoptFilterExponential(Grr_u32 *data, Grr_u32 valueCount);
+
+// Codec + filter for one buffer view
+Grr_bool Grr_meshoptDecode(const GrrMeshoptCompression *compression);
+
+// Decodes independent buffer views in parallel on the job system
+Grr_bool Grr_meshoptDecodeAll(const GrrMeshoptCompression *compressions,
+                              Grr_u32 count);
+
+#endif
@@ -0,0 +1,169 @@
+#include "pacing.h"
+#include "vulkan.h"
+
+const VkPresentModeKHR vulkanPresentModes[GRR_PRESENT_MODE_COUNT] = {
+    VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+    VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+
+GRR_PRESENT_MODE preferredPresentMode = GRR_PRESENT_MODE_MAILBOX;
+GRR_PRESENT_MODE activePresentMode = GRR_PRESENT_MODE_FIFO;
+Grr_f64 targetFrameInterval = 0.0; // Seconds, 0 without a target rate
+Grr_f64 frameDeadline = 0.0;
+Grr_f64 previousFrameStart = 0.0;
+Grr_f64 nextInputTime = 0.0; // 0 when not given
+Grr_f64 currentInputTime = 0.0;
+
+Grr_bool presentWaitEnabled = false;
+PFN_vkWaitForPresentKHR fpWaitForPresentKHR = NULL;
+
+// Submitted frames, oldest first, from pendingFirst
+typedef struct GrrPendingFrame {
+  Grr_u64 number; // Also the present ID
+  Grr_f64 inputTime;
+} GrrPendingFrame;
+GrrPendingFrame pendingFrames[GRR_PACING_MAX_PENDING];
+Grr_u32 pendingFirst = 0;
+Grr_u32 pendingCount = 0;
+
+GrrTimingHistory latencyHistory;
+GrrTimingHistory frameTimeHistory;
+
+GRR_PRESENT_MODE Grr_choosePresentMode(GRR_PRESENT_MODE preferred,
+                                       const VkPresentModeKHR *available,
+                                       Grr_u32 availableCount) {
+  if (preferred < GRR_PRESENT_MODE_COUNT) {
+    for (Grr_u32 i = 0; i < availableCount; i++) {
+      if (available[i] == vulkanPresentModes[preferred])
+        return preferred;
+    }
+  }
+  return GRR_PRESENT_MODE_FIFO;
+}
+
+Grr_f64 Grr_nextFrameDeadline(Grr_f64 previous, Grr_f64 now,
+                              Grr_f64 interval) {
+  Grr_f64 next = previous + interval;
+  return next + interval < now ? now : next;
+}
+
+Grr_bool Grr_setFramesInFlight(Grr_u32 count) {
+  if (count == 0 || count > GRR_MAX_FRAMES_IN_FLIGHT) {
+    GRR_LOG_ERROR("Unsupported number of frames in flight (%u)\n", count);
+    return false;
+  }
+  if (count == framesInFlight)
+    return true;
+
+  // Resources exist for every possible frame in flight, but the frames of the
+  // old count must be complete before frame indices wrap differently
+  if (VK_NULL_HANDLE != device) {
+    vkDeviceWaitIdle(device);
+    _Grr_pollFrameLatency();
+  }
+  framesInFlight = count;
+  currentFrame = 0;
+  return true;
+}
+
+void Grr_setPresentMode(GRR_PRESENT_MODE mode) {
+  if (mode >= GRR_PRESENT_MODE_COUNT) {
+    GRR_LOG_ERROR("Unknown present mode %u\n", (Grr_u32)mode);
+    return;
+  }
+  preferredPresentMode = mode;
+  if (VK_NULL_HANDLE != swapchain && mode != activePresentMode)
+    recreateSwapChain = true;
+}
+
+void Grr_setTargetFrameRate(Grr_f32 framesPerSecond) {
+  targetFrameInterval = framesPerSecond > 0.0f ? 1.0 / framesPerSecond : 0.0;
+}
+
+void Grr_setFrameInputTime(Grr_f64 seconds) { nextInputTime = seconds; }
+
+void Grr_frameStatistics(GrrFrameStatistics *statistics) {
+  Grr_summarizeHistory(&latencyHistory, &statistics->latency);
+  Grr_summarizeHistory(&frameTimeHistory, &statistics->frameTime);
+  statistics->framesInFlight = framesInFlight;
+  statistics->presentMode = activePresentMode;
+  statistics->presentWait = presentWaitEnabled;
+}
+
+void _Grr_initializeFramePacing(Grr_bool presentWait) {
+  if (presentWait) {
+    fpWaitForPresentKHR = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(
+        device, "vkWaitForPresentKHR");
+  }
+  presentWaitEnabled = NULL != fpWaitForPresentKHR;
+}
+
+VkPresentModeKHR _Grr_selectPresentMode(const VkPresentModeKHR *available,
+                                        Grr_u32 availableCount) {
+  activePresentMode =
+      Grr_choosePresentMode(preferredPresentMode, available, availableCount);
+  if (activePresentMode != preferredPresentMode)
+    GRR_LOG_WARNING("Present mode %u is not available, using FIFO\n",
+                    (Grr_u32)preferredPresentMode);
+  return vulkanPresentModes[activePresentMode];
+}
+
+void _Grr_paceFrame() {
+  Grr_f64 now = Grr_seconds();
+  if (targetFrameInterval > 0.0) {
+    frameDeadline =
+        Grr_nextFrameDeadline(frameDeadline, now, targetFrameInterval);
+    // Sleeps are coarse: the end of the wait spins
+    if (frameDeadline - now > GRR_PACING_SPIN_SECONDS)
+      Grr_sleep(frameDeadline - now - GRR_PACING_SPIN_SECONDS);
+    while ((now = Grr_seconds()) < frameDeadline)
+      ;
+  }
+
+  if (previousFrameStart > 0.0)
+    Grr_recordTiming(&frameTimeHistory,
+                     (Grr_f32)((now - previousFrameStart) * 1e3));
+  previousFrameStart = now;
+  currentInputTime = nextInputTime > 0.0 ? nextInputTime : now;
+  nextInputTime = 0.0;
+}
+
+void _Grr_pollFrameLatency() {
+  // Frames complete in submission order: the first one still pending ends
+  // the poll
+  Grr_u64 completedFrame = Grr_completedFrame();
+  while (pendingCount > 0) {
+    const GrrPendingFrame *pending = &pendingFrames[pendingFirst];
+    VkResult result;
+    if (presentWaitEnabled && !headless)
+      result = fpWaitForPresentKHR(device, swapchain, pending->number, 0);
+    else
+      result = pending->number <= completedFrame ? VK_SUCCESS : VK_NOT_READY;
+    if (result == VK_TIMEOUT || result == VK_NOT_READY)
+      break;
+    if (result == VK_SUCCESS)
+      Grr_recordTiming(&latencyHistory,
+                       (Grr_f32)((Grr_seconds() - pending->inputTime) * 1e3));
+    pendingFirst = (pendingFirst + 1) % GRR_PACING_MAX_PENDING;
+    pendingCount--;
+  }
+}
+
+void _Grr_trackFrameLatency(Grr_u64 frameNumber) {
+  // The oldest frame is not measured when too many are pending
+  if (pendingCount == GRR_PACING_MAX_PENDING) {
+    pendingFirst = (pendingFirst + 1) % GRR_PACING_MAX_PENDING;
+    pendingCount--;
+  }
+  GrrPendingFrame *pending =
+      &pendingFrames[(pendingFirst + pendingCount) % GRR_PACING_MAX_PENDING];
+  pending->number = frameNumber;
+  pending->inputTime = currentInputTime;
+  pendingCount++;
+}
+
+void _Grr_forgetPendingPresents() {
+  if (presentWaitEnabled && !headless) {
+    pendingFirst = 0;
+    pendingCount = 0;
+  }
+}
@@ -0,0 +1,87 @@
+#ifndef GRR_PACING_H
+#define GRR_PACING_H
+
+#include "logging.h"
+#include "profiler.h"
+#include "types.h"
+#include "utils.h"
+#include <vulkan/vulkan.h>
+
+// Frame pacing: the number of frames in flight and the present mode trade
+// latency against throughput, and an optional target frame rate sleeps before
+// each frame begins. The latency of every frame is measured from its input
+// (Grr_setFrameInputTime, else the start of Grr_drawFrame) to the completion
+// of its present with VK_KHR_present_wait, else to the completion of its
+// commands. Completion is polled when frames begin, so samples may exceed the
+// true latency by up to a frame
+
+#define GRR_DEFAULT_FRAMES_IN_FLIGHT 2
+#define GRR_PACING_SPIN_SECONDS 0.001 // Busy wait before a frame deadline
+#define GRR_PACING_MAX_PENDING 16     // Frames whose latency is unknown yet
+
+typedef enum GRR_PRESENT_MODE {
+  GRR_PRESENT_MODE_FIFO = 0, // Vertical sync, always supported
+  GRR_PRESENT_MODE_MAILBOX,  // Vertical sync, queued images are replaced
+  GRR_PRESENT_MODE_IMMEDIATE,
+  GRR_PRESENT_MODE_FIFO_RELAXED, // Late images are presented immediately
+  GRR_PRESENT_MODE_COUNT
+} GRR_PRESENT_MODE;
+
+typedef struct GrrFrameStatistics {
+  GrrTimings latency;   // Input to present (or GPU completion), milliseconds
+  GrrTimings frameTime; // Between the starts of consecutive frames
+  Grr_u32 framesInFlight;
+  GRR_PRESENT_MODE presentMode; // Of the swapchain, FIFO when headless
+  Grr_bool presentWait;         // Latency measured to present completion
+} GrrFrameStatistics;
+
+// Present mode used with preferred given the ones of the surface: preferred
+// when available, else FIFO
+GRR_PRESENT_MODE Grr_choosePresentMode(GRR_PRESENT_MODE preferred,
+                                       const VkPresentModeKHR *available,
+                                       Grr_u32 availableCount);
+
+// Time the frame after the one of previous may begin, frames are interval
+// seconds apart. A frame more than an interval late starts a new schedule
+// from now instead of catching up with a burst of frames
+Grr_f64 Grr_nextFrameDeadline(Grr_f64 previous, Grr_f64 now,
+                              Grr_f64 interval);
+
+// From 1 to GRR_MAX_FRAMES_IN_FLIGHT. Once initialized, waits for the device
+// to be idle
+Grr_bool Grr_setFramesInFlight(Grr_u32 count);
+
+// Takes effect when the swapchain is next created (at the next present)
+void Grr_setPresentMode(GRR_PRESENT_MODE mode);
+
+// 0 draws frames as fast as the present mode allows
+void Grr_setTargetFrameRate(Grr_f32 framesPerSecond);
+
+// Grr_seconds when the input of the next frame was sampled
+void Grr_setFrameInputTime(Grr_f64 seconds);
+
+void Grr_frameStatistics(GrrFrameStatistics *statistics);
+
+// Called once the logical device exists, presentWait when VK_KHR_present_id
+// and VK_KHR_present_wait are enabled
+void _Grr_initializeFramePacing(Grr_bool presentWait);
+
+// Swapchain present mode of the preferred one
+VkPresentModeKHR _Grr_selectPresentMode(const VkPresentModeKHR *available,
+                                        Grr_u32 availableCount);
+
+// Sleeps until the frame may begin, then starts its latency measurement
+void _Grr_paceFrame();
+
+// Latency samples of the frames complete since the last call. Called after
+// the wait for the current frame in flight
+void _Grr_pollFrameLatency();
+
+// The current frame was submitted (and presented, unless headless) as frame
+// number frameNumber, also its present ID
+void _Grr_trackFrameLatency(Grr_u64 frameNumber);
+
+// Pending presents belong to the swapchain being replaced
+void _Grr_forgetPendingPresents();
+
+#endif
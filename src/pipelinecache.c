@@ -0,0 +1,102 @@
+#include "pipelinecache.h"
+
+Grr_u32 _Grr_readPipelineCacheU32(const Grr_byte *bytes) {
+  return (Grr_u32)bytes[0] | (Grr_u32)bytes[1] << 8 | (Grr_u32)bytes[2] << 16 |
+         (Grr_u32)bytes[3] << 24;
+}
+
+Grr_bool Grr_isPipelineCacheCompatible(
+    const Grr_byte *bytes, size_t nBytes,
+    const VkPhysicalDeviceProperties *properties) {
+  if (NULL == bytes || nBytes < GRR_PIPELINE_CACHE_HEADER_SIZE)
+    return false;
+
+  Grr_u32 headerSize = _Grr_readPipelineCacheU32(bytes);
+  Grr_u32 headerVersion = _Grr_readPipelineCacheU32(bytes + 4);
+  Grr_u32 vendorID = _Grr_readPipelineCacheU32(bytes + 8);
+  Grr_u32 deviceID = _Grr_readPipelineCacheU32(bytes + 12);
+  if (headerSize < GRR_PIPELINE_CACHE_HEADER_SIZE || headerSize > nBytes ||
+      headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    return false;
+
+  return vendorID == properties->vendorID &&
+         deviceID == properties->deviceID &&
+         memcmp(bytes + 16, properties->pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+VkPipelineCache _Grr_loadPipelineCache(VkPhysicalDevice physicalDevice,
+                                       VkDevice device, const Grr_string path) {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+  size_t nBytes = 0;
+  Grr_byte *bytes = NULL;
+  if (Grr_fileExists(path)) {
+    bytes = Grr_readBytesFromFile(path, &nBytes);
+    if (!Grr_isPipelineCacheCompatible(bytes, nBytes, &properties)) {
+      GRR_LOG_WARNING("Ignoring incompatible pipeline cache (%s)\n", path);
+      free(bytes);
+      bytes = NULL;
+      nBytes = 0;
+    }
+  }
+
+  VkPipelineCacheCreateInfo createInfo = {0};
+  createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  createInfo.initialDataSize = nBytes;
+  createInfo.pInitialData = bytes;
+
+  VkPipelineCache cache = VK_NULL_HANDLE;
+  VkResult result = vkCreatePipelineCache(device, &createInfo, NULL, &cache);
+  if (result != VK_SUCCESS && bytes != NULL) {
+    // Drivers may still reject data that passed the header check
+    GRR_LOG_WARNING("Pipeline cache data rejected (%s)\n", path);
+    createInfo.initialDataSize = 0;
+    createInfo.pInitialData = NULL;
+    result = vkCreatePipelineCache(device, &createInfo, NULL, &cache);
+  }
+  free(bytes);
+
+  if (result != VK_SUCCESS) {
+    GRR_LOG_ERROR("Failed to create pipeline cache\n");
+    return VK_NULL_HANDLE;
+  }
+  GRR_LOG_DEBUG("Pipeline cache: %zu bytes loaded\n", nBytes);
+  return cache;
+}
+
+Grr_bool _Grr_savePipelineCache(VkDevice device, VkPipelineCache cache,
+                                const Grr_string path) {
+  size_t nBytes = 0;
+  if (vkGetPipelineCacheData(device, cache, &nBytes, NULL) != VK_SUCCESS ||
+      nBytes == 0)
+    return false;
+  Grr_byte *bytes = (Grr_byte *)malloc(nBytes);
+  if (NULL == bytes) {
+    GRR_LOG_ERROR("Failed to allocate memory for pipeline cache data\n");
+    return false;
+  }
+  if (vkGetPipelineCacheData(device, cache, &nBytes, bytes) != VK_SUCCESS) {
+    free(bytes);
+    return false;
+  }
+
+  // Replace the previous file only once the new one is complete
+  char temporaryPath[512];
+  if (snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path) >=
+      (int)sizeof(temporaryPath)) {
+    free(bytes);
+    return false;
+  }
+  Grr_bool written =
+      Grr_writeBytesToFile(temporaryPath, bytes, (Grr_u32)nBytes);
+  free(bytes);
+  if (!written || rename(temporaryPath, path) != 0) {
+    GRR_LOG_ERROR("Failed to write pipeline cache (%s)\n", path);
+    remove(temporaryPath);
+    return false;
+  }
+
+  GRR_LOG_DEBUG("Pipeline cache: %zu bytes saved\n", nBytes);
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef GRR_PIPELINECACHE_H
+#define GRR_PIPELINECACHE_H
+
+#include "logging.h"
+#include "types.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// VkPipelineCache persisted between runs: loaded at startup when its header
+// matches the device (vendorID, deviceID and pipelineCacheUUID, a driver
+// update changes the UUID) and written back at exit to a temporary file
+// renamed over the previous one, so a crash never leaves a truncated cache
+
+#define GRR_PIPELINE_CACHE_PATH "./pipeline_cache.bin"
+
+// Header of the data returned by vkGetPipelineCacheData (version one)
+#define GRR_PIPELINE_CACHE_HEADER_SIZE (16 + VK_UUID_SIZE)
+
+// Whether cache data was produced by this device and driver
+Grr_bool Grr_isPipelineCacheCompatible(
+    const Grr_byte *bytes, size_t nBytes,
+    const VkPhysicalDeviceProperties *properties);
+
+// Pipeline cache seeded from path when compatible, VK_NULL_HANDLE on failure
+VkPipelineCache _Grr_loadPipelineCache(VkPhysicalDevice physicalDevice,
+                                       VkDevice device, const Grr_string path);
+
+Grr_bool _Grr_savePipelineCache(VkDevice device, VkPipelineCache cache,
+                                const Grr_string path);
+
+#endif
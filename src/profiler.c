@@ -0,0 +1,276 @@
+#include "profiler.h"
+#include "vulkan.h"
+
+const char *gpuRegionNames[GRR_GPU_REGION_COUNT] = {
+    "frame", "cull early", "render pass", "hi-z", "cull late",
+    "late render pass"};
+
+// Begin and end timestamps of every region, per frame in flight
+VkQueryPool timestampPools[GRR_MAX_FRAMES_IN_FLIGHT];
+VkQueryPool statisticsPools[GRR_MAX_FRAMES_IN_FLIGHT]; // One query each
+Grr_bool profilerAvailable = false;
+Grr_bool profilerEnabled = false;
+Grr_bool statisticsAvailable = false;
+Grr_u32 timestampValidBits = 0;
+Grr_f32 timestampPeriod = 1.0f;
+
+// Number of the frame submitted in each frame in flight, 0 once read
+Grr_u64 profiledFrames[GRR_MAX_FRAMES_IN_FLIGHT];
+
+GrrTimingHistory gpuRegionHistories[GRR_GPU_REGION_COUNT];
+GrrPipelineStatistics lastStatistics;
+
+#define GRR_PIPELINE_STATISTICS                                                \
+  (VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |                   \
+   VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |                 \
+   VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT)
+
+Grr_f64 Grr_timestampMilliseconds(Grr_u64 begin, Grr_u64 end,
+                                  Grr_u32 validBits, Grr_f32 period) {
+  Grr_u64 mask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+  Grr_u64 ticks = (end - begin) & mask;
+  return (Grr_f64)ticks * period * 1e-6;
+}
+
+int _Grr_compareTimings(const void *a, const void *b) {
+  Grr_f32 first = *(const Grr_f32 *)a;
+  Grr_f32 second = *(const Grr_f32 *)b;
+  return first < second ? -1 : (first > second ? 1 : 0);
+}
+
+Grr_bool Grr_summarizeTimings(const Grr_f32 *samples, Grr_u32 count,
+                              Grr_f32 *scratch, GrrTimings *timings) {
+  memset(timings, 0, sizeof(GrrTimings));
+  if (count == 0)
+    return false;
+
+  memcpy(scratch, samples, sizeof(Grr_f32) * count);
+  qsort(scratch, count, sizeof(Grr_f32), _Grr_compareTimings);
+  Grr_f64 sum = 0.0;
+  for (Grr_u32 i = 0; i < count; i++)
+    sum += scratch[i];
+
+  // Smallest sample not below 99% of them
+  Grr_u32 rank = (Grr_u32)(((Grr_u64)count * 99 + 99) / 100);
+  timings->min = scratch[0];
+  timings->average = (Grr_f32)(sum / count);
+  timings->p99 = scratch[rank - 1];
+  timings->last = samples[count - 1];
+  timings->sampleCount = count;
+  return true;
+}
+
+void Grr_recordTiming(GrrTimingHistory *history, Grr_f32 milliseconds) {
+  history->samples[history->next] = milliseconds;
+  history->next = (history->next + 1) % GRR_PROFILER_HISTORY;
+  if (history->count < GRR_PROFILER_HISTORY)
+    history->count++;
+}
+
+Grr_bool Grr_summarizeHistory(const GrrTimingHistory *history,
+                              GrrTimings *timings) {
+  // Oldest first
+  Grr_u32 first = history->count < GRR_PROFILER_HISTORY ? 0 : history->next;
+  Grr_f32 ordered[GRR_PROFILER_HISTORY];
+  Grr_f32 scratch[GRR_PROFILER_HISTORY];
+  for (Grr_u32 i = 0; i < history->count; i++)
+    ordered[i] = history->samples[(first + i) % GRR_PROFILER_HISTORY];
+  return Grr_summarizeTimings(ordered, history->count, scratch, timings);
+}
+
+const char *Grr_gpuRegionName(GRR_GPU_REGION region) {
+  return region < GRR_GPU_REGION_COUNT ? gpuRegionNames[region] : "unknown";
+}
+
+Grr_bool Grr_gpuTimings(GRR_GPU_REGION region, GrrTimings *timings) {
+  if (region >= GRR_GPU_REGION_COUNT) {
+    memset(timings, 0, sizeof(GrrTimings));
+    return false;
+  }
+  return Grr_summarizeHistory(&gpuRegionHistories[region], timings);
+}
+
+Grr_bool Grr_gpuPipelineStatistics(GrrPipelineStatistics *statistics) {
+  *statistics = lastStatistics;
+  return statisticsAvailable && lastStatistics.frame != 0;
+}
+
+void Grr_logGpuProfile() {
+  GrrTimings timings;
+  for (Grr_u32 region = 0; region < GRR_GPU_REGION_COUNT; region++) {
+    if (!Grr_gpuTimings((GRR_GPU_REGION)region, &timings))
+      continue;
+    GRR_LOG_INFO("GPU %-16s min %.3f avg %.3f p99 %.3f ms (%u frames)\n",
+                 gpuRegionNames[region], timings.min, timings.average,
+                 timings.p99, timings.sampleCount);
+  }
+  GrrPipelineStatistics statistics;
+  if (Grr_gpuPipelineStatistics(&statistics)) {
+    GRR_LOG_INFO("GPU frame %llu: %llu vertices, %llu primitives, %llu "
+                 "fragment invocations\n",
+                 (unsigned long long)statistics.frame,
+                 (unsigned long long)statistics.vertices,
+                 (unsigned long long)statistics.primitives,
+                 (unsigned long long)statistics.fragmentInvocations);
+  }
+}
+
+void Grr_setGpuProfiling(Grr_bool enabled) {
+  enabled = enabled && profilerAvailable;
+  if (enabled != profilerEnabled)
+    _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_ALL);
+  profilerEnabled = enabled;
+}
+
+void _Grr_destroyProfiler() {
+  GRR_LOG_INFO("Free GPU profiler\n");
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++) {
+    vkDestroyQueryPool(device, timestampPools[i], NULL);
+    if (statisticsAvailable)
+      vkDestroyQueryPool(device, statisticsPools[i], NULL);
+  }
+}
+
+Grr_bool _Grr_initializeProfiler(Grr_bool pipelineStatistics) {
+  Grr_u32 familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, NULL);
+  VkQueueFamilyProperties *families = (VkQueueFamilyProperties *)malloc(
+      sizeof(VkQueueFamilyProperties) * familyCount);
+  if (NULL == families)
+    return false;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount,
+                                           families);
+  timestampValidBits =
+      families[queueFamilyIndices.graphicsFamilyIndex].timestampValidBits;
+  free(families);
+  if (timestampValidBits == 0)
+    return false;
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  timestampPeriod = properties.limits.timestampPeriod;
+
+  VkQueryPoolCreateInfo timestampInfo = {0};
+  timestampInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  timestampInfo.queryCount = GRR_GPU_REGION_COUNT * 2;
+  VkQueryPoolCreateInfo statisticsInfo = {0};
+  statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+  statisticsInfo.queryCount = 1;
+  statisticsInfo.pipelineStatistics = GRR_PIPELINE_STATISTICS;
+  Grr_u32 created = 0;
+  Grr_u32 statisticsCreated = 0;
+  for (; created < GRR_MAX_FRAMES_IN_FLIGHT; created++) {
+    if (vkCreateQueryPool(device, &timestampInfo, NULL,
+                          &timestampPools[created]) != VK_SUCCESS)
+      break;
+  }
+  for (; pipelineStatistics && statisticsCreated < GRR_MAX_FRAMES_IN_FLIGHT;
+       statisticsCreated++) {
+    if (vkCreateQueryPool(device, &statisticsInfo, NULL,
+                          &statisticsPools[statisticsCreated]) != VK_SUCCESS)
+      break;
+  }
+  if (created < GRR_MAX_FRAMES_IN_FLIGHT ||
+      (pipelineStatistics && statisticsCreated < GRR_MAX_FRAMES_IN_FLIGHT)) {
+    for (Grr_u32 i = 0; i < created; i++)
+      vkDestroyQueryPool(device, timestampPools[i], NULL);
+    for (Grr_u32 i = 0; i < statisticsCreated; i++)
+      vkDestroyQueryPool(device, statisticsPools[i], NULL);
+    return false;
+  }
+
+  statisticsAvailable = pipelineStatistics;
+  profilerAvailable = true;
+  profilerEnabled = true;
+  atexit(_Grr_destroyProfiler);
+  return true;
+}
+
+VkQueryPipelineStatisticFlags _Grr_gpuPipelineStatisticsFlags() {
+  return profilerEnabled && statisticsAvailable ? GRR_PIPELINE_STATISTICS : 0;
+}
+
+void _Grr_beginGpuProfile(VkCommandBuffer commandBuffer, Grr_u32 frame) {
+  if (!profilerEnabled)
+    return;
+  // Queries left unwritten by the frame stay unavailable
+  vkCmdResetQueryPool(commandBuffer, timestampPools[frame], 0,
+                      GRR_GPU_REGION_COUNT * 2);
+  if (statisticsAvailable)
+    vkCmdResetQueryPool(commandBuffer, statisticsPools[frame], 0, 1);
+  _Grr_beginGpuRegion(commandBuffer, frame, GRR_GPU_REGION_FRAME);
+}
+
+void _Grr_endGpuProfile(VkCommandBuffer commandBuffer, Grr_u32 frame) {
+  _Grr_endGpuRegion(commandBuffer, frame, GRR_GPU_REGION_FRAME);
+}
+
+void _Grr_beginGpuRegion(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                         GRR_GPU_REGION region) {
+  if (profilerEnabled)
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        timestampPools[frame], region * 2);
+}
+
+void _Grr_endGpuRegion(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                       GRR_GPU_REGION region) {
+  if (profilerEnabled)
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        timestampPools[frame], region * 2 + 1);
+}
+
+void _Grr_beginGpuStatistics(VkCommandBuffer commandBuffer, Grr_u32 frame) {
+  if (profilerEnabled && statisticsAvailable)
+    vkCmdBeginQuery(commandBuffer, statisticsPools[frame], 0, 0);
+}
+
+void _Grr_endGpuStatistics(VkCommandBuffer commandBuffer, Grr_u32 frame) {
+  if (profilerEnabled && statisticsAvailable)
+    vkCmdEndQuery(commandBuffer, statisticsPools[frame], 0);
+}
+
+void _Grr_submitGpuProfile(Grr_u32 frame, Grr_u64 frameNumber) {
+  profiledFrames[frame] = profilerEnabled ? frameNumber : 0;
+}
+
+void _Grr_readGpuProfile(Grr_u32 frame) {
+  if (profiledFrames[frame] == 0)
+    return;
+
+  // Value then availability of every query, without waiting
+  Grr_u64 timestamps[GRR_GPU_REGION_COUNT * 2][2];
+  VkResult result = vkGetQueryPoolResults(
+      device, timestampPools[frame], 0, GRR_GPU_REGION_COUNT * 2,
+      sizeof(timestamps), timestamps, sizeof(timestamps[0]),
+      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  if (result == VK_SUCCESS || result == VK_NOT_READY) {
+    for (Grr_u32 region = 0; region < GRR_GPU_REGION_COUNT; region++) {
+      const Grr_u64 *begin = timestamps[region * 2];
+      const Grr_u64 *end = timestamps[region * 2 + 1];
+      if (begin[1] == 0 || end[1] == 0)
+        continue;
+      Grr_recordTiming(&gpuRegionHistories[region],
+                       (Grr_f32)Grr_timestampMilliseconds(
+                           begin[0], end[0], timestampValidBits,
+                           timestampPeriod));
+    }
+  }
+
+  if (statisticsAvailable) {
+    // In the order of the flag bits, then availability
+    Grr_u64 counters[4];
+    result = vkGetQueryPoolResults(
+        device, statisticsPools[frame], 0, 1, sizeof(counters), counters,
+        sizeof(counters),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result == VK_SUCCESS && counters[3] != 0) {
+      lastStatistics.vertices = counters[0];
+      lastStatistics.primitives = counters[1];
+      lastStatistics.fragmentInvocations = counters[2];
+      lastStatistics.frame = profiledFrames[frame];
+    }
+  }
+  profiledFrames[frame] = 0;
+}
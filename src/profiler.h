@@ -0,0 +1,112 @@
+#ifndef GRR_PROFILER_H
+#define GRR_PROFILER_H
+
+#include "logging.h"
+#include "types.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// GPU profiler: timestamps are written around the regions of a frame's command
+// buffer into a query pool per frame in flight, reset by the command buffer
+// itself so cached ones can be submitted again. Results are read once the
+// frame is complete, so reading never stalls, and every region keeps the
+// durations of its last frames for a rolling report. Optionally, a pipeline
+// statistics query counts what the frame's render passes processed
+
+#define GRR_PROFILER_HISTORY 128 // Frames kept per region
+
+// Regions of a frame, the frame one spans the whole command buffer
+typedef enum GRR_GPU_REGION {
+  GRR_GPU_REGION_FRAME = 0,
+  GRR_GPU_REGION_CULL_EARLY,
+  GRR_GPU_REGION_RENDER_PASS,
+  GRR_GPU_REGION_HIZ,
+  GRR_GPU_REGION_CULL_LATE,
+  GRR_GPU_REGION_LATE_RENDER_PASS,
+  GRR_GPU_REGION_COUNT
+} GRR_GPU_REGION;
+
+// Durations in milliseconds over the frames kept
+typedef struct GrrTimings {
+  Grr_f32 min;
+  Grr_f32 average;
+  Grr_f32 p99; // Nearest rank
+  Grr_f32 last;
+  Grr_u32 sampleCount;
+} GrrTimings;
+
+// Last GRR_PROFILER_HISTORY durations, empty when zero initialized
+typedef struct GrrTimingHistory {
+  Grr_f32 samples[GRR_PROFILER_HISTORY];
+  Grr_u32 count;
+  Grr_u32 next; // Replaced by the next sample once full
+} GrrTimingHistory;
+
+// Counted by the render passes of a frame
+typedef struct GrrPipelineStatistics {
+  Grr_u64 vertices;            // Input assembly
+  Grr_u64 primitives;          // Input assembly
+  Grr_u64 fragmentInvocations; // Fragment shader
+  Grr_u64 frame;               // Number of the frame, 0 when none was read
+} GrrPipelineStatistics;
+
+// Milliseconds between two timestamps of a queue with validBits valid bits
+// (the counter wraps), period is in nanoseconds per tick
+Grr_f64 Grr_timestampMilliseconds(Grr_u64 begin, Grr_u64 end,
+                                  Grr_u32 validBits, Grr_f32 period);
+
+// Summary of count samples in any order (sorted into scratch, of count
+// elements). False when count is 0
+Grr_bool Grr_summarizeTimings(const Grr_f32 *samples, Grr_u32 count,
+                              Grr_f32 *scratch, GrrTimings *timings);
+
+void Grr_recordTiming(GrrTimingHistory *history, Grr_f32 milliseconds);
+
+// Summary of the samples kept, the last one is the most recent
+Grr_bool Grr_summarizeHistory(const GrrTimingHistory *history,
+                              GrrTimings *timings);
+
+const char *Grr_gpuRegionName(GRR_GPU_REGION region);
+
+// False while the region has no sample, or profiling is not available
+Grr_bool Grr_gpuTimings(GRR_GPU_REGION region, GrrTimings *timings);
+
+// Of the last frame read, false when pipeline statistics are not available
+Grr_bool Grr_gpuPipelineStatistics(GrrPipelineStatistics *statistics);
+
+// Logs the timings of every region with samples and the last statistics
+void Grr_logGpuProfile();
+
+// Enabled by default when available. History is kept while disabled
+void Grr_setGpuProfiling(Grr_bool enabled);
+
+// Called once the logical device exists. Fails when the graphics queue has no
+// timestamps. Pipeline statistics need the pipelineStatisticsQuery and
+// inheritedQueries features (queries span secondary command buffers)
+Grr_bool _Grr_initializeProfiler(Grr_bool pipelineStatistics);
+
+// Statistics counted by the frame's query, for the inheritance info of
+// secondary command buffers recorded inside it (0 when there is none)
+VkQueryPipelineStatisticFlags _Grr_gpuPipelineStatisticsFlags();
+
+// Outside render passes: the profile begins before every other command of the
+// frame's command buffer and ends after them
+void _Grr_beginGpuProfile(VkCommandBuffer commandBuffer, Grr_u32 frame);
+void _Grr_endGpuProfile(VkCommandBuffer commandBuffer, Grr_u32 frame);
+void _Grr_beginGpuRegion(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                         GRR_GPU_REGION region);
+void _Grr_endGpuRegion(VkCommandBuffer commandBuffer, Grr_u32 frame,
+                       GRR_GPU_REGION region);
+
+// Around the render passes of the frame
+void _Grr_beginGpuStatistics(VkCommandBuffer commandBuffer, Grr_u32 frame);
+void _Grr_endGpuStatistics(VkCommandBuffer commandBuffer, Grr_u32 frame);
+
+// The frame's command buffer was submitted as frame number frameNumber
+void _Grr_submitGpuProfile(Grr_u32 frame, Grr_u64 frameNumber);
+
+// Reads the results of frame once it is complete
+void _Grr_readGpuProfile(Grr_u32 frame);
+
+#endif
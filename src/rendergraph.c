@@ -0,0 +1,663 @@
+#include "rendergraph.h"
+#include "vulkan.h"
+
+typedef struct GrrGraphAccessInfo {
+  VkPipelineStageFlags stages;
+  VkAccessFlags access;
+  VkImageLayout layout;
+  Grr_bool write;
+} GrrGraphAccessInfo;
+
+const GrrGraphAccessInfo graphAccesses[GRR_GRAPH_ACCESS_COUNT] = {
+    {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+     VK_IMAGE_LAYOUT_UNDEFINED, false},
+    {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+     VK_IMAGE_LAYOUT_GENERAL, false},
+    {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+     VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+     VK_IMAGE_LAYOUT_GENERAL, true},
+    {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+     VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false},
+    {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true},
+    {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true},
+    {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false},
+    {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true},
+    // The present waits for the frame's semaphore. The next frame waits for
+    // its acquire at the color attachment output stage, where this one ends
+    {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+     VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false}};
+
+#define GRR_GRAPH_WRITE_ACCESS                                                 \
+  (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |         \
+   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |                              \
+   VK_ACCESS_TRANSFER_WRITE_BIT)
+
+// Accesses to a resource since its last write (or layout transition)
+typedef struct GrrGraphState {
+  VkImageLayout layout;
+  VkPipelineStageFlags writeStages;
+  VkAccessFlags writeAccess; // Not available yet
+  VkPipelineStageFlags readStages;
+  // Where the last write is visible
+  VkPipelineStageFlags visibleStages;
+  VkAccessFlags visibleAccess;
+  Grr_bool used; // In the current frame
+} GrrGraphState;
+
+PFN_vkCmdPipelineBarrier2KHR fpCmdPipelineBarrier2 = NULL;
+
+void Grr_initializeRenderGraph(GrrRenderGraph *graph) {
+  memset(graph, 0, sizeof(GrrRenderGraph));
+}
+
+Grr_u32 _Grr_addGraphResource(GrrRenderGraph *graph, const char *name) {
+  if (graph->resourceCount == GRR_RENDER_GRAPH_MAX_RESOURCES) {
+    GRR_LOG_ERROR("Too many render graph resources (%s)\n", name);
+    return GRR_RENDER_GRAPH_NONE;
+  }
+  GrrGraphResource *resource = &graph->resources[graph->resourceCount];
+  memset(resource, 0, sizeof(GrrGraphResource));
+  resource->name = name;
+  resource->output = GRR_RENDER_GRAPH_NONE;
+  resource->firstPass = GRR_RENDER_GRAPH_NONE;
+  resource->lastPass = GRR_RENDER_GRAPH_NONE;
+  resource->slot = GRR_RENDER_GRAPH_NONE;
+  graph->compiled = false;
+  return graph->resourceCount++;
+}
+
+Grr_u32 Grr_addGraphImage(GrrRenderGraph *graph, const char *name,
+                          VkImageAspectFlags aspects, Grr_bool discard) {
+  Grr_u32 index = _Grr_addGraphResource(graph, name);
+  if (index != GRR_RENDER_GRAPH_NONE) {
+    graph->resources[index].isImage = true;
+    graph->resources[index].aspects = aspects;
+    graph->resources[index].discard = discard;
+  }
+  return index;
+}
+
+Grr_u32 Grr_addGraphBuffer(GrrRenderGraph *graph, const char *name,
+                           Grr_bool discard) {
+  Grr_u32 index = _Grr_addGraphResource(graph, name);
+  if (index != GRR_RENDER_GRAPH_NONE)
+    graph->resources[index].discard = discard;
+  return index;
+}
+
+Grr_u32 Grr_addGraphTransientImage(GrrRenderGraph *graph, const char *name,
+                                   VkExtent2D extent, VkFormat format,
+                                   VkImageUsageFlags usage,
+                                   VkImageAspectFlags aspects) {
+  Grr_u32 index = Grr_addGraphImage(graph, name, aspects, true);
+  if (index != GRR_RENDER_GRAPH_NONE) {
+    GrrGraphResource *resource = &graph->resources[index];
+    resource->transient = true;
+    resource->extent = extent;
+    resource->format = format;
+    resource->usage = usage;
+  }
+  return index;
+}
+
+Grr_bool Grr_setGraphOutput(GrrRenderGraph *graph, Grr_u32 resource,
+                            GRR_GRAPH_ACCESS access) {
+  if (resource >= graph->resourceCount || access >= GRR_GRAPH_ACCESS_COUNT)
+    return false;
+  graph->resources[resource].output = access;
+  graph->compiled = false;
+  return true;
+}
+
+Grr_u32 Grr_addGraphPass(GrrRenderGraph *graph, const char *name,
+                         GrrGraphRecorder record, void *data,
+                         GRR_GPU_REGION region, Grr_bool sideEffects) {
+  if (graph->passCount == GRR_RENDER_GRAPH_MAX_PASSES) {
+    GRR_LOG_ERROR("Too many render graph passes (%s)\n", name);
+    return GRR_RENDER_GRAPH_NONE;
+  }
+  GrrGraphPass *pass = &graph->passes[graph->passCount];
+  memset(pass, 0, sizeof(GrrGraphPass));
+  pass->name = name;
+  pass->record = record;
+  pass->data = data;
+  pass->region = region;
+  pass->sideEffects = sideEffects;
+  graph->compiled = false;
+  return graph->passCount++;
+}
+
+Grr_bool Grr_useGraphResource(GrrRenderGraph *graph, Grr_u32 pass,
+                              Grr_u32 resource, GRR_GRAPH_ACCESS access) {
+  if (pass >= graph->passCount || resource >= graph->resourceCount ||
+      access >= GRR_GRAPH_ACCESS_COUNT)
+    return false;
+  GrrGraphPass *graphPass = &graph->passes[pass];
+  const GrrGraphAccessInfo *info = &graphAccesses[access];
+  VkImageLayout layout = graph->resources[resource].isImage
+                             ? info->layout
+                             : VK_IMAGE_LAYOUT_UNDEFINED;
+  graph->compiled = false;
+
+  for (Grr_u32 i = 0; i < graphPass->useCount; i++) {
+    GrrGraphUse *use = &graphPass->uses[i];
+    if (use->resource != resource)
+      continue;
+    if (use->layout != layout) {
+      GRR_LOG_ERROR("Pass %s uses %s in two layouts\n", graphPass->name,
+                    graph->resources[resource].name);
+      return false;
+    }
+    use->stages |= info->stages;
+    use->access |= info->access;
+    use->write = use->write || info->write;
+    return true;
+  }
+
+  if (graphPass->useCount == GRR_RENDER_GRAPH_MAX_USES) {
+    GRR_LOG_ERROR("Pass %s uses too many resources\n", graphPass->name);
+    return false;
+  }
+  GrrGraphUse *use = &graphPass->uses[graphPass->useCount++];
+  use->resource = resource;
+  use->stages = info->stages;
+  use->access = info->access;
+  use->layout = layout;
+  use->write = info->write;
+  return true;
+}
+
+Grr_u32 Grr_aliasTransients(const GrrTransientLifetime *lifetimes,
+                            Grr_u32 count, Grr_u32 *slots,
+                            VkMemoryRequirements *slotRequirements) {
+  // Largest first, in declaration order for equal sizes
+  Grr_u32 order[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  if (count > GRR_RENDER_GRAPH_MAX_RESOURCES)
+    count = GRR_RENDER_GRAPH_MAX_RESOURCES;
+  for (Grr_u32 i = 0; i < count; i++) {
+    Grr_u32 j = i;
+    for (; j > 0 && lifetimes[order[j - 1]].requirements.size <
+                        lifetimes[i].requirements.size;
+         j--)
+      order[j] = order[j - 1];
+    order[j] = i;
+  }
+
+  Grr_u32 slotCount = 0;
+  for (Grr_u32 k = 0; k < count; k++) {
+    const GrrTransientLifetime *lifetime = &lifetimes[order[k]];
+    Grr_u32 slot = GRR_RENDER_GRAPH_NONE;
+    for (Grr_u32 s = 0; s < slotCount && slot == GRR_RENDER_GRAPH_NONE; s++) {
+      if (!(slotRequirements[s].memoryTypeBits &
+            lifetime->requirements.memoryTypeBits))
+        continue;
+      Grr_bool overlap = false;
+      for (Grr_u32 j = 0; j < k && !overlap; j++) {
+        const GrrTransientLifetime *other = &lifetimes[order[j]];
+        overlap = slots[order[j]] == s &&
+                  lifetime->firstPass <= other->lastPass &&
+                  other->firstPass <= lifetime->lastPass;
+      }
+      if (!overlap)
+        slot = s;
+    }
+
+    if (slot == GRR_RENDER_GRAPH_NONE) {
+      slot = slotCount++;
+      slotRequirements[slot] = lifetime->requirements;
+    } else {
+      // Transients are bound at the start of their slot
+      VkMemoryRequirements *requirements = &slotRequirements[slot];
+      if (lifetime->requirements.size > requirements->size)
+        requirements->size = lifetime->requirements.size;
+      if (lifetime->requirements.alignment > requirements->alignment)
+        requirements->alignment = lifetime->requirements.alignment;
+      requirements->memoryTypeBits &= lifetime->requirements.memoryTypeBits;
+    }
+    slots[order[k]] = slot;
+  }
+  return slotCount;
+}
+
+// A pass is kept when it has side effects, or writes what a later pass that
+// was kept reads, an output, or contents kept for the next frame
+void _Grr_cullGraphPasses(GrrRenderGraph *graph) {
+  Grr_bool needed[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+    const GrrGraphResource *resource = &graph->resources[r];
+    needed[r] = resource->output != GRR_RENDER_GRAPH_NONE || !resource->discard;
+  }
+
+  for (Grr_u32 p = graph->passCount; p-- > 0;) {
+    GrrGraphPass *pass = &graph->passes[p];
+    pass->culled = !pass->sideEffects;
+    for (Grr_u32 i = 0; i < pass->useCount && pass->culled; i++) {
+      if (pass->uses[i].write && needed[pass->uses[i].resource])
+        pass->culled = false;
+    }
+    if (pass->culled)
+      continue;
+    for (Grr_u32 i = 0; i < pass->useCount; i++) {
+      const GrrGraphUse *use = &pass->uses[i];
+      if (!use->write || (use->access & ~GRR_GRAPH_WRITE_ACCESS))
+        needed[use->resource] = true;
+    }
+  }
+}
+
+// Lifetimes over the passes that were kept, then memory slots of transients
+Grr_bool _Grr_assignGraphLifetimes(GrrRenderGraph *graph) {
+  for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+    graph->resources[r].firstPass = GRR_RENDER_GRAPH_NONE;
+    graph->resources[r].lastPass = GRR_RENDER_GRAPH_NONE;
+    graph->resources[r].slot = GRR_RENDER_GRAPH_NONE;
+  }
+  for (Grr_u32 p = 0; p < graph->passCount; p++) {
+    const GrrGraphPass *pass = &graph->passes[p];
+    for (Grr_u32 i = 0; i < pass->useCount && !pass->culled; i++) {
+      GrrGraphResource *resource = &graph->resources[pass->uses[i].resource];
+      if (resource->firstPass == GRR_RENDER_GRAPH_NONE)
+        resource->firstPass = p;
+      resource->lastPass = p;
+    }
+  }
+
+  GrrTransientLifetime lifetimes[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  Grr_u32 transients[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  Grr_u32 slots[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  Grr_u32 transientCount = 0;
+  for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+    const GrrGraphResource *resource = &graph->resources[r];
+    if (!resource->transient || resource->firstPass == GRR_RENDER_GRAPH_NONE)
+      continue;
+    if (resource->output != GRR_RENDER_GRAPH_NONE) {
+      GRR_LOG_ERROR("Transient %s can not be an output\n", resource->name);
+      return false;
+    }
+    lifetimes[transientCount].firstPass = resource->firstPass;
+    lifetimes[transientCount].lastPass = resource->lastPass;
+    lifetimes[transientCount].requirements = resource->requirements;
+    transients[transientCount++] = r;
+  }
+  graph->slotCount = Grr_aliasTransients(lifetimes, transientCount, slots,
+                                         graph->slotRequirements);
+  for (Grr_u32 i = 0; i < transientCount; i++)
+    graph->resources[transients[i]].slot = slots[i];
+  return true;
+}
+
+// Barrier before use, if it needs one, and the state of its resource after
+void _Grr_trackGraphUse(GrrRenderGraph *graph, GrrGraphState *states,
+                        VkPipelineStageFlags *slotStages,
+                        VkAccessFlags *slotAccess, const GrrGraphUse *use,
+                        Grr_bool emit) {
+  const GrrGraphResource *resource = &graph->resources[use->resource];
+  GrrGraphState *state = &states[use->resource];
+  Grr_bool first = !state->used;
+  state->used = true;
+
+  GrrGraphBarrier barrier = {0};
+  barrier.resource = use->resource;
+  barrier.dstStages = use->stages;
+  barrier.dstAccess = use->access;
+  barrier.oldLayout = first && resource->discard ? VK_IMAGE_LAYOUT_UNDEFINED
+                                                 : state->layout;
+  barrier.newLayout = use->layout;
+  Grr_bool transition =
+      resource->isImage && barrier.oldLayout != barrier.newLayout;
+
+  Grr_bool needed;
+  if (transition || use->write) {
+    // After every earlier access
+    barrier.srcStages = state->writeStages | state->readStages;
+    barrier.srcAccess = state->writeAccess;
+    if (first && resource->slot != GRR_RENDER_GRAPH_NONE) {
+      // And after the transients that used the memory before, with their
+      // writes made available
+      barrier.srcStages |= slotStages[resource->slot];
+      barrier.srcAccess |= slotAccess[resource->slot];
+      slotStages[resource->slot] = 0;
+      slotAccess[resource->slot] = 0;
+    }
+    needed = transition || barrier.srcStages != 0;
+    state->layout = use->layout;
+    state->writeStages = use->stages;
+    state->writeAccess = use->write ? use->access & GRR_GRAPH_WRITE_ACCESS : 0;
+    state->readStages = use->write ? 0 : use->stages;
+    state->visibleStages = use->write ? 0 : use->stages;
+    state->visibleAccess = use->write ? 0 : use->access;
+  } else {
+    // Reads after reads only wait for the write others waited for
+    barrier.srcStages = state->writeStages;
+    barrier.srcAccess = state->writeAccess;
+    needed = state->writeStages != 0 &&
+             ((use->stages & ~state->visibleStages) ||
+              (use->access & ~state->visibleAccess));
+    if (needed) {
+      state->visibleStages |= use->stages;
+      state->visibleAccess |= use->access;
+    }
+    state->readStages |= use->stages;
+  }
+  if (resource->slot != GRR_RENDER_GRAPH_NONE) {
+    slotStages[resource->slot] |= use->stages;
+    if (use->write)
+      slotAccess[resource->slot] |= use->access & GRR_GRAPH_WRITE_ACCESS;
+  }
+
+  if (needed && emit)
+    graph->barriers[graph->barrierCount++] = barrier;
+}
+
+void _Grr_computeGraphBarriers(GrrRenderGraph *graph) {
+  GrrGraphState states[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  VkPipelineStageFlags slotStages[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  VkAccessFlags slotAccess[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  memset(states, 0, sizeof(states));
+  memset(slotStages, 0, sizeof(slotStages));
+  memset(slotAccess, 0, sizeof(slotAccess));
+
+  // The first round starts from an idle device, the second one from the state
+  // the first round left: the one of every frame after the first
+  for (Grr_u32 round = 0; round < 2; round++) {
+    Grr_bool emit = round == 1;
+    for (Grr_u32 r = 0; r < graph->resourceCount; r++)
+      states[r].used = false;
+    graph->barrierCount = 0;
+    for (Grr_u32 p = 0; p < graph->passCount; p++) {
+      GrrGraphPass *pass = &graph->passes[p];
+      pass->firstBarrier = graph->barrierCount;
+      for (Grr_u32 i = 0; i < pass->useCount && !pass->culled; i++)
+        _Grr_trackGraphUse(graph, states, slotStages, slotAccess,
+                           &pass->uses[i], emit);
+      pass->barrierCount = graph->barrierCount - pass->firstBarrier;
+    }
+
+    graph->outputBarrier = graph->barrierCount;
+    for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+      const GrrGraphResource *resource = &graph->resources[r];
+      if (resource->output == GRR_RENDER_GRAPH_NONE)
+        continue;
+      const GrrGraphAccessInfo *info = &graphAccesses[resource->output];
+      GrrGraphUse use = {0};
+      use.resource = r;
+      use.stages = info->stages;
+      use.access = info->access;
+      use.layout = resource->isImage ? info->layout : VK_IMAGE_LAYOUT_UNDEFINED;
+      use.write = info->write;
+      _Grr_trackGraphUse(graph, states, slotStages, slotAccess, &use, emit);
+    }
+    graph->outputBarrierCount = graph->barrierCount - graph->outputBarrier;
+  }
+}
+
+Grr_bool Grr_compileRenderGraph(GrrRenderGraph *graph) {
+  graph->compiled = false;
+  if (graph->passCount == 0)
+    return false;
+  _Grr_cullGraphPasses(graph);
+  if (!_Grr_assignGraphLifetimes(graph))
+    return false;
+  _Grr_computeGraphBarriers(graph);
+  graph->compiled = true;
+  return true;
+}
+
+void _Grr_initializeRenderGraphs(Grr_bool synchronization2) {
+  if (synchronization2) {
+    fpCmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(
+        device, "vkCmdPipelineBarrier2KHR");
+  }
+}
+
+void _Grr_destroyRenderGraph(GrrRenderGraph *graph) {
+  for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+    GrrGraphResource *resource = &graph->resources[r];
+    if (resource->transient && resource->image != VK_NULL_HANDLE) {
+      _Grr_deferImage(resource->image, NULL);
+      resource->image = VK_NULL_HANDLE;
+    }
+  }
+  for (Grr_u32 s = 0; s < graph->slotCount; s++)
+    _Grr_deferMemory(&graph->slotMemory[s]);
+  graph->slotCount = 0;
+  graph->compiled = false;
+}
+
+Grr_bool _Grr_buildRenderGraph(GrrRenderGraph *graph) {
+  // Memory requirements of transients are needed to alias them
+  for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+    GrrGraphResource *resource = &graph->resources[r];
+    if (!resource->transient)
+      continue;
+    VkImageCreateInfo imageInfo = {0};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = resource->extent.width;
+    imageInfo.extent.height = resource->extent.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = resource->format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = resource->usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    if (vkCreateImage(device, &imageInfo, NULL, &resource->image) !=
+        VK_SUCCESS) {
+      GRR_LOG_ERROR("Failed to create transient image %s\n", resource->name);
+      resource->image = VK_NULL_HANDLE;
+      _Grr_destroyRenderGraph(graph);
+      return false;
+    }
+    vkGetImageMemoryRequirements(device, resource->image,
+                                 &resource->requirements);
+  }
+
+  if (!Grr_compileRenderGraph(graph)) {
+    _Grr_destroyRenderGraph(graph);
+    return false;
+  }
+
+  Grr_u32 slotCount = graph->slotCount;
+  graph->slotCount = 0;
+  for (; graph->slotCount < slotCount; graph->slotCount++) {
+    const VkMemoryRequirements *requirements =
+        &graph->slotRequirements[graph->slotCount];
+    Grr_u32 memoryTypeIndex = _Grr_findMemoryType(
+        requirements->memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (!_Grr_allocateGpuMemory(requirements, memoryTypeIndex,
+                                GRR_GPU_MEMORY_PERSISTENT, true,
+                                &graph->slotMemory[graph->slotCount])) {
+      GRR_LOG_ERROR("Failed to allocate transient memory\n");
+      _Grr_destroyRenderGraph(graph);
+      return false;
+    }
+  }
+
+  Grr_u32 transientCount = 0;
+  for (Grr_u32 r = 0; r < graph->resourceCount; r++) {
+    GrrGraphResource *resource = &graph->resources[r];
+    if (!resource->transient)
+      continue;
+    // Of culled passes only
+    if (resource->slot == GRR_RENDER_GRAPH_NONE) {
+      vkDestroyImage(device, resource->image, NULL);
+      resource->image = VK_NULL_HANDLE;
+      continue;
+    }
+    const GrrGpuAllocation *memory = &graph->slotMemory[resource->slot];
+    if (vkBindImageMemory(device, resource->image, memory->memory,
+                          memory->offset) != VK_SUCCESS) {
+      GRR_LOG_ERROR("Failed to bind transient image %s\n", resource->name);
+      _Grr_destroyRenderGraph(graph);
+      return false;
+    }
+    transientCount++;
+  }
+
+  Grr_u32 passCount = 0;
+  for (Grr_u32 p = 0; p < graph->passCount; p++)
+    passCount += !graph->passes[p].culled;
+  GRR_LOG_DEBUG("Render graph: %u of %u passes, %u barriers, %u transient "
+                "images in %u allocations\n",
+                passCount, graph->passCount, graph->barrierCount,
+                transientCount, graph->slotCount);
+  return true;
+}
+
+void _Grr_bindGraphImage(GrrRenderGraph *graph, Grr_u32 resource,
+                         VkImage image) {
+  graph->resources[resource].image = image;
+}
+
+void _Grr_bindGraphBuffer(GrrRenderGraph *graph, Grr_u32 resource,
+                          VkBuffer buffer) {
+  graph->resources[resource].buffer = buffer;
+}
+
+void _Grr_recordGraphBarriers(const GrrRenderGraph *graph,
+                              VkCommandBuffer commandBuffer, Grr_u32 first,
+                              Grr_u32 count) {
+  if (count == 0)
+    return;
+  VkImageSubresourceRange range = {0};
+  range.levelCount = VK_REMAINING_MIP_LEVELS;
+  range.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+  // A resource has at most one barrier before a pass
+  Grr_u32 imageCount = 0;
+  Grr_u32 bufferCount = 0;
+  if (fpCmdPipelineBarrier2 != NULL) {
+    VkImageMemoryBarrier2KHR images[GRR_RENDER_GRAPH_MAX_RESOURCES];
+    VkBufferMemoryBarrier2KHR buffers[GRR_RENDER_GRAPH_MAX_RESOURCES];
+    for (Grr_u32 i = first; i < first + count; i++) {
+      const GrrGraphBarrier *barrier = &graph->barriers[i];
+      const GrrGraphResource *resource = &graph->resources[barrier->resource];
+      if (resource->isImage) {
+        VkImageMemoryBarrier2KHR *image = &images[imageCount++];
+        *image = (VkImageMemoryBarrier2KHR){0};
+        image->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+        image->srcStageMask = barrier->srcStages;
+        image->srcAccessMask = barrier->srcAccess;
+        image->dstStageMask = barrier->dstStages;
+        image->dstAccessMask = barrier->dstAccess;
+        image->oldLayout = barrier->oldLayout;
+        image->newLayout = barrier->newLayout;
+        image->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image->image = resource->image;
+        image->subresourceRange = range;
+        image->subresourceRange.aspectMask = resource->aspects;
+      } else {
+        VkBufferMemoryBarrier2KHR *buffer = &buffers[bufferCount++];
+        *buffer = (VkBufferMemoryBarrier2KHR){0};
+        buffer->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+        buffer->srcStageMask = barrier->srcStages;
+        buffer->srcAccessMask = barrier->srcAccess;
+        buffer->dstStageMask = barrier->dstStages;
+        buffer->dstAccessMask = barrier->dstAccess;
+        buffer->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer->buffer = resource->buffer;
+        buffer->offset = 0;
+        buffer->size = VK_WHOLE_SIZE;
+      }
+    }
+    VkDependencyInfoKHR dependency = {0};
+    dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+    dependency.bufferMemoryBarrierCount = bufferCount;
+    dependency.pBufferMemoryBarriers = buffers;
+    dependency.imageMemoryBarrierCount = imageCount;
+    dependency.pImageMemoryBarriers = images;
+    fpCmdPipelineBarrier2(commandBuffer, &dependency);
+    return;
+  }
+
+  // Without synchronization2, the barriers share the stages of all of them
+  VkImageMemoryBarrier images[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  VkBufferMemoryBarrier buffers[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  VkPipelineStageFlags srcStages = 0;
+  VkPipelineStageFlags dstStages = 0;
+  for (Grr_u32 i = first; i < first + count; i++) {
+    const GrrGraphBarrier *barrier = &graph->barriers[i];
+    const GrrGraphResource *resource = &graph->resources[barrier->resource];
+    srcStages |= barrier->srcStages;
+    dstStages |= barrier->dstStages;
+    if (resource->isImage) {
+      VkImageMemoryBarrier *image = &images[imageCount++];
+      *image = (VkImageMemoryBarrier){0};
+      image->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      image->srcAccessMask = barrier->srcAccess;
+      image->dstAccessMask = barrier->dstAccess;
+      image->oldLayout = barrier->oldLayout;
+      image->newLayout = barrier->newLayout;
+      image->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      image->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      image->image = resource->image;
+      image->subresourceRange = range;
+      image->subresourceRange.aspectMask = resource->aspects;
+    } else {
+      VkBufferMemoryBarrier *buffer = &buffers[bufferCount++];
+      *buffer = (VkBufferMemoryBarrier){0};
+      buffer->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      buffer->srcAccessMask = barrier->srcAccess;
+      buffer->dstAccessMask = barrier->dstAccess;
+      buffer->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      buffer->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      buffer->buffer = resource->buffer;
+      buffer->offset = 0;
+      buffer->size = VK_WHOLE_SIZE;
+    }
+  }
+  vkCmdPipelineBarrier(
+      commandBuffer, srcStages ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      dstStages ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL,
+      bufferCount, buffers, imageCount, images);
+}
+
+Grr_bool _Grr_executeRenderGraph(GrrRenderGraph *graph,
+                                 VkCommandBuffer commandBuffer,
+                                 Grr_u32 frame) {
+  return _Grr_executeRenderGraphPasses(graph, commandBuffer, frame, 0,
+                                       graph->passCount);
+}
+
+Grr_bool _Grr_executeRenderGraphPasses(GrrRenderGraph *graph,
+                                       VkCommandBuffer commandBuffer,
+                                       Grr_u32 frame, Grr_u32 firstPass,
+                                       Grr_u32 lastPass) {
+  if (!graph->compiled) {
+    GRR_LOG_ERROR("Render graph is not compiled\n");
+    return false;
+  }
+  for (Grr_u32 p = firstPass; p < lastPass; p++) {
+    const GrrGraphPass *pass = &graph->passes[p];
+    if (pass->culled)
+      continue;
+    _Grr_recordGraphBarriers(graph, commandBuffer, pass->firstBarrier,
+                             pass->barrierCount);
+    if (pass->region != GRR_GPU_REGION_COUNT)
+      _Grr_beginGpuRegion(commandBuffer, frame, pass->region);
+    Grr_bool recorded = pass->record(commandBuffer, pass->data);
+    if (pass->region != GRR_GPU_REGION_COUNT)
+      _Grr_endGpuRegion(commandBuffer, frame, pass->region);
+    if (!recorded) {
+      GRR_LOG_ERROR("Failed to record pass %s\n", pass->name);
+      return false;
+    }
+  }
+  if (lastPass == graph->passCount)
+    _Grr_recordGraphBarriers(graph, commandBuffer, graph->outputBarrier,
+                             graph->outputBarrierCount);
+  return true;
+}
@@ -0,0 +1,197 @@
+#ifndef GRR_RENDERGRAPH_H
+#define GRR_RENDERGRAPH_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "profiler.h"
+#include "types.h"
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Render graph: the passes of a frame, in execution order, declare how they
+// access the resources they read and write. Compiling the graph (once) culls
+// the passes whose writes nothing reads, and turns the declared accesses into
+// the barriers between passes: reads following reads in the same layout need
+// none, and the barriers of a pass are issued in one call, with
+// vkCmdPipelineBarrier2 when VK_KHR_synchronization2 is enabled. The graph
+// repeats every frame, so the first accesses of a frame wait for the last ones
+// of the previous frame. Transient images only live within a frame and are
+// created by the graph, those used by passes that do not overlap share memory.
+// Render passes recorded by the graph leave their attachments in the layout
+// of the declared access (initialLayout and finalLayout are the same)
+
+#define GRR_RENDER_GRAPH_MAX_PASSES 16
+#define GRR_RENDER_GRAPH_MAX_RESOURCES 16
+#define GRR_RENDER_GRAPH_MAX_USES 8 // Resources per pass
+#define GRR_RENDER_GRAPH_MAX_BARRIERS                                          \
+  ((GRR_RENDER_GRAPH_MAX_PASSES + 1) * GRR_RENDER_GRAPH_MAX_RESOURCES)
+#define GRR_RENDER_GRAPH_NONE 0xFFFFFFFFu // No pass, resource or memory slot
+
+typedef enum GRR_GRAPH_ACCESS {
+  GRR_GRAPH_ACCESS_INDIRECT_READ = 0,  // Indirect draw arguments (buffers)
+  GRR_GRAPH_ACCESS_COMPUTE_READ,       // Buffers, or images in the general
+  GRR_GRAPH_ACCESS_COMPUTE_WRITE,      // layout (reads and writes)
+  GRR_GRAPH_ACCESS_DEPTH_COMPUTE_READ, // Sampled depth attachment
+  GRR_GRAPH_ACCESS_COLOR_ATTACHMENT,   // Loaded or cleared, then written
+  GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT,
+  GRR_GRAPH_ACCESS_TRANSFER_READ,
+  GRR_GRAPH_ACCESS_TRANSFER_WRITE,
+  GRR_GRAPH_ACCESS_PRESENT, // Output only
+  GRR_GRAPH_ACCESS_COUNT
+} GRR_GRAPH_ACCESS;
+
+// Access of a pass to a resource, accesses of the same pass are merged
+typedef struct GrrGraphUse {
+  Grr_u32 resource;
+  VkPipelineStageFlags stages;
+  VkAccessFlags access;
+  VkImageLayout layout; // Of images
+  Grr_bool write;
+} GrrGraphUse;
+
+typedef struct GrrGraphResource {
+  const char *name;
+  Grr_bool isImage;
+  Grr_bool transient; // Created by the graph, contents do not last a frame
+  Grr_bool discard;   // Contents are not kept from a frame to the next
+  Grr_u32 output;     // Access after the last pass, GRR_RENDER_GRAPH_NONE
+  VkImageAspectFlags aspects;
+  // Of transient images
+  VkExtent2D extent;
+  VkFormat format;
+  VkImageUsageFlags usage;
+  VkMemoryRequirements requirements;
+  // Bound before every execution, transient images are created by the graph
+  VkImage image;
+  VkBuffer buffer;
+  // Set by compilation: passes of the first and last use (none when no pass
+  // that was kept uses the resource), memory slot of transients
+  Grr_u32 firstPass;
+  Grr_u32 lastPass;
+  Grr_u32 slot;
+} GrrGraphResource;
+
+// Records the commands of a pass, false on failure
+typedef Grr_bool (*GrrGraphRecorder)(VkCommandBuffer commandBuffer,
+                                     void *data);
+
+typedef struct GrrGraphPass {
+  const char *name;
+  GrrGraphRecorder record;
+  void *data;
+  GRR_GPU_REGION region; // Timed by the profiler, GRR_GPU_REGION_COUNT
+  Grr_bool sideEffects;  // Kept even when nothing reads its writes
+  GrrGraphUse uses[GRR_RENDER_GRAPH_MAX_USES];
+  Grr_u32 useCount;
+  // Set by compilation: barriers before the pass
+  Grr_bool culled;
+  Grr_u32 firstBarrier;
+  Grr_u32 barrierCount;
+} GrrGraphPass;
+
+typedef struct GrrGraphBarrier {
+  Grr_u32 resource;
+  VkPipelineStageFlags srcStages; // 0 waits for nothing
+  VkAccessFlags srcAccess;
+  VkPipelineStageFlags dstStages;
+  VkAccessFlags dstAccess;
+  VkImageLayout oldLayout; // Of images, undefined discards the contents
+  VkImageLayout newLayout;
+} GrrGraphBarrier;
+
+// Transient image lifetime and memory, for aliasing
+typedef struct GrrTransientLifetime {
+  Grr_u32 firstPass;
+  Grr_u32 lastPass;
+  VkMemoryRequirements requirements;
+} GrrTransientLifetime;
+
+typedef struct GrrRenderGraph {
+  GrrGraphResource resources[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  Grr_u32 resourceCount;
+  GrrGraphPass passes[GRR_RENDER_GRAPH_MAX_PASSES];
+  Grr_u32 passCount;
+  GrrGraphBarrier barriers[GRR_RENDER_GRAPH_MAX_BARRIERS];
+  Grr_u32 barrierCount;
+  Grr_u32 outputBarrier; // Barriers after the last pass, to the outputs
+  Grr_u32 outputBarrierCount;
+  Grr_bool compiled;
+  // Transient memory, one allocation per slot
+  VkMemoryRequirements slotRequirements[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  GrrGpuAllocation slotMemory[GRR_RENDER_GRAPH_MAX_RESOURCES];
+  Grr_u32 slotCount;
+} GrrRenderGraph;
+
+// Empty graph
+void Grr_initializeRenderGraph(GrrRenderGraph *graph);
+
+// Resources the graph does not own: handles are bound before every execution.
+// Unless discard, an image is in the layout of its last use in the graph
+// before the first execution. Return the resource, GRR_RENDER_GRAPH_NONE when
+// the graph is full
+Grr_u32 Grr_addGraphImage(GrrRenderGraph *graph, const char *name,
+                          VkImageAspectFlags aspects, Grr_bool discard);
+Grr_u32 Grr_addGraphBuffer(GrrRenderGraph *graph, const char *name,
+                           Grr_bool discard);
+
+// Image created with the graph, its contents are discarded every frame
+Grr_u32 Grr_addGraphTransientImage(GrrRenderGraph *graph, const char *name,
+                                   VkExtent2D extent, VkFormat format,
+                                   VkImageUsageFlags usage,
+                                   VkImageAspectFlags aspects);
+
+// Read after the graph with access (presented, copied by later submissions).
+// Outputs and the resources whose contents are kept are what passes are kept
+// for
+Grr_bool Grr_setGraphOutput(GrrRenderGraph *graph, Grr_u32 resource,
+                            GRR_GRAPH_ACCESS access);
+
+// Passes execute in the order they are added. Returns the pass,
+// GRR_RENDER_GRAPH_NONE when the graph is full
+Grr_u32 Grr_addGraphPass(GrrRenderGraph *graph, const char *name,
+                         GrrGraphRecorder record, void *data,
+                         GRR_GPU_REGION region, Grr_bool sideEffects);
+
+// False when the pass uses too many resources, or an image in two layouts
+Grr_bool Grr_useGraphResource(GrrRenderGraph *graph, Grr_u32 pass,
+                              Grr_u32 resource, GRR_GRAPH_ACCESS access);
+
+// Memory slot of every transient: transients whose lifetimes do not overlap
+// and whose memory types are compatible share one, the largest first.
+// slotRequirements cover every transient of a slot. Returns the number of
+// slots
+Grr_u32 Grr_aliasTransients(const GrrTransientLifetime *lifetimes,
+                            Grr_u32 count, Grr_u32 *slots,
+                            VkMemoryRequirements *slotRequirements);
+
+// Culls passes, computes lifetimes and barriers, and assigns the memory slots
+// of transient images from their requirements. False for an empty graph
+Grr_bool Grr_compileRenderGraph(GrrRenderGraph *graph);
+
+// Called once the logical device exists, synchronization2 when
+// VK_KHR_synchronization2 is enabled
+void _Grr_initializeRenderGraphs(Grr_bool synchronization2);
+
+// Compiles the graph and creates its transient images
+Grr_bool _Grr_buildRenderGraph(GrrRenderGraph *graph);
+void _Grr_destroyRenderGraph(GrrRenderGraph *graph);
+
+void _Grr_bindGraphImage(GrrRenderGraph *graph, Grr_u32 resource,
+                         VkImage image);
+void _Grr_bindGraphBuffer(GrrRenderGraph *graph, Grr_u32 resource,
+                          VkBuffer buffer);
+
+// Records the passes that were kept with their barriers, timed for the
+// profiler as part of frame
+Grr_bool _Grr_executeRenderGraph(GrrRenderGraph *graph,
+                                 VkCommandBuffer commandBuffer, Grr_u32 frame);
+
+// Same for passes firstPass up to lastPass (excluded), the barriers to the
+// outputs follow the last pass of the graph. Frames submitted in parts record
+// consecutive ranges, in submission order on the same queue
+Grr_bool _Grr_executeRenderGraphPasses(GrrRenderGraph *graph,
+                                       VkCommandBuffer commandBuffer,
+                                       Grr_u32 frame, Grr_u32 firstPass,
+                                       Grr_u32 lastPass);
+
+#endif
@@ -1,9 +1,38 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless resources (set GRR_BINDLESS_SET, see bindless.h)
+layout(set = 1, binding = 0) uniform texture2D images[];
+layout(set = 1, binding = 1) uniform sampler samplers[];
+
+// GrrMaterial
+struct Material {
+    vec4 baseColorFactor;
+    uint baseColorImage;
+    uint baseColorSampler;
+    uint padding[2];
+};
+
+layout(std430, set = 1, binding = 3) readonly buffer Materials {
+    Material materials[];
+};
 
 layout(location = 0) in vec3 fragColor;
+layout(location = 3) in vec2 fragTextureCoordinates;
+layout(location = 4) flat in uint fragMaterialIndex;
 
 layout(location = 0) out vec4 outColor;
 
+const uint INVALID = 0xFFFFFFFFu; // GRR_BINDLESS_INVALID
+
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    Material material = materials[fragMaterialIndex];
+    vec4 color = vec4(fragColor, 1.0) * material.baseColorFactor;
+    if (material.baseColorImage != INVALID) {
+        color *= texture(
+            sampler2D(images[nonuniformEXT(material.baseColorImage)],
+                      samplers[nonuniformEXT(material.baseColorSampler)]),
+            fragTextureCoordinates);
+    }
+    outColor = color;
 }
\ No newline at end of file
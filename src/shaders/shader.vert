@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(binding = 0) uniform UniformBufferObject {
     mat4x4 model;
@@ -6,11 +7,67 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4x4 projection;
 } ubo;
 
+// Per draw data (GrrDrawConstants)
+layout(push_constant) uniform DrawConstants {
+    mat4x4 transform;
+    uint objectIndex;
+    uint materialIndex;
+    uint objectBuffer; // Bindless ID of the objects of indirect draws
+    uint instanceBuffer; // Bindless ID of the instances of instanced draws
+    uint instanceBase;   // Of the frame's instances, in vec4s
+} draw;
+
+// GrrGpuObject, read by indirect draws (see indirect.h)
+struct Object {
+    mat4x4 transform;
+    vec4 boundingSphere;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint materialIndex;
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer Objects {
+    Object objects[];
+} objectBuffers[];
+
+// GrrInstance (see instancing.h): transform columns then color, 5 vec4s. The
+// frame data buffer aliases the bindless storage buffers binding
+layout(std430, set = 1, binding = 2) readonly buffer Instances {
+    vec4 data[];
+} instanceBuffers[];
+
 layout(location = 0) in vec3 inPosition;
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 3) out vec2 fragTextureCoordinates;
+layout(location = 4) flat out uint fragMaterialIndex;
+
+const uint INVALID = 0xFFFFFFFFu; // GRR_BINDLESS_INVALID
 
 void main() {
-    gl_Position = ubo.projection * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragColor = vec3(0.0, 1.0, 1.0);
+    mat4x4 transform = draw.transform;
+    vec3 color = vec3(0.0, 1.0, 1.0);
+    fragMaterialIndex = draw.materialIndex;
+    if (draw.objectBuffer != INVALID) {
+        // First instance of indirect commands is the object index
+        Object object =
+            objectBuffers[draw.objectBuffer].objects[gl_InstanceIndex];
+        transform = object.transform;
+        fragMaterialIndex = object.materialIndex;
+    } else if (draw.instanceBuffer != INVALID) {
+        // First instance of the batch is included in gl_InstanceIndex
+        uint base = draw.instanceBase + uint(gl_InstanceIndex) * 5u;
+        uint instances = draw.instanceBuffer;
+        transform = mat4x4(instanceBuffers[instances].data[base],
+                           instanceBuffers[instances].data[base + 1u],
+                           instanceBuffers[instances].data[base + 2u],
+                           instanceBuffers[instances].data[base + 3u]);
+        color = instanceBuffers[instances].data[base + 4u].rgb;
+    }
+
+    gl_Position = ubo.projection * ubo.view * transform * ubo.model *
+                  vec4(inPosition, 1.0);
+    fragColor = color;
+    fragTextureCoordinates = vec2(0.0); // GrrVertex has none
 }
\ No newline at end of file
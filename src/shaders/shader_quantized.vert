@@ -0,0 +1,92 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Vertex shader for GrrQuantizedVertex. Positions are UNORM16 within the mesh
+// AABB: the dequantization (scale by extent, offset by minimum) is folded into
+// ubo.model on the CPU side.
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4x4 model;
+    mat4x4 view;
+    mat4x4 projection;
+} ubo;
+
+// Per draw data (GrrDrawConstants)
+layout(push_constant) uniform DrawConstants {
+    mat4x4 transform;
+    uint objectIndex;
+    uint materialIndex;
+    uint objectBuffer; // Bindless ID of the objects of indirect draws
+    uint instanceBuffer; // Bindless ID of the instances of instanced draws
+    uint instanceBase;   // Of the frame's instances, in vec4s
+} draw;
+
+// GrrGpuObject, read by indirect draws (see indirect.h)
+struct Object {
+    mat4x4 transform;
+    vec4 boundingSphere;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint materialIndex;
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer Objects {
+    Object objects[];
+} objectBuffers[];
+
+// GrrInstance (see instancing.h): transform columns then color, 5 vec4s. The
+// frame data buffer aliases the bindless storage buffers binding
+layout(std430, set = 1, binding = 2) readonly buffer Instances {
+    vec4 data[];
+} instanceBuffers[];
+
+layout(location = 0) in vec4 inPosition; // xyz: position, w: tangent sign
+layout(location = 1) in vec2 inNormal;   // Octahedral
+layout(location = 2) in vec2 inTangent;  // Octahedral
+layout(location = 3) in vec2 inTextureCoordinates;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec4 fragTangent;
+layout(location = 3) out vec2 fragTextureCoordinates;
+layout(location = 4) flat out uint fragMaterialIndex;
+
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.x += v.x >= 0.0 ? -t : t;
+    v.y += v.y >= 0.0 ? -t : t;
+    return normalize(v);
+}
+
+const uint INVALID = 0xFFFFFFFFu; // GRR_BINDLESS_INVALID
+
+void main() {
+    mat4x4 transform = draw.transform;
+    vec3 color = vec3(0.0, 1.0, 1.0);
+    fragMaterialIndex = draw.materialIndex;
+    if (draw.objectBuffer != INVALID) {
+        // First instance of indirect commands is the object index
+        Object object =
+            objectBuffers[draw.objectBuffer].objects[gl_InstanceIndex];
+        transform = object.transform;
+        fragMaterialIndex = object.materialIndex;
+    } else if (draw.instanceBuffer != INVALID) {
+        // First instance of the batch is included in gl_InstanceIndex
+        uint base = draw.instanceBase + uint(gl_InstanceIndex) * 5u;
+        uint instances = draw.instanceBuffer;
+        transform = mat4x4(instanceBuffers[instances].data[base],
+                           instanceBuffers[instances].data[base + 1u],
+                           instanceBuffers[instances].data[base + 2u],
+                           instanceBuffers[instances].data[base + 3u]);
+        color = instanceBuffers[instances].data[base + 4u].rgb;
+    }
+
+    gl_Position = ubo.projection * ubo.view * transform * ubo.model *
+                  vec4(inPosition.xyz, 1.0);
+    fragColor = color;
+    fragNormal = octahedralDecode(inNormal);
+    fragTangent = vec4(octahedralDecode(inTangent), inPosition.w * 2.0 - 1.0);
+    fragTextureCoordinates = inTextureCoordinates;
+}
@@ -0,0 +1,253 @@
+#include "sync.h"
+#include "vulkan.h"
+
+GrrTimeline timelines[GRR_QUEUE_COUNT];
+PFN_vkWaitSemaphoresKHR fpWaitSemaphoresKHR = NULL;
+PFN_vkGetSemaphoreCounterValueKHR fpGetSemaphoreCounterValueKHR = NULL;
+
+Grr_u64 Grr_advanceTimeline(GrrTimeline *timeline, Grr_u64 value) {
+  if (value > timeline->completed)
+    timeline->completed = value;
+  return timeline->completed;
+}
+
+Grr_bool Grr_timelineReached(const GrrTimeline *timeline, Grr_u64 value) {
+  return value <= timeline->completed;
+}
+
+Grr_u32 Grr_mergeTimelineWaits(GrrTimelineWait *waits, Grr_u32 count) {
+  Grr_u32 merged = 0;
+  for (Grr_u32 i = 0; i < count; i++) {
+    if (waits[i].value == 0)
+      continue;
+    Grr_u32 j = 0;
+    while (j < merged && waits[j].queue != waits[i].queue)
+      j++;
+    if (j == merged) {
+      waits[merged++] = waits[i];
+    } else {
+      if (waits[i].value > waits[j].value)
+        waits[j].value = waits[i].value;
+      waits[j].stages |= waits[i].stages;
+    }
+  }
+  return merged;
+}
+
+void _Grr_destroySync() {
+  GRR_LOG_INFO("Free queue timelines\n");
+  for (Grr_u32 q = 0; q < GRR_QUEUE_COUNT; q++) {
+    GrrTimeline *timeline = &timelines[q];
+    if (VK_NULL_HANDLE != timeline->semaphore)
+      vkDestroySemaphore(device, timeline->semaphore, NULL);
+    for (Grr_u32 i = 0; i < GRR_SYNC_MAX_PENDING; i++) {
+      if (VK_NULL_HANDLE != timeline->fences[i])
+        vkDestroyFence(device, timeline->fences[i], NULL);
+    }
+    *timeline = (GrrTimeline){0};
+  }
+}
+
+Grr_bool _Grr_createTimeline(GrrTimeline *timeline, VkQueue queue,
+                             Grr_bool timelineSemaphores) {
+  timeline->queue = queue;
+  if (VK_NULL_HANDLE == queue)
+    return true;
+
+  if (timelineSemaphores) {
+    VkSemaphoreTypeCreateInfoKHR typeInfo = {0};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo = {0};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    return vkCreateSemaphore(device, &semaphoreInfo, NULL,
+                             &timeline->semaphore) == VK_SUCCESS;
+  }
+
+  VkFenceCreateInfo fenceInfo = {0};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  for (Grr_u32 i = 0; i < GRR_SYNC_MAX_PENDING; i++) {
+    if (vkCreateFence(device, &fenceInfo, NULL, &timeline->fences[i]) !=
+        VK_SUCCESS)
+      return false;
+  }
+  return true;
+}
+
+Grr_bool _Grr_initializeSync(Grr_bool timelineSemaphores) {
+  if (timelineSemaphores) {
+    fpWaitSemaphoresKHR = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(
+        device, "vkWaitSemaphoresKHR");
+    fpGetSemaphoreCounterValueKHR =
+        (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(
+            device, "vkGetSemaphoreCounterValueKHR");
+    timelineSemaphores =
+        NULL != fpWaitSemaphoresKHR && NULL != fpGetSemaphoreCounterValueKHR;
+  }
+
+  atexit(_Grr_destroySync);
+  if (!_Grr_createTimeline(&timelines[GRR_QUEUE_GRAPHICS], graphicsQueue,
+                           timelineSemaphores) ||
+      !_Grr_createTimeline(&timelines[GRR_QUEUE_COMPUTE], computeQueue,
+                           timelineSemaphores) ||
+      !_Grr_createTimeline(&timelines[GRR_QUEUE_TRANSFER], transferQueue,
+                           timelineSemaphores))
+    return false;
+
+  GRR_LOG_DEBUG("Queue timelines with %s\n",
+                timelineSemaphores ? "timeline semaphores" : "fences");
+  return true;
+}
+
+Grr_u64 _Grr_submit(GRR_QUEUE queue, const VkSubmitInfo *submitInfo,
+                    const GrrTimelineWait *waits, Grr_u32 waitCount) {
+  GrrTimeline *timeline = &timelines[queue];
+  if (VK_NULL_HANDLE == timeline->queue) {
+    GRR_LOG_ERROR("Submission to missing queue %u\n", (Grr_u32)queue);
+    return 0;
+  }
+  GrrTimelineWait merged[GRR_SYNC_MAX_WAITS];
+  if (waitCount > GRR_SYNC_MAX_WAITS ||
+      submitInfo->waitSemaphoreCount > GRR_SYNC_MAX_WAITS ||
+      submitInfo->signalSemaphoreCount >= GRR_SYNC_MAX_WAITS) {
+    GRR_LOG_ERROR("Too many semaphores in a submission\n");
+    return 0;
+  }
+  if (waitCount > 0)
+    memcpy(merged, waits, sizeof(GrrTimelineWait) * waitCount);
+  waitCount = Grr_mergeTimelineWaits(merged, waitCount);
+
+  // Binary semaphores first, their values are ignored
+  VkSemaphore waitSemaphores[GRR_SYNC_MAX_WAITS];
+  Grr_u64 waitValues[GRR_SYNC_MAX_WAITS];
+  VkPipelineStageFlags waitStages[GRR_SYNC_MAX_WAITS];
+  Grr_u32 count = submitInfo->waitSemaphoreCount;
+  for (Grr_u32 i = 0; i < count; i++) {
+    waitSemaphores[i] = submitInfo->pWaitSemaphores[i];
+    waitValues[i] = 0;
+    waitStages[i] = submitInfo->pWaitDstStageMask[i];
+  }
+  for (Grr_u32 i = 0; i < waitCount; i++) {
+    GrrTimeline *other = &timelines[merged[i].queue];
+    if (Grr_timelineReached(other, merged[i].value))
+      continue;
+    if (VK_NULL_HANDLE == other->semaphore) {
+      // Fences are only visible to the host
+      _Grr_waitTimeline(merged[i].queue, merged[i].value);
+      continue;
+    }
+    if (count == GRR_SYNC_MAX_WAITS) {
+      GRR_LOG_ERROR("Too many semaphores in a submission\n");
+      return 0;
+    }
+    waitSemaphores[count] = other->semaphore;
+    waitValues[count] = merged[i].value;
+    waitStages[count] = merged[i].stages;
+    count++;
+  }
+
+  Grr_u64 value = timeline->submitted + 1;
+  VkSemaphore signalSemaphores[GRR_SYNC_MAX_WAITS];
+  Grr_u64 signalValues[GRR_SYNC_MAX_WAITS];
+  Grr_u32 signalCount = submitInfo->signalSemaphoreCount;
+  for (Grr_u32 i = 0; i < signalCount; i++) {
+    signalSemaphores[i] = submitInfo->pSignalSemaphores[i];
+    signalValues[i] = 0;
+  }
+
+  VkSubmitInfo info = *submitInfo;
+  VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {0};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+  VkFence fence = VK_NULL_HANDLE;
+  if (VK_NULL_HANDLE != timeline->semaphore) {
+    signalSemaphores[signalCount] = timeline->semaphore;
+    signalValues[signalCount] = value;
+    signalCount++;
+    timelineInfo.pNext = submitInfo->pNext;
+    timelineInfo.waitSemaphoreValueCount = count;
+    timelineInfo.pWaitSemaphoreValues = &waitValues[0];
+    timelineInfo.signalSemaphoreValueCount = signalCount;
+    timelineInfo.pSignalSemaphoreValues = &signalValues[0];
+    info.pNext = &timelineInfo;
+  } else {
+    // The fence was last signaled by the submission GRR_SYNC_MAX_PENDING
+    // values before
+    if (value > GRR_SYNC_MAX_PENDING)
+      _Grr_waitTimeline(queue, value - GRR_SYNC_MAX_PENDING);
+    fence = timeline->fences[value % GRR_SYNC_MAX_PENDING];
+    vkResetFences(device, 1, &fence);
+  }
+  info.waitSemaphoreCount = count;
+  info.pWaitSemaphores = &waitSemaphores[0];
+  info.pWaitDstStageMask = &waitStages[0];
+  info.signalSemaphoreCount = signalCount;
+  info.pSignalSemaphores = &signalSemaphores[0];
+
+  if (vkQueueSubmit(timeline->queue, 1, &info, fence) != VK_SUCCESS)
+    return 0;
+  timeline->submitted = value;
+  return value;
+}
+
+Grr_u64 _Grr_submittedValue(GRR_QUEUE queue) {
+  return timelines[queue].submitted;
+}
+
+Grr_bool _Grr_gpuTimelineWaits(GRR_QUEUE queue) {
+  return VK_NULL_HANDLE != timelines[queue].semaphore;
+}
+
+Grr_u64 _Grr_completedValue(GRR_QUEUE queue) {
+  GrrTimeline *timeline = &timelines[queue];
+  if (VK_NULL_HANDLE != timeline->semaphore) {
+    Grr_u64 value = 0;
+    if (fpGetSemaphoreCounterValueKHR(device, timeline->semaphore, &value) ==
+        VK_SUCCESS)
+      Grr_advanceTimeline(timeline, value);
+    return timeline->completed;
+  }
+
+  // Fences of the pending values, which complete in order
+  while (timeline->completed < timeline->submitted) {
+    Grr_u64 value = timeline->completed + 1;
+    if (vkGetFenceStatus(device,
+                         timeline->fences[value % GRR_SYNC_MAX_PENDING]) !=
+        VK_SUCCESS)
+      break;
+    Grr_advanceTimeline(timeline, value);
+  }
+  return timeline->completed;
+}
+
+Grr_bool _Grr_timelineComplete(GRR_QUEUE queue, Grr_u64 value) {
+  return Grr_timelineReached(&timelines[queue], value) ||
+         value <= _Grr_completedValue(queue);
+}
+
+void _Grr_waitTimeline(GRR_QUEUE queue, Grr_u64 value) {
+  GrrTimeline *timeline = &timelines[queue];
+  if (Grr_timelineReached(timeline, value))
+    return;
+  if (value > timeline->submitted) {
+    GRR_LOG_ERROR("Wait for value %llu of queue %u, never submitted\n",
+                  (unsigned long long)value, (Grr_u32)queue);
+    return;
+  }
+
+  if (VK_NULL_HANDLE != timeline->semaphore) {
+    VkSemaphoreWaitInfoKHR waitInfo = {0};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline->semaphore;
+    waitInfo.pValues = &value;
+    if (fpWaitSemaphoresKHR(device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+      return;
+  } else if (vkWaitForFences(device, 1,
+                             &timeline->fences[value % GRR_SYNC_MAX_PENDING],
+                             VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+    return;
+  }
+  Grr_advanceTimeline(timeline, value);
+}
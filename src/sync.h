@@ -0,0 +1,77 @@
+#ifndef GRR_SYNC_H
+#define GRR_SYNC_H
+
+#include "logging.h"
+#include "types.h"
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Queue synchronization: every queue has a timeline, a value that grows by one
+// with every submission to the queue and that the submission signals once its
+// commands are complete (a signal covers every earlier submission of the
+// queue). Submissions wait for values of other queues on the GPU, and the host
+// polls or waits for values instead of fences. With VK_KHR_timeline_semaphore
+// a timeline is a timeline semaphore. Without it, a fence per recent
+// submission stands in for the semaphore, and waits across queues block the
+// host before submitting. Swapchain images are still acquired and presented
+// with binary semaphores
+
+#define GRR_SYNC_MAX_PENDING 16 // Submissions per queue tracked by fences
+#define GRR_SYNC_MAX_WAITS 4    // Semaphores a submission waits for
+
+typedef enum GRR_QUEUE {
+  GRR_QUEUE_GRAPHICS = 0,
+  GRR_QUEUE_COMPUTE,
+  GRR_QUEUE_TRANSFER,
+  GRR_QUEUE_COUNT
+} GRR_QUEUE;
+
+typedef struct GrrTimeline {
+  VkQueue queue;         // VK_NULL_HANDLE when the device has none
+  VkSemaphore semaphore; // Timeline semaphore, VK_NULL_HANDLE without them
+  VkFence fences[GRR_SYNC_MAX_PENDING]; // Without: of value % MAX_PENDING
+  Grr_u64 submitted;                    // Value of the last submission
+  Grr_u64 completed;                    // Last value known to be reached
+} GrrTimeline;
+
+// Wait of a submission for a value of the timeline of queue
+typedef struct GrrTimelineWait {
+  GRR_QUEUE queue;
+  Grr_u64 value;
+  VkPipelineStageFlags stages; // Of the submission, that wait
+} GrrTimelineWait;
+
+// Records that the timeline reached value, values never go back. Returns the
+// completed value
+Grr_u64 Grr_advanceTimeline(GrrTimeline *timeline, Grr_u64 value);
+
+// Known to be reached, without asking the device. Value 0 always is
+Grr_bool Grr_timelineReached(const GrrTimeline *timeline, Grr_u64 value);
+
+// Merges the waits for the same queue (the largest value, the stages of all
+// of them) and drops the waits for value 0. Returns the number of waits left
+Grr_u32 Grr_mergeTimelineWaits(GrrTimelineWait *waits, Grr_u32 count);
+
+// Called once the logical device and queues exist, timelineSemaphores when
+// VK_KHR_timeline_semaphore is enabled
+Grr_bool _Grr_initializeSync(Grr_bool timelineSemaphores);
+
+// Submits submitInfo (without a fence) to queue once the waits are reached,
+// and signals the next value of its timeline. Semaphores of submitInfo are
+// binary ones. Returns the value, 0 on failure
+Grr_u64 _Grr_submit(GRR_QUEUE queue, const VkSubmitInfo *submitInfo,
+                    const GrrTimelineWait *waits, Grr_u32 waitCount);
+
+// Value of the last submission to queue
+Grr_u64 _Grr_submittedValue(GRR_QUEUE queue);
+
+// Submissions wait for the values of queue on the GPU (timeline semaphores)
+Grr_bool _Grr_gpuTimelineWaits(GRR_QUEUE queue);
+
+// Polls the device without blocking
+Grr_bool _Grr_timelineComplete(GRR_QUEUE queue, Grr_u64 value);
+Grr_u64 _Grr_completedValue(GRR_QUEUE queue);
+
+void _Grr_waitTimeline(GRR_QUEUE queue, Grr_u64 value);
+
+#endif
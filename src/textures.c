@@ -0,0 +1,734 @@
+#include "textures.h"
+
+#define GRR_BC_MAX_PALETTE 16
+
+// Block texels in SoA form: channel c of texel i is texels[c][i]
+typedef struct _GrrBCBlock {
+  Grr_f32 texels[4][16];
+} _GrrBCBlock;
+
+void _Grr_bcLoadBlock(const Grr_byte *pixels, _GrrBCBlock *block) {
+  for (Grr_u32 i = 0; i < 16; i++)
+    for (Grr_u32 c = 0; c < 4; c++)
+      block->texels[c][i] = pixels[i * 4 + c];
+}
+
+// Picks the closest palette entry for every texel of channels [first, first +
+// channelCount), 4 texels at a time. Returns the total squared error
+Grr_f32 _Grr_bcSelectIndices(const _GrrBCBlock *block, Grr_u32 first,
+                             Grr_u32 channelCount,
+                             Grr_f32 palette[GRR_BC_MAX_PALETTE][4],
+                             Grr_u32 paletteCount, Grr_byte *indices) {
+  GrrF32x4 error = Grr_f32x4Splat(0.0f);
+  Grr_i32 best[4];
+  for (Grr_u32 i = 0; i < 16; i += 4) {
+    GrrF32x4 texels[4];
+    for (Grr_u32 c = 0; c < channelCount; c++)
+      texels[c] = Grr_f32x4Load(&block->texels[first + c][i]);
+
+    GrrF32x4 bestError = Grr_f32x4Splat(INFINITY);
+    GrrF32x4 bestIndex = Grr_f32x4Splat(0.0f);
+    for (Grr_u32 j = 0; j < paletteCount; j++) {
+      GrrF32x4 distance = Grr_f32x4Splat(0.0f);
+      for (Grr_u32 c = 0; c < channelCount; c++) {
+        GrrF32x4 d =
+            Grr_f32x4Sub(texels[c], Grr_f32x4Splat(palette[j][c]));
+        distance = Grr_f32x4Add(distance, Grr_f32x4Mul(d, d));
+      }
+      bestIndex = Grr_f32x4SelectLess(distance, bestError,
+                                      Grr_f32x4Splat((Grr_f32)j), bestIndex);
+      bestError = Grr_f32x4Min(distance, bestError);
+    }
+
+    Grr_i32x4Store(best, Grr_f32x4RoundToI32(bestIndex));
+    for (Grr_u32 k = 0; k < 4; k++)
+      indices[i + k] = (Grr_byte)best[k];
+    error = Grr_f32x4Add(error, bestError);
+  }
+  return Grr_f32x4Sum(error);
+}
+
+// Endpoints at the extremes of the texels projected on the block's principal
+// axis: the bounding box diagonal for the fast preset, refined with power
+// iterations on the covariance matrix for the high quality preset
+void _Grr_bcFitEndpoints(const _GrrBCBlock *block, Grr_u32 first,
+                         Grr_u32 channelCount, GRR_BC_QUALITY quality,
+                         Grr_f32 *e0, Grr_f32 *e1) {
+  GrrF32x4 centered[4][4]; // [channel][group of 4 texels]
+  Grr_f32 mean[4], axis[4];
+  Grr_u32 dominant = 0;
+
+  for (Grr_u32 c = 0; c < channelCount; c++) {
+    const Grr_f32 *texels = block->texels[first + c];
+    GrrF32x4 sum = Grr_f32x4Splat(0.0f);
+    GrrF32x4 lo = Grr_f32x4Splat(INFINITY);
+    GrrF32x4 hi = Grr_f32x4Splat(-INFINITY);
+    for (Grr_u32 g = 0; g < 4; g++) {
+      GrrF32x4 v = Grr_f32x4Load(texels + g * 4);
+      sum = Grr_f32x4Add(sum, v);
+      lo = Grr_f32x4Min(lo, v);
+      hi = Grr_f32x4Max(hi, v);
+    }
+    mean[c] = Grr_f32x4Sum(sum) / 16.0f;
+
+    // Range of the whole block, not of each column
+    axis[c] = Grr_f32x4MaxLane(hi) - Grr_f32x4MinLane(lo);
+    if (axis[c] > axis[dominant])
+      dominant = c;
+
+    GrrF32x4 m = Grr_f32x4Splat(mean[c]);
+    for (Grr_u32 g = 0; g < 4; g++)
+      centered[c][g] = Grr_f32x4Sub(Grr_f32x4Load(texels + g * 4), m);
+  }
+
+  // Covariance matrix (upper triangle)
+  Grr_f32 covariance[4][4] = {{0}};
+  for (Grr_u32 a = 0; a < channelCount; a++) {
+    for (Grr_u32 b = a; b < channelCount; b++) {
+      GrrF32x4 sum = Grr_f32x4Splat(0.0f);
+      for (Grr_u32 g = 0; g < 4; g++)
+        sum = Grr_f32x4Add(sum, Grr_f32x4Mul(centered[a][g], centered[b][g]));
+      covariance[a][b] = covariance[b][a] = Grr_f32x4Sum(sum);
+    }
+  }
+
+  // Orient the bounding box diagonal along the dominant channel's covariance
+  for (Grr_u32 c = 0; c < channelCount; c++)
+    if (covariance[dominant][c] < 0.0f)
+      axis[c] = -axis[c];
+
+  if (quality == GRR_BC_QUALITY_HIGH) {
+    for (Grr_u32 iteration = 0; iteration < 8; iteration++) {
+      Grr_f32 next[4] = {0};
+      Grr_f32 length = 0.0f;
+      for (Grr_u32 a = 0; a < channelCount; a++) {
+        for (Grr_u32 b = 0; b < channelCount; b++)
+          next[a] += covariance[a][b] * axis[b];
+        length = fmaxf(length, fabsf(next[a]));
+      }
+      if (length < 1e-6f)
+        break;
+      for (Grr_u32 c = 0; c < channelCount; c++)
+        axis[c] = next[c] / length;
+    }
+  }
+
+  Grr_f32 length2 = 0.0f;
+  for (Grr_u32 c = 0; c < channelCount; c++)
+    length2 += axis[c] * axis[c];
+  if (length2 < 1e-6f) { // Flat block
+    for (Grr_u32 c = 0; c < channelCount; c++)
+      e0[c] = e1[c] = mean[c];
+    return;
+  }
+
+  // Extremes of the projections
+  GrrF32x4 lo = Grr_f32x4Splat(INFINITY);
+  GrrF32x4 hi = Grr_f32x4Splat(-INFINITY);
+  for (Grr_u32 g = 0; g < 4; g++) {
+    GrrF32x4 t = Grr_f32x4Splat(0.0f);
+    for (Grr_u32 c = 0; c < channelCount; c++)
+      t = Grr_f32x4Add(t,
+                       Grr_f32x4Mul(centered[c][g], Grr_f32x4Splat(axis[c])));
+    lo = Grr_f32x4Min(lo, t);
+    hi = Grr_f32x4Max(hi, t);
+  }
+  Grr_f32 tMin = Grr_f32x4MinLane(lo);
+  Grr_f32 tMax = Grr_f32x4MaxLane(hi);
+
+  for (Grr_u32 c = 0; c < channelCount; c++) {
+    e0[c] = fminf(fmaxf(mean[c] + axis[c] * tMin / length2, 0.0f), 255.0f);
+    e1[c] = fminf(fmaxf(mean[c] + axis[c] * tMax / length2, 0.0f), 255.0f);
+  }
+}
+
+// Least squares endpoints for fixed indices. weights[i] is the interpolation
+// weight of palette entry i towards e1. Returns false for degenerate systems
+Grr_bool _Grr_bcRefineEndpoints(const _GrrBCBlock *block, Grr_u32 first,
+                                Grr_u32 channelCount, const Grr_byte *indices,
+                                const Grr_f32 *weights, Grr_f32 *e0,
+                                Grr_f32 *e1) {
+  Grr_f32 a = 0.0f, b = 0.0f, c = 0.0f;
+  Grr_f32 x[4] = {0}, y[4] = {0};
+  for (Grr_u32 i = 0; i < 16; i++) {
+    Grr_f32 w = weights[indices[i]];
+    a += (1.0f - w) * (1.0f - w);
+    b += (1.0f - w) * w;
+    c += w * w;
+    for (Grr_u32 k = 0; k < channelCount; k++) {
+      x[k] += (1.0f - w) * block->texels[first + k][i];
+      y[k] += w * block->texels[first + k][i];
+    }
+  }
+
+  Grr_f32 determinant = a * c - b * b;
+  if (fabsf(determinant) < 1e-6f)
+    return false;
+  for (Grr_u32 k = 0; k < channelCount; k++) {
+    e0[k] = fminf(fmaxf((c * x[k] - b * y[k]) / determinant, 0.0f), 255.0f);
+    e1[k] = fminf(fmaxf((a * y[k] - b * x[k]) / determinant, 0.0f), 255.0f);
+  }
+  return true;
+}
+
+// BC1 color block
+
+Grr_u16 _Grr_bcPack565(const Grr_f32 *color) {
+  Grr_u16 r = (Grr_u16)lrintf(color[0] * 31.0f / 255.0f);
+  Grr_u16 g = (Grr_u16)lrintf(color[1] * 63.0f / 255.0f);
+  Grr_u16 b = (Grr_u16)lrintf(color[2] * 31.0f / 255.0f);
+  return (r << 11) | (g << 5) | b;
+}
+
+void _Grr_bcUnpack565(Grr_u16 packed, Grr_f32 *color) {
+  Grr_u32 r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+  color[0] = (Grr_f32)((r << 3) | (r >> 2));
+  color[1] = (Grr_f32)((g << 2) | (g >> 4));
+  color[2] = (Grr_f32)((b << 3) | (b >> 2));
+}
+
+// Orders endpoints for the 4 color mode (color0 > color1) and selects indices
+Grr_f32 _Grr_bcEvaluateColor(const _GrrBCBlock *block, Grr_u16 *color0,
+                             Grr_u16 *color1, Grr_byte *indices) {
+  static const Grr_f32 weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+  if (*color0 < *color1) {
+    Grr_u16 swap = *color0;
+    *color0 = *color1;
+    *color1 = swap;
+  }
+
+  Grr_f32 palette[GRR_BC_MAX_PALETTE][4];
+  _Grr_bcUnpack565(*color0, palette[0]);
+  _Grr_bcUnpack565(*color1, palette[1]);
+  if (*color0 == *color1) // Single color, every index 0
+    return _Grr_bcSelectIndices(block, 0, 3, palette, 1, indices);
+
+  for (Grr_u32 j = 2; j < 4; j++)
+    for (Grr_u32 c = 0; c < 3; c++)
+      palette[j][c] = palette[0][c] * (1.0f - weights[j]) +
+                      palette[1][c] * weights[j];
+  return _Grr_bcSelectIndices(block, 0, 3, palette, 4, indices);
+}
+
+void _Grr_bcEncodeColor(const _GrrBCBlock *block, GRR_BC_QUALITY quality,
+                        Grr_byte *out) {
+  static const Grr_f32 weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+  Grr_f32 e0[4], e1[4];
+  _Grr_bcFitEndpoints(block, 0, 3, quality, e0, e1);
+
+  Grr_u16 bestColor0 = 0, bestColor1 = 0;
+  Grr_byte bestIndices[16] = {0};
+  Grr_f32 bestError = INFINITY;
+  Grr_u32 iterations = (quality == GRR_BC_QUALITY_HIGH ? 3 : 1);
+  for (Grr_u32 iteration = 0; iteration < iterations; iteration++) {
+    Grr_u16 color0 = _Grr_bcPack565(e1);
+    Grr_u16 color1 = _Grr_bcPack565(e0);
+    Grr_byte indices[16];
+    Grr_f32 error = _Grr_bcEvaluateColor(block, &color0, &color1, indices);
+    if (error < bestError) {
+      bestError = error;
+      bestColor0 = color0;
+      bestColor1 = color1;
+      memcpy(bestIndices, indices, sizeof(indices));
+    }
+    // Refined e1 maps to color0 (weight 0) on the next pass
+    if (iteration + 1 == iterations ||
+        !_Grr_bcRefineEndpoints(block, 0, 3, indices, weights, e1, e0))
+      break;
+  }
+
+  Grr_u32 bits = 0;
+  for (Grr_u32 i = 0; i < 16; i++)
+    bits |= (Grr_u32)bestIndices[i] << (i * 2);
+  out[0] = bestColor0 & 0xFF;
+  out[1] = bestColor0 >> 8;
+  out[2] = bestColor1 & 0xFF;
+  out[3] = bestColor1 >> 8;
+  for (Grr_u32 i = 0; i < 4; i++)
+    out[4 + i] = (Grr_byte)(bits >> (i * 8));
+}
+
+// BC4 single channel block (8 value mode)
+
+Grr_f32 _Grr_bcEvaluateChannel(const _GrrBCBlock *block, Grr_u32 channel,
+                               Grr_byte *value0, Grr_byte *value1,
+                               Grr_byte *indices) {
+  if (*value0 < *value1) {
+    Grr_byte swap = *value0;
+    *value0 = *value1;
+    *value1 = swap;
+  }
+
+  Grr_f32 palette[GRR_BC_MAX_PALETTE][4];
+  palette[0][0] = *value0;
+  palette[1][0] = *value1;
+  if (*value0 == *value1) // 6 value mode with every index 0
+    return _Grr_bcSelectIndices(block, channel, 1, palette, 1, indices);
+
+  for (Grr_u32 j = 2; j < 8; j++)
+    palette[j][0] = ((8 - j) * palette[0][0] + (j - 1) * palette[1][0]) / 7.0f;
+  return _Grr_bcSelectIndices(block, channel, 1, palette, 8, indices);
+}
+
+void _Grr_bcEncodeChannel(const _GrrBCBlock *block, Grr_u32 channel,
+                          GRR_BC_QUALITY quality, Grr_byte *out) {
+  static const Grr_f32 weights[8] = {0.0f,        1.0f,        1.0f / 7.0f,
+                                     2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f,
+                                     5.0f / 7.0f, 6.0f / 7.0f};
+  Grr_f32 e0, e1;
+  _Grr_bcFitEndpoints(block, channel, 1, GRR_BC_QUALITY_FAST, &e0, &e1);
+
+  Grr_byte bestValue0 = 0, bestValue1 = 0;
+  Grr_byte bestIndices[16] = {0};
+  Grr_f32 bestError = INFINITY;
+  Grr_u32 iterations = (quality == GRR_BC_QUALITY_HIGH ? 3 : 1);
+  for (Grr_u32 iteration = 0; iteration < iterations; iteration++) {
+    Grr_byte value0 = (Grr_byte)lrintf(e1);
+    Grr_byte value1 = (Grr_byte)lrintf(e0);
+    Grr_byte indices[16];
+    Grr_f32 error =
+        _Grr_bcEvaluateChannel(block, channel, &value0, &value1, indices);
+    if (error < bestError) {
+      bestError = error;
+      bestValue0 = value0;
+      bestValue1 = value1;
+      memcpy(bestIndices, indices, sizeof(indices));
+    }
+    if (iteration + 1 == iterations ||
+        !_Grr_bcRefineEndpoints(block, channel, 1, indices, weights, &e1,
+                                &e0))
+      break;
+  }
+
+  Grr_u64 bits = 0;
+  for (Grr_u32 i = 0; i < 16; i++)
+    bits |= (Grr_u64)bestIndices[i] << (i * 3);
+  out[0] = bestValue0;
+  out[1] = bestValue1;
+  for (Grr_u32 i = 0; i < 6; i++)
+    out[2 + i] = (Grr_byte)(bits >> (i * 8));
+}
+
+// BC7 mode 6: single subset, RGBA 7-bit endpoints with a p-bit each, 4-bit
+// indices
+
+static const Grr_u32 bc7Weights[16] = {0,  4,  9,  13, 17, 21, 26, 30,
+                                       34, 38, 43, 47, 51, 55, 60, 64};
+
+// Quantizes an endpoint to 7 bits per channel + shared p-bit
+void _Grr_bc7QuantizeEndpoint(const Grr_f32 *endpoint, Grr_byte *quantized,
+                              Grr_byte *pBit) {
+  Grr_f32 bestError = INFINITY;
+  for (Grr_byte p = 0; p < 2; p++) {
+    Grr_byte q[4];
+    Grr_f32 error = 0.0f;
+    for (Grr_u32 c = 0; c < 4; c++) {
+      Grr_i32 v = (Grr_i32)lrintf((endpoint[c] - p) / 2.0f);
+      q[c] = (Grr_byte)(v < 0 ? 0 : (v > 127 ? 127 : v));
+      Grr_f32 d = (Grr_f32)((q[c] << 1) | p) - endpoint[c];
+      error += d * d;
+    }
+    if (error < bestError) {
+      bestError = error;
+      memcpy(quantized, q, 4);
+      *pBit = p;
+    }
+  }
+}
+
+Grr_f32 _Grr_bc7Evaluate(const _GrrBCBlock *block, const Grr_byte *q0,
+                         Grr_byte p0, const Grr_byte *q1, Grr_byte p1,
+                         Grr_byte *indices) {
+  Grr_f32 palette[GRR_BC_MAX_PALETTE][4];
+  for (Grr_u32 c = 0; c < 4; c++) {
+    Grr_u32 a = (q0[c] << 1) | p0;
+    Grr_u32 b = (q1[c] << 1) | p1;
+    for (Grr_u32 j = 0; j < 16; j++)
+      palette[j][c] =
+          (Grr_f32)(((64 - bc7Weights[j]) * a + bc7Weights[j] * b + 32) >> 6);
+  }
+  return _Grr_bcSelectIndices(block, 0, 4, palette, 16, indices);
+}
+
+void _Grr_bc7PutBits(Grr_byte *out, Grr_u32 *position, Grr_u32 value,
+                     Grr_u32 count) {
+  for (Grr_u32 i = 0; i < count; i++, (*position)++)
+    out[*position >> 3] |= ((value >> i) & 1) << (*position & 7);
+}
+
+void _Grr_bc7EncodeBlock(const _GrrBCBlock *block, GRR_BC_QUALITY quality,
+                         Grr_byte *out) {
+  Grr_f32 weights[16];
+  for (Grr_u32 j = 0; j < 16; j++)
+    weights[j] = bc7Weights[j] / 64.0f;
+
+  Grr_f32 e0[4], e1[4];
+  _Grr_bcFitEndpoints(block, 0, 4, quality, e0, e1);
+
+  Grr_byte bestQ0[4] = {0}, bestQ1[4] = {0}, bestP0 = 0, bestP1 = 0;
+  Grr_byte bestIndices[16] = {0};
+  Grr_f32 bestError = INFINITY;
+  Grr_u32 iterations = (quality == GRR_BC_QUALITY_HIGH ? 3 : 1);
+  for (Grr_u32 iteration = 0; iteration < iterations; iteration++) {
+    Grr_byte q0[4], q1[4], p0, p1;
+    _Grr_bc7QuantizeEndpoint(e0, q0, &p0);
+    _Grr_bc7QuantizeEndpoint(e1, q1, &p1);
+    Grr_byte indices[16];
+    Grr_f32 error = _Grr_bc7Evaluate(block, q0, p0, q1, p1, indices);
+    if (error < bestError) {
+      bestError = error;
+      memcpy(bestQ0, q0, 4);
+      memcpy(bestQ1, q1, 4);
+      bestP0 = p0;
+      bestP1 = p1;
+      memcpy(bestIndices, indices, sizeof(indices));
+    }
+    if (iteration + 1 == iterations ||
+        !_Grr_bcRefineEndpoints(block, 0, 4, indices, weights, e0, e1))
+      break;
+  }
+
+  // The anchor (first) index is stored without its most significant bit
+  if (bestIndices[0] >= 8) {
+    Grr_byte q[4], p = bestP0;
+    memcpy(q, bestQ0, 4);
+    memcpy(bestQ0, bestQ1, 4);
+    memcpy(bestQ1, q, 4);
+    bestP0 = bestP1;
+    bestP1 = p;
+    for (Grr_u32 i = 0; i < 16; i++)
+      bestIndices[i] = 15 - bestIndices[i];
+  }
+
+  memset(out, 0, 16);
+  Grr_u32 position = 0;
+  _Grr_bc7PutBits(out, &position, 1 << 6, 7); // Mode 6
+  for (Grr_u32 c = 0; c < 4; c++) {
+    _Grr_bc7PutBits(out, &position, bestQ0[c], 7);
+    _Grr_bc7PutBits(out, &position, bestQ1[c], 7);
+  }
+  _Grr_bc7PutBits(out, &position, bestP0, 1);
+  _Grr_bc7PutBits(out, &position, bestP1, 1);
+  _Grr_bc7PutBits(out, &position, bestIndices[0], 3);
+  for (Grr_u32 i = 1; i < 16; i++)
+    _Grr_bc7PutBits(out, &position, bestIndices[i], 4);
+}
+
+void Grr_encodeBC1Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block) {
+  _GrrBCBlock texels;
+  _Grr_bcLoadBlock(pixels, &texels);
+  _Grr_bcEncodeColor(&texels, quality, block);
+}
+
+void Grr_encodeBC3Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block) {
+  _GrrBCBlock texels;
+  _Grr_bcLoadBlock(pixels, &texels);
+  _Grr_bcEncodeChannel(&texels, 3, quality, block);
+  _Grr_bcEncodeColor(&texels, quality, block + 8);
+}
+
+void Grr_encodeBC4Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block) {
+  _GrrBCBlock texels;
+  _Grr_bcLoadBlock(pixels, &texels);
+  _Grr_bcEncodeChannel(&texels, 0, quality, block);
+}
+
+void Grr_encodeBC5Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block) {
+  _GrrBCBlock texels;
+  _Grr_bcLoadBlock(pixels, &texels);
+  _Grr_bcEncodeChannel(&texels, 0, quality, block);
+  _Grr_bcEncodeChannel(&texels, 1, quality, block + 8);
+}
+
+void Grr_encodeBC7Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block) {
+  _GrrBCBlock texels;
+  _Grr_bcLoadBlock(pixels, &texels);
+  _Grr_bc7EncodeBlock(&texels, quality, block);
+}
+
+Grr_u32 Grr_bcBlockBytes(GRR_BC_FORMAT format) {
+  return (format == GRR_BC1 || format == GRR_BC4 ? 8 : 16);
+}
+
+size_t Grr_bcImageBytes(GRR_BC_FORMAT format, Grr_u32 width, Grr_u32 height) {
+  return (size_t)((width + 3) / 4) * ((height + 3) / 4) *
+         Grr_bcBlockBytes(format);
+}
+
+VkFormat Grr_bcVkFormat(GRR_BC_FORMAT format, Grr_bool srgb) {
+  switch (format) {
+  case GRR_BC1:
+    return (srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK
+                 : VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+  case GRR_BC3:
+    return (srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK);
+  case GRR_BC4:
+    return VK_FORMAT_BC4_UNORM_BLOCK;
+  case GRR_BC5:
+    return VK_FORMAT_BC5_UNORM_BLOCK;
+  case GRR_BC7:
+    return (srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK);
+  }
+  return VK_FORMAT_UNDEFINED;
+}
+
+typedef struct _GrrBCJob {
+  const Grr_byte *rgba;
+  Grr_u32 width;
+  Grr_u32 height;
+  GRR_BC_FORMAT format;
+  GRR_BC_QUALITY quality;
+  Grr_byte *blocks;
+} _GrrBCJob;
+
+// Encodes one row of blocks
+void _Grr_encodeBCRow(void *data, Grr_u32 row, Grr_u32 threadIndex) {
+  const _GrrBCJob *job = (const _GrrBCJob *)data;
+  Grr_u32 blocksX = (job->width + 3) / 4;
+  Grr_u32 blockBytes = Grr_bcBlockBytes(job->format);
+  Grr_byte pixels[16 * 4];
+
+  for (Grr_u32 bx = 0; bx < blocksX; bx++) {
+    for (Grr_u32 y = 0; y < 4; y++) {
+      Grr_u32 sy = row * 4 + y;
+      sy = (sy < job->height ? sy : job->height - 1);
+      for (Grr_u32 x = 0; x < 4; x++) {
+        Grr_u32 sx = bx * 4 + x;
+        sx = (sx < job->width ? sx : job->width - 1);
+        memcpy(&pixels[(y * 4 + x) * 4],
+               &job->rgba[((size_t)sy * job->width + sx) * 4], 4);
+      }
+    }
+
+    Grr_byte *block =
+        job->blocks + ((size_t)row * blocksX + bx) * blockBytes;
+    switch (job->format) {
+    case GRR_BC1:
+      Grr_encodeBC1Block(pixels, job->quality, block);
+      break;
+    case GRR_BC3:
+      Grr_encodeBC3Block(pixels, job->quality, block);
+      break;
+    case GRR_BC4:
+      Grr_encodeBC4Block(pixels, job->quality, block);
+      break;
+    case GRR_BC5:
+      Grr_encodeBC5Block(pixels, job->quality, block);
+      break;
+    case GRR_BC7:
+      Grr_encodeBC7Block(pixels, job->quality, block);
+      break;
+    }
+  }
+}
+
+void Grr_encodeBC(const Grr_byte *rgba, Grr_u32 width, Grr_u32 height,
+                  GRR_BC_FORMAT format, GRR_BC_QUALITY quality,
+                  Grr_byte *blocks) {
+  _GrrBCJob job = {rgba, width, height, format, quality, blocks};
+  Grr_parallelFor((height + 3) / 4, _Grr_encodeBCRow, &job);
+}
+
+// Mip chains
+
+Grr_f32 srgbToLinear[256];
+Grr_byte linearToSRGB[4096]; // Indexed by linear values scaled to 0..4095
+Grr_bool srgbTablesInitialized = false;
+
+void _Grr_initializeSRGBTables() {
+  if (srgbTablesInitialized)
+    return;
+  for (Grr_u32 i = 0; i < 256; i++) {
+    Grr_f32 c = i / 255.0f;
+    srgbToLinear[i] =
+        (c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f));
+  }
+  for (Grr_u32 i = 0; i < 4096; i++) {
+    Grr_f32 l = i / 4095.0f;
+    Grr_f32 c =
+        (l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f);
+    linearToSRGB[i] = (Grr_byte)lrintf(c * 255.0f);
+  }
+  srgbTablesInitialized = true;
+}
+
+typedef struct _GrrDownsampleJob {
+  const Grr_byte *rgba;
+  Grr_u32 width;
+  Grr_u32 height;
+  Grr_bool srgb;
+  Grr_byte *downsampled;
+  Grr_u32 downsampledWidth;
+} _GrrDownsampleJob;
+
+GrrF32x4 _Grr_loadTexel(const Grr_byte *texel, Grr_bool srgb) {
+  if (srgb)
+    return Grr_f32x4Set(srgbToLinear[texel[0]], srgbToLinear[texel[1]],
+                        srgbToLinear[texel[2]], texel[3] / 255.0f);
+  return Grr_f32x4Set(texel[0] / 255.0f, texel[1] / 255.0f, texel[2] / 255.0f,
+                      texel[3] / 255.0f);
+}
+
+// Filters one row of the downsampled level, one RGBA texel per SIMD vector
+void _Grr_downsampleRow(void *data, Grr_u32 y, Grr_u32 threadIndex) {
+  const _GrrDownsampleJob *job = (const _GrrDownsampleJob *)data;
+  const GrrF32x4 scale =
+      (job->srgb ? Grr_f32x4Set(4095.0f * 0.25f, 4095.0f * 0.25f,
+                                4095.0f * 0.25f, 255.0f * 0.25f)
+                 : Grr_f32x4Splat(255.0f * 0.25f));
+  Grr_u32 y0 = 2 * y;
+  Grr_u32 y1 = (y0 + 1 < job->height ? y0 + 1 : y0);
+  const Grr_byte *row0 = job->rgba + (size_t)y0 * job->width * 4;
+  const Grr_byte *row1 = job->rgba + (size_t)y1 * job->width * 4;
+  Grr_byte *out = job->downsampled + (size_t)y * job->downsampledWidth * 4;
+  Grr_i32 values[4];
+
+  for (Grr_u32 x = 0; x < job->downsampledWidth; x++) {
+    Grr_u32 x0 = 2 * x * 4;
+    Grr_u32 x1 = (2 * x + 1 < job->width ? x0 + 4 : x0);
+    GrrF32x4 sum = Grr_f32x4Add(
+        Grr_f32x4Add(_Grr_loadTexel(row0 + x0, job->srgb),
+                     _Grr_loadTexel(row0 + x1, job->srgb)),
+        Grr_f32x4Add(_Grr_loadTexel(row1 + x0, job->srgb),
+                     _Grr_loadTexel(row1 + x1, job->srgb)));
+    Grr_i32x4Store(values, Grr_f32x4RoundToI32(Grr_f32x4Mul(sum, scale)));
+
+    for (Grr_u32 c = 0; c < 3; c++)
+      out[x * 4 + c] =
+          (job->srgb ? linearToSRGB[values[c]] : (Grr_byte)values[c]);
+    out[x * 4 + 3] = (Grr_byte)values[3];
+  }
+}
+
+Grr_u32 Grr_mipLevelCount(Grr_u32 width, Grr_u32 height) {
+  Grr_u32 levelCount = 1;
+  for (Grr_u32 size = (width > height ? width : height); size > 1; size >>= 1)
+    levelCount++;
+  return levelCount;
+}
+
+void Grr_downsampleRGBA8(const Grr_byte *rgba, Grr_u32 width, Grr_u32 height,
+                         Grr_bool srgb, Grr_byte *downsampled) {
+  _Grr_initializeSRGBTables();
+  Grr_u32 downsampledHeight = (height > 1 ? height / 2 : 1);
+  _GrrDownsampleJob job = {rgba, width, height, srgb, downsampled,
+                           (width > 1 ? width / 2 : 1)};
+  Grr_parallelFor(downsampledHeight, _Grr_downsampleRow, &job);
+}
+
+Grr_byte *Grr_generateMipChain(const Grr_byte *rgba, Grr_u32 width,
+                               Grr_u32 height, Grr_bool srgb,
+                               Grr_u32 *levelCount, size_t *levelOffsets) {
+  *levelCount = Grr_mipLevelCount(width, height);
+  if (*levelCount > GRR_KTX2_MAX_LEVELS) {
+    GRR_LOG_ERROR("Texture too large for a mip chain (%ux%u)\n", width,
+                  height);
+    return NULL;
+  }
+
+  size_t nBytes = 0;
+  for (Grr_u32 i = 0; i < *levelCount; i++) {
+    levelOffsets[i] = nBytes;
+    nBytes += (size_t)(width >> i ? width >> i : 1) *
+              (height >> i ? height >> i : 1) * 4;
+  }
+  Grr_byte *chain = (Grr_byte *)malloc(nBytes);
+  if (NULL == chain) {
+    GRR_LOG_ERROR("Failed to allocate memory for mip chain\n");
+    return NULL;
+  }
+
+  memcpy(chain, rgba, (size_t)width * height * 4);
+  for (Grr_u32 i = 1; i < *levelCount; i++)
+    Grr_downsampleRGBA8(chain + levelOffsets[i - 1],
+                        (width >> (i - 1) ? width >> (i - 1) : 1),
+                        (height >> (i - 1) ? height >> (i - 1) : 1), srgb,
+                        chain + levelOffsets[i]);
+  return chain;
+}
+
+Grr_bool Grr_cookedTexturePath(const Grr_string sourcePath, char *cookedPath,
+                               size_t cookedPathSize) {
+  size_t length = strlen(sourcePath);
+  const char *extension = strrchr(sourcePath, '.');
+  const char *separator = strrchr(sourcePath, '/');
+  if (extension != NULL && (separator == NULL || extension > separator))
+    length = (size_t)(extension - sourcePath);
+
+  if (length + sizeof(".ktx2") > cookedPathSize) {
+    GRR_LOG_ERROR("Cooked texture path too long (%s)\n", sourcePath);
+    return false;
+  }
+  memcpy(cookedPath, sourcePath, length);
+  memcpy(cookedPath + length, ".ktx2", sizeof(".ktx2"));
+  return true;
+}
+
+Grr_bool Grr_cookTexture(const Grr_string sourcePath, GRR_BC_FORMAT format,
+                         GRR_BC_QUALITY quality, Grr_bool srgb,
+                         char *cookedPath, size_t cookedPathSize) {
+  if (!Grr_cookedTexturePath(sourcePath, cookedPath, cookedPathSize))
+    return false;
+
+  struct stat sourceStat, cookedStat;
+  if (stat(sourcePath, &sourceStat) != 0) {
+    GRR_LOG_ERROR("Texture source not found (%s)\n", sourcePath);
+    return false;
+  }
+  if (stat(cookedPath, &cookedStat) == 0 &&
+      cookedStat.st_mtime >= sourceStat.st_mtime) {
+    GRR_LOG_DEBUG("Cooked texture up to date (%s)\n", cookedPath);
+    return true;
+  }
+
+  Grr_u32 nBytes, width, height;
+  Grr_byte *rgba = Grr_loadImage(sourcePath, &nBytes, &width, &height);
+  if (NULL == rgba)
+    return false;
+
+  Grr_u32 levelCount;
+  size_t mipOffsets[GRR_KTX2_MAX_LEVELS];
+  Grr_byte *chain =
+      Grr_generateMipChain(rgba, width, height, srgb, &levelCount, mipOffsets);
+  free(rgba);
+  if (NULL == chain)
+    return false;
+
+  // Every level encoded into a single allocation
+  size_t levelBytes[GRR_KTX2_MAX_LEVELS];
+  size_t blocksBytes = 0;
+  for (Grr_u32 i = 0; i < levelCount; i++) {
+    levelBytes[i] = Grr_bcImageBytes(format, (width >> i ? width >> i : 1),
+                                      (height >> i ? height >> i : 1));
+    blocksBytes += levelBytes[i];
+  }
+  Grr_byte *blocks = (Grr_byte *)malloc(blocksBytes);
+  if (NULL == blocks) {
+    GRR_LOG_ERROR("Failed to allocate memory for compressed texture\n");
+    free(chain);
+    return false;
+  }
+
+  const Grr_byte *levelData[GRR_KTX2_MAX_LEVELS];
+  Grr_byte *level = blocks;
+  for (Grr_u32 i = 0; i < levelCount; i++) {
+    Grr_encodeBC(chain + mipOffsets[i], (width >> i ? width >> i : 1),
+                 (height >> i ? height >> i : 1), format, quality, level);
+    levelData[i] = level;
+    level += levelBytes[i];
+  }
+  free(chain);
+
+  Grr_bool written =
+      Grr_writeKTX2(cookedPath, Grr_bcVkFormat(format, srgb), width, height,
+                    levelCount, levelData, levelBytes);
+  free(blocks);
+  if (written)
+    GRR_LOG_INFO("Cooked texture %s (%u levels)\n", cookedPath, levelCount);
+  return written;
+}
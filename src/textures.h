@@ -0,0 +1,83 @@
+#ifndef GRR_TEXTURES_H
+#define GRR_TEXTURES_H
+
+#include "assets.h"
+#include "jobs.h"
+#include "logging.h"
+#include "math/simd.h"
+#include "types.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vulkan/vulkan.h>
+
+// Texture cooking: CPU block compression of RGBA8 images (Grr_loadImage output)
+// into BCn formats, cached as KTX2 files next to their source
+
+typedef enum GRR_BC_FORMAT {
+  GRR_BC1, // RGB, 8 bytes per 4x4 block
+  GRR_BC3, // RGBA (BC1 color + BC4 alpha), 16 bytes per block
+  GRR_BC4, // R, 8 bytes per block
+  GRR_BC5, // RG (2 x BC4), 16 bytes per block
+  GRR_BC7  // RGBA (mode 6), 16 bytes per block
+} GRR_BC_FORMAT;
+
+typedef enum GRR_BC_QUALITY {
+  GRR_BC_QUALITY_FAST, // Bounding box endpoints, single index pass
+  GRR_BC_QUALITY_HIGH  // Principal axis endpoints + least squares refinement
+} GRR_BC_QUALITY;
+
+// Block encoders: pixels are 16 RGBA8 texels in row-major order
+void Grr_encodeBC1Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block);
+void Grr_encodeBC3Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block);
+void Grr_encodeBC4Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block);
+void Grr_encodeBC5Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block);
+void Grr_encodeBC7Block(const Grr_byte *pixels, GRR_BC_QUALITY quality,
+                        Grr_byte *block);
+
+Grr_u32 Grr_bcBlockBytes(GRR_BC_FORMAT format);
+size_t Grr_bcImageBytes(GRR_BC_FORMAT format, Grr_u32 width, Grr_u32 height);
+VkFormat Grr_bcVkFormat(GRR_BC_FORMAT format, Grr_bool srgb);
+
+// Encodes a whole RGBA8 image (blocks outside the image repeat edge texels).
+// Rows of blocks are encoded in parallel on the job system
+void Grr_encodeBC(const Grr_byte *rgba, Grr_u32 width, Grr_u32 height,
+                  GRR_BC_FORMAT format, GRR_BC_QUALITY quality,
+                  Grr_byte *blocks);
+
+// Mip chains of RGBA8 images: 2x2 box filter, averaged in linear space for
+// sRGB images (alpha is always linear). The last row/column of odd sizes is
+// dropped, single texel rows/columns are repeated
+
+// Number of levels of a full mip chain
+Grr_u32 Grr_mipLevelCount(Grr_u32 width, Grr_u32 height);
+
+// Half size (at least 1x1) level from the level above, rows are filtered in
+// parallel on the job system
+void Grr_downsampleRGBA8(const Grr_byte *rgba, Grr_u32 width, Grr_u32 height,
+                         Grr_bool srgb, Grr_byte *downsampled);
+
+// Full mip chain of an image (level 0 is a copy of rgba) in a single
+// allocation, levelOffsets receives the offset of each level (at most
+// GRR_KTX2_MAX_LEVELS). Returns NULL on failure
+Grr_byte *Grr_generateMipChain(const Grr_byte *rgba, Grr_u32 width,
+                               Grr_u32 height, Grr_bool srgb,
+                               Grr_u32 *levelCount, size_t *levelOffsets);
+
+// Path of the cooked KTX2 file for sourcePath (extension replaced by .ktx2)
+Grr_bool Grr_cookedTexturePath(const Grr_string sourcePath, char *cookedPath,
+                               size_t cookedPathSize);
+
+// Encodes the image (PNG or JPEG) at sourcePath with its full mip chain and
+// writes its KTX2 file unless one at least as recent as the source exists.
+// cookedPath receives the KTX2 file path
+Grr_bool Grr_cookTexture(const Grr_string sourcePath, GRR_BC_FORMAT format,
+                         GRR_BC_QUALITY quality, Grr_bool srgb,
+                         char *cookedPath, size_t cookedPathSize);
+
+#endif
@@ -0,0 +1,481 @@
+#include "upload.h"
+#include "vulkan.h"
+
+typedef struct GrrUploadBatch {
+  VkCommandBuffer transferCommands;
+  VkCommandBuffer graphicsCommands; // Ownership acquires and mip generation
+  Grr_bool graphicsRecording;
+  GRR_QUEUE queue; // Of the last submission of the batch
+  Grr_u64 value;   // Reached once the whole batch is done
+  Grr_bool shared; // Writes buffers shared with the compute queue
+  GrrUploadTicket ticket;
+  VkDeviceSize ringBytes; // Ring bytes to recycle once done
+  // Staging buffers of uploads larger than the ring
+  VkBuffer *overflowBuffers;
+  GrrGpuAllocation *overflowMemory;
+  Grr_u32 overflowCount;
+} GrrUploadBatch;
+
+VkCommandPool uploadTransferPool;
+VkCommandPool uploadGraphicsPool;
+Grr_bool ownershipTransfer; // Transfer and graphics families differ
+
+GrrUploadBatch uploadBatches[GRR_UPLOAD_MAX_BATCHES];
+Grr_u32 oldestUploadBatch = 0;
+Grr_u32 uploadBatchesInFlight = 0;
+Grr_bool uploadRecording = false; // Batch after the in flight ones
+GrrUploadTicket lastUploadTicket = 0;
+GrrUploadTicket completedUploadTicket = 0;
+Grr_u64 sharedUploadValue = 0; // Transfer value of the last shared batch
+
+VkBuffer uploadRing;
+GrrGpuAllocation uploadRingMemory;
+VkDeviceSize uploadRingHead = 0;
+VkDeviceSize uploadRingUsed = 0; // Including bytes skipped when wrapping
+
+void _Grr_destroyUploads() {
+  GRR_LOG_INFO("Free upload manager\n");
+  for (Grr_u32 i = 0; i < GRR_UPLOAD_MAX_BATCHES; i++) {
+    GrrUploadBatch *batch = &uploadBatches[i];
+    for (Grr_u32 j = 0; j < batch->overflowCount; j++)
+      _Grr_deferBuffer(batch->overflowBuffers[j], &batch->overflowMemory[j]);
+    free(batch->overflowBuffers);
+    free(batch->overflowMemory);
+  }
+  vkDestroyCommandPool(device, uploadTransferPool, NULL);
+  if (ownershipTransfer)
+    vkDestroyCommandPool(device, uploadGraphicsPool, NULL);
+  _Grr_deferBuffer(uploadRing, &uploadRingMemory);
+}
+
+Grr_bool _Grr_createUploadCommandPool(Grr_u32 familyIndex,
+                                      VkCommandPool *pool) {
+  VkCommandPoolCreateInfo poolInfo = {0};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
+                   VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  poolInfo.queueFamilyIndex = familyIndex;
+  return vkCreateCommandPool(device, &poolInfo, NULL, pool) == VK_SUCCESS;
+}
+
+Grr_bool _Grr_initializeUploads() {
+  ownershipTransfer = queueFamilyIndices.transferFamilyIndex !=
+                      queueFamilyIndices.graphicsFamilyIndex;
+
+  if (!_Grr_createUploadCommandPool(queueFamilyIndices.transferFamilyIndex,
+                                    &uploadTransferPool))
+    return false;
+  uploadGraphicsPool = uploadTransferPool;
+  if (ownershipTransfer &&
+      !_Grr_createUploadCommandPool(queueFamilyIndices.graphicsFamilyIndex,
+                                    &uploadGraphicsPool))
+    return false;
+
+  VkCommandBuffer commandBuffers[GRR_UPLOAD_MAX_BATCHES];
+  VkCommandBufferAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = GRR_UPLOAD_MAX_BATCHES;
+
+  allocInfo.commandPool = uploadTransferPool;
+  if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers) !=
+      VK_SUCCESS)
+    return false;
+  for (Grr_u32 i = 0; i < GRR_UPLOAD_MAX_BATCHES; i++)
+    uploadBatches[i].transferCommands = commandBuffers[i];
+
+  allocInfo.commandPool = uploadGraphicsPool;
+  if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers) !=
+      VK_SUCCESS)
+    return false;
+  for (Grr_u32 i = 0; i < GRR_UPLOAD_MAX_BATCHES; i++)
+    uploadBatches[i].graphicsCommands = commandBuffers[i];
+
+  if (!_Grr_createBuffer(GRR_UPLOAD_RING_SIZE,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         GRR_GPU_MEMORY_PERSISTENT, &uploadRing,
+                         &uploadRingMemory))
+    return false;
+
+  GRR_LOG_DEBUG("Uploads on queue family %u%s\n",
+                queueFamilyIndices.transferFamilyIndex,
+                ownershipTransfer ? " (ownership transfers to graphics)" : "");
+  atexit(_Grr_destroyUploads);
+  return true;
+}
+
+// Recycles the oldest batch, wait blocks until it is done
+Grr_bool _Grr_retireUploadBatch(Grr_bool wait) {
+  if (uploadBatchesInFlight == 0)
+    return false;
+
+  GrrUploadBatch *batch = &uploadBatches[oldestUploadBatch];
+  if (wait)
+    _Grr_waitTimeline(batch->queue, batch->value);
+  else if (!_Grr_timelineComplete(batch->queue, batch->value))
+    return false;
+
+  for (Grr_u32 i = 0; i < batch->overflowCount; i++) {
+    vkDestroyBuffer(device, batch->overflowBuffers[i], NULL);
+    _Grr_freeGpuMemory(&batch->overflowMemory[i]);
+  }
+  batch->overflowCount = 0;
+  uploadRingUsed -= batch->ringBytes;
+  batch->ringBytes = 0;
+  completedUploadTicket = batch->ticket;
+
+  oldestUploadBatch = (oldestUploadBatch + 1) % GRR_UPLOAD_MAX_BATCHES;
+  uploadBatchesInFlight--;
+  return true;
+}
+
+// Batch collecting uploads, begun on first use
+GrrUploadBatch *_Grr_recordingUploadBatch() {
+  Grr_u32 index =
+      (oldestUploadBatch + uploadBatchesInFlight) % GRR_UPLOAD_MAX_BATCHES;
+  if (uploadRecording)
+    return &uploadBatches[index];
+
+  // Every batch is in flight: the oldest one is reused
+  if (uploadBatchesInFlight == GRR_UPLOAD_MAX_BATCHES) {
+    _Grr_retireUploadBatch(true);
+    index =
+        (oldestUploadBatch + uploadBatchesInFlight) % GRR_UPLOAD_MAX_BATCHES;
+  }
+
+  GrrUploadBatch *batch = &uploadBatches[index];
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(batch->transferCommands, &beginInfo);
+  batch->graphicsRecording = false;
+  batch->shared = false;
+  uploadRecording = true;
+  return batch;
+}
+
+// Command buffer for work the transfer queue may not do (acquires, blits)
+VkCommandBuffer _Grr_uploadGraphicsCommands(GrrUploadBatch *batch) {
+  if (!ownershipTransfer)
+    return batch->transferCommands;
+
+  if (!batch->graphicsRecording) {
+    VkCommandBufferBeginInfo beginInfo = {0};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(batch->graphicsCommands, &beginInfo);
+    batch->graphicsRecording = true;
+  }
+  return batch->graphicsCommands;
+}
+
+// Reserves size bytes of the ring (16 byte aligned, valid for any texel
+// block), returns the number of ring bytes consumed or 0 when full
+VkDeviceSize _Grr_reserveUploadRing(VkDeviceSize size, VkDeviceSize *offset) {
+  if (uploadRingUsed == 0)
+    uploadRingHead = 0;
+  VkDeviceSize start = (uploadRingHead + 15) & ~(VkDeviceSize)15;
+  VkDeviceSize consumed;
+  if (start + size <= GRR_UPLOAD_RING_SIZE) {
+    consumed = start + size - uploadRingHead;
+  } else {
+    start = 0;
+    consumed = GRR_UPLOAD_RING_SIZE - uploadRingHead + size;
+  }
+  if (uploadRingUsed + consumed > GRR_UPLOAD_RING_SIZE)
+    return 0;
+
+  *offset = start;
+  uploadRingHead = start + size;
+  uploadRingUsed += consumed;
+  return consumed;
+}
+
+// Staging memory for an upload of size bytes in the recording batch
+Grr_bool _Grr_stageUpload(VkDeviceSize size, GrrUploadBatch **batch,
+                          VkBuffer *buffer, VkDeviceSize *offset,
+                          Grr_byte **mapped) {
+  if (size <= GRR_UPLOAD_RING_SIZE - 16) {
+    VkDeviceSize consumed;
+    // Make room by submitting pending work and recycling finished batches
+    while ((consumed = _Grr_reserveUploadRing(size, offset)) == 0) {
+      if (uploadRecording)
+        Grr_submitUploads();
+      else if (!_Grr_retireUploadBatch(true))
+        return false;
+    }
+    *batch = _Grr_recordingUploadBatch();
+    (*batch)->ringBytes += consumed;
+    *buffer = uploadRing;
+    *mapped = (Grr_byte *)uploadRingMemory.mapped + *offset;
+    return true;
+  }
+
+  *batch = _Grr_recordingUploadBatch();
+  GrrUploadBatch *b = *batch;
+  VkBuffer *buffers = (VkBuffer *)realloc(
+      b->overflowBuffers, sizeof(VkBuffer) * (b->overflowCount + 1));
+  if (NULL == buffers)
+    return false;
+  b->overflowBuffers = buffers;
+  GrrGpuAllocation *memory = (GrrGpuAllocation *)realloc(
+      b->overflowMemory, sizeof(GrrGpuAllocation) * (b->overflowCount + 1));
+  if (NULL == memory)
+    return false;
+  b->overflowMemory = memory;
+
+  if (!_Grr_createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         GRR_GPU_MEMORY_TRANSIENT,
+                         &b->overflowBuffers[b->overflowCount],
+                         &b->overflowMemory[b->overflowCount]))
+    return false;
+  *buffer = b->overflowBuffers[b->overflowCount];
+  *offset = 0;
+  *mapped = (Grr_byte *)b->overflowMemory[b->overflowCount].mapped;
+  b->overflowCount++;
+  return true;
+}
+
+// Concurrent buffers belong to no queue family
+Grr_bool _Grr_recordBufferUpload(VkBuffer buffer, VkDeviceSize offset,
+                                 const void *data, VkDeviceSize size,
+                                 VkPipelineStageFlags dstStage,
+                                 VkAccessFlags dstAccess, Grr_bool concurrent) {
+  if (size == 0)
+    return true;
+
+  GrrUploadBatch *batch;
+  VkBuffer stagingBuffer;
+  VkDeviceSize stagingOffset;
+  Grr_byte *mapped;
+  if (!_Grr_stageUpload(size, &batch, &stagingBuffer, &stagingOffset,
+                        &mapped)) {
+    GRR_LOG_ERROR("Failed to stage buffer upload of %llu bytes\n",
+                  (unsigned long long)size);
+    return false;
+  }
+  memcpy(mapped, data, (size_t)size);
+
+  VkBufferCopy copyRegion = {0};
+  copyRegion.srcOffset = stagingOffset;
+  copyRegion.dstOffset = offset;
+  copyRegion.size = size;
+  vkCmdCopyBuffer(batch->transferCommands, stagingBuffer, buffer, 1,
+                  &copyRegion);
+
+  VkBufferMemoryBarrier barrier = {0};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.buffer = buffer;
+  barrier.offset = offset;
+  barrier.size = size;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = dstAccess;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  if (!ownershipTransfer) {
+    vkCmdPipelineBarrier(batch->transferCommands,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, NULL,
+                         1, &barrier, 0, NULL);
+    return true;
+  }
+  if (concurrent) {
+    // The semaphore waits of the graphics submission of the batch (and of the
+    // compute queue) make the copy visible
+    _Grr_uploadGraphicsCommands(batch);
+    return true;
+  }
+
+  // Release on the transfer queue, acquire on the graphics queue
+  barrier.srcQueueFamilyIndex = queueFamilyIndices.transferFamilyIndex;
+  barrier.dstQueueFamilyIndex = queueFamilyIndices.graphicsFamilyIndex;
+  barrier.dstAccessMask = 0;
+  vkCmdPipelineBarrier(batch->transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 1,
+                       &barrier, 0, NULL);
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = dstAccess;
+  vkCmdPipelineBarrier(_Grr_uploadGraphicsCommands(batch),
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage, 0, 0, NULL,
+                       1, &barrier, 0, NULL);
+  return true;
+}
+
+Grr_bool Grr_uploadBuffer(VkBuffer buffer, VkDeviceSize offset,
+                          const void *data, VkDeviceSize size,
+                          VkPipelineStageFlags dstStage,
+                          VkAccessFlags dstAccess) {
+  return _Grr_recordBufferUpload(buffer, offset, data, size, dstStage,
+                                 dstAccess, false);
+}
+
+Grr_bool _Grr_uploadSharedBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                 const void *data, VkDeviceSize size,
+                                 VkPipelineStageFlags dstStage,
+                                 VkAccessFlags dstAccess) {
+  Grr_u32 families[GRR_QUEUE_COUNT];
+  Grr_bool concurrent = _Grr_sharedQueueFamilies(families) > 1;
+  if (!_Grr_recordBufferUpload(buffer, offset, data, size, dstStage, dstAccess,
+                               concurrent))
+    return false;
+  if (size > 0)
+    _Grr_recordingUploadBatch()->shared = true;
+  return true;
+}
+
+Grr_bool Grr_uploadImage(VkImage image, Grr_u32 width, Grr_u32 height,
+                         Grr_u32 levelCount, const Grr_byte *const *levelData,
+                         const size_t *levelBytes, Grr_u32 mipLevels) {
+  // Buffer offsets must be multiples of the texel block size (at most 16)
+  VkDeviceSize levelOffsets[levelCount];
+  VkDeviceSize stagingSize = 0;
+  for (Grr_u32 i = 0; i < levelCount; i++) {
+    levelOffsets[i] = stagingSize;
+    stagingSize = (stagingSize + levelBytes[i] + 15) & ~(VkDeviceSize)15;
+  }
+
+  GrrUploadBatch *batch;
+  VkBuffer stagingBuffer;
+  VkDeviceSize stagingOffset;
+  Grr_byte *mapped;
+  if (!_Grr_stageUpload(stagingSize, &batch, &stagingBuffer, &stagingOffset,
+                        &mapped)) {
+    GRR_LOG_ERROR("Failed to stage image upload of %llu bytes\n",
+                  (unsigned long long)stagingSize);
+    return false;
+  }
+  for (Grr_u32 i = 0; i < levelCount; i++)
+    memcpy(mapped + levelOffsets[i], levelData[i], levelBytes[i]);
+
+  VkImageMemoryBarrier barrier = {0};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = mipLevels;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(batch->transferCommands,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                       &barrier);
+
+  // One region per mip level
+  VkBufferImageCopy regions[levelCount];
+  for (Grr_u32 i = 0; i < levelCount; i++) {
+    regions[i] = (VkBufferImageCopy){0};
+    regions[i].bufferOffset = stagingOffset + levelOffsets[i];
+    regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    regions[i].imageSubresource.mipLevel = i;
+    regions[i].imageSubresource.baseArrayLayer = 0;
+    regions[i].imageSubresource.layerCount = 1;
+    regions[i].imageExtent.width = (width >> i ? width >> i : 1);
+    regions[i].imageExtent.height = (height >> i ? height >> i : 1);
+    regions[i].imageExtent.depth = 1;
+  }
+  vkCmdCopyBufferToImage(batch->transferCommands, stagingBuffer, image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount,
+                         regions);
+
+  // Levels to generate: the image moves to the graphics queue as is
+  Grr_bool generate = mipLevels > levelCount;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = (generate ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  if (ownershipTransfer) {
+    barrier.srcQueueFamilyIndex = queueFamilyIndices.transferFamilyIndex;
+    barrier.dstQueueFamilyIndex = queueFamilyIndices.graphicsFamilyIndex;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(batch->transferCommands,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0,
+                         NULL, 1, &barrier);
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = (generate ? VK_ACCESS_TRANSFER_WRITE_BIT |
+                                            VK_ACCESS_TRANSFER_READ_BIT
+                                      : VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(_Grr_uploadGraphicsCommands(batch),
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         (generate ? VK_PIPELINE_STAGE_TRANSFER_BIT
+                                   : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT),
+                         0, 0, NULL, 0, NULL, 1, &barrier);
+  } else if (!generate) {
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(batch->transferCommands,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                         NULL, 1, &barrier);
+  }
+
+  if (generate)
+    _Grr_recordGenerateMipmaps(_Grr_uploadGraphicsCommands(batch), image,
+                               width, height, levelCount, mipLevels);
+  return true;
+}
+
+GrrUploadTicket Grr_submitUploads() {
+  if (!uploadRecording)
+    return lastUploadTicket;
+
+  Grr_u32 index =
+      (oldestUploadBatch + uploadBatchesInFlight) % GRR_UPLOAD_MAX_BATCHES;
+  GrrUploadBatch *batch = &uploadBatches[index];
+  vkEndCommandBuffer(batch->transferCommands);
+
+  VkSubmitInfo submitInfo = {0};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &batch->transferCommands;
+  batch->queue = GRR_QUEUE_TRANSFER;
+  batch->value = _Grr_submit(GRR_QUEUE_TRANSFER, &submitInfo, NULL, 0);
+  if (batch->value == 0) {
+    GRR_LOG_CRITICAL("Failed to submit uploads\n");
+    exit(EXIT_FAILURE);
+  }
+  if (batch->shared)
+    sharedUploadValue = batch->value;
+
+  if (batch->graphicsRecording) {
+    // Graphics work waits for the released resources on the GPU
+    vkEndCommandBuffer(batch->graphicsCommands);
+    GrrTimelineWait released = {GRR_QUEUE_TRANSFER, batch->value,
+                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+    submitInfo.pCommandBuffers = &batch->graphicsCommands;
+    batch->queue = GRR_QUEUE_GRAPHICS;
+    batch->value = _Grr_submit(GRR_QUEUE_GRAPHICS, &submitInfo, &released, 1);
+    if (batch->value == 0) {
+      GRR_LOG_CRITICAL("Failed to submit upload acquires\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  batch->ticket = ++lastUploadTicket;
+  uploadBatchesInFlight++;
+  uploadRecording = false;
+  return batch->ticket;
+}
+
+Grr_u64 _Grr_sharedUploadValue() { return sharedUploadValue; }
+
+Grr_bool Grr_isUploadComplete(GrrUploadTicket ticket) {
+  while (completedUploadTicket < ticket && _Grr_retireUploadBatch(false))
+    ;
+  return completedUploadTicket >= ticket;
+}
+
+void Grr_waitForUpload(GrrUploadTicket ticket) {
+  if (ticket > lastUploadTicket)
+    Grr_submitUploads();
+  while (completedUploadTicket < ticket && _Grr_retireUploadBatch(true))
+    ;
+}
@@ -0,0 +1,64 @@
+#ifndef GRR_UPLOAD_H
+#define GRR_UPLOAD_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include "types.h"
+#include <string.h>
+#include <vulkan/vulkan.h>
+
+// Asynchronous uploads: data is copied into a persistently mapped staging ring
+// and the copies and barriers of many uploads are recorded into one batch,
+// submitted on the transfer queue. When the transfer queue belongs to another
+// family than the graphics queue, resources are released by the transfer queue
+// and acquired by the graphics queue (which also generates mip levels with
+// blits), after waiting for the transfer queue timeline on the GPU. Completion
+// is tracked with the timeline value of each batch: the renderer polls tickets
+// instead of waiting for the queue to go idle.
+// Uploads larger than the ring get their own transient staging buffer
+
+#define GRR_UPLOAD_RING_SIZE (16ull << 20)
+#define GRR_UPLOAD_MAX_BATCHES 4
+
+// Identifies a submitted batch, tickets increase with every submission
+typedef Grr_u64 GrrUploadTicket;
+
+// Called once the logical device, queues and memory allocator exist
+Grr_bool _Grr_initializeUploads();
+
+// Queues a copy of size bytes of data to buffer at offset. dstStage and
+// dstAccess describe the first use of the data on the graphics queue
+Grr_bool Grr_uploadBuffer(VkBuffer buffer, VkDeviceSize offset,
+                          const void *data, VkDeviceSize size,
+                          VkPipelineStageFlags dstStage,
+                          VkAccessFlags dstAccess);
+
+// Same for buffers created with _Grr_createSharedBuffer, read by the compute
+// queue too: it waits for _Grr_sharedUploadValue of the transfer queue
+Grr_bool _Grr_uploadSharedBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                 const void *data, VkDeviceSize size,
+                                 VkPipelineStageFlags dstStage,
+                                 VkAccessFlags dstAccess);
+
+// Queues the upload of the first levelCount levels of a 2D color image created
+// with mipLevels levels in VK_IMAGE_LAYOUT_UNDEFINED. Remaining levels are
+// generated with linear blits. The image ends in SHADER_READ_ONLY_OPTIMAL for
+// fragment shaders
+Grr_bool Grr_uploadImage(VkImage image, Grr_u32 width, Grr_u32 height,
+                         Grr_u32 levelCount, const Grr_byte *const *levelData,
+                         const size_t *levelBytes, Grr_u32 mipLevels);
+
+// Submits the queued uploads, returns the ticket of the batch (the last
+// submitted one when nothing was queued)
+GrrUploadTicket Grr_submitUploads();
+
+// Transfer timeline value of the last submitted batch that wrote shared
+// buffers, 0 before the first one
+Grr_u64 _Grr_sharedUploadValue();
+
+// Non-blocking check, also recycles the staging memory of finished batches
+Grr_bool Grr_isUploadComplete(GrrUploadTicket ticket);
+
+void Grr_waitForUpload(GrrUploadTicket ticket);
+
+#endif
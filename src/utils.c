@@ -2,6 +2,14 @@
 
 // Binary file IO
 
+Grr_bool Grr_fileExists(const Grr_string path) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return false;
+  fclose(f);
+  return true;
+}
+
 Grr_byte *Grr_readBytesFromFile(const Grr_string path, size_t *nBytes) {
   FILE *f = fopen(path, "rb");
   Grr_byte *bytes = NULL;
@@ -849,7 +857,7 @@ void _Grr_writeJSONToFileRecursive(GrrHashMapValue value, GrrType type,
   case INT64:
     if (indentFlag)
       INDENT(depth, f);
-    fprintf(f, "%lld", value.i64);
+    fprintf(f, "%" PRId64, value.i64);
     break;
 
   case STRING:
@@ -908,4 +916,23 @@ Grr_string Grr_dirFromFilePath(Grr_string path) {
     return dir;
   }
   return NULL;
-}
\ No newline at end of file
+}
+
+// Time
+
+Grr_f64 Grr_seconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (Grr_f64)now.tv_sec + (Grr_f64)now.tv_nsec * 1e-9;
+}
+
+void Grr_sleep(Grr_f64 seconds) {
+  if (seconds <= 0.0)
+    return;
+  struct timespec duration;
+  duration.tv_sec = (time_t)seconds;
+  duration.tv_nsec = (long)((seconds - (Grr_f64)duration.tv_sec) * 1e9);
+  // Interrupted sleeps resume with the time left
+  while (nanosleep(&duration, &duration) != 0 && errno == EINTR)
+    ;
+}
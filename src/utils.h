@@ -5,7 +5,10 @@
 #include "string.h"
 #include "types.h"
 #include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
+#include <time.h>
 
 // Binary IO
 #define BYTE_TO_BINARY_PATTERN "%c%c%c%c%c%c%c%c"
@@ -15,6 +18,7 @@
       ((byte) & 0x08 ? '1' : '0'), ((byte) & 0x04 ? '1' : '0'),                \
       ((byte) & 0x02 ? '1' : '0'), ((byte) & 0x01 ? '1' : '0')
 
+Grr_bool Grr_fileExists(const Grr_string path);
 Grr_byte *Grr_readBytesFromFile(const Grr_string path, size_t *nBytes);
 Grr_bool Grr_writeBytesToFile(const Grr_string path, const Grr_byte *bytes,
                               const Grr_u32 nBytes);
@@ -110,4 +114,8 @@ void Grr_writeJSONToFile(GrrHashMap *json, const Grr_string path);
 // Directory and path utils
 Grr_string Grr_dirFromFilePath(Grr_string path);
 
+// Time
+Grr_f64 Grr_seconds(); // Monotonic clock
+void Grr_sleep(Grr_f64 seconds);
+
 #endif
\ No newline at end of file
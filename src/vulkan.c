@@ -8,6 +8,7 @@ GrrQueueFamilyIndices queueFamilyIndices; // Indices of queue families
 VkQueue graphicsQueue;                    // Graphics queue handle
 VkQueue presentQueue;                     // Presentation queue handle
 VkQueue computeQueue;                     // Compute queue handle
+VkQueue transferQueue;                    // Transfer queue handle (uploads)
 VkSwapchainKHR swapchain;                 // Swap chain
 VkSurfaceFormatKHR selectedFormat;        // Swap chain format
 VkExtent2D selectedExtent;                // Swap chain extent
@@ -20,30 +21,64 @@ VkFramebuffer *swapchainFramebuffers;     // Frame buffers
 Grr_bool recreateSwapChain = false;
 Grr_bool windowMinimized = false;
 
+// Offscreen images of that size replace the surface and swapchain
+Grr_bool headless = false;
+Grr_u32 headlessWidth = 0;
+Grr_u32 headlessHeight = 0;
+
 // Pipeline
 VkShaderModule vertShaderModule;
 VkShaderModule fragShaderModule;
 VkRenderPass renderPass;
+VkRenderPass loadRenderPass; // Same attachments, loaded: late GPU driven draws
 VkPipelineLayout pipelineLayout;
 VkPipeline graphicsPipeline;
+VkPipelineCache pipelineCache = VK_NULL_HANDLE; // Persisted between runs
 
 // Commands
 VkCommandPool commandPool;
 VkCommandBuffer *commandBuffers;
 
-// Sync objects
+// Render graphs of a frame, compiled once: the draw list culled on the CPU, or
+// GPU driven objects culled in two phases around the Hi-Z pyramid, the early
+// phase on the compute queue with async compute. Resources have the same index
+// in all of them
+GrrRenderGraph directGraph;
+GrrRenderGraph gpuDrivenGraph;
+GrrRenderGraph asyncCullingGraph;
+Grr_u32 asyncTailPass; // First pass of the tail of split frames
+Grr_u32 graphColor;
+Grr_u32 graphDepth;
+Grr_u32 graphHiZ;
+Grr_u32 graphIndirect;
+Grr_u32 graphVisibility;
+GRR_CULL_PHASE cullPhases[] = {GRR_CULL_PHASE_EARLY, GRR_CULL_PHASE_LATE};
+GrrTimelineWait acquiredWait; // Of the head of split frames, for its acquires
+Grr_u32 recordedImageIndex = 0; // Swapchain image of the graph's passes
+
+// Cached command buffers, per frame in flight and swapchain image (a buffer
+// binds the frame's descriptor set and the image's framebuffer)
+Grr_bool commandBufferCaching = false;
+VkCommandBuffer *cachedCommandBuffers = NULL;
+Grr_u32 *cachedCommandBuffersDirty = NULL; // GRR_COMMANDS_DIRTY flags
+Grr_u32 cachedCommandBufferCount = 0;
+
+// Sync objects: binary semaphores of the swapchain, frames are tracked with
+// the graphics queue timeline
 VkSemaphore *imageAvailableSemaphores;
 VkSemaphore *renderFinishedSemaphores;
-VkFence *inFlightFences;
+// Graphics timeline values of the last frames, by frame number
+Grr_u64 frameTimelineValues[GRR_MAX_FRAMES_IN_FLIGHT];
 
 // Buffer and buffer memory
 VkBuffer vertexBuffer;
-VkDeviceMemory vertexBufferMemory;
+GrrGpuAllocation vertexBufferMemory;
 VkBuffer indexBuffer;
-VkDeviceMemory indexBufferMemory;
-VkBuffer *uniformBuffers;
-VkDeviceMemory *uniformBuffersMemory;
-void **uniformBuffersMapped;
+GrrGpuAllocation indexBufferMemory;
+// Offset of the frame's GrrUniformBufferObject in the frame data buffer: the
+// first allocation of a frame, so it is the same every time a frame in flight
+// comes back (cached command buffers keep their dynamic offset)
+VkDeviceSize frameUniformOffsets[GRR_MAX_FRAMES_IN_FLIGHT];
 
 // Descriptor set layout
 VkDescriptorSetLayout descriptorSetLayout;
@@ -53,20 +88,58 @@ VkDescriptorSet *descriptorSets;
 
 // Depth
 VkImage depthImage;
-VkDeviceMemory depthImageMemory;
+GrrGpuAllocation depthImageMemory;
 VkImageView depthImageView;
 
 // Texture
 VkImage textureImage;
-VkDeviceMemory textureImageMemory;
+GrrGpuAllocation textureImageMemory;
 VkImageView textureImageView;
 VkSampler textureSampler;
+VkFormat textureFormat = VK_FORMAT_R8G8B8A8_SRGB;
+Grr_u32 textureMipLevels = 1;
 
 // Model
 GrrModel model;
-
-const Grr_u32 MAX_FRAMES_IN_FLIGHT = 2;
+Grr_bool quantizedVertices = false; // Upload GrrQuantizedVertex instead of f32
+GrrMatrix4x4 modelDequantization;   // Maps quantized positions to mesh space
+
+// Draw list
+GrrDraw *drawList = NULL;
+Grr_u32 drawCount = 0;
+Grr_u32 drawCapacity = 0;
+GrrBoundingSpheres drawBounds = {0}; // Of the draw list, in the same order
+Grr_u32 *visibleDraws = NULL;        // Draw list indices recorded this frame
+Grr_u32 visibleDrawCount = 0;
+
+// Camera
+GrrCamera camera;
+Grr_bool hasCamera = false;
+GrrVector4 frustumPlanes[6]; // Of the current frame's view and projection
+
+// Per frame resources exist for GRR_MAX_FRAMES_IN_FLIGHT frames, the first
+// framesInFlight of them are used (see pacing.h)
+Grr_u32 framesInFlight = GRR_DEFAULT_FRAMES_IN_FLIGHT;
 Grr_u32 currentFrame = 0;
+Grr_u64 frameNumber = 1;    // Frames drawn since startup, from 1
+Grr_u64 recreatedFrame = 0; // Frame number of the last swapchain recreation
+
+// GPU driven draws need multiDrawIndirect and drawIndirectFirstInstance, draw
+// counts are optional (VK_KHR_draw_indirect_count)
+Grr_bool indirectDrawFeatures = false;
+Grr_bool drawIndirectCountExtension = false;
+Grr_bool pipelineStatisticsFeatures = false;
+// Latency is measured to present completion with VK_KHR_present_id and
+// VK_KHR_present_wait, when available
+Grr_bool presentWaitFeatures = false;
+// Render graph barriers use vkCmdPipelineBarrier2 with VK_KHR_synchronization2,
+// when available
+Grr_bool synchronization2Features = false;
+// Queue timelines are timeline semaphores with VK_KHR_timeline_semaphore, when
+// available
+Grr_bool timelineSemaphoreFeatures = false;
+Grr_bool gpuDrivenDraws = false; // Hi-Z and indirect draws are initialized
+GrrMatrix4x4 previousViewProjection; // Zero at first: nothing is occluded
 
 #if defined(GRR_DEBUG)
 VkDebugUtilsMessengerEXT debugMessenger;
@@ -113,7 +186,11 @@ void _Grr_destroyVulkanInstance() {
 bool _Grr_createVulkanInstance() {
   VkApplicationInfo appInfo = {0};
   appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-  appInfo.pApplicationName = windowInfo->title;
+#if defined(GRR_PLATFORM_MACOS)
+  appInfo.pApplicationName = headless ? "Grr" : windowInfo->title;
+#else
+  appInfo.pApplicationName = "Grr"; // Headless only
+#endif
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "None";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
@@ -126,31 +203,25 @@ bool _Grr_createVulkanInstance() {
 #endif
   createInfo.pApplicationInfo = &appInfo;
 
-  // Eextension names
-  const Grr_string extensionNames[] = {
+  // Eextension names (surface ones unless headless), the features of
+  // descriptor indexing are queried with vkGetPhysicalDeviceFeatures2KHR
+  Grr_string extensionNames[5];
+  Grr_u32 extensionCount = 0;
 #if defined(GRR_DEBUG)
-    VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+  extensionNames[extensionCount++] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
 #endif
-
-    VK_KHR_SURFACE_EXTENSION_NAME,
-
+  extensionNames[extensionCount++] =
+      VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME;
 #if defined(GRR_PLATFORM_MACOS)
-    VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME,
-    VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
-    VK_EXT_METAL_SURFACE_EXTENSION_NAME
-#endif
-  };
-
-  // Extension count
-  Grr_u32 extensionCount = 1;
-
-#if defined(GRR_DEBUG)
-  extensionCount += 1;
+  extensionNames[extensionCount++] =
+      VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME;
 #endif
-
+  if (!headless) {
+    extensionNames[extensionCount++] = VK_KHR_SURFACE_EXTENSION_NAME;
 #if defined(GRR_PLATFORM_MACOS)
-  extensionCount += 3;
+    extensionNames[extensionCount++] = VK_EXT_METAL_SURFACE_EXTENSION_NAME;
 #endif
+  }
 
   GRR_LOG_DEBUG("Extensions\n");
   for (Grr_u32 i = 0; i < extensionCount; i++) {
@@ -268,8 +339,11 @@ Grr_bool _Grr_deviceMeetsRequirements(VkPhysicalDevice device) {
   VkPhysicalDeviceFeatures supportedFeatures;
   vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
+  // Software rasterizers are enough to draw headless
   return (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU ||
-          properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) &&
+          properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU ||
+          (headless &&
+           properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)) &&
          supportedFeatures.samplerAnisotropy;
 }
 
@@ -305,6 +379,23 @@ void _Grr_destroyLogicalDevice() {
   vkDestroyDevice(device, NULL);
 }
 
+Grr_bool _Grr_hasDeviceExtension(const char *name) {
+  Grr_u32 propertyCount = 0;
+  vkEnumerateDeviceExtensionProperties(physicalDevice, NULL, &propertyCount,
+                                       NULL);
+  VkExtensionProperties *properties = (VkExtensionProperties *)malloc(
+      sizeof(VkExtensionProperties) * propertyCount);
+  if (properties == NULL)
+    return false;
+  vkEnumerateDeviceExtensionProperties(physicalDevice, NULL, &propertyCount,
+                                       properties);
+  Grr_bool found = false;
+  for (Grr_u32 i = 0; i < propertyCount && !found; i++)
+    found = strcmp(properties[i].extensionName, name) == 0;
+  free(properties);
+  return found;
+}
+
 Grr_bool _Grr_createLogicalDevice() {
 
   if (queueFamilyIndices.graphicsFamilyIndex == -1 ||
@@ -323,18 +414,8 @@ Grr_bool _Grr_createLogicalDevice() {
 
   // Find unique queue indices
   Grr_u32 uniqueQueueIndices[maxQueueIndices];
-  Grr_u32 uniqueCount = 0;
-  for (Grr_u32 i = 0; i < maxQueueIndices; i++) {
-    if (queueIndices[i] != -1) {
-      Grr_bool exists = false;
-      for (Grr_u32 j = 0; j < uniqueCount && !exists; j++) {
-        if (uniqueQueueIndices[j] == queueIndices[i])
-          exists = true;
-      }
-      if (!exists)
-        uniqueQueueIndices[uniqueCount++] = queueIndices[i];
-    }
-  }
+  Grr_u32 uniqueCount = Grr_uniqueQueueFamilies(queueIndices, maxQueueIndices,
+                                                uniqueQueueIndices);
 
   // Create unique queues
   VkDeviceQueueCreateInfo queueCreateInfos[uniqueCount];
@@ -347,11 +428,117 @@ Grr_bool _Grr_createLogicalDevice() {
     queueCreateInfos[i].pQueuePriorities = &queuePriority;
   }
 
+  VkPhysicalDeviceFeatures supportedFeatures;
+  vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
   VkPhysicalDeviceFeatures deviceFeatures = {0};
   deviceFeatures.samplerAnisotropy = VK_TRUE;
+  // Block-compressed texture formats, enabled when available
+  deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+  deviceFeatures.textureCompressionETC2 =
+      supportedFeatures.textureCompressionETC2;
+  deviceFeatures.textureCompressionASTC_LDR =
+      supportedFeatures.textureCompressionASTC_LDR;
+  // GPU driven draws, enabled when available
+  indirectDrawFeatures = supportedFeatures.multiDrawIndirect &&
+                         supportedFeatures.drawIndirectFirstInstance;
+  deviceFeatures.multiDrawIndirect = indirectDrawFeatures;
+  deviceFeatures.drawIndirectFirstInstance = indirectDrawFeatures;
+  // Pipeline statistics of the GPU profiler, enabled when available
+  pipelineStatisticsFeatures = supportedFeatures.pipelineStatisticsQuery &&
+                               supportedFeatures.inheritedQueries;
+  deviceFeatures.pipelineStatisticsQuery = pipelineStatisticsFeatures;
+  deviceFeatures.inheritedQueries = pipelineStatisticsFeatures;
+
+  // Descriptor indexing features of bindless resources
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedIndexing = {0};
+  supportedIndexing.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+  VkPhysicalDeviceFeatures2 supportedFeatures2 = {0};
+  supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+  supportedFeatures2.pNext = &supportedIndexing;
+  VkPhysicalDevicePresentIdFeaturesKHR supportedPresentId = {0};
+  supportedPresentId.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+  VkPhysicalDevicePresentWaitFeaturesKHR supportedPresentWait = {0};
+  supportedPresentWait.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+  // Features of optional extensions are only queried when they exist
+  Grr_bool presentWaitExtensions =
+      !headless &&
+      _Grr_hasDeviceExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+      _Grr_hasDeviceExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+  if (presentWaitExtensions) {
+    supportedIndexing.pNext = &supportedPresentId;
+    supportedPresentId.pNext = &supportedPresentWait;
+  }
+  VkPhysicalDeviceSynchronization2FeaturesKHR supportedSynchronization2 = {0};
+  supportedSynchronization2.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+  Grr_bool synchronization2Extension =
+      _Grr_hasDeviceExtension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+  if (synchronization2Extension) {
+    supportedSynchronization2.pNext = supportedIndexing.pNext;
+    supportedIndexing.pNext = &supportedSynchronization2;
+  }
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR supportedTimelineSemaphore = {0};
+  supportedTimelineSemaphore.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+  Grr_bool timelineSemaphoreExtension =
+      _Grr_hasDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+  if (timelineSemaphoreExtension) {
+    supportedTimelineSemaphore.pNext = supportedIndexing.pNext;
+    supportedIndexing.pNext = &supportedTimelineSemaphore;
+  }
+  PFN_vkGetPhysicalDeviceFeatures2KHR fpGetPhysicalDeviceFeatures2KHR =
+      (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(
+          instance, "vkGetPhysicalDeviceFeatures2KHR");
+  if (fpGetPhysicalDeviceFeatures2KHR)
+    fpGetPhysicalDeviceFeatures2KHR(physicalDevice, &supportedFeatures2);
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures;
+  if (!_Grr_bindlessFeatures(&supportedIndexing, &indexingFeatures)) {
+    GRR_LOG_CRITICAL("No support for descriptor indexing features\n");
+    return false;
+  }
+  presentWaitFeatures = presentWaitExtensions &&
+                        supportedPresentId.presentId &&
+                        supportedPresentWait.presentWait;
+  VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {0};
+  presentIdFeatures.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+  presentIdFeatures.presentId = VK_TRUE;
+  VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeaturesInfo = {0};
+  presentWaitFeaturesInfo.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+  presentWaitFeaturesInfo.presentWait = VK_TRUE;
+  if (presentWaitFeatures) {
+    indexingFeatures.pNext = &presentIdFeatures;
+    presentIdFeatures.pNext = &presentWaitFeaturesInfo;
+  }
+  synchronization2Features =
+      synchronization2Extension && supportedSynchronization2.synchronization2;
+  VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Info = {0};
+  synchronization2Info.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+  synchronization2Info.synchronization2 = VK_TRUE;
+  if (synchronization2Features) {
+    synchronization2Info.pNext = indexingFeatures.pNext;
+    indexingFeatures.pNext = &synchronization2Info;
+  }
+  timelineSemaphoreFeatures = timelineSemaphoreExtension &&
+                              supportedTimelineSemaphore.timelineSemaphore;
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreInfo = {0};
+  timelineSemaphoreInfo.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+  timelineSemaphoreInfo.timelineSemaphore = VK_TRUE;
+  if (timelineSemaphoreFeatures) {
+    timelineSemaphoreInfo.pNext = indexingFeatures.pNext;
+    indexingFeatures.pNext = &timelineSemaphoreInfo;
+  }
 
   VkDeviceCreateInfo deviceCreateInfo = {0};
   deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  deviceCreateInfo.pNext = &indexingFeatures;
   deviceCreateInfo.pQueueCreateInfos =
       (VkDeviceQueueCreateInfo *)queueCreateInfos;
   deviceCreateInfo.queueCreateInfoCount = uniqueCount;
@@ -370,17 +557,26 @@ Grr_bool _Grr_createLogicalDevice() {
   }
   vkEnumerateDeviceExtensionProperties(physicalDevice, NULL, &propertyCount,
                                        properties);
-  const Grr_string extensionNames[] = {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+  Grr_string extensionNames[] = {
+    VK_KHR_MAINTENANCE_3_EXTENSION_NAME, // Required by descriptor indexing
+    VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
 #if defined(GRR_PLATFORM_MACOS)
-    "VK_KHR_portability_subset"
+    "VK_KHR_portability_subset",
 #endif
+    NULL, // VK_KHR_swapchain, unless headless
+    NULL, // Optional VK_KHR_draw_indirect_count
+    NULL, // Optional VK_KHR_present_id
+    NULL, // Optional VK_KHR_present_wait
+    NULL, // Optional VK_KHR_synchronization2
+    NULL  // Optional VK_KHR_timeline_semaphore
   };
 
-  Grr_u32 extensionCount = 1;
+  Grr_u32 extensionCount = 2;
 #if defined(GRR_PLATFORM_MACOS)
   extensionCount += 1;
 #endif
+  if (!headless)
+    extensionNames[extensionCount++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
 
   GRR_LOG_DEBUG("Device extensions\n");
   for (Grr_u32 i = 0; i < extensionCount; i++) {
@@ -402,7 +598,32 @@ Grr_bool _Grr_createLogicalDevice() {
       extensionsOk = false;
     }
   }
+  for (Grr_u32 i = 0; i < propertyCount && indirectDrawFeatures; i++) {
+    if (strcmp(properties[i].extensionName,
+               VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0) {
+      drawIndirectCountExtension = true;
+      extensionNames[extensionCount++] =
+          VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+      GRR_LOG_DEBUG("\t%s (optional)\n", extensionNames[extensionCount - 1]);
+      break;
+    }
+  }
   free(properties);
+  if (presentWaitFeatures) {
+    extensionNames[extensionCount++] = VK_KHR_PRESENT_ID_EXTENSION_NAME;
+    extensionNames[extensionCount++] = VK_KHR_PRESENT_WAIT_EXTENSION_NAME;
+    GRR_LOG_DEBUG("\t%s, %s (optional)\n", VK_KHR_PRESENT_ID_EXTENSION_NAME,
+                  VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+  }
+  if (synchronization2Features) {
+    extensionNames[extensionCount++] = VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME;
+    GRR_LOG_DEBUG("\t%s (optional)\n", VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+  }
+  if (timelineSemaphoreFeatures) {
+    extensionNames[extensionCount++] = VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME;
+    GRR_LOG_DEBUG("\t%s (optional)\n",
+                  VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+  }
 
   if (!extensionsOk)
     return false;
@@ -424,8 +645,10 @@ Grr_bool _Grr_createLogicalDevice() {
   if (queueFamilyIndices.computeFamilyIndex != -1)
     vkGetDeviceQueue(device, queueFamilyIndices.computeFamilyIndex, 0,
                      &computeQueue);
+  vkGetDeviceQueue(device, queueFamilyIndices.transferFamilyIndex, 0,
+                   &transferQueue);
   // TODO: grab other queue handles if needed: video decode, video encode,
-  // protected memory management, sparse memory management, and transfer
+  // protected memory management and sparse memory management
 
   atexit(_Grr_destroyLogicalDevice);
 
@@ -461,6 +684,9 @@ Grr_bool _Grr_createSurface() {
   atexit(_Grr_destroySurface);
 
   return true;
+#else
+  GRR_LOG_CRITICAL("No window surface on this platform, draw headless\n");
+  return false;
 #endif
 }
 
@@ -484,21 +710,37 @@ void _Grr_findQueueFamilies() {
     for (Grr_u32 i = 0; i < queueFamilyCount; i++) {
       if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
         queueFamilyIndices.graphicsFamilyIndex = i;
-      if (queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT)
+      // Prefer a compute family without graphics for async compute
+      if ((queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+          (queueFamilyIndices.computeFamilyIndex == -1 ||
+           !(queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)))
         queueFamilyIndices.computeFamilyIndex = i;
-      if (queueFamilies[i].queueFlags & VK_QUEUE_TRANSFER_BIT)
+      // Prefer a transfer family without graphics (DMA engine) for uploads
+      if ((queueFamilies[i].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+          (queueFamilyIndices.transferFamilyIndex == -1 ||
+           !(queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)))
         queueFamilyIndices.transferFamilyIndex = i;
       if (queueFamilies[i].queueFlags & VK_QUEUE_SPARSE_BINDING_BIT)
         queueFamilyIndices.sparseBndingFamilyIndex = i;
 
       presentSupport = false;
-      vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface,
-                                           &presentSupport);
+      if (!headless)
+        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface,
+                                             &presentSupport);
       if (presentSupport) {
         queueFamilyIndices.presentFamilyIndex = i;
       }
     }
     free(queueFamilies);
+
+    // Graphics queues support transfers even when not advertised
+    if (queueFamilyIndices.transferFamilyIndex == -1)
+      queueFamilyIndices.transferFamilyIndex =
+          queueFamilyIndices.graphicsFamilyIndex;
+    // Nothing is presented headless
+    if (headless)
+      queueFamilyIndices.presentFamilyIndex =
+          queueFamilyIndices.graphicsFamilyIndex;
   } else {
     GRR_LOG_CRITICAL(
         "Failed to allocate memory to get queue family properties\n");
@@ -518,17 +760,6 @@ VkSurfaceFormatKHR _Grr_selectFormat(VkSurfaceFormatKHR *formats,
   return formats[0];
 }
 
-VkPresentModeKHR _Grr_selectPresentMode(VkPresentModeKHR *presentModes,
-                                        Grr_u32 presentModeCount) {
-  for (Grr_u32 i = 0; i < presentModeCount; i++) {
-    if (presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
-      return presentModes[i];
-    }
-  }
-
-  return VK_PRESENT_MODE_FIFO_KHR; // Guaranteed to exist
-}
-
 VkExtent2D _Grr_selectExtenct(VkSurfaceCapabilitiesKHR capabilities) {
   return capabilities.currentExtent; // TODO
 }
@@ -540,12 +771,44 @@ void _Grr_swapchainResizeHandler(void *sender, const GrrEventData data) {
 
 void _Grr_destroySwapchain() {
   GRR_LOG_INFO("Free swapchain\n");
-  vkDestroySwapchainKHR(device, swapchain, NULL);
+  if (headless)
+    _Grr_destroyOffscreenTargets();
+  else
+    _Grr_deferSwapchain(swapchain);
   if (swapchainImages != NULL)
     free(swapchainImages);
+  swapchainImages = NULL;
+}
+
+// One offscreen image per frame in flight stands in for the swapchain images
+Grr_bool _Grr_createOffscreenSwapchain(Grr_bool recreateFlag) {
+  selectedFormat.format = GRR_HEADLESS_FORMAT;
+  selectedFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+  selectedExtent.width = headlessWidth;
+  selectedExtent.height = headlessHeight;
+  imageCount = GRR_MAX_FRAMES_IN_FLIGHT;
+  swapchainImages = (VkImage *)malloc(sizeof(VkImage) * imageCount);
+  if (swapchainImages == NULL) {
+    GRR_LOG_CRITICAL("Failed to allocate memory for offscreen images\n");
+    return false;
+  }
+  if (!_Grr_createOffscreenTargets(headlessWidth, headlessHeight, imageCount,
+                                   swapchainImages)) {
+    free(swapchainImages);
+    swapchainImages = NULL;
+    return false;
+  }
+
+  if (!recreateFlag)
+    atexit(_Grr_destroySwapchain);
+
+  return true;
 }
 
 Grr_bool _Grr_createSwapchain(Grr_bool recreateFlag) {
+  if (headless)
+    return _Grr_createOffscreenSwapchain(recreateFlag);
+
   VkSurfaceCapabilitiesKHR capabilities;
   VkSurfaceFormatKHR *formats;
   VkPresentModeKHR *presentModes;
@@ -644,9 +907,14 @@ Grr_bool _Grr_createSwapchain(Grr_bool recreateFlag) {
   createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
   createInfo.presentMode = selectedPresentMode;
   createInfo.clipped = VK_TRUE;
-  createInfo.oldSwapchain = VK_NULL_HANDLE; // TODO
-
-  if (vkCreateSwapchainKHR(device, &createInfo, NULL, &swapchain) != VK_SUCCESS)
+  // Images of the previous swapchain still being presented stay valid, it is
+  // retired (even when creation fails) and destroyed after its last frame
+  createInfo.oldSwapchain = swapchain;
+
+  VkResult result = vkCreateSwapchainKHR(device, &createInfo, NULL, &swapchain);
+  if (VK_NULL_HANDLE != createInfo.oldSwapchain)
+    _Grr_deferSwapchain(createInfo.oldSwapchain);
+  if (result != VK_SUCCESS)
     return false;
 
   vkGetSwapchainImagesKHR(device, swapchain, &imageCount, NULL);
@@ -664,7 +932,8 @@ Grr_bool _Grr_createSwapchain(Grr_bool recreateFlag) {
 }
 
 VkImageView _Grr_createImageView(VkImage image, VkFormat format,
-                                 VkImageAspectFlags aspectFlags) {
+                                 VkImageAspectFlags aspectFlags,
+                                 Grr_u32 mipLevels) {
   VkImageViewCreateInfo viewInfo = {0};
   viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
   viewInfo.image = image;
@@ -672,7 +941,7 @@ VkImageView _Grr_createImageView(VkImage image, VkFormat format,
   viewInfo.format = format;
   viewInfo.subresourceRange.aspectMask = aspectFlags;
   viewInfo.subresourceRange.baseMipLevel = 0;
-  viewInfo.subresourceRange.levelCount = 1;
+  viewInfo.subresourceRange.levelCount = mipLevels;
   viewInfo.subresourceRange.baseArrayLayer = 0;
   viewInfo.subresourceRange.layerCount = 1;
 
@@ -689,7 +958,7 @@ void _Grr_destroyImageViews() {
   GRR_LOG_INFO("Free swapchain image views\n");
   Grr_u32 viewCount = imageCount;
   for (Grr_u32 i = 0; i < viewCount; i++)
-    vkDestroyImageView(device, imageViews[i], NULL);
+    _Grr_deferImageView(imageViews[i]);
   free(imageViews);
 }
 
@@ -701,8 +970,9 @@ Grr_bool _Grr_createImageViews(Grr_bool recreate) {
   }
 
   for (Grr_u32 i = 0; i < imageCount; i++) {
-    imageViews[i] = _Grr_createImageView(
-        swapchainImages[i], selectedFormat.format, VK_IMAGE_ASPECT_COLOR_BIT);
+    imageViews[i] =
+        _Grr_createImageView(swapchainImages[i], selectedFormat.format,
+                             VK_IMAGE_ASPECT_COLOR_BIT, 1);
 
     // VkImageViewCreateInfo createInfo = (VkImageViewCreateInfo){0};
     // createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -756,6 +1026,7 @@ void _Grr_destroyGraphicsPipeline() {
 
 void _Grr_destroyRenderPass() {
   GRR_LOG_INFO("Free render pass\n");
+  vkDestroyRenderPass(device, loadRenderPass, NULL);
   vkDestroyRenderPass(device, renderPass, NULL);
 }
 
@@ -767,9 +1038,11 @@ void _Grr_destroyDescriptorSetLayout() {
 Grr_bool _Grr_createDescriptorSetLayout() {
   VkDescriptorSetLayoutBinding uboLayoutBinding = {0};
   uboLayoutBinding.binding = 0;
-  uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
   uboLayoutBinding.descriptorCount = 1;
-  uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  // Compute: frustum planes of GPU culling
+  uboLayoutBinding.stageFlags =
+      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
   uboLayoutBinding.pImmutableSamplers = NULL; // Optional
 
   VkDescriptorSetLayoutBinding samplerLayoutBinding = {0};
@@ -797,22 +1070,45 @@ Grr_bool _Grr_createDescriptorSetLayout() {
   return true;
 }
 
+void _Grr_destroyPipelineCache() {
+  GRR_LOG_INFO("Free pipeline cache\n");
+  _Grr_savePipelineCache(device, pipelineCache, GRR_PIPELINE_CACHE_PATH);
+  vkDestroyPipelineCache(device, pipelineCache, NULL);
+}
+
+Grr_bool _Grr_createPipelineCache() {
+  pipelineCache =
+      _Grr_loadPipelineCache(physicalDevice, device, GRR_PIPELINE_CACHE_PATH);
+  if (pipelineCache == VK_NULL_HANDLE)
+    return false;
+
+  atexit(_Grr_destroyPipelineCache);
+  return true;
+}
+
+// Quantized vertices carry what the f32 layout streams: positions alone as
+// long as it has no other attribute
+Grr_bool _Grr_quantizedPositionsOnly() {
+  Grr_u32 attributeCount;
+  free(Grr_getAtributeDescriptions(&attributeCount));
+  return attributeCount == 1;
+}
+
 Grr_bool _Grr_createGraphicsPipeline() {
   size_t nBytes;
 
-  // Vertex shader
-  Grr_byte *vertShaderBytes =
-      Grr_readBytesFromFile("src/shaders/vert.spv", &nBytes);
+  // Vertex shader (variant matches the vertex buffer layout, quantized
+  // positions alone are read like f32 ones)
+  Grr_bool quantizedAttributes =
+      quantizedVertices && !_Grr_quantizedPositionsOnly();
+  Grr_byte *vertShaderBytes = Grr_readBytesFromFile(
+      (quantizedAttributes ? "src/shaders/vert_quantized.spv"
+                           : "src/shaders/vert.spv"),
+      &nBytes);
   if (_Grr_createShaderModule(vertShaderBytes, nBytes, &vertShaderModule) ==
       false) {
     return false;
   }
-  VkPipelineShaderStageCreateInfo vertShaderStageInfo = {0};
-  vertShaderStageInfo.sType =
-      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-  vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-  vertShaderStageInfo.module = vertShaderModule;
-  vertShaderStageInfo.pName = "main";
 
   // Fragment shader
   Grr_byte *fragShaderBytes =
@@ -821,6 +1117,56 @@ Grr_bool _Grr_createGraphicsPipeline() {
       false) {
     return false;
   }
+
+  // Pipeline layout
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
+  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipelineLayoutInfo.setLayoutCount = 0;         // Optional
+  pipelineLayoutInfo.pSetLayouts = NULL;         // Optional
+  pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
+  pipelineLayoutInfo.pPushConstantRanges = NULL; // Optional
+  // Set 0: frame uniforms, set GRR_BINDLESS_SET: bindless resources
+  VkDescriptorSetLayout setLayouts[] = {descriptorSetLayout,
+                                        Grr_bindlessSetLayout()};
+  pipelineLayoutInfo.setLayoutCount =
+      sizeof(setLayouts) / sizeof(setLayouts[0]);
+  pipelineLayoutInfo.pSetLayouts = setLayouts;
+
+  // Per draw transform, object and material indices
+  VkPushConstantRange pushConstantRange = {0};
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(GrrDrawConstants);
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+  if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, NULL,
+                             &pipelineLayout) != VK_SUCCESS) {
+    return false;
+  }
+
+  Grr_f64 start = Grr_seconds();
+  if (!_Grr_buildGraphicsPipeline(pipelineCache, &graphicsPipeline))
+    return false;
+  GRR_LOG_DEBUG("Graphics pipeline created in %.2f ms\n",
+                (Grr_seconds() - start) * 1e3);
+
+  _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_PIPELINE);
+  atexit(_Grr_destroyGraphicsPipeline);
+  return true;
+}
+
+// Fixed function state of the graphics pipeline around the current shader
+// modules, layout and render pass
+Grr_bool _Grr_buildGraphicsPipeline(VkPipelineCache cache,
+                                    VkPipeline *pipeline) {
+  VkPipelineShaderStageCreateInfo vertShaderStageInfo = {0};
+  vertShaderStageInfo.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+  vertShaderStageInfo.module = vertShaderModule;
+  vertShaderStageInfo.pName = "main";
+
   VkPipelineShaderStageCreateInfo fragShaderStageInfo = {0};
   fragShaderStageInfo.sType =
       VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -840,15 +1186,28 @@ Grr_bool _Grr_createGraphicsPipeline() {
       sizeof(dynamicStates) / sizeof(VkDynamicState);
   dynamicState.pDynamicStates = &dynamicStates[0];
 
-  // Vertex input data binding
+  // Vertex input data binding and attribute descriptions
+  Grr_bool quantizedPositions =
+      quantizedVertices && _Grr_quantizedPositionsOnly();
   Grr_u32 bindingDescriptionCount;
-  VkVertexInputBindingDescription *bindingDescriptions =
-      Grr_getBindingDescriptions(&bindingDescriptionCount);
-
-  // Vertex input attribute descriptions
+  VkVertexInputBindingDescription *bindingDescriptions;
   Grr_u32 attributeDescriptionCount;
-  VkVertexInputAttributeDescription *attributeDescriptions =
-      Grr_getAtributeDescriptions(&attributeDescriptionCount);
+  VkVertexInputAttributeDescription *attributeDescriptions;
+  if (quantizedVertices && !quantizedPositions) {
+    bindingDescriptions =
+        Grr_getQuantizedBindingDescriptions(&bindingDescriptionCount);
+    attributeDescriptions =
+        Grr_getQuantizedAttributeDescriptions(&attributeDescriptionCount);
+  } else if (quantizedPositions) {
+    bindingDescriptions =
+        Grr_getQuantizedPositionBindingDescriptions(&bindingDescriptionCount);
+    attributeDescriptions = Grr_getQuantizedPositionAttributeDescriptions(
+        &attributeDescriptionCount);
+  } else {
+    bindingDescriptions = Grr_getBindingDescriptions(&bindingDescriptionCount);
+    attributeDescriptions =
+        Grr_getAtributeDescriptions(&attributeDescriptionCount);
+  }
 
   // Vertex input create info
   VkPipelineVertexInputStateCreateInfo vertexInputInfo = {0};
@@ -937,21 +1296,6 @@ Grr_bool _Grr_createGraphicsPipeline() {
   colorBlending.blendConstants[2] = 0.0f; // Optional
   colorBlending.blendConstants[3] = 0.0f; // Optional
 
-  // Pipeline layout
-  VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
-  pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-  pipelineLayoutInfo.setLayoutCount = 0;         // Optional
-  pipelineLayoutInfo.pSetLayouts = NULL;         // Optional
-  pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-  pipelineLayoutInfo.pPushConstantRanges = NULL; // Optional
-  pipelineLayoutInfo.setLayoutCount = 1;
-  pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-
-  if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, NULL,
-                             &pipelineLayout) != VK_SUCCESS) {
-    return false;
-  }
-
   // Depth stencil
   VkPipelineDepthStencilStateCreateInfo depthStencil = {0};
   depthStencil.sType =
@@ -985,12 +1329,11 @@ Grr_bool _Grr_createGraphicsPipeline() {
   pipelineInfo.basePipelineIndex = -1;              // Optional
   pipelineInfo.pDepthStencilState = &depthStencil;
 
-  if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL,
-                                &graphicsPipeline) != VK_SUCCESS) {
+  if (vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, NULL,
+                                pipeline) != VK_SUCCESS) {
     return false;
   }
 
-  atexit(_Grr_destroyGraphicsPipeline);
   return true;
 }
 
@@ -1024,16 +1367,22 @@ VkFormat _Grr_findDepthFormat() {
       VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
 
-Grr_bool _Grr_createRenderPass() {
+// Cleared attachments, or loaded ones to draw more after a render pass. Depth
+// is stored for the Hi-Z pyramid built between the two. Attachments stay in
+// their attachment layouts: the frame's render graph transitions and
+// synchronizes them around the render pass
+Grr_bool _Grr_createRenderPassWithLoadOp(VkAttachmentLoadOp loadOp,
+                                         VkRenderPass *pass) {
+  Grr_bool load = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
   VkAttachmentDescription colorAttachment = {0};
   colorAttachment.format = selectedFormat.format;
   colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  colorAttachment.loadOp = loadOp;
   colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
   colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-  colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
   VkAttachmentReference colorAttachmentRef = {0};
   colorAttachmentRef.attachment = 0;
@@ -1042,11 +1391,13 @@ Grr_bool _Grr_createRenderPass() {
   VkAttachmentDescription depthAttachment = {0};
   depthAttachment.format = _Grr_findDepthFormat();
   depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-  depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depthAttachment.loadOp = loadOp;
+  depthAttachment.storeOp = load ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+                                 : VK_ATTACHMENT_STORE_OP_STORE;
   depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-  depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  depthAttachment.initialLayout =
+      VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
   depthAttachment.finalLayout =
       VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
@@ -1069,23 +1420,17 @@ Grr_bool _Grr_createRenderPass() {
   renderPassInfo.subpassCount = 1;
   renderPassInfo.pSubpasses = &subpass;
 
-  VkSubpassDependency dependency = {0};
-  dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-  dependency.dstSubpass = 0;
-
-  dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-  dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-  dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-                            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-  dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-                             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-  renderPassInfo.dependencyCount = 1;
-  renderPassInfo.pDependencies = &dependency;
+  return vkCreateRenderPass(device, &renderPassInfo, NULL, pass) == VK_SUCCESS;
+}
 
-  if (vkCreateRenderPass(device, &renderPassInfo, NULL, &renderPass) !=
-      VK_SUCCESS) {
+Grr_bool _Grr_createRenderPass() {
+  if (!_Grr_createRenderPassWithLoadOp(VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                       &renderPass)) {
+    return false;
+  }
+  if (!_Grr_createRenderPassWithLoadOp(VK_ATTACHMENT_LOAD_OP_LOAD,
+                                       &loadRenderPass)) {
+    vkDestroyRenderPass(device, renderPass, NULL);
     return false;
   }
 
@@ -1096,7 +1441,7 @@ Grr_bool _Grr_createRenderPass() {
 void _Grr_destroyFramebuffers() {
   GRR_LOG_INFO("Free framebuffers\n");
   for (Grr_u32 i = 0; i < imageCount; i++) {
-    vkDestroyFramebuffer(device, swapchainFramebuffers[i], NULL);
+    _Grr_deferFramebuffer(swapchainFramebuffers[i]);
   }
   free(swapchainFramebuffers);
 }
@@ -1134,7 +1479,8 @@ Grr_bool _Grr_createFramebuffers(Grr_bool recreate) {
 
 void _Grr_destroyCommandPool() {
   GRR_LOG_INFO("Free command pool\n");
-  vkDestroyCommandPool(device, commandPool, NULL);
+  // After the command buffers queued for deletion
+  _Grr_deferCommandPool(commandPool);
 }
 
 Grr_bool _Grr_createCommandPool() {
@@ -1172,17 +1518,18 @@ Grr_u32 _Grr_findMemoryType(Grr_u32 typeFilter,
   exit(EXIT_FAILURE);
 }
 
-Grr_bool _Grr_createImage(Grr_u32 width, Grr_u32 height, VkFormat format,
-                          VkImageTiling tiling, VkImageUsageFlags usage,
+Grr_bool _Grr_createImage(Grr_u32 width, Grr_u32 height, Grr_u32 mipLevels,
+                          VkFormat format, VkImageTiling tiling,
+                          VkImageUsageFlags usage,
                           VkMemoryPropertyFlags properties, VkImage *image,
-                          VkDeviceMemory *imageMemory) {
+                          GrrGpuAllocation *imageMemory) {
   VkImageCreateInfo imageInfo = {0};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
   imageInfo.imageType = VK_IMAGE_TYPE_2D;
   imageInfo.extent.width = width;
   imageInfo.extent.height = height;
   imageInfo.extent.depth = 1;
-  imageInfo.mipLevels = 1;
+  imageInfo.mipLevels = mipLevels;
   imageInfo.arrayLayers = 1;
   imageInfo.format = format;
   imageInfo.tiling = tiling;
@@ -1198,51 +1545,77 @@ Grr_bool _Grr_createImage(Grr_u32 width, Grr_u32 height, VkFormat format,
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device, *image, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo = {0};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = _Grr_findMemoryType(
-      memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-  if (vkAllocateMemory(device, &allocInfo, NULL, imageMemory) != VK_SUCCESS) {
+  Grr_u32 memoryTypeIndex =
+      _Grr_findMemoryType(memRequirements.memoryTypeBits, properties);
+  if (!_Grr_allocateGpuMemory(&memRequirements, memoryTypeIndex,
+                              GRR_GPU_MEMORY_PERSISTENT,
+                              tiling == VK_IMAGE_TILING_OPTIMAL,
+                              imageMemory)) {
     GRR_LOG_CRITICAL("Failed to allocate image memory\n");
+    vkDestroyImage(device, *image, NULL);
     return false;
   }
 
-  vkBindImageMemory(device, *image, *imageMemory, 0);
+  if (vkBindImageMemory(device, *image, imageMemory->memory,
+                        imageMemory->offset) != VK_SUCCESS) {
+    GRR_LOG_CRITICAL("Failed to bind image memory\n");
+    vkDestroyImage(device, *image, NULL);
+    _Grr_freeGpuMemory(imageMemory);
+    return false;
+  }
   return true;
 }
 
-bool _Grr_hasStencilComponent(VkFormat format) {
+Grr_bool _Grr_hasStencilComponent(VkFormat format) {
   return format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
          format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
 
 void _Grr_destroyDepthResources() {
-  vkDestroyImageView(device, depthImageView, NULL);
-  vkDestroyImage(device, depthImage, NULL);
-  vkFreeMemory(device, depthImageMemory, NULL);
+  _Grr_destroyHiZPyramid();
+  _Grr_deferImageView(depthImageView);
+  _Grr_deferImage(depthImage, &depthImageMemory);
 }
 
-Grr_bool _Grr_createDepthResources() {
+Grr_bool _Grr_createDepthResources(Grr_bool recreate) {
   VkFormat depthFormat = _Grr_findDepthFormat();
-  _Grr_createImage(
-      selectedExtent.width, selectedExtent.height, depthFormat,
-      VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &depthImage, &depthImageMemory);
-  depthImageView =
-      _Grr_createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-
-  atexit(_Grr_destroyDepthResources);
+  // GPU driven draws sample it into the Hi-Z pyramid
+  VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+  if (gpuDrivenDraws)
+    usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+  if (!_Grr_createImage(selectedExtent.width, selectedExtent.height, 1,
+                        depthFormat, VK_IMAGE_TILING_OPTIMAL, usage,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &depthImage,
+                        &depthImageMemory))
+    return false;
+  depthImageView = _Grr_createImageView(depthImage, depthFormat,
+                                        VK_IMAGE_ASPECT_DEPTH_BIT, 1);
+  if (gpuDrivenDraws &&
+      !_Grr_createHiZPyramid(depthImageView, selectedExtent.width,
+                             selectedExtent.height)) {
+    GRR_LOG_ERROR("Failed to create Hi-Z pyramid\n");
+    vkDestroyImageView(device, depthImageView, NULL);
+    vkDestroyImage(device, depthImage, NULL);
+    _Grr_freeGpuMemory(&depthImageMemory);
+    return false;
+  }
+
+  if (!recreate)
+    atexit(_Grr_destroyDepthResources);
   return true;
 }
 
-void _Grr_freeCommandBuffers() { free(commandBuffers); }
+void _Grr_freeCommandBuffers() {
+  // Command buffers themselves are freed with their pool
+  free(commandBuffers);
+  free(cachedCommandBuffers);
+  free(cachedCommandBuffersDirty);
+}
 
 Grr_bool _Grr_createCommandBuffers() {
 
-  commandBuffers =
-      (VkCommandBuffer *)malloc(sizeof(VkCommandBuffer) * MAX_FRAMES_IN_FLIGHT);
+  commandBuffers = (VkCommandBuffer *)malloc(sizeof(VkCommandBuffer) *
+                                             GRR_MAX_FRAMES_IN_FLIGHT);
   if (commandBuffers == NULL) {
     GRR_LOG_ERROR("Failed to allocate memory for command buffers\n");
     return false;
@@ -1252,7 +1625,7 @@ Grr_bool _Grr_createCommandBuffers() {
   allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
   allocInfo.commandPool = commandPool;
   allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+  allocInfo.commandBufferCount = GRR_MAX_FRAMES_IN_FLIGHT;
 
   if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers) !=
       VK_SUCCESS) {
@@ -1264,38 +1637,129 @@ Grr_bool _Grr_createCommandBuffers() {
   return true;
 }
 
-Grr_bool _Grr_recordCommandBuffer(VkCommandBuffer commandBuffer,
-                                  Grr_u32 imageIndex) {
-  VkCommandBufferBeginInfo beginInfo = {0};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = 0;               // Optional
-  beginInfo.pInheritanceInfo = NULL; // Optional
+void _Grr_invalidateCommandBuffers(Grr_u32 dirtyFlags) {
+  for (Grr_u32 i = 0; i < cachedCommandBufferCount; i++)
+    cachedCommandBuffersDirty[i] |= dirtyFlags;
+}
+
+void _Grr_freeCachedCommandBuffers() {
+  for (Grr_u32 i = 0; i < cachedCommandBufferCount; i++)
+    _Grr_deferCommandBuffer(commandPool, cachedCommandBuffers[i]);
+  free(cachedCommandBuffers);
+  free(cachedCommandBuffersDirty);
+  cachedCommandBuffers = NULL;
+  cachedCommandBuffersDirty = NULL;
+  cachedCommandBufferCount = 0;
+}
+
+// One command buffer per frame in flight and swapchain image, reallocated
+// when the swapchain image count changes. Frames in flight may still use the
+// previous ones, which deferred deletion frees once they are complete
+Grr_bool _Grr_createCachedCommandBuffers() {
+  if (cachedCommandBufferCount == GRR_MAX_FRAMES_IN_FLIGHT * imageCount)
+    return true;
+  _Grr_freeCachedCommandBuffers();
+
+  Grr_u32 count = GRR_MAX_FRAMES_IN_FLIGHT * imageCount;
+  cachedCommandBuffers =
+      (VkCommandBuffer *)malloc(sizeof(VkCommandBuffer) * count);
+  cachedCommandBuffersDirty = (Grr_u32 *)malloc(sizeof(Grr_u32) * count);
+  if (cachedCommandBuffers == NULL || cachedCommandBuffersDirty == NULL) {
+    GRR_LOG_ERROR("Failed to allocate memory for cached command buffers\n");
+    _Grr_freeCachedCommandBuffers();
+    return false;
+  }
 
-  if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+  VkCommandBufferAllocateInfo allocInfo = {0};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool = commandPool;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = count;
+  if (vkAllocateCommandBuffers(device, &allocInfo, cachedCommandBuffers) !=
+      VK_SUCCESS) {
+    _Grr_freeCachedCommandBuffers();
     return false;
   }
+  cachedCommandBufferCount = count;
+  _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_ALL);
+  return true;
+}
 
-  VkRenderPassBeginInfo renderPassInfo = {0};
-  renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-  renderPassInfo.renderPass = renderPass;
-  renderPassInfo.framebuffer = swapchainFramebuffers[imageIndex];
+void Grr_setCommandBufferCaching(Grr_bool enabled) {
+  if (enabled && !commandBufferCaching)
+    _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_ALL);
+  commandBufferCaching = enabled;
+}
 
-  renderPassInfo.renderArea.offset.x = 0;
-  renderPassInfo.renderArea.offset.y = 0;
-  renderPassInfo.renderArea.extent = selectedExtent;
+void Grr_setQuantizedVertices(Grr_bool enabled) {
+  if (VK_NULL_HANDLE != device) {
+    GRR_LOG_WARNING("Vertex format is set before initialization\n");
+    return;
+  }
+  quantizedVertices = enabled;
+}
 
-  VkClearValue clearValues[2];
-  clearValues[0].color.float32[0] = 0.0f;
-  clearValues[0].color.float32[1] = 0.0f;
-  clearValues[0].color.float32[2] = 0.0f;
-  clearValues[0].color.float32[3] = 1.0f;
-  clearValues[1].depthStencil.depth = 1.0f;
-  clearValues[1].depthStencil.stencil = 0;
-  renderPassInfo.pClearValues = &clearValues[0];
-  renderPassInfo.clearValueCount = 2;
+void _Grr_freeDrawList() {
+  free(drawList);
+  free(visibleDraws);
+  Grr_destroyBoundingSpheres(&drawBounds);
+}
 
-  vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
-                       VK_SUBPASS_CONTENTS_INLINE);
+Grr_bool Grr_setDrawList(const GrrDraw *draws, Grr_u32 count) {
+  if (count > drawCapacity) {
+    if (NULL == drawList)
+      atexit(_Grr_freeDrawList);
+    GrrDraw *grown = (GrrDraw *)realloc(drawList, sizeof(GrrDraw) * count);
+    if (NULL != grown)
+      drawList = grown;
+    Grr_u32 *grownVisible =
+        (Grr_u32 *)realloc(visibleDraws, sizeof(Grr_u32) * count);
+    if (NULL != grownVisible)
+      visibleDraws = grownVisible;
+    if (NULL == grown || NULL == grownVisible) {
+      GRR_LOG_ERROR("Failed to allocate memory for draw list\n");
+      return false;
+    }
+    drawCapacity = count;
+  }
+  if (!Grr_resizeBoundingSpheres(&drawBounds, count))
+    return false;
+  memcpy(drawList, draws, sizeof(GrrDraw) * count);
+  drawCount = count;
+
+  // Bounds are culled as structure of arrays
+  for (Grr_u32 i = 0; i < count; i++) {
+    drawBounds.x[i] = draws[i].boundingSphere.x;
+    drawBounds.y[i] = draws[i].boundingSphere.y;
+    drawBounds.z[i] = draws[i].boundingSphere.z;
+    drawBounds.radius[i] = draws[i].boundingSphere.w > 0.0f
+                               ? draws[i].boundingSphere.w
+                               : INFINITY;
+  }
+  _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_DRAW_LIST);
+  return true;
+}
+
+void Grr_setCamera(const GrrCamera *newCamera) {
+  camera = *newCamera;
+  hasCamera = true;
+}
+
+// Draws of the list inside the current frame's frustum. Cached command buffers
+// record every draw: they are reused while the camera moves
+void _Grr_cullDraws() {
+  if (commandBufferCaching) {
+    for (Grr_u32 i = 0; i < drawCount; i++)
+      visibleDraws[i] = i;
+    visibleDrawCount = drawCount;
+    return;
+  }
+  visibleDrawCount =
+      Grr_cullSpheresParallel(frustumPlanes, &drawBounds, visibleDraws);
+}
+
+// State shared by the draws of a render pass
+void _Grr_bindDrawState(VkCommandBuffer commandBuffer) {
   vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                     graphicsPipeline);
 
@@ -1323,12 +1787,397 @@ Grr_bool _Grr_recordCommandBuffer(VkCommandBuffer commandBuffer,
   scissor.extent = selectedExtent;
   vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
+  // Bound once for all the draws
+  VkDescriptorSet sets[] = {descriptorSets[currentFrame], Grr_bindlessSet()};
+  Grr_u32 dynamicOffset = (Grr_u32)frameUniformOffsets[currentFrame];
   vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          pipelineLayout, 0, 1, &descriptorSets[currentFrame],
-                          0, NULL);
-  vkCmdDrawIndexed(commandBuffer, model.indexCount, 1, 0, 0, 0);
+                          pipelineLayout, 0, sizeof(sets) / sizeof(sets[0]),
+                          sets, 1, &dynamicOffset);
+}
+
+// Records items [first, first + count) with the state they need, into the
+// primary command buffer or a secondary one: the visible draws of the list,
+// then the instance batches of the frame
+void _Grr_recordDraws(VkCommandBuffer commandBuffer, void *data, Grr_u32 first,
+                      Grr_u32 count) {
+  _Grr_bindDrawState(commandBuffer);
+
+  // Per draw data goes through push constants, not descriptors
+  GrrDrawConstants constants;
+  constants.objectBuffer = GRR_BINDLESS_INVALID;
+  constants.instanceBuffer = GRR_BINDLESS_INVALID;
+  constants.instanceBase = 0;
+  Grr_u32 end = first + count;
+  Grr_u32 drawEnd = end < visibleDrawCount ? end : visibleDrawCount;
+  for (Grr_u32 i = first; i < drawEnd; i++) {
+    const GrrDraw *draw = &drawList[visibleDraws[i]];
+    constants.transform = draw->transform;
+    constants.objectIndex = draw->objectIndex;
+    constants.materialIndex = draw->materialIndex;
+    vkCmdPushConstants(commandBuffer, pipelineLayout,
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants),
+                       &constants);
+    vkCmdDrawIndexed(commandBuffer, draw->indexCount, 1, draw->firstIndex,
+                     draw->vertexOffset, 0);
+  }
+  if (end > visibleDrawCount) {
+    Grr_u32 firstBatch =
+        first > visibleDrawCount ? first - visibleDrawCount : 0;
+    _Grr_recordInstanceBatches(commandBuffer, pipelineLayout, firstBatch,
+                               end - visibleDrawCount - firstBatch);
+  }
+}
+
+// Draws of the GPU driven objects culling left for a phase, per object data is
+// read by the shaders
+void _Grr_recordGpuDrivenDraws(VkCommandBuffer commandBuffer,
+                               GRR_CULL_PHASE phase) {
+  _Grr_bindDrawState(commandBuffer);
+
+  GrrDrawConstants constants = {0};
+  Grr_identityMatrix(&constants.transform);
+  constants.objectBuffer = Grr_gpuObjectBuffer();
+  constants.instanceBuffer = GRR_BINDLESS_INVALID;
+  vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                     0, sizeof(constants), &constants);
+  _Grr_recordIndirectDraws(commandBuffer, currentFrame, phase);
+}
+
+void _Grr_beginFrameRenderPass(VkCommandBuffer commandBuffer,
+                               VkRenderPass pass, VkSubpassContents contents) {
+  VkRenderPassBeginInfo renderPassInfo = {0};
+  renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  renderPassInfo.renderPass = pass;
+  renderPassInfo.framebuffer = swapchainFramebuffers[recordedImageIndex];
 
+  renderPassInfo.renderArea.offset.x = 0;
+  renderPassInfo.renderArea.offset.y = 0;
+  renderPassInfo.renderArea.extent = selectedExtent;
+
+  // The load render pass keeps what the first one drew
+  VkClearValue clearValues[2];
+  clearValues[0].color.float32[0] = 0.0f;
+  clearValues[0].color.float32[1] = 0.0f;
+  clearValues[0].color.float32[2] = 0.0f;
+  clearValues[0].color.float32[3] = 1.0f;
+  clearValues[1].depthStencil.depth = 1.0f;
+  clearValues[1].depthStencil.stencil = 0;
+  if (pass == renderPass) {
+    renderPassInfo.pClearValues = &clearValues[0];
+    renderPassInfo.clearValueCount = 2;
+  }
+  vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+}
+
+// Render graph passes of a frame (data is the cull phase of culling passes)
+Grr_bool _Grr_recordCullPass(VkCommandBuffer commandBuffer, void *data) {
+  _Grr_recordCulling(commandBuffer, currentFrame, descriptorSets[currentFrame],
+                     (Grr_u32)frameUniformOffsets[currentFrame],
+                     *(GRR_CULL_PHASE *)data);
+  return true;
+}
+
+// Frames whose command buffers are recorded every frame cull GPU driven
+// objects early on the compute queue
+Grr_bool _Grr_asyncCulling() {
+  return Grr_asyncComputeEnabled() && gpuDrivenDraws &&
+         !commandBufferCaching && Grr_gpuObjectCount() > 0;
+}
+
+// Early culling reads the Hi-Z pyramid and the visibility the previous frame
+// left, released to the compute queue by its head
+Grr_u32 _Grr_cullInputTransfers(GrrQueueTransfer *transfers) {
+  transfers[0] = (GrrQueueTransfer){0};
+  transfers[0].image = _Grr_hiZImage();
+  transfers[0].layout = VK_IMAGE_LAYOUT_GENERAL;
+  transfers[0].dstAccess = VK_ACCESS_SHADER_READ_BIT;
+  transfers[1] = (GrrQueueTransfer){0};
+  transfers[1].buffer = _Grr_visibilityBuffer();
+  transfers[1].srcAccess = VK_ACCESS_SHADER_WRITE_BIT;
+  transfers[1].dstAccess =
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  return 2;
+}
+
+// And hands them back with the commands it wrote for frame
+Grr_u32 _Grr_cullOutputTransfers(GrrQueueTransfer *transfers, Grr_u32 frame) {
+  Grr_u32 count = _Grr_cullInputTransfers(transfers);
+  transfers[0].srcAccess = 0;
+  transfers[0].dstAccess = VK_ACCESS_SHADER_WRITE_BIT;
+  transfers[1].srcAccess = VK_ACCESS_SHADER_WRITE_BIT;
+  transfers[count] = (GrrQueueTransfer){0};
+  transfers[count].buffer = _Grr_indirectBuffer(frame);
+  transfers[count].srcAccess =
+      VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  transfers[count].dstAccess = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                               VK_ACCESS_SHADER_READ_BIT |
+                               VK_ACCESS_SHADER_WRITE_BIT;
+  return count + 1;
+}
+
+// Early culling of the current frame on the compute queue, once the head of
+// the previous frame released its inputs
+void _Grr_submitAsyncCulling() {
+  const VkPipelineStageFlags stages =
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkCommandBuffer commandBuffer = _Grr_beginComputeCommands(currentFrame);
+  GrrTimelineWait waits[3];
+  _Grr_acquireQueueTransfers(commandBuffer, GRR_QUEUE_COMPUTE, stages,
+                             &waits[0]);
+  _Grr_recordCulling(commandBuffer, currentFrame, descriptorSets[currentFrame],
+                     (Grr_u32)frameUniformOffsets[currentFrame],
+                     GRR_CULL_PHASE_EARLY);
+  GrrQueueTransfer transfers[GRR_COMPUTE_MAX_TRANSFERS];
+  _Grr_releaseQueueTransfers(
+      commandBuffer, GRR_QUEUE_COMPUTE, GRR_QUEUE_GRAPHICS, transfers,
+      _Grr_cullOutputTransfers(transfers, currentFrame), stages);
+
+  // The tail of the last frame of this frame in flight may still draw its
+  // commands (one frame in flight), and the objects may be uploading
+  waits[1] = (GrrTimelineWait){GRR_QUEUE_GRAPHICS, 0, stages};
+  if (frameNumber > framesInFlight)
+    waits[1].value =
+        frameTimelineValues[(frameNumber - framesInFlight) %
+                            GRR_MAX_FRAMES_IN_FLIGHT];
+  waits[2] = (GrrTimelineWait){GRR_QUEUE_TRANSFER, _Grr_sharedUploadValue(),
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT};
+  Grr_u64 value = _Grr_submitComputeCommands(currentFrame, waits, 3);
+  if (value == 0) {
+    GRR_LOG_CRITICAL("Failed to submit culling to the compute queue\n");
+    exit(EXIT_FAILURE);
+  }
+  _Grr_submittedQueueTransfers(GRR_QUEUE_COMPUTE, value);
+}
+
+Grr_bool _Grr_recordRenderPass(VkCommandBuffer commandBuffer, void *data) {
+  // Large draw lists are recorded in parallel into secondary command buffers.
+  // Cached command buffers are recorded inline: their secondaries would be
+  // reset with the frame's pools when another image is recorded
+  Grr_bool gpuDriven = Grr_gpuObjectCount() > 0;
+  Grr_u32 itemCount = visibleDrawCount + _Grr_instanceBatchCount();
+  if (!gpuDriven && !commandBufferCaching &&
+      Grr_recordingSliceCount(itemCount) > 1) {
+    _Grr_beginFrameRenderPass(commandBuffer, renderPass,
+                              VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    VkCommandBufferInheritanceInfo inheritance = {0};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = renderPass;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = swapchainFramebuffers[recordedImageIndex];
+    inheritance.pipelineStatistics = _Grr_gpuPipelineStatisticsFlags();
+    if (!_Grr_recordSecondaryCommandBuffers(commandBuffer, currentFrame,
+                                            &inheritance, itemCount,
+                                            _Grr_recordDraws, NULL)) {
+      return false;
+    }
+  } else {
+    _Grr_beginFrameRenderPass(commandBuffer, renderPass,
+                              VK_SUBPASS_CONTENTS_INLINE);
+    if (gpuDriven) {
+      _Grr_recordGpuDrivenDraws(commandBuffer, GRR_CULL_PHASE_EARLY);
+      _Grr_recordInstanceBatches(commandBuffer, pipelineLayout, 0,
+                                 _Grr_instanceBatchCount());
+    } else {
+      _Grr_recordDraws(commandBuffer, NULL, 0, itemCount);
+    }
+  }
+
+  vkCmdEndRenderPass(commandBuffer);
+  return true;
+}
+
+Grr_bool _Grr_recordHiZPass(VkCommandBuffer commandBuffer, void *data) {
+  _Grr_recordHiZ(commandBuffer);
+  return true;
+}
+
+// Objects the previous frame's depth hid, revealed by the depth just drawn,
+// are drawn over it
+Grr_bool _Grr_recordLateRenderPass(VkCommandBuffer commandBuffer,
+                                   void *data) {
+  _Grr_beginFrameRenderPass(commandBuffer, loadRenderPass,
+                            VK_SUBPASS_CONTENTS_INLINE);
+  _Grr_recordGpuDrivenDraws(commandBuffer, GRR_CULL_PHASE_LATE);
   vkCmdEndRenderPass(commandBuffer);
+  return true;
+}
+
+void _Grr_destroyFrameGraphs() {
+  GRR_LOG_INFO("Free render graphs\n");
+  _Grr_destroyRenderGraph(&directGraph);
+  _Grr_destroyRenderGraph(&gpuDrivenGraph);
+  _Grr_destroyRenderGraph(&asyncCullingGraph);
+}
+
+// Attachments of the render passes, the color is the output
+void _Grr_addFrameGraphAttachments(GrrRenderGraph *graph) {
+  VkImageAspectFlags depthAspects = VK_IMAGE_ASPECT_DEPTH_BIT;
+  if (_Grr_hasStencilComponent(_Grr_findDepthFormat()))
+    depthAspects |= VK_IMAGE_ASPECT_STENCIL_BIT;
+  Grr_initializeRenderGraph(graph);
+  graphColor =
+      Grr_addGraphImage(graph, "color", VK_IMAGE_ASPECT_COLOR_BIT, true);
+  graphDepth = Grr_addGraphImage(graph, "depth", depthAspects, true);
+  // Offscreen images are copied by readbacks instead of presented
+  Grr_setGraphOutput(graph, graphColor,
+                     headless ? GRR_GRAPH_ACCESS_TRANSFER_READ
+                              : GRR_GRAPH_ACCESS_PRESENT);
+}
+
+// Without the early culling pass when it runs on the compute queue
+Grr_bool _Grr_createGpuDrivenGraph(GrrRenderGraph *graph,
+                                   Grr_bool asyncCulling) {
+  _Grr_addFrameGraphAttachments(graph);
+  graphHiZ = Grr_addGraphImage(graph, "hi-z", VK_IMAGE_ASPECT_COLOR_BIT, false);
+  graphIndirect = Grr_addGraphBuffer(graph, "indirect", true);
+  graphVisibility = Grr_addGraphBuffer(graph, "visibility", false);
+
+  Grr_u32 pass;
+  Grr_bool declared = true;
+  if (!asyncCulling) {
+    pass = Grr_addGraphPass(graph, "cull early", _Grr_recordCullPass,
+                            &cullPhases[GRR_CULL_PHASE_EARLY],
+                            GRR_GPU_REGION_CULL_EARLY, false);
+    // Draw counts are reset with a transfer
+    declared &= Grr_useGraphResource(graph, pass, graphIndirect,
+                                     GRR_GRAPH_ACCESS_TRANSFER_WRITE);
+    declared &= Grr_useGraphResource(graph, pass, graphIndirect,
+                                     GRR_GRAPH_ACCESS_COMPUTE_WRITE);
+    declared &= Grr_useGraphResource(graph, pass, graphVisibility,
+                                     GRR_GRAPH_ACCESS_COMPUTE_WRITE);
+    declared &= Grr_useGraphResource(graph, pass, graphHiZ,
+                                     GRR_GRAPH_ACCESS_COMPUTE_READ);
+  }
+
+  pass = Grr_addGraphPass(graph, "render pass", _Grr_recordRenderPass, NULL,
+                          GRR_GPU_REGION_RENDER_PASS, false);
+  declared &= Grr_useGraphResource(graph, pass, graphIndirect,
+                                   GRR_GRAPH_ACCESS_INDIRECT_READ);
+  declared &= Grr_useGraphResource(graph, pass, graphColor,
+                                   GRR_GRAPH_ACCESS_COLOR_ATTACHMENT);
+  declared &= Grr_useGraphResource(graph, pass, graphDepth,
+                                   GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT);
+
+  pass = Grr_addGraphPass(graph, "hi-z", _Grr_recordHiZPass, NULL,
+                          GRR_GPU_REGION_HIZ, false);
+  declared &= Grr_useGraphResource(graph, pass, graphDepth,
+                                   GRR_GRAPH_ACCESS_DEPTH_COMPUTE_READ);
+  declared &= Grr_useGraphResource(graph, pass, graphHiZ,
+                                   GRR_GRAPH_ACCESS_COMPUTE_WRITE);
+
+  // The visibility is also copied for the readback
+  pass = Grr_addGraphPass(graph, "cull late", _Grr_recordCullPass,
+                          &cullPhases[GRR_CULL_PHASE_LATE],
+                          GRR_GPU_REGION_CULL_LATE, false);
+  declared &= Grr_useGraphResource(graph, pass, graphHiZ,
+                                   GRR_GRAPH_ACCESS_COMPUTE_READ);
+  declared &= Grr_useGraphResource(graph, pass, graphVisibility,
+                                   GRR_GRAPH_ACCESS_COMPUTE_WRITE);
+  declared &= Grr_useGraphResource(graph, pass, graphVisibility,
+                                   GRR_GRAPH_ACCESS_TRANSFER_READ);
+  declared &= Grr_useGraphResource(graph, pass, graphIndirect,
+                                   GRR_GRAPH_ACCESS_COMPUTE_WRITE);
+
+  // The tail of split frames
+  pass = Grr_addGraphPass(graph, "late render pass", _Grr_recordLateRenderPass,
+                          NULL, GRR_GPU_REGION_LATE_RENDER_PASS, false);
+  if (asyncCulling)
+    asyncTailPass = pass;
+  declared &= Grr_useGraphResource(graph, pass, graphIndirect,
+                                   GRR_GRAPH_ACCESS_INDIRECT_READ);
+  declared &= Grr_useGraphResource(graph, pass, graphColor,
+                                   GRR_GRAPH_ACCESS_COLOR_ATTACHMENT);
+  declared &= Grr_useGraphResource(graph, pass, graphDepth,
+                                   GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT);
+  return declared && _Grr_buildRenderGraph(graph);
+}
+
+Grr_bool _Grr_createFrameGraphs() {
+  _Grr_addFrameGraphAttachments(&directGraph);
+  Grr_u32 pass =
+      Grr_addGraphPass(&directGraph, "render pass", _Grr_recordRenderPass,
+                       NULL, GRR_GPU_REGION_RENDER_PASS, false);
+  Grr_bool declared = Grr_useGraphResource(&directGraph, pass, graphColor,
+                                           GRR_GRAPH_ACCESS_COLOR_ATTACHMENT);
+  declared &= Grr_useGraphResource(&directGraph, pass, graphDepth,
+                                   GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT);
+  if (!declared || !_Grr_buildRenderGraph(&directGraph))
+    return false;
+  atexit(_Grr_destroyFrameGraphs);
+  if (!gpuDrivenDraws)
+    return true;
+  return _Grr_createGpuDrivenGraph(&gpuDrivenGraph, false) &&
+         (!Grr_asyncComputeSupported() ||
+          _Grr_createGpuDrivenGraph(&asyncCullingGraph, true));
+}
+
+Grr_bool _Grr_recordCommandBuffer(VkCommandBuffer commandBuffer,
+                                  VkCommandBuffer tailCommandBuffer,
+                                  Grr_u32 imageIndex) {
+  Grr_bool split = tailCommandBuffer != VK_NULL_HANDLE;
+  VkCommandBufferBeginInfo beginInfo = {0};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = 0;               // Optional
+  beginInfo.pInheritanceInfo = NULL; // Optional
+
+  if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+    return false;
+  }
+
+  _Grr_beginGpuProfile(commandBuffer, currentFrame);
+  if (split)
+    _Grr_acquireQueueTransfers(commandBuffer, GRR_QUEUE_GRAPHICS,
+                               VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               &acquiredWait);
+
+  // GPU driven objects replace the draw list, culled by compute passes of
+  // their graph (the early one on the compute queue for split frames)
+  GrrRenderGraph *graph = &directGraph;
+  if (Grr_gpuObjectCount() > 0) {
+    graph = split ? &asyncCullingGraph : &gpuDrivenGraph;
+    _Grr_bindGraphImage(graph, graphHiZ, _Grr_hiZImage());
+    _Grr_bindGraphBuffer(graph, graphIndirect,
+                         _Grr_indirectBuffer(currentFrame));
+    _Grr_bindGraphBuffer(graph, graphVisibility, _Grr_visibilityBuffer());
+  } else {
+    _Grr_cullDraws();
+  }
+  recordedImageIndex = imageIndex;
+  _Grr_bindGraphImage(graph, graphColor, swapchainImages[imageIndex]);
+  _Grr_bindGraphImage(graph, graphDepth, depthImage);
+
+  // Pipeline statistics of split frames only count their head
+  Grr_u32 headPasses = split ? asyncTailPass : graph->passCount;
+  _Grr_beginGpuStatistics(commandBuffer, currentFrame);
+  if (!_Grr_executeRenderGraphPasses(graph, commandBuffer, currentFrame, 0,
+                                     headPasses)) {
+    return false;
+  }
+  _Grr_endGpuStatistics(commandBuffer, currentFrame);
+
+  // The next frame culls on the compute queue as soon as the head is done
+  if (graph != &directGraph && _Grr_asyncCulling()) {
+    GrrQueueTransfer transfers[GRR_COMPUTE_MAX_TRANSFERS];
+    _Grr_releaseQueueTransfers(commandBuffer, GRR_QUEUE_GRAPHICS,
+                               GRR_QUEUE_COMPUTE, transfers,
+                               _Grr_cullInputTransfers(transfers),
+                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT);
+  }
+  if (split) {
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS ||
+        vkBeginCommandBuffer(tailCommandBuffer, &beginInfo) != VK_SUCCESS) {
+      return false;
+    }
+    commandBuffer = tailCommandBuffer;
+    if (!_Grr_executeRenderGraphPasses(graph, commandBuffer, currentFrame,
+                                       headPasses, graph->passCount)) {
+      return false;
+    }
+  }
+  _Grr_endGpuProfile(commandBuffer, currentFrame);
 
   if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
     return false;
@@ -1339,40 +2188,30 @@ Grr_bool _Grr_recordCommandBuffer(VkCommandBuffer commandBuffer,
 
 void _Grr_destroySyncObjects() {
   GRR_LOG_INFO("Free synchronization objects\n");
-  for (Grr_u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++) {
     vkDestroySemaphore(device, imageAvailableSemaphores[i], NULL);
     vkDestroySemaphore(device, renderFinishedSemaphores[i], NULL);
-    vkDestroyFence(device, inFlightFences[i], NULL);
   }
   if (imageAvailableSemaphores != NULL)
     free(imageAvailableSemaphores);
   if (renderFinishedSemaphores != NULL)
     free(renderFinishedSemaphores);
-  if (inFlightFences != NULL)
-    free(inFlightFences);
 }
 
 Grr_bool _Grr_createSyncObjects() {
   imageAvailableSemaphores =
-      (VkSemaphore *)malloc(sizeof(VkSemaphore) * MAX_FRAMES_IN_FLIGHT);
+      (VkSemaphore *)malloc(sizeof(VkSemaphore) * GRR_MAX_FRAMES_IN_FLIGHT);
   renderFinishedSemaphores =
-      (VkSemaphore *)malloc(sizeof(VkSemaphore) * MAX_FRAMES_IN_FLIGHT);
-  inFlightFences = (VkFence *)malloc(sizeof(VkFence) * MAX_FRAMES_IN_FLIGHT);
+      (VkSemaphore *)malloc(sizeof(VkSemaphore) * GRR_MAX_FRAMES_IN_FLIGHT);
 
   VkSemaphoreCreateInfo semaphoreInfo = {0};
   semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-  VkFenceCreateInfo fenceInfo = {0};
-  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-  for (Grr_u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++) {
     if (vkCreateSemaphore(device, &semaphoreInfo, NULL,
                           &imageAvailableSemaphores[i]) != VK_SUCCESS ||
         vkCreateSemaphore(device, &semaphoreInfo, NULL,
-                          &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-        vkCreateFence(device, &fenceInfo, NULL, &inFlightFences[i]) !=
-            VK_SUCCESS) {
+                          &renderFinishedSemaphores[i]) != VK_SUCCESS) {
       return false;
     }
   }
@@ -1381,122 +2220,312 @@ Grr_bool _Grr_createSyncObjects() {
   return true;
 }
 
+// Objects of the previous swapchain are destroyed once the frames in flight
+// that use them are complete. Recreating again before a frame was drawn (the
+// surface keeps changing) waits for the device instead of piling them up
 Grr_bool _Grr_recreateSwapchain() {
-  vkDeviceWaitIdle(device);
+  if (headless || recreatedFrame == frameNumber) {
+    vkDeviceWaitIdle(device);
+    _Grr_flushDeletions(UINT64_MAX);
+  }
+  recreatedFrame = frameNumber;
+  _Grr_forgetPendingPresents();
 
   _Grr_destroyDepthResources();
   _Grr_destroyFramebuffers();
   _Grr_destroyImageViews();
-  _Grr_destroySwapchain();
+  if (headless) {
+    _Grr_destroySwapchain();
+  } else {
+    // Retired when the new one is created
+    free(swapchainImages);
+    swapchainImages = NULL;
+  }
 
   GRR_LOG_INFO("Recreate swapchain\n");
   if (!_Grr_createSwapchain(true) || !_Grr_createImageViews(true) ||
-      !_Grr_createDepthResources() || !_Grr_createFramebuffers(true)) {
+      !_Grr_createDepthResources(true) || !_Grr_createFramebuffers(true)) {
     return false;
   }
+  _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_SWAPCHAIN);
 
   return true;
 }
 
 void _Grr_updateUniformBuffer(Grr_u32 currentFrame) {
-  GrrUniformBufferObject ubo;
-  Grr_identityMatrix(&ubo.model);
-  Grr_identityMatrix(&ubo.view);
-  Grr_identityMatrix(&ubo.projection);
-  memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
+  _Grr_beginFrameData(currentFrame);
+  GrrUniformBufferObject *ubo = (GrrUniformBufferObject *)Grr_allocateFrameData(
+      sizeof(GrrUniformBufferObject), &frameUniformOffsets[currentFrame]);
+
+  GrrMatrix4x4 modelMatrix;
+  Grr_identityMatrix(&modelMatrix);
+  Grr_multiplyMatrix(&modelMatrix, &modelDequantization, &ubo->model);
+  if (hasCamera) {
+    Grr_viewMatrix(&camera, &ubo->view);
+    Grr_perspectiveProjectionMatrix(&camera, &ubo->projection);
+  } else {
+    Grr_identityMatrix(&ubo->view);
+    Grr_identityMatrix(&ubo->projection);
+  }
+
+  // Same planes for CPU culling of the draw list and GPU culling
+  Grr_multiplyMatrix(&ubo->projection, &ubo->view, &ubo->viewProjection);
+  Grr_frustumPlanes(&ubo->viewProjection, frustumPlanes);
+  memcpy(ubo->frustumPlanes, frustumPlanes, sizeof(frustumPlanes));
+
+  // The Hi-Z pyramid culling starts with was built by the previous frame
+  ubo->previousViewProjection = previousViewProjection;
+  previousViewProjection = ubo->viewProjection;
 }
 
-void Grr_drawFrame() {
-  vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE,
-                  UINT64_MAX);
+// Queues the image drawn by the current frame for presentation
+void _Grr_presentFrame(Grr_u32 imageIndex) {
+  VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
+  VkPresentInfoKHR presentInfo = {0};
+  presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
-  Grr_u32 imageIndex;
-  VkResult result = vkAcquireNextImageKHR(
-      device, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame],
-      VK_NULL_HANDLE, &imageIndex);
-  if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+  presentInfo.waitSemaphoreCount = 1;
+  presentInfo.pWaitSemaphores = signalSemaphores;
+
+  VkSwapchainKHR swapChains[] = {swapchain};
+  presentInfo.swapchainCount = 1;
+  presentInfo.pSwapchains = &swapChains[0];
+  presentInfo.pImageIndices = &imageIndex;
+
+  presentInfo.pResults = NULL; // Optional
+
+  // The frame number identifies the present whose completion ends the frame's
+  // latency
+  VkPresentIdKHR presentId = {0};
+  presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+  presentId.swapchainCount = 1;
+  presentId.pPresentIds = &frameNumber;
+  if (presentWaitFeatures)
+    presentInfo.pNext = &presentId;
+
+  // Recreated when the next frame begins
+  VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+  if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+    recreateSwapChain = true;
+  } else if (result != VK_SUCCESS) {
+    GRR_LOG_CRITICAL("Failed to present swapchain image\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+Grr_u64 Grr_completedFrame() {
+  Grr_u64 completed = _Grr_completedValue(GRR_QUEUE_GRAPHICS);
+  // Newest first, frames older than the ones whose values are kept were
+  // waited for before their frame in flight was reused
+  Grr_u64 frame = frameNumber - 1;
+  while (frame > 0 && frame + GRR_MAX_FRAMES_IN_FLIGHT >= frameNumber &&
+         frameTimelineValues[frame % GRR_MAX_FRAMES_IN_FLIGHT] > completed)
+    frame--;
+  return frame;
+}
+
+void Grr_waitForFrame(Grr_u64 number) {
+  if (number == 0 || number >= frameNumber ||
+      number + GRR_MAX_FRAMES_IN_FLIGHT < frameNumber)
+    return;
+  _Grr_waitTimeline(GRR_QUEUE_GRAPHICS,
+                    frameTimelineValues[number % GRR_MAX_FRAMES_IN_FLIGHT]);
+}
+
+void Grr_drawFrame() {
+  _Grr_paceFrame();
+  // The frame in flight is reused once the last frame that used it is complete
+  if (frameNumber > framesInFlight)
+    Grr_waitForFrame(frameNumber - framesInFlight);
+  // Later frames may be complete too
+  Grr_u64 completedFrame = Grr_completedFrame();
+  _Grr_flushDeletions(completedFrame);
+  _Grr_readGpuObjectVisibility(currentFrame);
+  _Grr_readGpuProfile(currentFrame);
+  _Grr_pollFrameLatency();
+
+  // Bursts of resize events and out of date presents since the last frame
+  // recreate the swapchain once
+  if (recreateSwapChain) {
+    recreateSwapChain = false;
     if (false == _Grr_recreateSwapchain()) {
       GRR_LOG_CRITICAL("Failed to recreate swapchain\n");
       exit(EXIT_FAILURE);
     }
+  }
+
+  // Offscreen images belong to frames in flight, free once they are complete
+  Grr_u32 imageIndex = currentFrame;
+  VkResult result = VK_SUCCESS;
+  if (!headless) {
+    result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX,
+                                   imageAvailableSemaphores[currentFrame],
+                                   VK_NULL_HANDLE, &imageIndex);
+  }
+  if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+    recreateSwapChain = true;
     return;
   } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
     GRR_LOG_CRITICAL("Failed to acquire swapchain image\n");
     exit(EXIT_FAILURE);
   }
 
-  vkResetFences(device, 1, &inFlightFences[currentFrame]);
-
-  vkResetCommandBuffer(commandBuffers[currentFrame], 0);
-  _Grr_recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
-
+  // Before recording, which needs the frame's uniform data offset
   _Grr_updateUniformBuffer(currentFrame);
+  _Grr_prepareInstances(frustumPlanes);
+
+  _Grr_beginBindlessFrame(frameNumber, completedFrame);
+
+  // Early culling runs on the compute queue once the previous frame released
+  // what it reads, and the frame is split around the culling of the next one.
+  // Otherwise what the compute queue holds comes back first
+  VkCommandBuffer tailCommandBuffer = VK_NULL_HANDLE;
+  GrrQueueTransfer cullInputs[GRR_COMPUTE_MAX_TRANSFERS];
+  if (_Grr_asyncCulling() &&
+      _Grr_queueTransfersPending(GRR_QUEUE_COMPUTE, cullInputs,
+                                 _Grr_cullInputTransfers(cullInputs))) {
+    _Grr_submitAsyncCulling();
+    tailCommandBuffer = _Grr_frameTailCommandBuffer(currentFrame);
+  } else {
+    _Grr_returnQueueTransfers(currentFrame);
+  }
+
+  // Cached command buffers are only recorded again once something they
+  // reference changed, per frame data is updated in place in mapped buffers
+  VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+  Grr_bool recorded = true;
+  if (commandBufferCaching && _Grr_createCachedCommandBuffers()) {
+    Grr_u32 slot = currentFrame * imageCount + imageIndex;
+    commandBuffer = cachedCommandBuffers[slot];
+    if (cachedCommandBuffersDirty[slot] != 0) {
+      GRR_LOG_DEBUG("Record cached command buffer %u (dirty flags 0x%x)\n",
+                    slot, cachedCommandBuffersDirty[slot]);
+      // Implicitly reset by vkBeginCommandBuffer, kept dirty on failure
+      recorded =
+          _Grr_recordCommandBuffer(commandBuffer, VK_NULL_HANDLE, imageIndex);
+      if (recorded)
+        cachedCommandBuffersDirty[slot] = 0;
+      else
+        GRR_LOG_ERROR("Failed to record cached command buffer %u, frame "
+                      "dropped\n",
+                      slot);
+    }
+  } else {
+    vkResetCommandBuffer(commandBuffer, 0);
+    if (tailCommandBuffer != VK_NULL_HANDLE)
+      vkResetCommandBuffer(tailCommandBuffer, 0);
+    // Queue ownership transfers of unsubmitted command buffers never happen,
+    // neither head nor tail of split frames are submitted on failure
+    _Grr_saveQueueTransfers();
+    recorded =
+        _Grr_recordCommandBuffer(commandBuffer, tailCommandBuffer, imageIndex);
+    if (!recorded) {
+      _Grr_restoreQueueTransfers();
+      tailCommandBuffer = VK_NULL_HANDLE;
+      GRR_LOG_ERROR("Failed to record command buffer %u, frame dropped\n",
+                    currentFrame);
+    }
+  }
 
   VkSubmitInfo submitInfo = {0};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
+  // Nothing to wait for or signal when no image is acquired nor presented
   VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
   VkPipelineStageFlags waitStages[] = {
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.waitSemaphoreCount = headless ? 0 : 1;
   submitInfo.pWaitSemaphores = &waitSemaphores[0];
   submitInfo.pWaitDstStageMask = &waitStages[0];
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
-
-  VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-  submitInfo.signalSemaphoreCount = 1;
-  submitInfo.pSignalSemaphores = &signalSemaphores[0];
 
-  if (vkQueueSubmit(graphicsQueue, 1, &submitInfo,
-                    inFlightFences[currentFrame]) != VK_SUCCESS) {
-    GRR_LOG_CRITICAL("Failed to submit draw command buffer!");
-    exit(EXIT_FAILURE);
+  // The head of split frames waits for their culling on the compute queue,
+  // and releases what the next frame culls with once submitted
+  if (tailCommandBuffer != VK_NULL_HANDLE) {
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    Grr_u64 headValue =
+        _Grr_submit(GRR_QUEUE_GRAPHICS, &submitInfo, &acquiredWait, 1);
+    if (headValue == 0) {
+      GRR_LOG_CRITICAL("Failed to submit draw command buffer!");
+      exit(EXIT_FAILURE);
+    }
+    _Grr_submittedQueueTransfers(GRR_QUEUE_GRAPHICS, headValue);
+    submitInfo.waitSemaphoreCount = 0;
+    commandBuffer = tailCommandBuffer;
   }
 
-  VkPresentInfoKHR presentInfo = {0};
-  presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+  // Readback of the frame after its commands
+  VkCommandBuffer submitted[] = {commandBuffer, VK_NULL_HANDLE};
+  if (recorded)
+    submitted[1] = _Grr_readbackCommandBuffer(currentFrame, frameNumber);
+  submitInfo.commandBufferCount = submitted[1] != VK_NULL_HANDLE ? 2 : 1;
+  submitInfo.pCommandBuffers = &submitted[0];
 
-  presentInfo.waitSemaphoreCount = 1;
-  presentInfo.pWaitSemaphores = signalSemaphores;
-
-  VkSwapchainKHR swapChains[] = {swapchain};
-  presentInfo.swapchainCount = 1;
-  presentInfo.pSwapchains = &swapChains[0];
-  presentInfo.pImageIndices = &imageIndex;
+  VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
+  submitInfo.signalSemaphoreCount = headless ? 0 : 1;
+  submitInfo.pSignalSemaphores = &signalSemaphores[0];
 
-  presentInfo.pResults = NULL; // Optional
+  // Dropped frames submit no commands, only to wait for their image, which
+  // the swapchain recreated next frame takes back without presenting it.
+  // What their early culling released is still acquired
+  GrrTimelineWait acquireWait = {GRR_QUEUE_COMPUTE, 0, 0};
+  if (!recorded) {
+    submitted[0] = _Grr_recordGraphicsAcquires(currentFrame, &acquireWait);
+    submitInfo.commandBufferCount = submitted[0] != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.signalSemaphoreCount = 0;
+    recreateSwapChain = !headless;
+  }
 
-  result = vkQueuePresentKHR(presentQueue, &presentInfo);
-  if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||
-      recreateSwapChain) {
-    recreateSwapChain = false;
-    if (false == _Grr_recreateSwapchain()) {
-      GRR_LOG_CRITICAL("Failed to recreate swapchain\n");
-      exit(EXIT_FAILURE);
-    }
-  } else if (result != VK_SUCCESS) {
-    GRR_LOG_CRITICAL("Failed to present swapchain image\n");
+  Grr_u64 value = _Grr_submit(GRR_QUEUE_GRAPHICS, &submitInfo, &acquireWait, 1);
+  if (value == 0) {
+    GRR_LOG_CRITICAL("Failed to submit draw command buffer!");
     exit(EXIT_FAILURE);
   }
+  _Grr_submittedQueueTransfers(GRR_QUEUE_GRAPHICS, value);
+  frameTimelineValues[frameNumber % GRR_MAX_FRAMES_IN_FLIGHT] = value;
+  if (recorded) {
+    _Grr_submitGpuProfile(currentFrame, frameNumber);
+    if (!headless)
+      _Grr_presentFrame(imageIndex);
+    _Grr_trackFrameLatency(frameNumber);
+  }
 
-  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+  currentFrame = (currentFrame + 1) % framesInFlight;
+  frameNumber++;
 }
 
-void _Grr_destroyVertexBuffer() {
-  GRR_LOG_INFO("Free vertex buffer\n");
-  vkDestroyBuffer(device, vertexBuffer, NULL);
-  vkFreeMemory(device, vertexBufferMemory, NULL);
+void Grr_drawFrames(Grr_u32 frameCount) {
+  for (Grr_u32 i = 0; i < frameCount; i++)
+    Grr_drawFrame();
 }
 
-Grr_bool _Grr_createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
-                           VkMemoryPropertyFlags properties, VkBuffer *buffer,
-                           VkDeviceMemory *bufferMemory) {
+void _Grr_destroyVertexBuffer() {
+  GRR_LOG_INFO("Free vertex buffer\n");
+  _Grr_deferBuffer(vertexBuffer, &vertexBufferMemory);
+}
+
+// Transient buffers (staging) are linearly sub-allocated, others are
+// persistent. Host visible buffers are mapped at bufferMemory->mapped
+// Shared buffers are concurrent between the families of the queues that use
+// them, without ownership transfers
+Grr_bool _Grr_createBufferWithSharing(VkDeviceSize size,
+                                      VkBufferUsageFlags usage,
+                                      VkMemoryPropertyFlags properties,
+                                      GRR_GPU_MEMORY_USAGE memoryUsage,
+                                      Grr_bool shared, VkBuffer *buffer,
+                                      GrrGpuAllocation *bufferMemory) {
   VkBufferCreateInfo bufferInfo = {0};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = size;
   bufferInfo.usage = usage;
   bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  Grr_u32 families[GRR_QUEUE_COUNT];
+  Grr_u32 familyCount = shared ? _Grr_sharedQueueFamilies(families) : 1;
+  if (familyCount > 1) {
+    bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    bufferInfo.queueFamilyIndexCount = familyCount;
+    bufferInfo.pQueueFamilyIndices = &families[0];
+  }
 
   if (vkCreateBuffer(device, &bufferInfo, NULL, buffer) != VK_SUCCESS) {
     GRR_LOG_CRITICAL("Failed to create buffer\n");
@@ -1506,215 +2535,279 @@ Grr_bool _Grr_createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
   VkMemoryRequirements memRequirements;
   vkGetBufferMemoryRequirements(device, *buffer, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo = {0};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex =
+  Grr_u32 memoryTypeIndex =
       _Grr_findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device, &allocInfo, NULL, bufferMemory) != VK_SUCCESS) {
+  if (!_Grr_allocateGpuMemory(&memRequirements, memoryTypeIndex, memoryUsage,
+                              false, bufferMemory)) {
     GRR_LOG_CRITICAL("Failed to allocate buffer memory\n");
+    vkDestroyBuffer(device, *buffer, NULL);
     return false;
   }
 
-  if (vkBindBufferMemory(device, *buffer, *bufferMemory, 0) != VK_SUCCESS) {
+  if (vkBindBufferMemory(device, *buffer, bufferMemory->memory,
+                         bufferMemory->offset) != VK_SUCCESS) {
     GRR_LOG_CRITICAL("Failed to bind buffer memory\n");
+    vkDestroyBuffer(device, *buffer, NULL);
+    _Grr_freeGpuMemory(bufferMemory);
     return false;
   }
 
   return true;
 }
 
-VkCommandBuffer _Grr_beginSingleTimeCommands() {
-  VkCommandBufferAllocateInfo allocInfo = {0};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = commandPool;
-  allocInfo.commandBufferCount = 1;
-
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-  VkCommandBufferBeginInfo beginInfo = {0};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-  return commandBuffer;
+Grr_bool _Grr_createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                           VkMemoryPropertyFlags properties,
+                           GRR_GPU_MEMORY_USAGE memoryUsage, VkBuffer *buffer,
+                           GrrGpuAllocation *bufferMemory) {
+  return _Grr_createBufferWithSharing(size, usage, properties, memoryUsage,
+                                      false, buffer, bufferMemory);
 }
 
-void _Grr_endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-  vkEndCommandBuffer(commandBuffer);
-
-  VkSubmitInfo submitInfo = {0};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
+Grr_bool _Grr_createSharedBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                 VkMemoryPropertyFlags properties,
+                                 GRR_GPU_MEMORY_USAGE memoryUsage,
+                                 VkBuffer *buffer,
+                                 GrrGpuAllocation *bufferMemory) {
+  return _Grr_createBufferWithSharing(size, usage, properties, memoryUsage,
+                                      true, buffer, bufferMemory);
+}
 
-  vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphicsQueue);
+void _Grr_destroyTextureImage() {
+  GRR_LOG_INFO("Free texture image\n");
+  _Grr_deferImage(textureImage, &textureImageMemory);
+}
 
-  vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+Grr_bool _Grr_isFormatSampleable(VkFormat format) {
+  VkFormatProperties properties;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+  return (properties.optimalTilingFeatures &
+          VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 }
 
-void _Grr_transitionImageLayout(VkImage image, VkFormat format,
-                                VkImageLayout oldLayout,
-                                VkImageLayout newLayout) {
-  VkCommandBuffer commandBuffer = _Grr_beginSingleTimeCommands();
+// Mip levels can be generated with linear filtered blits
+Grr_bool _Grr_canBlitMipmaps(VkFormat format) {
+  const VkFormatFeatureFlags required =
+      VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  VkFormatProperties properties;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+  return (properties.optimalTilingFeatures & required) == required;
+}
 
+// Fills levels [firstLevel, mipLevels) with a chain of linear blits, each
+// level from the one above (sRGB formats are filtered in linear space). All
+// levels must be in TRANSFER_DST_OPTIMAL, they end in SHADER_READ_ONLY_OPTIMAL.
+// Needs a graphics queue
+void _Grr_recordGenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image,
+                                Grr_u32 width, Grr_u32 height,
+                                Grr_u32 firstLevel, Grr_u32 mipLevels) {
   VkImageMemoryBarrier barrier = {0};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-  barrier.oldLayout = oldLayout;
-  barrier.newLayout = newLayout;
   barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   barrier.image = image;
   barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  barrier.subresourceRange.baseMipLevel = 0;
-  barrier.subresourceRange.levelCount = 1;
   barrier.subresourceRange.baseArrayLayer = 0;
   barrier.subresourceRange.layerCount = 1;
-  barrier.srcAccessMask = 0; // TODO
-  barrier.dstAccessMask = 0; // TODO
-
-  VkPipelineStageFlags sourceStage;
-  VkPipelineStageFlags destinationStage;
-
-  if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-      newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.subresourceRange.levelCount = 1;
 
-    sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-  } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-             newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+  // Uploaded levels not used as blit sources
+  if (firstLevel > 1) {
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = firstLevel - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-  } else {
-    GRR_LOG_CRITICAL("Unsupported layout transition\n");
-    exit(EXIT_FAILURE);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                         NULL, 1, &barrier);
+    barrier.subresourceRange.levelCount = 1;
   }
 
-  vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, NULL,
-                       0, NULL, 1, &barrier);
-
-  _Grr_endSingleTimeCommands(commandBuffer);
-}
-
-void _Grr_copyBufferToImage(VkBuffer buffer, VkImage image, Grr_u32 width,
-                            Grr_u32 height) {
-  VkCommandBuffer commandBuffer = _Grr_beginSingleTimeCommands();
-
-  VkBufferImageCopy region = {0};
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
-
-  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = 1;
-
-  region.imageOffset.x = 0;
-  region.imageOffset.y = 0;
-  region.imageOffset.z = 0;
-  region.imageExtent.width = width;
-  region.imageExtent.height = height;
-  region.imageExtent.depth = 1;
+  for (Grr_u32 i = firstLevel; i < mipLevels; i++) {
+    // Level above becomes the blit source
+    barrier.subresourceRange.baseMipLevel = i - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
+                         &barrier);
+
+    VkImageBlit blit = {0};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.mipLevel = i - 1;
+    blit.srcSubresource.baseArrayLayer = 0;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[1].x = (Grr_i32)(width >> (i - 1) ? width >> (i - 1) : 1);
+    blit.srcOffsets[1].y = (Grr_i32)(height >> (i - 1) ? height >> (i - 1) : 1);
+    blit.srcOffsets[1].z = 1;
+    blit.dstSubresource = blit.srcSubresource;
+    blit.dstSubresource.mipLevel = i;
+    blit.dstOffsets[1].x = (Grr_i32)(width >> i ? width >> i : 1);
+    blit.dstOffsets[1].y = (Grr_i32)(height >> i ? height >> i : 1);
+    blit.dstOffsets[1].z = 1;
+    vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                   VK_FILTER_LINEAR);
+
+    // Source level is done
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                         NULL, 1, &barrier);
+  }
+
+  // Last level was only written
+  barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0,
+                       NULL, 1, &barrier);
+}
+
+// Creates the texture image with mipLevels levels and queues the upload of
+// the first levelCount (remaining levels are generated with blits)
+Grr_bool _Grr_uploadTextureImage(VkFormat format, Grr_u32 width,
+                                 Grr_u32 height, Grr_u32 levelCount,
+                                 const Grr_byte *const *levelData,
+                                 const size_t *levelBytes, Grr_u32 mipLevels) {
+  VkImageUsageFlags usage =
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+  if (mipLevels > levelCount)
+    usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+  if (!_Grr_createImage(width, height, mipLevels, format,
+                        VK_IMAGE_TILING_OPTIMAL, usage,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &textureImage,
+                        &textureImageMemory)) {
+    GRR_LOG_CRITICAL("Failed to create texture image\n");
+    return false;
+  }
 
-  vkCmdCopyBufferToImage(commandBuffer, buffer, image,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+  if (!Grr_uploadImage(textureImage, width, height, levelCount, levelData,
+                       levelBytes, mipLevels)) {
+    GRR_LOG_CRITICAL("Failed to upload texture image\n");
+    vkDestroyImage(device, textureImage, NULL);
+    _Grr_freeGpuMemory(&textureImageMemory);
+    return false;
+  }
 
-  _Grr_endSingleTimeCommands(commandBuffer);
+  textureFormat = format;
+  textureMipLevels = mipLevels;
+  atexit(_Grr_destroyTextureImage);
+  return true;
 }
 
-void _Grr_copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer,
-                     VkDeviceSize size) {
-  VkCommandBuffer commandBuffer = _Grr_beginSingleTimeCommands();
-
-  VkBufferCopy copyRegion = {0};
-  copyRegion.srcOffset = 0; // Optional
-  copyRegion.dstOffset = 0; // Optional
-  copyRegion.size = size;
-  vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+// Block-compressed (or raw) texture with stored mip levels: no CPU decoding
+Grr_bool _Grr_createTextureImageKTX2(const Grr_string path) {
+  GrrImageKTX2 image;
+  if (!Grr_loadKTX2(path, &image))
+    return false;
 
-  _Grr_endSingleTimeCommands(commandBuffer);
-}
+  if (!_Grr_isFormatSampleable(image.format)) {
+    GRR_LOG_WARNING("KTX2 texture format (%u) not supported by device\n",
+                    image.format);
+    Grr_freeKTX2(&image);
+    return false;
+  }
 
-void _Grr_destroyTextureImage() {
-  GRR_LOG_INFO("Free texture image\n");
-  vkDestroyImage(device, textureImage, NULL);
-  vkFreeMemory(device, textureImageMemory, NULL);
+  const Grr_byte *levelData[GRR_KTX2_MAX_LEVELS];
+  size_t levelBytes[GRR_KTX2_MAX_LEVELS];
+  for (Grr_u32 i = 0; i < image.levelCount; i++) {
+    levelData[i] = image.bytes + image.levels[i].offset;
+    levelBytes[i] = image.levels[i].nBytes;
+  }
+  // A lone base level gets a mip chain when the format can be blitted
+  Grr_u32 mipLevels = image.levelCount;
+  if (mipLevels == 1 && _Grr_canBlitMipmaps(image.format))
+    mipLevels = Grr_mipLevelCount(image.width, image.height);
+  Grr_bool uploaded = _Grr_uploadTextureImage(
+      image.format, image.width, image.height, image.levelCount, levelData,
+      levelBytes, mipLevels);
+  Grr_freeKTX2(&image);
+  return uploaded;
 }
 
-Grr_bool _Grr_createTextureImage() {
+// PNG or JPEG texture decoded to RGBA8
+Grr_bool _Grr_createTextureImageRGBA8(const Grr_string path) {
   Grr_u32 nBytes;
   Grr_u32 width, height;
   Grr_byte *pixelData;
-  pixelData = Grr_loadPNG("./assets/coat_of_arms_of_morocco.png", &nBytes,
-                          &width, &height);
+  pixelData = Grr_loadImage(path, &nBytes, &width, &height);
   if (pixelData == NULL) {
-    GRR_LOG_CRITICAL("Failed to load PNG texture image (%s)\n",
-                     "./assets/coat_of_arms_of_morocco.png");
-    return false;
-  }
-  VkDeviceSize imageSize = width * height * 4;
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
-  _Grr_createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    &stagingBuffer, &stagingBufferMemory);
-
-  void *data;
-  vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-  memcpy(data, pixelData, imageSize);
-  vkUnmapMemory(device, stagingBufferMemory);
-  free(pixelData);
+    GRR_LOG_CRITICAL("Failed to load texture image (%s)\n", path);
+    return false;
+  }
 
-  if (!_Grr_createImage(
-          width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-          VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &textureImage,
-          &textureImageMemory)) {
-    GRR_LOG_CRITICAL("Failed to create texture image\n");
+  const VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+  Grr_u32 mipLevels = Grr_mipLevelCount(width, height);
+  if (_Grr_canBlitMipmaps(format)) {
+    const Grr_byte *levelData[] = {pixelData};
+    size_t levelBytes[] = {(size_t)width * height * 4};
+    Grr_bool uploaded = _Grr_uploadTextureImage(
+        format, width, height, 1, levelData, levelBytes, mipLevels);
+    free(pixelData);
+    return uploaded;
+  }
+
+  // No linear blits: filter the mip chain on the CPU
+  size_t levelOffsets[GRR_KTX2_MAX_LEVELS];
+  Grr_byte *chain = Grr_generateMipChain(pixelData, width, height, true,
+                                         &mipLevels, levelOffsets);
+  free(pixelData);
+  if (NULL == chain) {
+    GRR_LOG_CRITICAL("Failed to generate texture mip chain (%s)\n", path);
     return false;
   }
+  const Grr_byte *levelData[GRR_KTX2_MAX_LEVELS];
+  size_t levelBytes[GRR_KTX2_MAX_LEVELS];
+  for (Grr_u32 i = 0; i < mipLevels; i++) {
+    levelData[i] = chain + levelOffsets[i];
+    levelBytes[i] = (size_t)(width >> i ? width >> i : 1) *
+                    (height >> i ? height >> i : 1) * 4;
+  }
+  Grr_bool uploaded = _Grr_uploadTextureImage(
+      format, width, height, mipLevels, levelData, levelBytes, mipLevels);
+  free(chain);
+  return uploaded;
+}
 
-  _Grr_transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB,
-                             VK_IMAGE_LAYOUT_UNDEFINED,
-                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-  _Grr_copyBufferToImage(stagingBuffer, textureImage, width, height);
-  _Grr_transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB,
-                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+Grr_bool _Grr_createTextureImage() {
+  const Grr_string imagePath = "./assets/coat_of_arms_of_morocco.png";
+  char ktx2Path[256];
 
-  vkDestroyBuffer(device, stagingBuffer, NULL);
-  vkFreeMemory(device, stagingBufferMemory, NULL);
+  // Cook to BC7 when the device samples it (the KTX2 next to the source is
+  // reused while up to date), otherwise prefer any pre-compressed KTX2
+  if (_Grr_isFormatSampleable(VK_FORMAT_BC7_SRGB_BLOCK) &&
+      Grr_cookTexture(imagePath, GRR_BC7, GRR_BC_QUALITY_HIGH, true, ktx2Path,
+                      sizeof(ktx2Path)) &&
+      _Grr_createTextureImageKTX2(ktx2Path))
+    return true;
+  if (Grr_cookedTexturePath(imagePath, ktx2Path, sizeof(ktx2Path)) &&
+      Grr_fileExists(ktx2Path) && _Grr_createTextureImageKTX2(ktx2Path))
+    return true;
 
-  atexit(_Grr_destroyTextureImage);
-  return true;
+  return _Grr_createTextureImageRGBA8(imagePath);
 }
 
-void _Grr_destroyTextureImageView() {
-  vkDestroyImageView(device, textureImageView, NULL);
-}
+void _Grr_destroyTextureImageView() { _Grr_deferImageView(textureImageView); }
 
 void _Grr_createTextureImageView() {
-  textureImageView = _Grr_createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB,
-                                          VK_IMAGE_ASPECT_COLOR_BIT);
+  textureImageView = _Grr_createImageView(
+      textureImage, textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, textureMipLevels);
 
   atexit(_Grr_destroyTextureImageView);
 }
 
-void _Grr_destroyTextureSampler() {
-  vkDestroySampler(device, textureSampler, NULL);
-}
+void _Grr_destroyTextureSampler() { _Grr_deferSampler(textureSampler); }
 
 Grr_bool _Grr_createTextureSampler() {
   VkSamplerCreateInfo samplerInfo = {0};
@@ -1735,7 +2828,7 @@ Grr_bool _Grr_createTextureSampler() {
   samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
   samplerInfo.mipLodBias = 0.0f;
   samplerInfo.minLod = 0.0f;
-  samplerInfo.maxLod = 0.0f;
+  samplerInfo.maxLod = (Grr_f32)textureMipLevels;
 
   if (vkCreateSampler(device, &samplerInfo, NULL, &textureSampler) !=
       VK_SUCCESS) {
@@ -1746,6 +2839,18 @@ Grr_bool _Grr_createTextureSampler() {
   return true;
 }
 
+Grr_bool _Grr_createDefaultMaterial() {
+  GrrMaterial material = {0};
+  for (Grr_u32 i = 0; i < 4; i++)
+    material.baseColorFactor[i] = 1.0f;
+  material.baseColorImage = Grr_registerImage(textureImageView);
+  material.baseColorSampler = Grr_registerSampler(textureSampler);
+  if (material.baseColorImage == GRR_BINDLESS_INVALID ||
+      material.baseColorSampler == GRR_BINDLESS_INVALID)
+    return false;
+  return Grr_createMaterial(&material) == 0;
+}
+
 void _Grr_modelDebug(GrrModel *model) {
   printf("Vertex count %u\n", model->vertexCount);
   for (Grr_u32 i = 0; i < model->vertexCount * 3; i += 3) {
@@ -1823,9 +2928,39 @@ Grr_bool _Grr_createVertexBuffer() {
   // Grr_writeJSONToFile(json, "output.json");
   Grr_modelFromAsset(&model, glTF, 0, 0);
   _Grr_modelDebug(&model);
+
+  // Quantized vertices replace the f32 attribute streams entirely, positions
+  // alone take 8 bytes per vertex instead of 12
+  void *quantized = NULL;
+  VkDeviceSize quantizedSize = (_Grr_quantizedPositionsOnly()
+                                    ? sizeof(GrrQuantizedPosition)
+                                    : sizeof(GrrQuantizedVertex));
+  Grr_identityMatrix(&modelDequantization);
+  if (quantizedVertices && NULL != model.positions) {
+    quantized = malloc(quantizedSize * model.vertexCount);
+    if (NULL == quantized) {
+      GRR_LOG_CRITICAL("Failed to allocate memory for quantized vertices\n");
+      return false;
+    }
+    GrrVector3 aabbMin, aabbExtent;
+    if (quantizedSize == sizeof(GrrQuantizedPosition))
+      Grr_quantizePositions(model.vertexCount, model.positions,
+                            (Grr_u16 *)quantized,
+                            sizeof(GrrQuantizedPosition) / sizeof(Grr_u16),
+                            &aabbMin, &aabbExtent);
+    else
+      Grr_quantizeVertices(model.vertexCount, model.positions, model.normals,
+                           model.tangents, model.textureCoordinates,
+                           (GrrQuantizedVertex *)quantized, &aabbMin,
+                           &aabbExtent);
+    Grr_dequantizationMatrix(&aabbMin, &aabbExtent, &modelDequantization);
+  }
+
   VkDeviceSize positionBufferSize =
       (model.positions ? sizeof(Grr_f32) * 3 * model.vertexCount
                        : 0); // Positions
+  if (NULL != quantized)
+    positionBufferSize = quantizedSize * model.vertexCount;
   // VkDeviceSize colorBufferSize =
   //     (model.colors ? sizeof(Grr_f32) * 3 * model.vertexCount : 0); // Colors
   // VkDeviceSize textureCoordinateBufferSize =
@@ -1833,20 +2968,23 @@ Grr_bool _Grr_createVertexBuffer() {
   //                               : 0); // Texture coordinates
   VkDeviceSize bufferSize =
       positionBufferSize; // + colorBufferSize + textureCoordinateBufferSize;
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
-  if (_Grr_createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        &stagingBuffer, &stagingBufferMemory) == false) {
-    GRR_LOG_CRITICAL("Failed to create staging buffer\n");
+  if (_Grr_createBuffer(bufferSize,
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        GRR_GPU_MEMORY_PERSISTENT, &vertexBuffer,
+                        &vertexBufferMemory) == false) {
+    GRR_LOG_CRITICAL("Failed to create vertex buffer\n");
+    free(quantized);
     return false;
   }
 
-  void *data;
-  vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-  if (NULL != model.positions)
-    memcpy(data, model.positions, (size_t)positionBufferSize); // Positions
+  const void *data =
+      (NULL != quantized ? (const void *)quantized : model.positions);
+  Grr_bool uploaded = (NULL == data ||
+                       Grr_uploadBuffer(vertexBuffer, 0, data, bufferSize,
+                                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT));
   // if (NULL != model.colors)
   //   memcpy(data + positionBufferSize, model.colors,
   //          (size_t)colorBufferSize); // Colors
@@ -1854,22 +2992,12 @@ Grr_bool _Grr_createVertexBuffer() {
   //   memcpy(data + positionBufferSize + colorBufferSize,
   //          model.textureCoordinates,
   //          (size_t)textureCoordinateBufferSize); // Texture coordinates
-  vkUnmapMemory(device, stagingBufferMemory);
-
-  if (_Grr_createBuffer(bufferSize,
-                        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &vertexBuffer,
-                        &vertexBufferMemory) == false) {
-    GRR_LOG_CRITICAL("Failed to create vertex buffer\n");
+  free(quantized);
+  if (!uploaded) {
+    GRR_LOG_CRITICAL("Failed to upload vertex buffer\n");
     return false;
   }
 
-  _Grr_copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
-
-  vkDestroyBuffer(device, stagingBuffer, NULL);
-  vkFreeMemory(device, stagingBufferMemory, NULL);
-
   atexit(_Grr_destroyVertexBuffer);
 
   return true;
@@ -1877,48 +3005,7 @@ Grr_bool _Grr_createVertexBuffer() {
 
 void _Grr_destroyIndexBuffer() {
   GRR_LOG_INFO("Free index buffer\n");
-  vkDestroyBuffer(device, indexBuffer, NULL);
-  vkFreeMemory(device, indexBufferMemory, NULL);
-}
-
-void _Grr_destroyUniformBuffers() {
-  for (Grr_u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    vkDestroyBuffer(device, uniformBuffers[i], NULL);
-    vkFreeMemory(device, uniformBuffersMemory[i], NULL);
-  }
-
-  free(uniformBuffers);
-  free(uniformBuffersMapped);
-  free(uniformBuffersMemory);
-
-  // vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
-}
-
-Grr_bool _Grr_createUniformBuffers() {
-  VkDeviceSize bufferSize = sizeof(GrrUniformBufferObject);
-
-  uniformBuffers = (VkBuffer *)malloc(sizeof(VkBuffer) * MAX_FRAMES_IN_FLIGHT);
-  uniformBuffersMemory =
-      (VkDeviceMemory *)malloc(sizeof(VkDeviceMemory) * MAX_FRAMES_IN_FLIGHT);
-  uniformBuffersMapped = (void **)malloc(sizeof(void *) * MAX_FRAMES_IN_FLIGHT);
-
-  for (Grr_u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    if (_Grr_createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                          &uniformBuffers[i],
-                          &uniformBuffersMemory[i]) == false) {
-      return false;
-    }
-
-    if (vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0,
-                    &uniformBuffersMapped[i]) != VK_SUCCESS) {
-      return false;
-    }
-  }
-
-  atexit(_Grr_destroyUniformBuffers);
-  return true;
+  _Grr_deferBuffer(indexBuffer, &indexBufferMemory);
 }
 
 void _Grr_destroyDescriptorPool() {
@@ -1928,16 +3015,16 @@ void _Grr_destroyDescriptorPool() {
 
 Grr_bool _Grr_createDescriptorPool() {
   VkDescriptorPoolSize poolSizes[2] = {0};
-  poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-  poolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+  poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  poolSizes[0].descriptorCount = GRR_MAX_FRAMES_IN_FLIGHT;
   poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  poolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+  poolSizes[1].descriptorCount = GRR_MAX_FRAMES_IN_FLIGHT;
 
   VkDescriptorPoolCreateInfo poolInfo = {0};
   poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
   poolInfo.poolSizeCount = sizeof(poolSizes) / sizeof(poolSizes[0]);
   poolInfo.pPoolSizes = poolSizes;
-  poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+  poolInfo.maxSets = GRR_MAX_FRAMES_IN_FLIGHT;
 
   if (vkCreateDescriptorPool(device, &poolInfo, NULL, &descriptorPool) !=
       VK_SUCCESS) {
@@ -1956,21 +3043,21 @@ void _Grr_destroyDescriptorSets() {
 }
 
 Grr_bool _Grr_createDescriptorSets() {
-  layouts = malloc(sizeof(VkDescriptorSetLayout) * MAX_FRAMES_IN_FLIGHT);
+  layouts = malloc(sizeof(VkDescriptorSetLayout) * GRR_MAX_FRAMES_IN_FLIGHT);
   if (layouts == NULL) {
     GRR_LOG_CRITICAL("Failed to allocate memory for descriptor set layouts\n");
     return false;
   }
-  for (Grr_u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++)
     layouts[i] = descriptorSetLayout;
 
   VkDescriptorSetAllocateInfo allocInfo = {0};
   allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
   allocInfo.descriptorPool = descriptorPool;
-  allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+  allocInfo.descriptorSetCount = GRR_MAX_FRAMES_IN_FLIGHT;
   allocInfo.pSetLayouts = layouts;
 
-  descriptorSets = malloc(sizeof(VkDescriptorSet) * MAX_FRAMES_IN_FLIGHT);
+  descriptorSets = malloc(sizeof(VkDescriptorSet) * GRR_MAX_FRAMES_IN_FLIGHT);
   if (descriptorSets == NULL) {
     GRR_LOG_CRITICAL("Failed to allocate memory for descriptor sets\n");
     return false;
@@ -1981,9 +3068,10 @@ Grr_bool _Grr_createDescriptorSets() {
     return false;
   }
 
-  for (Grr_u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+  for (Grr_u32 i = 0; i < GRR_MAX_FRAMES_IN_FLIGHT; i++) {
     VkDescriptorBufferInfo bufferInfo = {0};
-    bufferInfo.buffer = uniformBuffers[i];
+    // Dynamic offsets select the frame's data
+    bufferInfo.buffer = Grr_frameDataBuffer();
     bufferInfo.offset = 0;
     bufferInfo.range = sizeof(GrrUniformBufferObject);
 
@@ -1997,7 +3085,8 @@ Grr_bool _Grr_createDescriptorSets() {
     descriptorWrites[0].dstSet = descriptorSets[i];
     descriptorWrites[0].dstBinding = 0;
     descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptorWrites[0].descriptorType =
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     descriptorWrites[0].descriptorCount = 1;
     descriptorWrites[0].pBufferInfo = &bufferInfo;
 
@@ -2015,6 +3104,7 @@ Grr_bool _Grr_createDescriptorSets() {
         &descriptorWrites[0], 0, NULL);
   }
 
+  _Grr_invalidateCommandBuffers(GRR_COMMANDS_DIRTY_DESCRIPTORS);
   atexit(_Grr_destroyDescriptorSets);
   return true;
 }
@@ -2022,34 +3112,24 @@ Grr_bool _Grr_createDescriptorSets() {
 Grr_bool _Grr_createIndexBuffer() {
   VkDeviceSize bufferSize = sizeof(Grr_u32) * model.indexCount;
 
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
-  if (_Grr_createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        &stagingBuffer, &stagingBufferMemory) == false) {
-    GRR_LOG_CRITICAL("Failed to create staging buffer");
-    return false;
-  }
-
-  void *data;
-  vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-  memcpy(data, model.indices, (size_t)bufferSize);
-  vkUnmapMemory(device, stagingBufferMemory);
-
   if (_Grr_createBuffer(bufferSize,
                         VK_BUFFER_USAGE_TRANSFER_DST_BIT |
                             VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &indexBuffer,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        GRR_GPU_MEMORY_PERSISTENT, &indexBuffer,
                         &indexBufferMemory) == false) {
     GRR_LOG_CRITICAL("Failed to create index buffer");
     return false;
   }
 
-  _Grr_copyBuffer(stagingBuffer, indexBuffer, bufferSize);
-
-  vkDestroyBuffer(device, stagingBuffer, NULL);
-  vkFreeMemory(device, stagingBufferMemory, NULL);
+  if (!Grr_uploadBuffer(indexBuffer, 0, model.indices, bufferSize,
+                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                        VK_ACCESS_INDEX_READ_BIT)) {
+    GRR_LOG_CRITICAL("Failed to upload index buffer");
+    return false;
+  }
+  // Vertex and index data were copied for the upload, counts are kept for draws
+  Grr_freeModel(&model);
 
   atexit(_Grr_destroyIndexBuffer);
   return true;
@@ -2057,9 +3137,7 @@ Grr_bool _Grr_createIndexBuffer() {
 
 void _Grr_deviceWait() { vkDeviceWaitIdle(device); }
 
-void Grr_initializeVulkan() {
-  GRR_LOG_INFO("Initialize vulkan\n");
-
+void _Grr_initializeVulkan() {
   // Instance and debugger callback
   if (false == _Grr_createVulkanInstance()) {
     GRR_LOG_CRITICAL("Failed to create vulkan instance\n");
@@ -2067,7 +3145,7 @@ void Grr_initializeVulkan() {
   }
 
   // Window surface
-  if (false == _Grr_createSurface()) {
+  if (!headless && false == _Grr_createSurface()) {
     GRR_LOG_CRITICAL("Failed to create vulkan surface\n");
     exit(EXIT_FAILURE);
   }
@@ -2087,12 +3165,41 @@ void Grr_initializeVulkan() {
     exit(EXIT_FAILURE);
   }
 
+  // Queue timelines, frames and uploads are tracked with them
+  if (false == _Grr_initializeSync(timelineSemaphoreFeatures)) {
+    GRR_LOG_CRITICAL("Failed to create queue timelines\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Latency measurement, to present completion when possible
+  _Grr_initializeFramePacing(presentWaitFeatures);
+
+  // Render graph barriers, with synchronization2 when available
+  _Grr_initializeRenderGraphs(synchronization2Features);
+
+  // Device memory blocks (freed after every resource using them)
+  if (false == _Grr_initializeGpuMemory(physicalDevice, device)) {
+    GRR_LOG_CRITICAL("Failed to initialize device memory allocator\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Objects released at runtime are destroyed once the frames using them are
+  // complete. At exit, modules queue their objects too and the queue is
+  // flushed once, after all of them and before device memory
+  atexit(_Grr_destroyDeletions);
+
+  // Pipeline cache, a missing one only costs pipeline compilation time
+  if (false == _Grr_createPipelineCache()) {
+    GRR_LOG_WARNING("Pipelines are created without a pipeline cache\n");
+  }
+
   // Swap chain
   if (false == _Grr_createSwapchain(false)) {
     GRR_LOG_CRITICAL("Failed to create swapchain\n");
     exit(EXIT_FAILURE);
   }
-  if (false == Grr_subscribe(GRR_WINDOW_RESIZED, _Grr_swapchainResizeHandler)) {
+  if (!headless &&
+      false == Grr_subscribe(GRR_WINDOW_RESIZED, _Grr_swapchainResizeHandler)) {
     GRR_LOG_CRITICAL("Failed to subscribe swapchain resize handler\n");
     exit(EXIT_FAILURE);
   }
@@ -2115,20 +3222,55 @@ void Grr_initializeVulkan() {
     exit(EXIT_FAILURE);
   }
 
+  // Bindless descriptor set, part of the pipeline layout
+  if (false == _Grr_initializeBindless()) {
+    GRR_LOG_CRITICAL("Failed to create bindless descriptors\n");
+    exit(EXIT_FAILURE);
+  }
+
   // Graphics pipeline
   if (false == _Grr_createGraphicsPipeline()) {
     GRR_LOG_CRITICAL("Failed to create graphics pipeline\n");
     exit(EXIT_FAILURE);
   }
 
+  // GPU driven draws (compute frustum and Hi-Z occlusion culling), when the
+  // device supports them
+  gpuDrivenDraws =
+      indirectDrawFeatures &&
+      _Grr_initializeHiZ(_Grr_findDepthFormat(), pipelineCache) &&
+      _Grr_initializeIndirectDraws(descriptorSetLayout, pipelineCache,
+                                   drawIndirectCountExtension);
+  if (!gpuDrivenDraws) {
+    GRR_LOG_WARNING("GPU driven draws are not available\n");
+  }
+
+  // GPU timestamps and pipeline statistics, when the device supports them
+  if (false == _Grr_initializeProfiler(pipelineStatisticsFeatures)) {
+    GRR_LOG_WARNING("GPU profiling is not available\n");
+  }
+
   // Command pool
   if (false == _Grr_createCommandPool()) {
     GRR_LOG_CRITICAL("Failed to create command pool\n");
     exit(EXIT_FAILURE);
   }
 
+  // Upload manager (staging ring and transfer queue batches)
+  if (false == _Grr_initializeUploads()) {
+    GRR_LOG_CRITICAL("Failed to initialize upload manager\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Compute queue work overlapped with the graphics queue, when the device
+  // has a separate compute family
+  if (false == _Grr_initializeAsyncCompute()) {
+    GRR_LOG_CRITICAL("Failed to initialize async compute\n");
+    exit(EXIT_FAILURE);
+  }
+
   // Depth buffer
-  if (false == _Grr_createDepthResources()) {
+  if (false == _Grr_createDepthResources(false)) {
     GRR_LOG_CRITICAL("Failed to create depth resources\n");
     exit(EXIT_FAILURE);
   }
@@ -2139,6 +3281,12 @@ void Grr_initializeVulkan() {
     exit(EXIT_FAILURE);
   }
 
+  // Render graphs of the frame
+  if (false == _Grr_createFrameGraphs()) {
+    GRR_LOG_CRITICAL("Failed to create render graphs\n");
+    exit(EXIT_FAILURE);
+  }
+
   // Texture image
   if (false == _Grr_createTextureImage()) {
     GRR_LOG_CRITICAL("Failed to create texture image\n");
@@ -2154,6 +3302,12 @@ void Grr_initializeVulkan() {
     exit(EXIT_FAILURE);
   }
 
+  // Material 0, used by draws that do not set one
+  if (!_Grr_createDefaultMaterial()) {
+    GRR_LOG_CRITICAL("Failed to create default material\n");
+    exit(EXIT_FAILURE);
+  }
+
   // Vertex buffers
   if (false == _Grr_createVertexBuffer()) {
     GRR_LOG_CRITICAL("Failed to create vertex buffer\n");
@@ -2166,9 +3320,19 @@ void Grr_initializeVulkan() {
     exit(EXIT_FAILURE);
   }
 
-  // Uniform buffers
-  if (false == _Grr_createUniformBuffers()) {
-    GRR_LOG_CRITICAL("Failed to create uniform buffers\n");
+  // Texture, vertex and index data go in a single batch, the graphics queue
+  // waits for it through the queue ownership acquire (or the same queue)
+  Grr_submitUploads();
+
+  // Per frame uniform data
+  if (false == _Grr_initializeFrameData(GRR_MAX_FRAMES_IN_FLIGHT)) {
+    GRR_LOG_CRITICAL("Failed to create frame data buffer\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Instance data of instanced draws lives in the frame data
+  if (false == _Grr_initializeInstancing()) {
+    GRR_LOG_CRITICAL("Failed to initialize instancing\n");
     exit(EXIT_FAILURE);
   }
 
@@ -2190,12 +3354,56 @@ void Grr_initializeVulkan() {
     exit(EXIT_FAILURE);
   }
 
+  // Per thread command pools for parallel recording
+  if (false == _Grr_initializeCommandRecording(GRR_MAX_FRAMES_IN_FLIGHT)) {
+    GRR_LOG_CRITICAL("Failed to initialize command recording\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // The whole model, unless a draw list was set
+  if (drawList == NULL) {
+    GrrDraw modelDraw = {0};
+    modelDraw.indexCount = model.indexCount;
+    Grr_identityMatrix(&modelDraw.transform);
+    if (false == Grr_setDrawList(&modelDraw, 1)) {
+      GRR_LOG_CRITICAL("Failed to create draw list\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
   // Sync objects
   if (false == _Grr_createSyncObjects()) {
     GRR_LOG_CRITICAL("Failed to create sync objects\n");
     exit(EXIT_FAILURE);
   }
 
+  GrrGpuMemoryStatistics memoryStatistics;
+  Grr_gpuMemoryStatistics(GRR_GPU_MEMORY_ALL_TYPES, &memoryStatistics);
+  GRR_LOG_DEBUG("Device memory: %u allocations in %u device allocations, "
+                "%llu/%llu bytes used, fragmentation %.2f\n",
+                memoryStatistics.allocationCount,
+                memoryStatistics.deviceAllocationCount,
+                (unsigned long long)memoryStatistics.usedBytes,
+                (unsigned long long)memoryStatistics.reservedBytes,
+                memoryStatistics.fragmentation);
+
   // Should be last to have it execute first at exit
   atexit(_Grr_deviceWait);
+}
+
+void Grr_initializeVulkan() {
+  GRR_LOG_INFO("Initialize vulkan\n");
+  _Grr_initializeVulkan();
+}
+
+void Grr_initializeVulkanHeadless(Grr_u32 width, Grr_u32 height) {
+  GRR_LOG_INFO("Initialize vulkan (headless, %ux%u)\n", width, height);
+  if (width == 0 || height == 0) {
+    GRR_LOG_CRITICAL("Empty offscreen images\n");
+    exit(EXIT_FAILURE);
+  }
+  headless = true;
+  headlessWidth = width;
+  headlessHeight = height;
+  _Grr_initializeVulkan();
 }
\ No newline at end of file
@@ -2,9 +2,27 @@
 #define GRR_VULKAN_H
 
 #include "assets.h"
+#include "bindless.h"
+#include "commands.h"
+#include "compute.h"
+#include "culling.h"
+#include "deletion.h"
+#include "framedata.h"
+#include "gpumemory.h"
+#include "headless.h"
+#include "hiz.h"
+#include "indirect.h"
+#include "instancing.h"
 #include "logging.h"
 #include "math/linear.h"
+#include "pacing.h"
+#include "pipelinecache.h"
+#include "profiler.h"
+#include "rendergraph.h"
+#include "sync.h"
+#include "textures.h"
 #include "types.h"
+#include "upload.h"
 #include "utils.h"
 #include "window.h"
 #include <string.h>
@@ -29,9 +47,134 @@ typedef struct GrrUniformBufferObject {
   GrrMatrix4x4 model;
   GrrMatrix4x4 view;
   GrrMatrix4x4 projection;
+  GrrVector4 frustumPlanes[6]; // Of projection * view, for GPU culling
+  GrrMatrix4x4 viewProjection;
+  GrrMatrix4x4 previousViewProjection; // Of the previous frame, for Hi-Z
 } GrrUniformBufferObject;
 
+#define GRR_MAX_FRAMES_IN_FLIGHT 3 // Frames in flight are set at runtime
+
+// Indexed draw of the model vertex and index buffers
+typedef struct GrrDraw {
+  Grr_u32 indexCount;
+  Grr_u32 firstIndex;
+  Grr_i32 vertexOffset;
+  Grr_u32 objectIndex;    // Index of per object data for shaders
+  Grr_u32 materialIndex;  // From Grr_createMaterial, 0 is the default one
+  GrrMatrix4x4 transform; // Applied after the model matrix of the UBO
+  // Center (xyz) and radius (w) in world space, frustum culled on the CPU
+  // before recording. A radius of 0 or less is never culled
+  GrrVector4 boundingSphere;
+} GrrDraw;
+
+// Push constants of a draw (at most the 128 bytes every device supports)
+typedef struct GrrDrawConstants {
+  GrrMatrix4x4 transform;
+  Grr_u32 objectIndex;
+  Grr_u32 materialIndex;
+  // Bindless IDs, GRR_BINDLESS_INVALID for draws of the draw list
+  Grr_u32 objectBuffer;   // GPU objects of indirect draws
+  Grr_u32 instanceBuffer; // Instances of instanced draws
+  Grr_u32 instanceBase;   // Of the frame's instances, in 16 byte units
+} GrrDrawConstants;
+
+// Uploads the model quantized (see math/quantize.h) instead of as f32
+// attribute streams. While those are positions alone, vertices shrink from 12
+// bytes to GrrQuantizedPosition's 8. GrrQuantizedVertex (20 bytes) is only
+// uploaded once normals, tangents and texture coordinates (48 bytes) are
+// streamed. Off by default, set before initialization
+void Grr_setQuantizedVertices(Grr_bool enabled);
+
 void Grr_initializeVulkan();
 void Grr_drawFrame();
 
+// Draws into offscreen images of width x height instead of a window (see
+// headless.h), called instead of Grr_initializeVulkan. Frames are read back
+// with Grr_requestReadback and Grr_readback
+void Grr_initializeVulkanHeadless(Grr_u32 width, Grr_u32 height);
+
+// frameCount frames back to back, as many as the frames in flight allow
+void Grr_drawFrames(Grr_u32 frameCount);
+
+// Number of the last frame whose commands are complete, without blocking. 0
+// before the first one completes
+Grr_u64 Grr_completedFrame();
+
+// Blocks until the commands of frame number are complete, returns immediately
+// for frames not drawn yet
+void Grr_waitForFrame(Grr_u64 number);
+
+// Replaces the draw list (copied), which draws the whole model by default
+Grr_bool Grr_setDrawList(const GrrDraw *draws, Grr_u32 count);
+
+// View and projection of the frames drawn next (copied), identity until set
+void Grr_setCamera(const GrrCamera *camera);
+
+// Keeps pre-recorded command buffers per frame in flight and swapchain image,
+// recorded again only when something they reference changes. Meant for mostly
+// static scenes: large draw lists are then recorded on a single thread, and
+// the draw list is not frustum culled
+void Grr_setCommandBufferCaching(Grr_bool enabled);
+
+// Renderer state and helpers shared with the other renderer modules (defined
+// in vulkan.c)
+extern VkInstance instance;
+extern VkPhysicalDevice physicalDevice;
+extern VkDevice device;
+extern GrrQueueFamilyIndices queueFamilyIndices;
+extern VkQueue graphicsQueue;
+extern VkQueue computeQueue; // VK_NULL_HANDLE without a compute family
+extern VkQueue transferQueue;
+extern VkCommandPool commandPool;
+extern VkCommandBuffer *commandBuffers;
+extern VkSwapchainKHR swapchain;
+extern Grr_bool recreateSwapChain;
+extern Grr_bool headless;
+extern Grr_u32 framesInFlight;
+extern Grr_u32 currentFrame;
+extern Grr_u64 frameNumber; // Of the frame drawn next, from 1
+
+Grr_u32 _Grr_findMemoryType(Grr_u32 typeFilter,
+                            VkMemoryPropertyFlags properties);
+Grr_bool _Grr_createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                           VkMemoryPropertyFlags properties,
+                           GRR_GPU_MEMORY_USAGE memoryUsage, VkBuffer *buffer,
+                           GrrGpuAllocation *bufferMemory);
+// Buffer read by the graphics and the async compute queues (see compute.h)
+Grr_bool _Grr_createSharedBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                 VkMemoryPropertyFlags properties,
+                                 GRR_GPU_MEMORY_USAGE memoryUsage,
+                                 VkBuffer *buffer,
+                                 GrrGpuAllocation *bufferMemory);
+Grr_bool _Grr_createShaderModule(const Grr_byte *bytes, size_t nBytes,
+                                 VkShaderModule *shaderModule);
+Grr_bool _Grr_createImage(Grr_u32 width, Grr_u32 height, Grr_u32 mipLevels,
+                          VkFormat format, VkImageTiling tiling,
+                          VkImageUsageFlags usage,
+                          VkMemoryPropertyFlags properties, VkImage *image,
+                          GrrGpuAllocation *imageMemory);
+Grr_bool _Grr_hasStencilComponent(VkFormat format);
+void _Grr_recordGenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image,
+                                Grr_u32 width, Grr_u32 height,
+                                Grr_u32 firstLevel, Grr_u32 mipLevels);
+Grr_bool _Grr_buildGraphicsPipeline(VkPipelineCache cache,
+                                    VkPipeline *pipeline);
+// Frames split for async compute record their tail into tailCommandBuffer,
+// VK_NULL_HANDLE records the whole frame into commandBuffer
+Grr_bool _Grr_recordCommandBuffer(VkCommandBuffer commandBuffer,
+                                  VkCommandBuffer tailCommandBuffer,
+                                  Grr_u32 imageIndex);
+
+// What cached command buffers reference
+typedef enum GRR_COMMANDS_DIRTY {
+  GRR_COMMANDS_DIRTY_DRAW_LIST = 1 << 0,
+  GRR_COMMANDS_DIRTY_PIPELINE = 1 << 1,
+  GRR_COMMANDS_DIRTY_DESCRIPTORS = 1 << 2,
+  GRR_COMMANDS_DIRTY_SWAPCHAIN = 1 << 3, // Extent and framebuffers
+  GRR_COMMANDS_DIRTY_ALL = (1 << 4) - 1
+} GRR_COMMANDS_DIRTY;
+
+// Cached command buffers are recorded again before their next use
+void _Grr_invalidateCommandBuffers(Grr_u32 dirtyFlags);
+
 #endif
\ No newline at end of file
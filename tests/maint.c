@@ -1,4 +1,25 @@
+#include "test_assets.h"
+#include "test_bindless.h"
+#include "test_commands.h"
+#include "test_compute.h"
+#include "test_culling.h"
+#include "test_deletion.h"
 #include "test_events.h"
+#include "test_framedata.h"
+#include "test_gpumemory.h"
+#include "test_hiz.h"
+#include "test_instancing.h"
+#include "test_jobs.h"
+#include "test_jpeg.h"
+#include "test_linear.h"
+#include "test_meshopt.h"
+#include "test_pacing.h"
+#include "test_pipelinecache.h"
+#include "test_profiler.h"
+#include "test_quantize.h"
+#include "test_rendergraph.h"
+#include "test_sync.h"
+#include "test_textures.h"
 #include "test_utils.h"
 #include <stdlib.h>
 
@@ -14,5 +35,65 @@ int main() {
   test_Grr_listPushBack();
   test_Grr_listGetAtIndex();
 
+  // Math
+  test_Grr_f32ToF16();
+  test_Grr_octahedralEncode();
+  test_Grr_quantizeVertices();
+  test_Grr_quantizePositions();
+  test_Grr_frustumPlanes();
+  test_Grr_cameraFrustum();
+
+  // Jobs
+  test_Grr_parallelFor();
+
+  // Culling
+  test_Grr_cullSpheres();
+  test_Grr_cullBoxes();
+  test_Grr_cullParallel();
+
+  // Memory
+  test_Grr_buddyAllocate();
+  test_Grr_linearAllocate();
+  test_Grr_frameAllocate();
+
+  // Renderer
+  test_Grr_isPipelineCacheCompatible();
+  test_Grr_recordingSlice();
+  test_Grr_recordingSliceCount();
+  test_Grr_allocateIndex();
+  test_Grr_hiZPyramidSize();
+  test_Grr_batchInstances();
+  test_Grr_timestampMilliseconds();
+  test_Grr_summarizeTimings();
+  test_Grr_summarizeHistory();
+  test_Grr_choosePresentMode();
+  test_Grr_nextFrameDeadline();
+  test_Grr_aliasTransients();
+  test_Grr_compileRenderGraph();
+  test_Grr_completedDeletions();
+  test_Grr_pushDeletion();
+  test_Grr_advanceTimeline();
+  test_Grr_mergeTimelineWaits();
+  test_Grr_uniqueQueueFamilies();
+  test_Grr_queueTransferBarriers();
+
+  // Assets
+  test_Grr_meshoptDecodeVertexBuffer();
+  test_Grr_meshoptDecodeIndexBuffer();
+  test_Grr_meshoptDecodeIndexSequence();
+  test_Grr_meshoptFilters();
+  test_Grr_meshoptDecodeAll();
+  test_Grr_decodeJPEG();
+  test_Grr_glTFDecodeCompressedBufferViews();
+  test_Grr_modelFromAsset();
+  test_Grr_parseKTX2();
+  test_Grr_writeKTX2();
+  test_Grr_encodeBC1Block();
+  test_Grr_encodeBC4Block();
+  test_Grr_encodeBC7Block();
+  test_Grr_encodeBC();
+  test_Grr_cookedTexturePath();
+  test_Grr_generateMipChain();
+
   return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "test_assets.h"
+
+void _test_Grr_writeU32LE(Grr_byte *bytes, Grr_u32 value) {
+  for (Grr_u32 i = 0; i < 4; i++)
+    bytes[i] = (Grr_byte)(value >> (i * 8));
+}
+
+void _test_Grr_writeU64LE(Grr_byte *bytes, Grr_u64 value) {
+  _test_Grr_writeU32LE(bytes, (Grr_u32)value);
+  _test_Grr_writeU32LE(bytes + 4, (Grr_u32)(value >> 32));
+}
+
+// 8x8 BC1 texture with a full mip chain (4 levels of 32, 8, 8 and 8 bytes),
+// stored smallest level first as in KTX2 files
+size_t _test_Grr_buildKTX2(Grr_byte *bytes) {
+  const Grr_byte identifier[12] = {0xAB, 'K',  'T',  'X',  ' ',  '2',
+                                   '0',  0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  memset(bytes, 0, 256);
+  memcpy(bytes, identifier, sizeof(identifier));
+  _test_Grr_writeU32LE(bytes + 12, VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+  _test_Grr_writeU32LE(bytes + 16, 1); // typeSize
+  _test_Grr_writeU32LE(bytes + 20, 8); // pixelWidth
+  _test_Grr_writeU32LE(bytes + 24, 8); // pixelHeight
+  _test_Grr_writeU32LE(bytes + 36, 1); // faceCount
+  _test_Grr_writeU32LE(bytes + 40, 4); // levelCount
+
+  size_t levelBytes[4] = {32, 8, 8, 8};
+  size_t offset = 80 + 4 * 24;
+  for (Grr_i32 i = 3; i >= 0; i--) {
+    _test_Grr_writeU64LE(bytes + 80 + i * 24, offset);
+    _test_Grr_writeU64LE(bytes + 80 + i * 24 + 8, levelBytes[i]);
+    _test_Grr_writeU64LE(bytes + 80 + i * 24 + 16, levelBytes[i]);
+    memset(bytes + offset, 0x10 + i, levelBytes[i]);
+    offset += levelBytes[i];
+  }
+  return offset;
+}
+
+void test_Grr_parseKTX2() {
+  Grr_byte bytes[256];
+  size_t nBytes = _test_Grr_buildKTX2(bytes);
+
+  GrrImageKTX2 image;
+  assert(Grr_parseKTX2(bytes, nBytes, &image));
+  assert(image.format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+  assert(image.width == 8 && image.height == 8);
+  assert(image.levelCount == 4);
+  assert(image.levels[0].nBytes == 32);
+  for (Grr_u32 i = 0; i < 4; i++)
+    assert(bytes[image.levels[i].offset] == 0x10 + i);
+
+  Grr_u32 blockWidth, blockHeight, blockBytes;
+  assert(Grr_formatBlockInfo(VK_FORMAT_ASTC_6x5_SRGB_BLOCK, &blockWidth,
+                             &blockHeight, &blockBytes));
+  assert(blockWidth == 6 && blockHeight == 5 && blockBytes == 16);
+  assert(!Grr_formatBlockInfo(VK_FORMAT_R32G32B32_SFLOAT, &blockWidth,
+                              &blockHeight, &blockBytes));
+
+  // Truncated level data
+  assert(!Grr_parseKTX2(bytes, nBytes - 1, &image));
+
+  // Level size not matching the format
+  _test_Grr_writeU32LE(bytes + 12, VK_FORMAT_BC7_SRGB_BLOCK);
+  assert(!Grr_parseKTX2(bytes, nBytes, &image));
+  _test_Grr_writeU32LE(bytes + 12, VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+
+  // More levels than the base level allows
+  _test_Grr_writeU32LE(bytes + 40, 5);
+  assert(!Grr_parseKTX2(bytes, nBytes, &image));
+  _test_Grr_writeU32LE(bytes + 40, 4);
+
+  // Supercompressed
+  _test_Grr_writeU32LE(bytes + 44, 2);
+  assert(!Grr_parseKTX2(bytes, nBytes, &image));
+  _test_Grr_writeU32LE(bytes + 44, 0);
+
+  bytes[1] = 'k';
+  assert(!Grr_parseKTX2(bytes, nBytes, &image));
+
+  GRR_LOG_INFO("PASSED test_Grr_parseKTX2\n");
+}
+
+void test_Grr_writeKTX2() {
+  // 8x8 BC1 texture with 4 levels, read back with the parser
+  Grr_byte levels[4][32];
+  const Grr_byte *levelData[4];
+  size_t levelBytes[4] = {32, 8, 8, 8};
+  for (Grr_u32 i = 0; i < 4; i++) {
+    memset(levels[i], 0x10 + i, sizeof(levels[i]));
+    levelData[i] = levels[i];
+  }
+
+  const Grr_string path = "./tests/test_writeKTX2.ktx2";
+  assert(Grr_writeKTX2(path, VK_FORMAT_BC1_RGB_SRGB_BLOCK, 8, 8, 4, levelData,
+                       levelBytes));
+  GrrImageKTX2 image;
+  assert(Grr_loadKTX2(path, &image));
+  assert(image.format == VK_FORMAT_BC1_RGB_SRGB_BLOCK);
+  assert(image.width == 8 && image.height == 8 && image.levelCount == 4);
+  for (Grr_u32 i = 0; i < 4; i++) {
+    assert(image.levels[i].nBytes == levelBytes[i]);
+    assert(image.levels[i].offset % 16 == 0);
+    assert(0 == memcmp(image.bytes + image.levels[i].offset, levels[i],
+                       levelBytes[i]));
+  }
+  // Smallest level first
+  assert(image.levels[3].offset < image.levels[0].offset);
+  Grr_freeKTX2(&image);
+  remove(path);
+
+  // Formats without a descriptor
+  assert(!Grr_writeKTX2(path, VK_FORMAT_R32G32B32_SFLOAT, 8, 8, 1, levelData,
+                        levelBytes));
+
+  GRR_LOG_INFO("PASSED test_Grr_writeKTX2\n");
+}
+
+void test_Grr_modelFromAsset() {
+  // 3 vertices interleaving a position, a normal and texture coordinates
+  Grr_f32 vertices[3][8];
+  for (Grr_u32 i = 0; i < 3; i++) {
+    for (Grr_u32 c = 0; c < 8; c++)
+      vertices[i][c] = (Grr_f32)(i * 10 + c);
+  }
+  Grr_byte *buffers[1] = {(Grr_byte *)vertices};
+  size_t bufferSizes[1] = {sizeof(vertices)};
+  GrrBufferView bufferView = {0, sizeof(vertices), 0, sizeof(vertices[0]), 0};
+  GrrAccessor accessors[4] = {
+      {0, 0, 3, ELEMENT_TYPE_VEC3, COMPONENT_TYPE_FLOAT, NULL},
+      {0, 12, 3, ELEMENT_TYPE_VEC3, COMPONENT_TYPE_FLOAT, NULL},
+      {0, 24, 3, ELEMENT_TYPE_VEC2, COMPONENT_TYPE_FLOAT, NULL},
+      {0, 24, 2, ELEMENT_TYPE_VEC2, COMPONENT_TYPE_FLOAT, NULL}};
+  GrrMeshPrimitive primitive = {0, 1, -1, 2, -1};
+  GrrMesh mesh = {1, &primitive};
+  GrrAssetglTF glTF = {buffers,   bufferSizes, 1, &bufferView,
+                       accessors, &mesh,       0};
+
+  GrrModel model = {0};
+  Grr_modelFromAsset(&model, &glTF, 0, 0);
+  assert(model.vertexCount == 3);
+  assert(NULL == model.tangents);
+  for (Grr_u32 i = 0; i < 3; i++) {
+    for (Grr_u32 c = 0; c < 3; c++) {
+      assert(model.positions[i * 3 + c] == vertices[i][c]);
+      assert(model.normals[i * 3 + c] == vertices[i][3 + c]);
+    }
+    assert(model.textureCoordinates[i * 2] == vertices[i][6]);
+    assert(model.textureCoordinates[i * 2 + 1] == vertices[i][7]);
+  }
+  Grr_freeModel(&model);
+  assert(NULL == model.positions && model.vertexCount == 3);
+
+  // Tightly packed attributes are copied too
+  bufferView.stride = -1;
+  Grr_modelFromAsset(&model, &glTF, 0, 0);
+  assert((Grr_byte *)model.positions != buffers[0]);
+  assert(0 == memcmp(model.positions, vertices, sizeof(Grr_f32) * 9));
+  Grr_freeModel(&model);
+  bufferView.stride = sizeof(vertices[0]);
+
+  // Fewer texture coordinates than vertices
+  primitive.textureCoordinatesAccessorIndex = 3;
+  Grr_modelFromAsset(&model, &glTF, 0, 0);
+  assert(NULL == model.textureCoordinates);
+  Grr_freeModel(&model);
+
+  // Positions past the end of their buffer view
+  bufferView.nBytes = sizeof(vertices[0]) * 2 + 8;
+  Grr_modelFromAsset(&model, &glTF, 0, 0);
+  assert(NULL == model.positions && model.vertexCount == 0);
+
+  GRR_LOG_INFO("PASSED test_Grr_modelFromAsset\n");
+}
+
+// glTF of a 16 byte buffer whose first 8 bytes are a view compressed in the
+// last 8, with meshopt the properties of EXT_meshopt_compression
+Grr_bool _test_Grr_glTFLoadMeshopt(const char *buffer, const char *meshopt) {
+  FILE *file = fopen("./tests/test_meshopt.gltf", "w");
+  assert(NULL != file);
+  fprintf(file,
+          "{\"buffers\": [{\"uri\": \"test_meshopt.bin\", \"byteLength\": 16"
+          "%s}], \"bufferViews\": [{\"buffer\": 0, \"byteLength\": 8, "
+          "\"extensions\": {\"EXT_meshopt_compression\": {%s}}}], "
+          "\"accessors\": [], \"meshes\": []}",
+          buffer, meshopt);
+  fclose(file);
+  GrrAssetglTF *glTF = Grr_glTFLoad("./tests/test_meshopt.gltf");
+  if (NULL == glTF)
+    return false;
+  for (Grr_u32 i = 0; i < 16; i++)
+    assert(glTF->buffers[0][i] == i);
+  return true;
+}
+
+void test_Grr_glTFDecodeCompressedBufferViews() {
+  Grr_byte bytes[16];
+  for (Grr_u32 i = 0; i < 16; i++)
+    bytes[i] = (Grr_byte)i;
+  FILE *file = fopen("./tests/test_meshopt.bin", "wb");
+  assert(NULL != file);
+  fwrite(bytes, 1, sizeof(bytes), file);
+  fclose(file);
+
+  // Unknown filters keep the uncompressed data
+  assert(_test_Grr_glTFLoadMeshopt(
+      "", "\"buffer\": 0, \"byteOffset\": 8, \"byteLength\": 8, "
+          "\"byteStride\": 4, \"count\": 2, \"mode\": \"ATTRIBUTES\", "
+          "\"filter\": \"NEW\""));
+  // Unless there is none
+  assert(!_test_Grr_glTFLoadMeshopt(
+      ", \"extensions\": {\"EXT_meshopt_compression\": {\"fallback\": true}}",
+      "\"buffer\": 0, \"byteOffset\": 8, \"byteLength\": 8, \"byteStride\": "
+      "4, \"count\": 2, \"mode\": \"NEW\""));
+  // Compressed data past the end of the buffer
+  assert(!_test_Grr_glTFLoadMeshopt(
+      "", "\"buffer\": 0, \"byteOffset\": 12, \"byteLength\": 8, "
+          "\"byteStride\": 4, \"count\": 2, \"mode\": \"ATTRIBUTES\""));
+  assert(!_test_Grr_glTFLoadMeshopt(
+      "", "\"buffer\": 1, \"byteLength\": 8, \"byteStride\": 4, \"count\": 2, "
+          "\"mode\": \"ATTRIBUTES\""));
+  // Missing count
+  assert(!_test_Grr_glTFLoadMeshopt(
+      "", "\"buffer\": 0, \"byteOffset\": 8, \"byteLength\": 8, "
+          "\"byteStride\": 4, \"mode\": \"ATTRIBUTES\""));
+
+  remove("./tests/test_meshopt.gltf");
+  remove("./tests/test_meshopt.bin");
+
+  GRR_LOG_INFO("PASSED test_Grr_glTFDecodeCompressedBufferViews\n");
+}
@@ -0,0 +1,13 @@
+#ifndef GRR_TEST_ASSETS_H
+#define GRR_TEST_ASSETS_H
+
+#include "assets.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_glTFDecodeCompressedBufferViews();
+void test_Grr_modelFromAsset();
+void test_Grr_parseKTX2();
+void test_Grr_writeKTX2();
+
+#endif
@@ -0,0 +1,32 @@
+#include "test_bindless.h"
+
+void test_Grr_allocateIndex() {
+  GrrIndexAllocator allocator;
+  assert(Grr_initializeIndexAllocator(&allocator, 3));
+
+  // Never used IDs in order, until all are in use
+  assert(Grr_allocateIndex(&allocator) == 0);
+  assert(Grr_allocateIndex(&allocator) == 1);
+  assert(Grr_allocateIndex(&allocator) == 2);
+  assert(Grr_allocateIndex(&allocator) == GRR_BINDLESS_INVALID);
+
+  // Released IDs wait for the frame they were released in to complete
+  Grr_releaseIndex(&allocator, 1, 5);
+  Grr_releaseIndex(&allocator, 0, 6);
+  Grr_recycleIndices(&allocator, 4);
+  assert(Grr_allocateIndex(&allocator) == GRR_BINDLESS_INVALID);
+  Grr_recycleIndices(&allocator, 5);
+  assert(Grr_allocateIndex(&allocator) == 1);
+  assert(Grr_allocateIndex(&allocator) == GRR_BINDLESS_INVALID);
+  Grr_recycleIndices(&allocator, 6);
+  assert(Grr_allocateIndex(&allocator) == 0);
+  assert(allocator.retiredCount == 0);
+
+  // IDs that were never handed out are ignored
+  Grr_releaseIndex(&allocator, GRR_BINDLESS_INVALID, 7);
+  assert(allocator.retiredCount == 0);
+
+  Grr_destroyIndexAllocator(&allocator);
+
+  GRR_LOG_INFO("PASSED test_Grr_allocateIndex\n");
+}
@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_BINDLESS_H
+#define GRR_TEST_BINDLESS_H
+
+#include "bindless.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_allocateIndex();
+
+#endif
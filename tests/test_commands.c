@@ -0,0 +1,46 @@
+#include "test_commands.h"
+
+void test_Grr_recordingSlice() {
+  // Slices are contiguous, cover every item once and differ by at most one
+  Grr_u32 counts[] = {1, 7, 64, 1000, 1023};
+  Grr_u32 sliceCounts[] = {1, 2, 3, 8};
+  for (Grr_u32 c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+    for (Grr_u32 s = 0; s < sizeof(sliceCounts) / sizeof(sliceCounts[0]);
+         s++) {
+      Grr_u32 next = 0;
+      for (Grr_u32 i = 0; i < sliceCounts[s]; i++) {
+        Grr_u32 first, items;
+        Grr_recordingSlice(counts[c], sliceCounts[s], i, &first, &items);
+        assert(first == next);
+        assert(items == counts[c] / sliceCounts[s] ||
+               items == counts[c] / sliceCounts[s] + 1);
+        next = first + items;
+      }
+      assert(next == counts[c]);
+    }
+  }
+
+  GRR_LOG_INFO("PASSED test_Grr_recordingSlice\n");
+}
+
+void test_Grr_recordingSliceCount() {
+  // Small lists are recorded inline
+  assert(Grr_recordingSliceCount(0) == 1);
+  assert(Grr_recordingSliceCount(GRR_MIN_ITEMS_PER_SLICE - 1) == 1);
+
+  // At most one slice per recording thread
+  Grr_u32 threadCount = Grr_jobThreadCount();
+  assert(Grr_recordingThreadCount() == threadCount);
+  assert(Grr_recordingSliceCount(GRR_MIN_ITEMS_PER_SLICE * 1000) ==
+         threadCount);
+  Grr_setRecordingThreadCount(1);
+  assert(Grr_recordingSliceCount(GRR_MIN_ITEMS_PER_SLICE * 1000) == 1);
+  Grr_setRecordingThreadCount(threadCount + 10);
+  assert(Grr_recordingThreadCount() == threadCount);
+  Grr_setRecordingThreadCount(0);
+  if (threadCount > 1) {
+    assert(Grr_recordingSliceCount(GRR_MIN_ITEMS_PER_SLICE * 2) == 2);
+  }
+
+  GRR_LOG_INFO("PASSED test_Grr_recordingSliceCount\n");
+}
@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_COMMANDS_H
+#define GRR_TEST_COMMANDS_H
+
+#include "commands.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_recordingSlice();
+void test_Grr_recordingSliceCount();
+
+#endif
@@ -0,0 +1,73 @@
+#include "test_compute.h"
+
+void test_Grr_uniqueQueueFamilies() {
+  Grr_u32 unique[5];
+  assert(Grr_uniqueQueueFamilies(NULL, 0, unique) == 0);
+
+  // Missing families (-1) are skipped, the first occurrence is kept
+  Grr_u32 families[] = {2, -1, 0, 2, 1};
+  assert(Grr_uniqueQueueFamilies(families, 5, unique) == 3);
+  assert(unique[0] == 2);
+  assert(unique[1] == 0);
+  assert(unique[2] == 1);
+
+  Grr_u32 same[] = {0, 0, 0};
+  assert(Grr_uniqueQueueFamilies(same, 3, unique) == 1);
+  assert(unique[0] == 0);
+
+  GRR_LOG_INFO("PASSED test_Grr_uniqueQueueFamilies\n");
+}
+
+void test_Grr_queueTransferBarriers() {
+  GrrQueueTransfer transfers[3] = {0};
+  transfers[0].image = (VkImage)0x10;
+  transfers[0].layout = VK_IMAGE_LAYOUT_GENERAL;
+  transfers[0].dstAccess = VK_ACCESS_SHADER_READ_BIT;
+  transfers[1].buffer = (VkBuffer)0x20;
+  transfers[1].srcAccess = VK_ACCESS_SHADER_WRITE_BIT;
+  transfers[1].dstAccess = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+  transfers[2].buffer = (VkBuffer)0x30;
+  transfers[2].srcAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+  transfers[2].dstAccess = VK_ACCESS_SHADER_READ_BIT;
+
+  VkBufferMemoryBarrier buffers[3];
+  VkImageMemoryBarrier images[3];
+  Grr_u32 bufferCount;
+  Grr_u32 imageCount;
+
+  // The release only makes writes available
+  Grr_queueTransferBarriers(transfers, 3, 0, 2, false, buffers, &bufferCount,
+                            images, &imageCount);
+  assert(bufferCount == 2);
+  assert(imageCount == 1);
+  assert(buffers[0].buffer == transfers[1].buffer);
+  assert(buffers[0].srcAccessMask == VK_ACCESS_SHADER_WRITE_BIT);
+  assert(buffers[0].dstAccessMask == 0);
+  assert(buffers[0].srcQueueFamilyIndex == 0);
+  assert(buffers[0].dstQueueFamilyIndex == 2);
+  assert(buffers[0].size == VK_WHOLE_SIZE);
+  assert(buffers[1].buffer == transfers[2].buffer);
+  assert(buffers[1].srcAccessMask == VK_ACCESS_TRANSFER_WRITE_BIT);
+
+  // Images keep their layout, every level and layer
+  assert(images[0].image == transfers[0].image);
+  assert(images[0].oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+  assert(images[0].newLayout == VK_IMAGE_LAYOUT_GENERAL);
+  assert(images[0].srcAccessMask == 0);
+  assert(images[0].subresourceRange.levelCount == VK_REMAINING_MIP_LEVELS);
+  assert(images[0].subresourceRange.layerCount == VK_REMAINING_ARRAY_LAYERS);
+
+  // The acquire makes them visible, with the same families
+  Grr_queueTransferBarriers(transfers, 3, 0, 2, true, buffers, &bufferCount,
+                            images, &imageCount);
+  assert(bufferCount == 2);
+  assert(imageCount == 1);
+  assert(buffers[0].srcAccessMask == 0);
+  assert(buffers[0].dstAccessMask == VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+  assert(buffers[0].srcQueueFamilyIndex == 0);
+  assert(buffers[0].dstQueueFamilyIndex == 2);
+  assert(images[0].srcAccessMask == 0);
+  assert(images[0].dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+
+  GRR_LOG_INFO("PASSED test_Grr_queueTransferBarriers\n");
+}
@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_COMPUTE_H
+#define GRR_TEST_COMPUTE_H
+
+#include "compute.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_uniqueQueueFamilies();
+void test_Grr_queueTransferBarriers();
+
+#endif
@@ -0,0 +1,152 @@
+#include "test_culling.h"
+
+// Clip volume of an identity view-projection: [-1, 1] x [-1, 1] x [0, 1]
+void _test_Grr_identityPlanes(GrrVector4 planes[6]) {
+  GrrMatrix4x4 identity;
+  Grr_identityMatrix(&identity);
+  Grr_frustumPlanes(&identity, planes);
+}
+
+void _test_Grr_setSphere(GrrBoundingSpheres *spheres, Grr_u32 i, Grr_f32 x,
+                         Grr_f32 y, Grr_f32 z, Grr_f32 radius) {
+  spheres->x[i] = x;
+  spheres->y[i] = y;
+  spheres->z[i] = z;
+  spheres->radius[i] = radius;
+}
+
+void test_Grr_cullSpheres() {
+  GrrVector4 planes[6];
+  _test_Grr_identityPlanes(planes);
+
+  // 11 spheres: vector groups of 8 and the scalar tail are both used
+  GrrBoundingSpheres spheres = {0};
+  assert(Grr_resizeBoundingSpheres(&spheres, 11));
+  _test_Grr_setSphere(&spheres, 0, 0.0f, 0.0f, 0.5f, 0.1f);  // Inside
+  _test_Grr_setSphere(&spheres, 1, 3.0f, 0.0f, 0.5f, 1.0f);  // Right
+  _test_Grr_setSphere(&spheres, 2, 1.5f, 0.0f, 0.5f, 1.0f);  // Crosses right
+  _test_Grr_setSphere(&spheres, 3, 0.0f, -2.0f, 0.5f, 0.5f); // Below
+  _test_Grr_setSphere(&spheres, 4, 0.0f, 0.0f, -0.5f, 0.6f); // Crosses near
+  _test_Grr_setSphere(&spheres, 5, 0.0f, 0.0f, -0.5f, 0.4f); // Before near
+  _test_Grr_setSphere(&spheres, 6, 0.0f, 0.0f, 2.0f, 0.5f);  // Beyond far
+  _test_Grr_setSphere(&spheres, 7, -1.0f, 1.0f, 1.0f, 0.0f); // On a corner
+  _test_Grr_setSphere(&spheres, 8, 0.5f, 0.5f, 0.5f, 0.0f);  // Point inside
+  _test_Grr_setSphere(&spheres, 9, -5.0f, 0.0f, 0.5f, 1.0f); // Left
+  _test_Grr_setSphere(&spheres, 10, 0.0f, 0.0f, 0.5f, 100.0f); // Contains
+
+  Grr_u32 visible[11];
+  const Grr_u32 expected[] = {0, 2, 4, 7, 8, 10};
+  Grr_u32 visibleCount = Grr_cullSpheres(planes, &spheres, 0, 11, visible);
+  assert(visibleCount == sizeof(expected) / sizeof(expected[0]));
+  for (Grr_u32 i = 0; i < visibleCount; i++)
+    assert(visible[i] == expected[i]);
+
+  // Sub ranges keep the indices of the whole set
+  visibleCount = Grr_cullSpheres(planes, &spheres, 3, 6, visible);
+  assert(visibleCount == 3);
+  assert(visible[0] == 4 && visible[1] == 7 && visible[2] == 8);
+  assert(Grr_cullSpheres(planes, &spheres, 5, 0, visible) == 0);
+
+  // Growing keeps the existing volumes
+  assert(Grr_resizeBoundingSpheres(&spheres, 100));
+  assert(spheres.count == 100 && spheres.capacity >= 100);
+  assert(spheres.x[1] == 3.0f && spheres.radius[10] == 100.0f);
+  Grr_destroyBoundingSpheres(&spheres);
+  assert(spheres.x == NULL && spheres.count == 0);
+
+  GRR_LOG_INFO("PASSED test_Grr_cullSpheres\n");
+}
+
+void test_Grr_cullBoxes() {
+  GrrVector4 planes[6];
+  _test_Grr_identityPlanes(planes);
+
+  // Diagonal plane x + y <= 1: boxes use their corner farthest along it
+  GrrVector4 diagonal = {-0.70710678f, -0.70710678f, 0.0f, 0.70710678f};
+  planes[1] = diagonal;
+
+  GrrBoundingBoxes boxes = {0};
+  assert(Grr_resizeBoundingBoxes(&boxes, 6));
+  const Grr_f32 centers[6][3] = {{0.0f, 0.0f, 0.5f},   {1.2f, 0.2f, 0.5f},
+                                 {1.0f, 1.0f, 0.5f},   {0.8f, 0.8f, 0.5f},
+                                 {0.0f, 0.0f, -0.2f},  {0.0f, 3.0f, 0.5f}};
+  const Grr_f32 extents[6][3] = {{0.1f, 0.1f, 0.1f},   {0.35f, 0.1f, 0.1f},
+                                 {0.05f, 0.05f, 0.1f}, {0.35f, 0.35f, 0.1f},
+                                 {1.0f, 1.0f, 0.25f},  {5.0f, 1.0f, 0.1f}};
+  for (Grr_u32 i = 0; i < 6; i++) {
+    boxes.centerX[i] = centers[i][0];
+    boxes.centerY[i] = centers[i][1];
+    boxes.centerZ[i] = centers[i][2];
+    boxes.extentX[i] = extents[i][0];
+    boxes.extentY[i] = extents[i][1];
+    boxes.extentZ[i] = extents[i][2];
+  }
+
+  // 1 and 3 have a corner past the diagonal, 2 is beyond it, 4 crosses the
+  // near plane and 5 is above the frustum
+  Grr_u32 visible[6];
+  const Grr_u32 expected[] = {0, 1, 3, 4};
+  Grr_u32 visibleCount = Grr_cullBoxes(planes, &boxes, 0, 6, visible);
+  assert(visibleCount == sizeof(expected) / sizeof(expected[0]));
+  for (Grr_u32 i = 0; i < visibleCount; i++)
+    assert(visible[i] == expected[i]);
+
+  visibleCount = Grr_cullBoxes(planes, &boxes, 1, 4, visible);
+  assert(visibleCount == 3);
+  assert(visible[0] == 1 && visible[1] == 3 && visible[2] == 4);
+  Grr_destroyBoundingBoxes(&boxes);
+
+  GRR_LOG_INFO("PASSED test_Grr_cullBoxes\n");
+}
+
+void test_Grr_cullParallel() {
+  GrrVector4 planes[6];
+  _test_Grr_identityPlanes(planes);
+
+  // Enough volumes for every job thread, and not a multiple of a chunk
+  Grr_u32 count = GRR_CULL_MIN_ITEMS_PER_JOB * 9 + 5;
+  GrrBoundingSpheres spheres = {0};
+  GrrBoundingBoxes boxes = {0};
+  assert(Grr_resizeBoundingSpheres(&spheres, count));
+  assert(Grr_resizeBoundingBoxes(&boxes, count));
+  Grr_u32 seed = 1;
+  for (Grr_u32 i = 0; i < count; i++) {
+    Grr_f32 random[4];
+    for (Grr_u32 j = 0; j < 4; j++) {
+      seed = seed * 1664525 + 1013904223;
+      random[j] = (Grr_f32)(seed >> 8) / (Grr_f32)(1 << 24);
+    }
+    _test_Grr_setSphere(&spheres, i, random[0] * 6.0f - 3.0f,
+                        random[1] * 6.0f - 3.0f, random[2] * 3.0f - 1.0f,
+                        random[3] * 0.5f);
+    boxes.centerX[i] = spheres.x[i];
+    boxes.centerY[i] = spheres.y[i];
+    boxes.centerZ[i] = spheres.z[i];
+    boxes.extentX[i] = spheres.radius[i];
+    boxes.extentY[i] = spheres.radius[i] * 0.5f;
+    boxes.extentZ[i] = spheres.radius[i] * 0.25f;
+  }
+
+  Grr_u32 *serial = (Grr_u32 *)malloc(sizeof(Grr_u32) * count);
+  Grr_u32 *parallel = (Grr_u32 *)malloc(sizeof(Grr_u32) * count);
+  assert(serial != NULL && parallel != NULL);
+
+  Grr_u32 serialCount = Grr_cullSpheres(planes, &spheres, 0, count, serial);
+  Grr_u32 parallelCount = Grr_cullSpheresParallel(planes, &spheres, parallel);
+  assert(serialCount > 0 && serialCount < count);
+  assert(parallelCount == serialCount);
+  assert(memcmp(serial, parallel, sizeof(Grr_u32) * serialCount) == 0);
+
+  serialCount = Grr_cullBoxes(planes, &boxes, 0, count, serial);
+  parallelCount = Grr_cullBoxesParallel(planes, &boxes, parallel);
+  assert(serialCount > 0 && serialCount < count);
+  assert(parallelCount == serialCount);
+  assert(memcmp(serial, parallel, sizeof(Grr_u32) * serialCount) == 0);
+
+  free(serial);
+  free(parallel);
+  Grr_destroyBoundingSpheres(&spheres);
+  Grr_destroyBoundingBoxes(&boxes);
+
+  GRR_LOG_INFO("PASSED test_Grr_cullParallel\n");
+}
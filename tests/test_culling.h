@@ -0,0 +1,12 @@
+#ifndef GRR_TEST_CULLING_H
+#define GRR_TEST_CULLING_H
+
+#include "culling.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_cullSpheres();
+void test_Grr_cullBoxes();
+void test_Grr_cullParallel();
+
+#endif
@@ -0,0 +1,68 @@
+#include "test_deletion.h"
+
+void test_Grr_completedDeletions() {
+  GrrDeletionQueue queue = {0};
+  assert(Grr_completedDeletions(&queue, 10) == 0);
+
+  // Enough deletions to grow the queue, queued by frames 1 to 100
+  for (Grr_u64 frame = 1; frame <= 100; frame++) {
+    GrrDeletion deletion = {0};
+    deletion.type = GRR_DELETION_IMAGE_VIEW;
+    deletion.frame = frame;
+    assert(Grr_pushDeletion(&queue, &deletion));
+  }
+  assert(queue.count == 100);
+  assert(queue.capacity >= 100);
+
+  // Only the deletions of complete frames, from the oldest
+  assert(Grr_completedDeletions(&queue, 0) == 0);
+  assert(Grr_completedDeletions(&queue, 3) == 3);
+  Grr_popDeletions(&queue, 3);
+  assert(queue.count == 97);
+  assert(queue.deletions[0].frame == 4);
+  assert(Grr_completedDeletions(&queue, 3) == 0);
+
+  // Deletions of the same frame complete together
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_SWAPCHAIN;
+  deletion.frame = 100;
+  assert(Grr_pushDeletion(&queue, &deletion));
+  assert(Grr_completedDeletions(&queue, 99) == 96);
+  assert(Grr_completedDeletions(&queue, 100) == 98);
+  Grr_popDeletions(&queue, 98);
+  assert(queue.count == 0);
+  Grr_popDeletions(&queue, 0);
+  assert(queue.count == 0);
+
+  Grr_destroyDeletionQueue(&queue);
+  assert(queue.deletions == NULL && queue.capacity == 0);
+
+  GRR_LOG_INFO("PASSED test_Grr_completedDeletions\n");
+}
+
+void test_Grr_pushDeletion() {
+  GrrDeletionQueue queue = {0};
+
+  // Deletions of older frames are inserted in order, after those of the same
+  // frame
+  for (Grr_u64 frame = 1; frame <= 5; frame++) {
+    GrrDeletion deletion = {0};
+    deletion.type = GRR_DELETION_BUFFER;
+    deletion.frame = frame;
+    assert(Grr_pushDeletion(&queue, &deletion));
+  }
+  GrrDeletion deletion = {0};
+  deletion.type = GRR_DELETION_MEMORY;
+  deletion.frame = 2;
+  assert(Grr_pushDeletion(&queue, &deletion));
+  assert(queue.count == 6);
+  for (Grr_u32 i = 1; i < queue.count; i++)
+    assert(queue.deletions[i - 1].frame <= queue.deletions[i].frame);
+  assert(queue.deletions[1].type == GRR_DELETION_BUFFER);
+  assert(queue.deletions[2].type == GRR_DELETION_MEMORY);
+  assert(Grr_completedDeletions(&queue, 2) == 3);
+
+  Grr_destroyDeletionQueue(&queue);
+
+  GRR_LOG_INFO("PASSED test_Grr_pushDeletion\n");
+}
@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_DELETION_H
+#define GRR_TEST_DELETION_H
+
+#include "deletion.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_completedDeletions();
+void test_Grr_pushDeletion();
+
+#endif
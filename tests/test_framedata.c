@@ -0,0 +1,31 @@
+#include "test_framedata.h"
+
+void test_Grr_frameAllocate() {
+  Grr_byte region[1024];
+  GrrFrameAllocator allocator = {0};
+  allocator.base = 4096; // Second frame of a buffer
+  allocator.size = sizeof(region);
+  allocator.alignment = 256;
+  allocator.mapped = region;
+
+  // Allocations are aligned relative to the buffer, mapped pointers match
+  VkDeviceSize a, b, c, d;
+  Grr_byte *pa = (Grr_byte *)Grr_frameAllocate(&allocator, 192, &a);
+  Grr_byte *pb = (Grr_byte *)Grr_frameAllocate(&allocator, 4, &b);
+  assert(pa == region && a == 4096);
+  assert(pb == region + 256 && b == 4096 + 256);
+
+  // Full region
+  assert(Grr_frameAllocate(&allocator, 512, &c) == region + 512);
+  assert(c == 4096 + 512);
+  assert(Grr_frameAllocate(&allocator, 1, &d) == NULL);
+  assert(allocator.head == 1024);
+
+  // Rewound for the next use of the frame, offsets repeat
+  allocator.head = 0;
+  assert(Grr_frameAllocate(&allocator, 1024, &d) == region && d == a);
+  allocator.head = 0;
+  assert(Grr_frameAllocate(&allocator, 1025, &d) == NULL);
+
+  GRR_LOG_INFO("PASSED test_Grr_frameAllocate\n");
+}
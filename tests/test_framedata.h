@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_FRAMEDATA_H
+#define GRR_TEST_FRAMEDATA_H
+
+#include "framedata.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_frameAllocate();
+
+#endif
@@ -0,0 +1,77 @@
+#include "test_gpumemory.h"
+
+void test_Grr_buddyAllocate() {
+  GrrBuddyAllocator buddy;
+  assert(!Grr_initializeBuddyAllocator(&buddy, 1000, 16));
+  assert(Grr_initializeBuddyAllocator(&buddy, 1024, 16));
+  assert(Grr_buddyLargestFree(&buddy) == 1024);
+
+  // Sizes round up to powers of two (at least minSize), ranges are aligned
+  VkDeviceSize a, b, c, d;
+  assert(Grr_buddyAllocate(&buddy, 100, 4, &a));  // 128
+  assert(Grr_buddyAllocate(&buddy, 1, 1, &b));    // 16
+  assert(Grr_buddyAllocate(&buddy, 16, 256, &c)); // 256 for the alignment
+  assert(a == 0 && b == 128 && c == 256);
+  assert(c % 256 == 0);
+  assert(buddy.allocatedBytes == 128 + 16 + 256);
+  assert(Grr_buddyLargestFree(&buddy) == 512);
+
+  // Too large for any free range
+  assert(!Grr_buddyAllocate(&buddy, 513, 1, &d));
+  assert(!Grr_buddyAllocate(&buddy, 2048, 1, &d));
+  assert(Grr_buddyAllocate(&buddy, 512, 1, &d) && d == 512);
+  assert(Grr_buddyLargestFree(&buddy) == 64);
+
+  // Freeing merges buddies back
+  assert(Grr_buddyFree(&buddy, d) == 512);
+  assert(Grr_buddyFree(&buddy, b) == 16);
+  assert(Grr_buddyFree(&buddy, a) == 128);
+  assert(Grr_buddyLargestFree(&buddy) == 512);
+  assert(Grr_buddyFree(&buddy, c) == 256);
+  assert(Grr_buddyLargestFree(&buddy) == 1024);
+  assert(buddy.allocatedBytes == 0);
+
+  // Fill with minimum ranges, free every other one: nothing merges
+  VkDeviceSize offsets[64];
+  for (Grr_u32 i = 0; i < 64; i++) {
+    assert(Grr_buddyAllocate(&buddy, 16, 16, &offsets[i]));
+    assert(offsets[i] == i * 16);
+  }
+  assert(Grr_buddyLargestFree(&buddy) == 0);
+  assert(!Grr_buddyAllocate(&buddy, 1, 1, &d));
+  for (Grr_u32 i = 0; i < 64; i += 2)
+    Grr_buddyFree(&buddy, offsets[i]);
+  assert(Grr_buddyLargestFree(&buddy) == 16);
+  assert(!Grr_buddyAllocate(&buddy, 32, 1, &d));
+  for (Grr_u32 i = 1; i < 64; i += 2)
+    Grr_buddyFree(&buddy, offsets[i]);
+  assert(Grr_buddyLargestFree(&buddy) == 1024);
+
+  Grr_destroyBuddyAllocator(&buddy);
+  GRR_LOG_INFO("PASSED test_Grr_buddyAllocate\n");
+}
+
+void test_Grr_linearAllocate() {
+  GrrLinearAllocator linear;
+  Grr_initializeLinearAllocator(&linear, 4096, 1024);
+
+  VkDeviceSize a, b, c, d;
+  assert(Grr_linearAllocate(&linear, 100, 16, false, &a) && a == 0);
+  assert(Grr_linearAllocate(&linear, 100, 16, false, &b) && b == 112);
+  // An image after a buffer starts on the next granularity page
+  assert(Grr_linearAllocate(&linear, 100, 16, true, &c) && c == 1024);
+  assert(Grr_linearAllocate(&linear, 100, 4, true, &d) && d == 1124);
+  assert(Grr_linearAllocate(&linear, 10, 1, false, &d) && d == 2048);
+  assert(!Grr_linearAllocate(&linear, 4096, 1, false, &d));
+
+  // Rewinds once every allocation is freed
+  for (Grr_u32 i = 0; i < 4; i++)
+    Grr_linearFree(&linear);
+  assert(linear.head == 2058);
+  Grr_linearFree(&linear);
+  assert(linear.head == 0 && linear.allocationCount == 0);
+  assert(Grr_linearAllocate(&linear, 4096, 1, true, &d) && d == 0);
+  Grr_linearFree(&linear);
+
+  GRR_LOG_INFO("PASSED test_Grr_linearAllocate\n");
+}
@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_GPUMEMORY_H
+#define GRR_TEST_GPUMEMORY_H
+
+#include "gpumemory.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_buddyAllocate();
+void test_Grr_linearAllocate();
+
+#endif
@@ -0,0 +1,22 @@
+#include "test_hiz.h"
+
+void test_Grr_hiZPyramidSize() {
+  Grr_u32 width, height;
+
+  // Largest powers of two that fit, down to 1x1
+  assert(Grr_hiZPyramidSize(1920, 1080, &width, &height) == 11);
+  assert(width == 1024 && height == 1024);
+  assert(Grr_hiZPyramidSize(1024, 768, &width, &height) == 11);
+  assert(width == 1024 && height == 512);
+  assert(Grr_hiZPyramidSize(256, 255, &width, &height) == 9);
+  assert(width == 256 && height == 128);
+  assert(Grr_hiZPyramidSize(1, 1, &width, &height) == 1);
+  assert(width == 1 && height == 1);
+  assert(Grr_hiZPyramidSize(3, 100, &width, &height) == 7);
+  assert(width == 2 && height == 64);
+
+  assert(Grr_hiZPyramidSize(0, 600, &width, &height) == 0);
+  assert(width == 0 && height == 0);
+
+  GRR_LOG_INFO("PASSED test_Grr_hiZPyramidSize\n");
+}
@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_HIZ_H
+#define GRR_TEST_HIZ_H
+
+#include "hiz.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_hiZPyramidSize();
+
+#endif
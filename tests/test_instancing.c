@@ -0,0 +1,74 @@
+#include "test_instancing.h"
+
+// Instance scaled then translated, tagged by its color
+GrrInstance _test_Grr_instance(Grr_f32 x, Grr_f32 y, Grr_f32 z, Grr_f32 scale,
+                               Grr_f32 tag) {
+  GrrInstance instance = {0};
+  Grr_identityMatrix(&instance.transform);
+  instance.transform.data[0] = scale;
+  instance.transform.data[5] = scale;
+  instance.transform.data[10] = scale;
+  instance.transform.data[12] = x;
+  instance.transform.data[13] = y;
+  instance.transform.data[14] = z;
+  instance.color.x = tag;
+  return instance;
+}
+
+void test_Grr_batchInstances() {
+  // Clip volume of an identity view-projection: [-1, 1] x [-1, 1] x [0, 1]
+  GrrVector4 planes[6];
+  GrrMatrix4x4 identity;
+  Grr_identityMatrix(&identity);
+  Grr_frustumPlanes(&identity, planes);
+
+  GrrInstancedMesh unbounded = {0};
+  GrrInstancedMesh sphere = {0};
+  sphere.boundingSphere.w = 0.5f;
+
+  GrrInstanceQueue queue = {0};
+  GrrInstance first[] = {_test_Grr_instance(0.0f, 0.0f, 0.5f, 1.0f, 1.0f),
+                         _test_Grr_instance(5.0f, 0.0f, 0.5f, 1.0f, 2.0f)};
+  GrrInstance second[] = {_test_Grr_instance(9.0f, 9.0f, 9.0f, 1.0f, 3.0f)};
+  // The scaled sphere reaches into the volume
+  GrrInstance third[] = {_test_Grr_instance(0.5f, 0.0f, 0.5f, 1.0f, 4.0f),
+                         _test_Grr_instance(3.0f, 0.0f, 0.5f, 10.0f, 5.0f)};
+  GrrInstance fourth[] = {_test_Grr_instance(0.0f, 0.0f, 0.5f, 1.0f, 6.0f)};
+  assert(Grr_queueInstances(&queue, 1, &sphere, 0, first, 2));
+  assert(Grr_queueInstances(&queue, 0, &unbounded, 2, second, 1));
+  assert(Grr_queueInstances(&queue, 1, &sphere, 0, third, 2));
+  assert(Grr_queueInstances(&queue, 0, &unbounded, 1, fourth, 1));
+  assert(queue.instanceCount == 6);
+
+  // Sorted by mesh then material, submissions of a pair share a batch
+  assert(Grr_batchInstances(&queue, planes) == 3);
+  assert(queue.visibleCount == 5);
+  const GrrInstanceBatch expected[] = {
+      {0, 1, 0, 1}, {0, 2, 1, 1}, {1, 0, 2, 3}};
+  for (Grr_u32 i = 0; i < 3; i++) {
+    assert(queue.batches[i].mesh == expected[i].mesh);
+    assert(queue.batches[i].material == expected[i].material);
+    assert(queue.batches[i].firstInstance == expected[i].firstInstance);
+    assert(queue.batches[i].instanceCount == expected[i].instanceCount);
+  }
+
+  GrrInstance written[5];
+  const Grr_f32 expectedTags[] = {6.0f, 3.0f, 1.0f, 4.0f, 5.0f};
+  Grr_writeInstances(&queue, written);
+  for (Grr_u32 i = 0; i < 5; i++)
+    assert(written[i].color.x == expectedTags[i]);
+
+  // Written instances leave the queue
+  assert(queue.instanceCount == 0);
+  assert(Grr_batchInstances(&queue, planes) == 0);
+
+  // Without planes nothing is culled
+  assert(Grr_queueInstances(&queue, 1, &sphere, 0, first, 2));
+  assert(Grr_queueInstances(&queue, 1, &sphere, 0, third, 2));
+  assert(Grr_batchInstances(&queue, NULL) == 1);
+  assert(queue.batches[0].instanceCount == 4);
+
+  Grr_destroyInstanceQueue(&queue);
+
+  GRR_LOG_INFO("PASSED test_Grr_batchInstances\n");
+}
@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_INSTANCING_H
+#define GRR_TEST_INSTANCING_H
+
+#include "instancing.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_batchInstances();
+
+#endif
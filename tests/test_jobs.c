@@ -0,0 +1,74 @@
+#include "test_jobs.h"
+
+#define TEST_JOB_COUNT 1000
+
+// Thread indices in use, a per-thread resource never shared
+Grr_u32 testJobThreadsBusy[GRR_MAX_JOB_THREADS + 1];
+
+void _test_Grr_countJob(void *data, Grr_u32 index, Grr_u32 threadIndex) {
+  Grr_u32 *hits = (Grr_u32 *)data;
+  assert(threadIndex < Grr_jobThreadCount());
+  __atomic_add_fetch(&hits[index], 1, __ATOMIC_RELAXED);
+}
+
+typedef struct _TestGrrNestedJob {
+  Grr_u32 *hits;
+  Grr_u32 threadIndex; // Of the outer iteration
+} _TestGrrNestedJob;
+
+void _test_Grr_innerJob(void *data, Grr_u32 index, Grr_u32 threadIndex) {
+  _TestGrrNestedJob *job = (_TestGrrNestedJob *)data;
+  assert(threadIndex == job->threadIndex);
+  job->hits[index]++;
+}
+
+void _test_Grr_nestedJob(void *data, Grr_u32 index, Grr_u32 threadIndex) {
+  Grr_u32 *hits = (Grr_u32 *)data;
+  // Runs serially on the calling thread, with its index
+  _TestGrrNestedJob job = {&hits[index * 10], threadIndex};
+  Grr_parallelFor(10, _test_Grr_innerJob, &job);
+}
+
+void _test_Grr_exclusiveJob(void *data, Grr_u32 index, Grr_u32 threadIndex) {
+  assert(__atomic_exchange_n(&testJobThreadsBusy[threadIndex], 1,
+                             __ATOMIC_ACQ_REL) == 0);
+  _test_Grr_countJob(data, index, threadIndex);
+  __atomic_store_n(&testJobThreadsBusy[threadIndex], 0, __ATOMIC_RELEASE);
+}
+
+void *_test_Grr_concurrentLoops(void *data) {
+  for (Grr_u32 round = 0; round < 20; round++)
+    Grr_parallelFor(TEST_JOB_COUNT, _test_Grr_exclusiveJob, data);
+  return NULL;
+}
+
+void test_Grr_parallelFor() {
+  Grr_u32 hits[TEST_JOB_COUNT] = {0};
+
+  // Every index runs exactly once, also across consecutive loops
+  for (Grr_u32 round = 1; round <= 3; round++) {
+    Grr_parallelFor(TEST_JOB_COUNT, _test_Grr_countJob, hits);
+    for (Grr_u32 i = 0; i < TEST_JOB_COUNT; i++)
+      assert(hits[i] == round);
+  }
+
+  memset(hits, 0, sizeof(hits));
+  Grr_parallelFor(TEST_JOB_COUNT / 10, _test_Grr_nestedJob, hits);
+  for (Grr_u32 i = 0; i < TEST_JOB_COUNT; i++)
+    assert(hits[i] == 1);
+
+  // Loops from other threads never share a thread index
+  Grr_u32 otherHits[TEST_JOB_COUNT] = {0};
+  pthread_t thread;
+  assert(pthread_create(&thread, NULL, _test_Grr_concurrentLoops,
+                        otherHits) == 0);
+  memset(hits, 0, sizeof(hits));
+  _test_Grr_concurrentLoops(hits);
+  pthread_join(thread, NULL);
+  for (Grr_u32 i = 0; i < TEST_JOB_COUNT; i++)
+    assert(hits[i] == 20 && otherHits[i] == 20);
+
+  Grr_parallelFor(0, _test_Grr_countJob, NULL);
+
+  GRR_LOG_INFO("PASSED test_Grr_parallelFor\n");
+}
@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_JOBS_H
+#define GRR_TEST_JOBS_H
+
+#include "jobs.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_parallelFor();
+
+#endif
@@ -0,0 +1,218 @@
+#include "test_jpeg.h"
+
+// Encoded with libjpeg (quality 95) from the gradient of _test_Grr_jpegPixel
+
+// 24x16 baseline 4:2:0, restart interval of 1 MCU
+const Grr_byte jpegBaseline[745] = {
+    0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+    0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+    0x00, 0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01, 0x01, 0x02,
+    0x02, 0x02, 0x02, 0x02, 0x04, 0x03, 0x02, 0x02, 0x02, 0x02, 0x05, 0x04,
+    0x04, 0x03, 0x04, 0x06, 0x05, 0x06, 0x06, 0x06, 0x05, 0x06, 0x06, 0x06,
+    0x07, 0x09, 0x08, 0x06, 0x07, 0x09, 0x07, 0x06, 0x06, 0x08, 0x0b, 0x08,
+    0x09, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x06, 0x08, 0x0b, 0x0c, 0x0b, 0x0a,
+    0x0c, 0x09, 0x0a, 0x0a, 0x0a, 0xff, 0xdb, 0x00, 0x43, 0x01, 0x02, 0x02,
+    0x02, 0x02, 0x02, 0x02, 0x05, 0x03, 0x03, 0x05, 0x0a, 0x07, 0x06, 0x07,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0xff, 0xc0, 0x00, 0x11, 0x08, 0x00, 0x10, 0x00, 0x18, 0x03,
+    0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01, 0xff, 0xc4, 0x00,
+    0x1f, 0x00, 0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+    0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff, 0xc4, 0x00, 0xb5, 0x10, 0x00,
+    0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05, 0x05, 0x04, 0x04, 0x00,
+    0x00, 0x01, 0x7d, 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21,
+    0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81,
+    0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24,
+    0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25,
+    0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a,
+    0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56,
+    0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+    0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86,
+    0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+    0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3,
+    0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6,
+    0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9,
+    0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1,
+    0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xff, 0xc4, 0x00,
+    0x1f, 0x01, 0x00, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+    0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff, 0xc4, 0x00, 0xb5, 0x11, 0x00,
+    0x02, 0x01, 0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04, 0x04, 0x00,
+    0x01, 0x02, 0x77, 0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31,
+    0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08,
+    0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15,
+    0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18,
+    0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55,
+    0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84,
+    0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+    0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa,
+    0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4,
+    0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7,
+    0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+    0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xff, 0xdd, 0x00,
+    0x04, 0x00, 0x01, 0xff, 0xda, 0x00, 0x0c, 0x03, 0x01, 0x00, 0x02, 0x11,
+    0x03, 0x11, 0x00, 0x3f, 0x00, 0xfc, 0xd6, 0xf0, 0x07, 0xec, 0xe3, 0xf7,
+    0x3f, 0xd0, 0x3f, 0xf1, 0xda, 0xf6, 0xef, 0x00, 0x7e, 0xce, 0x3f, 0x73,
+    0xfd, 0x03, 0xd3, 0xf8, 0x6b, 0xe8, 0xbf, 0x00, 0x7e, 0xce, 0x5f, 0x73,
+    0xfd, 0x03, 0xff, 0x00, 0x1d, 0xaf, 0x6e, 0xf0, 0x07, 0xec, 0xe3, 0xf7,
+    0x3f, 0xd0, 0x3f, 0xf1, 0xda, 0xfd, 0x0a, 0x8f, 0x8f, 0x3f, 0xf4, 0xf7,
+    0xf1, 0x3f, 0x3c, 0xf0, 0xab, 0xc6, 0x5f, 0x83, 0xf7, 0x9d, 0xba, 0x9f,
+    0xff, 0xd0, 0xf3, 0x3f, 0x00, 0x7e, 0xce, 0x3f, 0x73, 0xfd, 0x03, 0xd3,
+    0xf8, 0x68, 0xaf, 0xbe, 0x3c, 0x01, 0xfb, 0x38, 0xfd, 0xcf, 0xf4, 0x0f,
+    0x4f, 0xe1, 0xa2, 0xbf, 0x54, 0x87, 0x8f, 0x3a, 0x7f, 0x17, 0xf1, 0x3f,
+    0xaf, 0xb8, 0x63, 0xc6, 0x5f, 0xf8, 0x4a, 0x8f, 0xef, 0x3f, 0x13, 0xff,
+    0xd9};
+
+// 21x13 progressive 4:2:0, restart interval of 2 MCUs
+const Grr_byte jpegProgressive[655] = {
+    0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+    0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+    0x00, 0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01, 0x01, 0x02,
+    0x02, 0x02, 0x02, 0x02, 0x04, 0x03, 0x02, 0x02, 0x02, 0x02, 0x05, 0x04,
+    0x04, 0x03, 0x04, 0x06, 0x05, 0x06, 0x06, 0x06, 0x05, 0x06, 0x06, 0x06,
+    0x07, 0x09, 0x08, 0x06, 0x07, 0x09, 0x07, 0x06, 0x06, 0x08, 0x0b, 0x08,
+    0x09, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x06, 0x08, 0x0b, 0x0c, 0x0b, 0x0a,
+    0x0c, 0x09, 0x0a, 0x0a, 0x0a, 0xff, 0xdb, 0x00, 0x43, 0x01, 0x02, 0x02,
+    0x02, 0x02, 0x02, 0x02, 0x05, 0x03, 0x03, 0x05, 0x0a, 0x07, 0x06, 0x07,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a,
+    0x0a, 0x0a, 0xff, 0xc2, 0x00, 0x11, 0x08, 0x00, 0x0d, 0x00, 0x15, 0x03,
+    0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01, 0xff, 0xc4, 0x00,
+    0x17, 0x00, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x07, 0x08, 0xff, 0xc4,
+    0x00, 0x17, 0x01, 0x00, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x05, 0x06, 0x07, 0xff,
+    0xdd, 0x00, 0x04, 0x00, 0x02, 0xff, 0xda, 0x00, 0x0c, 0x03, 0x01, 0x00,
+    0x02, 0x10, 0x03, 0x10, 0x00, 0x00, 0x01, 0xe6, 0xa6, 0xee, 0x9b, 0xd3,
+    0x21, 0x03, 0x6e, 0x11, 0xf6, 0xff, 0x00, 0xff, 0xc4, 0x00, 0x19, 0x10,
+    0x01, 0x00, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x05, 0x06, 0x12, 0x22, 0xff, 0xda,
+    0x00, 0x08, 0x01, 0x01, 0x00, 0x01, 0x05, 0x02, 0x06, 0x72, 0x03, 0x39,
+    0x3f, 0xff, 0xd0, 0x36, 0x73, 0xc0, 0x2a, 0x8f, 0x3f, 0xff, 0xd1, 0x05,
+    0x51, 0xe1, 0xaa, 0x8f, 0xc7, 0xff, 0xc4, 0x00, 0x1a, 0x11, 0x00, 0x02,
+    0x02, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x06, 0x01, 0x03, 0x04, 0x13, 0x22, 0xff, 0xda, 0x00,
+    0x08, 0x01, 0x03, 0x01, 0x01, 0x3f, 0x01, 0x55, 0x6d, 0xb7, 0x93, 0x1d,
+    0xb2, 0xdd, 0x30, 0x7f, 0xff, 0xc4, 0x00, 0x18, 0x11, 0x00, 0x02, 0x03,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x03, 0x02, 0x06, 0x16, 0xff, 0xda, 0x00, 0x08, 0x01, 0x02,
+    0x01, 0x01, 0x3f, 0x01, 0x85, 0xd5, 0xc6, 0xd5, 0xc7, 0xff, 0xc4, 0x00,
+    0x16, 0x10, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x10, 0xff, 0xda, 0x00,
+    0x08, 0x01, 0x01, 0x00, 0x06, 0x3f, 0x02, 0x10, 0xbf, 0xff, 0xd0, 0x19,
+    0xff, 0xd1, 0xcf, 0xff, 0xc4, 0x00, 0x1a, 0x10, 0x00, 0x02, 0x03, 0x01,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x21, 0x31, 0xa1, 0xc1, 0x41, 0xf1, 0xff, 0xda, 0x00, 0x08, 0x01,
+    0x01, 0x00, 0x01, 0x3f, 0x21, 0x8f, 0x24, 0x79, 0x3f, 0xff, 0xd0, 0xf2,
+    0xc5, 0x55, 0x1f, 0xff, 0xd1, 0x55, 0x51, 0xcb, 0xa3, 0xff, 0xda, 0x00,
+    0x0c, 0x03, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00, 0x10, 0xd4,
+    0xff, 0x00, 0xff, 0xc4, 0x00, 0x17, 0x11, 0x00, 0x03, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x31, 0x41, 0xff, 0xda, 0x00, 0x08, 0x01, 0x03, 0x01, 0x01, 0x3f,
+    0x10, 0xd8, 0x78, 0x55, 0xb8, 0x7f, 0xff, 0xc4, 0x00, 0x18, 0x11, 0x00,
+    0x02, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x11, 0x31, 0x51, 0xff, 0xda, 0x00, 0x08,
+    0x01, 0x02, 0x01, 0x01, 0x3f, 0x10, 0xd4, 0xc5, 0x15, 0xb3, 0xff, 0xc4,
+    0x00, 0x1b, 0x10, 0x01, 0x00, 0x02, 0x02, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x41, 0x01, 0x11,
+    0x81, 0x91, 0xa1, 0xff, 0xda, 0x00, 0x08, 0x01, 0x01, 0x00, 0x01, 0x3f,
+    0x10, 0x5b, 0xcb, 0x3f, 0xff, 0xd0, 0x87, 0x3a, 0x3a, 0xf5, 0x5f, 0xff,
+    0xd1, 0xd7, 0x7c, 0xbe, 0x27, 0xff, 0xd9};
+
+// 24x16 baseline grayscale
+const Grr_byte jpegGrayscale[401] = {
+    0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+    0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+    0x00, 0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01, 0x01, 0x02,
+    0x02, 0x02, 0x02, 0x02, 0x04, 0x03, 0x02, 0x02, 0x02, 0x02, 0x05, 0x04,
+    0x04, 0x03, 0x04, 0x06, 0x05, 0x06, 0x06, 0x06, 0x05, 0x06, 0x06, 0x06,
+    0x07, 0x09, 0x08, 0x06, 0x07, 0x09, 0x07, 0x06, 0x06, 0x08, 0x0b, 0x08,
+    0x09, 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x06, 0x08, 0x0b, 0x0c, 0x0b, 0x0a,
+    0x0c, 0x09, 0x0a, 0x0a, 0x0a, 0xff, 0xc0, 0x00, 0x0b, 0x08, 0x00, 0x10,
+    0x00, 0x18, 0x01, 0x01, 0x11, 0x00, 0xff, 0xc4, 0x00, 0x1f, 0x00, 0x00,
+    0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0a, 0x0b, 0xff, 0xc4, 0x00, 0xb5, 0x10, 0x00, 0x02, 0x01, 0x03,
+    0x03, 0x02, 0x04, 0x03, 0x05, 0x05, 0x04, 0x04, 0x00, 0x00, 0x01, 0x7d,
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06,
+    0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+    0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72,
+    0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45,
+    0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75,
+    0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3,
+    0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+    0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9,
+    0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4,
+    0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xff, 0xda, 0x00, 0x08, 0x01, 0x01,
+    0x00, 0x00, 0x3f, 0x00, 0xfc, 0xd6, 0xf0, 0x07, 0xec, 0xe3, 0xf7, 0x3f,
+    0xd0, 0x3f, 0xf1, 0xda, 0xf6, 0xef, 0x00, 0x7e, 0xce, 0x3f, 0x73, 0xfd,
+    0x03, 0xd3, 0xf8, 0x6b, 0xdb, 0xfc, 0x01, 0xfb, 0x38, 0xfd, 0xcf, 0xf4,
+    0x0f, 0x4f, 0xe1, 0xad, 0xcf, 0x00, 0x7e, 0xce, 0x5f, 0x73, 0xfd, 0x03,
+    0xff, 0x00, 0x1d, 0xaf, 0x6e, 0xf0, 0x07, 0xec, 0xe3, 0xf7, 0x3f, 0xd0,
+    0x3f, 0xf1, 0xda, 0xf6, 0xef, 0x00, 0x7e, 0xce, 0x3f, 0x73, 0xfd, 0x03,
+    0xd3, 0xf8, 0x6b, 0xff, 0xd9};
+
+void _test_Grr_jpegPixel(Grr_u32 x, Grr_u32 y, Grr_i32 *rgb) {
+  rgb[0] = x * 10;
+  rgb[1] = y * 14;
+  rgb[2] = 128 + ((Grr_i32)x - (Grr_i32)y) * 4;
+}
+
+Grr_i32 _test_Grr_jpegMaxError(const Grr_byte *rgba, Grr_u32 w, Grr_u32 h,
+                               Grr_bool grayscale) {
+  Grr_i32 maxError = 0;
+  for (Grr_u32 y = 0; y < h; y++) {
+    for (Grr_u32 x = 0; x < w; x++) {
+      Grr_i32 rgb[3];
+      _test_Grr_jpegPixel(x, y, rgb);
+      if (grayscale) {
+        rgb[0] = (rgb[0] * 299 + rgb[1] * 587 + rgb[2] * 114) / 1000;
+        rgb[1] = rgb[2] = rgb[0];
+      }
+      const Grr_byte *pixel = rgba + (y * w + x) * 4;
+      assert(pixel[3] == 255);
+      for (Grr_u32 c = 0; c < 3; c++) {
+        Grr_i32 error = abs(pixel[c] - rgb[c]);
+        maxError = (error > maxError ? error : maxError);
+      }
+    }
+  }
+  return maxError;
+}
+
+void test_Grr_decodeJPEG() {
+  Grr_u32 w, h;
+  Grr_byte *rgba = Grr_decodeJPEG(jpegBaseline, sizeof(jpegBaseline), &w, &h);
+  assert(NULL != rgba && w == 24 && h == 16);
+  assert(_test_Grr_jpegMaxError(rgba, w, h, false) <= 12);
+  free(rgba);
+
+  rgba = Grr_decodeJPEG(jpegProgressive, sizeof(jpegProgressive), &w, &h);
+  assert(NULL != rgba && w == 21 && h == 13);
+  assert(_test_Grr_jpegMaxError(rgba, w, h, false) <= 12);
+  free(rgba);
+
+  rgba = Grr_decodeJPEG(jpegGrayscale, sizeof(jpegGrayscale), &w, &h);
+  assert(NULL != rgba && w == 24 && h == 16);
+  assert(_test_Grr_jpegMaxError(rgba, w, h, true) <= 3);
+  free(rgba);
+
+  // Truncated, missing start of image
+  assert(NULL ==
+         Grr_decodeJPEG(jpegBaseline, sizeof(jpegBaseline) / 2, &w, &h));
+  assert(NULL == Grr_decodeJPEG(jpegBaseline + 2, sizeof(jpegBaseline) - 2, &w,
+                                &h));
+
+  GRR_LOG_INFO("PASSED test_Grr_decodeJPEG\n");
+}
@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_JPEG_H
+#define GRR_TEST_JPEG_H
+
+#include "jpeg.h"
+#include "logging.h"
+#include <assert.h>
+
+void test_Grr_decodeJPEG();
+
+#endif
@@ -0,0 +1,74 @@
+#include "test_linear.h"
+
+Grr_f32 planeDistance(const GrrVector4 *plane, Grr_f32 x, Grr_f32 y,
+                      Grr_f32 z) {
+  return plane->x * x + plane->y * y + plane->z * z + plane->w;
+}
+
+void test_Grr_frustumPlanes() {
+  // Identity: the frustum is the clip volume [-1, 1] x [-1, 1] x [0, 1]
+  GrrMatrix4x4 identity;
+  Grr_identityMatrix(&identity);
+  GrrVector4 planes[6];
+  Grr_frustumPlanes(&identity, planes);
+  const Grr_f32 expected[6][4] = {{1, 0, 0, 1},  {-1, 0, 0, 1}, {0, 1, 0, 1},
+                                  {0, -1, 0, 1}, {0, 0, 1, 0},  {0, 0, -1, 1}};
+  for (Grr_u32 p = 0; p < 6; p++) {
+    assert(fabsf(planes[p].x - expected[p][0]) < 1e-6f);
+    assert(fabsf(planes[p].y - expected[p][1]) < 1e-6f);
+    assert(fabsf(planes[p].z - expected[p][2]) < 1e-6f);
+    assert(fabsf(planes[p].w - expected[p][3]) < 1e-6f);
+  }
+
+  // Scaled x: planes are normalized, distances are in world units
+  GrrMatrix4x4 scale = identity;
+  scale.data[0] = 0.5f; // Visible x in [-2, 2]
+  Grr_frustumPlanes(&scale, planes);
+  assert(fabsf(planeDistance(&planes[0], -2.0f, 0.0f, 0.5f)) < 1e-6f);
+  assert(fabsf(planeDistance(&planes[1], 1.0f, 0.0f, 0.5f) - 1.0f) <
+         1e-6f);
+  assert(planeDistance(&planes[1], 3.0f, 0.0f, 0.5f) < 0.0f);
+
+  GRR_LOG_INFO("PASSED test_Grr_frustumPlanes\n");
+}
+
+Grr_bool isInsideFrustum(const GrrVector4 planes[6], Grr_f32 x, Grr_f32 y,
+                         Grr_f32 z) {
+  for (Grr_u32 p = 0; p < 6; p++) {
+    if (planeDistance(&planes[p], x, y, z) < 0.0f)
+      return false;
+  }
+  return true;
+}
+
+void test_Grr_cameraFrustum() {
+  // At z = 5 looking down -z, 90 degrees: the half width is the distance
+  GrrCamera camera = {0};
+  camera.origin.z = 5.0f;
+  camera.direction.z = -1.0f;
+  camera.upHint.y = 1.0f;
+  camera.zNear = 0.1f;
+  camera.zFar = 100.0f;
+  camera.aspectRatio = 1.0f;
+  camera.yFOV = 1.5707963f;
+
+  GrrMatrix4x4 view, projection, viewProjection;
+  Grr_viewMatrix(&camera, &view);
+  Grr_perspectiveProjectionMatrix(&camera, &projection);
+  Grr_multiplyMatrix(&projection, &view, &viewProjection);
+  GrrVector4 planes[6];
+  Grr_frustumPlanes(&viewProjection, planes);
+
+  assert(isInsideFrustum(planes, 0.0f, 0.0f, 0.0f));
+  assert(isInsideFrustum(planes, 4.0f, -4.0f, 0.0f));
+  assert(isInsideFrustum(planes, 0.0f, 0.0f, -90.0f));
+  assert(!isInsideFrustum(planes, 6.0f, 0.0f, 0.0f));  // Right
+  assert(!isInsideFrustum(planes, 0.0f, 6.0f, 0.0f));  // Above
+  assert(!isInsideFrustum(planes, 0.0f, 0.0f, 6.0f));  // Behind
+  assert(!isInsideFrustum(planes, 0.0f, 0.0f, -100.0f)); // Beyond far
+
+  // The near plane is at zNear from the camera
+  assert(fabsf(planeDistance(&planes[4], 0.0f, 0.0f, 0.0f) - 4.9f) < 1e-3f);
+
+  GRR_LOG_INFO("PASSED test_Grr_cameraFrustum\n");
+}
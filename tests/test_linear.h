@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_LINEAR_H
+#define GRR_TEST_LINEAR_H
+
+#include "logging.h"
+#include "math/linear.h"
+#include <assert.h>
+
+void test_Grr_frustumPlanes();
+void test_Grr_cameraFrustum();
+
+#endif
@@ -0,0 +1,165 @@
+#include "test_meshopt.h"
+
+// 16 vertices of 4 bytes, one byte channel per group encoding: channel 0
+// zero deltas, channel 1 2-bit deltas of +1, channel 2 4-bit escapes with
+// deltas of +2, channel 3 raw deltas of +3. Tail is zero (first vertex base)
+size_t _test_Grr_meshoptVertexStream(Grr_byte *stream) {
+  size_t n = 0;
+  stream[n++] = 0xa0;
+  stream[n++] = 0x00; // Channel 0 header: bitslog2 0
+  stream[n++] = 0x01; // Channel 1 header: bitslog2 1
+  memset(stream + n, 0xAA, 4); // 2-bit codes 2 (zigzag +1)
+  n += 4;
+  stream[n++] = 0x02;          // Channel 2 header: bitslog2 2
+  memset(stream + n, 0xFF, 8); // 4-bit escapes
+  n += 8;
+  memset(stream + n, 0x04, 16); // Escaped bytes (zigzag +2)
+  n += 16;
+  stream[n++] = 0x03; // Channel 3 header: bitslog2 3
+  memset(stream + n, 0x06, 16); // Raw bytes (zigzag +3)
+  n += 16;
+  memset(stream + n, 0, 32);
+  return n + 32;
+}
+
+void test_Grr_meshoptDecodeVertexBuffer() {
+  Grr_byte stream[128];
+  size_t nBytes = _test_Grr_meshoptVertexStream(stream);
+
+  Grr_byte vertices[16 * 4];
+  assert(Grr_meshoptDecodeVertexBuffer(vertices, 16, 4, stream, nBytes));
+  for (Grr_u32 i = 0; i < 16; i++) {
+    assert(vertices[i * 4] == 0);
+    assert(vertices[i * 4 + 1] == i + 1);
+    assert(vertices[i * 4 + 2] == (i + 1) * 2);
+    assert(vertices[i * 4 + 3] == (i + 1) * 3);
+  }
+
+  // Truncated stream, bad header, bad stride
+  assert(!Grr_meshoptDecodeVertexBuffer(vertices, 16, 4, stream, nBytes - 1));
+  stream[0] = 0xa1;
+  assert(!Grr_meshoptDecodeVertexBuffer(vertices, 16, 4, stream, nBytes));
+  stream[0] = 0xa0;
+  assert(!Grr_meshoptDecodeVertexBuffer(vertices, 16, 3, stream, nBytes));
+
+  GRR_LOG_INFO("PASSED test_Grr_meshoptDecodeVertexBuffer\n");
+}
+
+void test_Grr_meshoptDecodeIndexBuffer() {
+  // Free triangle from the code table (0, 1, 2), then a triangle reusing
+  // edge (2, 1) with a new vertex
+  Grr_byte stream[1 + 2 + 16] = {0xe1, 0xf0, 0x10};
+
+  Grr_u16 indices16[6];
+  assert(Grr_meshoptDecodeIndexBuffer((Grr_byte *)indices16, 6, 2, stream,
+                                      sizeof(stream)));
+  Grr_u16 expected16[6] = {0, 1, 2, 2, 1, 3};
+  assert(0 == memcmp(indices16, expected16, sizeof(expected16)));
+
+  Grr_u32 indices32[6];
+  assert(Grr_meshoptDecodeIndexBuffer((Grr_byte *)indices32, 6, 4, stream,
+                                      sizeof(stream)));
+  for (Grr_u32 i = 0; i < 6; i++)
+    assert(indices32[i] == expected16[i]);
+
+  assert(!Grr_meshoptDecodeIndexBuffer((Grr_byte *)indices16, 6, 2, stream,
+                                       sizeof(stream) - 1));
+  assert(!Grr_meshoptDecodeIndexBuffer((Grr_byte *)indices16, 5, 2, stream,
+                                       sizeof(stream)));
+
+  GRR_LOG_INFO("PASSED test_Grr_meshoptDecodeIndexBuffer\n");
+}
+
+void test_Grr_meshoptDecodeIndexSequence() {
+  // Deltas 0, +1, +1 against baseline 0, then +5 and -1 against baseline 1
+  Grr_byte stream[] = {0xd1, 0x00, 0x04, 0x04, 0x15, 0x03, 0, 0, 0, 0};
+
+  Grr_u32 indices[5];
+  assert(Grr_meshoptDecodeIndexSequence((Grr_byte *)indices, 5, 4, stream,
+                                        sizeof(stream)));
+  Grr_u32 expected[5] = {0, 1, 2, 5, 4};
+  assert(0 == memcmp(indices, expected, sizeof(expected)));
+
+  stream[0] = 0xe1;
+  assert(!Grr_meshoptDecodeIndexSequence((Grr_byte *)indices, 5, 4, stream,
+                                         sizeof(stream)));
+
+  GRR_LOG_INFO("PASSED test_Grr_meshoptDecodeIndexSequence\n");
+}
+
+void test_Grr_meshoptFilters() {
+  // Octahedral int8: +X and -Z (folded)
+  int8_t oct8[8] = {127, 0, 127, 42, 127, 127, 127, -1};
+  Grr_meshoptFilterOctahedral((Grr_byte *)oct8, 2, 4);
+  int8_t expected8[8] = {127, 0, 0, 42, 0, 0, -127, -1};
+  assert(0 == memcmp(oct8, expected8, sizeof(expected8)));
+
+  // Octahedral int16: (0.6, 0, -0.8), 5 vectors to cover a partial batch
+  Grr_i16 oct16[5 * 4];
+  for (Grr_u32 i = 0; i < 5; i++) {
+    Grr_i16 v[4] = {32767, 18724, 32767, 7};
+    memcpy(&oct16[i * 4], v, sizeof(v));
+  }
+  Grr_meshoptFilterOctahedral((Grr_byte *)oct16, 5, 8);
+  for (Grr_u32 i = 0; i < 5; i++) {
+    assert(abs(oct16[i * 4] - 19660) <= 2);
+    assert(abs(oct16[i * 4 + 1]) <= 2);
+    assert(abs(oct16[i * 4 + 2] + 26214) <= 2);
+    assert(oct16[i * 4 + 3] == 7);
+  }
+
+  // Quaternions: (0.5, 0.5, 0.5, 0.5) with W dropped, (0.8, 0.6, 0, 0) with
+  // X dropped. Component scale is 4095 << 2 | 3
+  Grr_i16 quat[8] = {11584, 11584, 11584, (4095 << 2) | 3,
+                     13901, 0,     0,     (4095 << 2) | 0};
+  Grr_meshoptFilterQuaternion(quat, 2);
+  Grr_i16 expectedQuat[8] = {16384, 16384, 16384, 16384, 26214, 19660, 0, 0};
+  for (Grr_u32 i = 0; i < 8; i++)
+    assert(abs(quat[i] - expectedQuat[i]) <= 2);
+
+  // Exponential: 3 * 2^-1, -5 * 2^2
+  Grr_u32 exponential[2] = {0xFF000003, 0x02FFFFFB};
+  Grr_meshoptFilterExponential(exponential, 2);
+  Grr_f32 decoded[2];
+  memcpy(decoded, exponential, sizeof(decoded));
+  assert(decoded[0] == 1.5f);
+  assert(decoded[1] == -20.0f);
+
+  GRR_LOG_INFO("PASSED test_Grr_meshoptFilters\n");
+}
+
+void test_Grr_meshoptDecodeAll() {
+  Grr_byte vertexStream[128];
+  size_t vertexBytes = _test_Grr_meshoptVertexStream(vertexStream);
+  Grr_byte indexStream[1 + 2 + 16] = {0xe1, 0xf0, 0x10};
+
+  // Same streams decoded into many views at once
+  enum { VIEW_COUNT = 32 };
+  Grr_byte *destination = (Grr_byte *)malloc(VIEW_COUNT * 64);
+  assert(NULL != destination);
+  GrrMeshoptCompression compressions[VIEW_COUNT];
+  for (Grr_u32 i = 0; i < VIEW_COUNT; i++) {
+    Grr_bool vertices = (i % 2 == 0);
+    compressions[i].source = (vertices ? vertexStream : indexStream);
+    compressions[i].sourceBytes =
+        (vertices ? vertexBytes : sizeof(indexStream));
+    compressions[i].destination = destination + i * 64;
+    compressions[i].count = (vertices ? 16 : 6);
+    compressions[i].stride = (vertices ? 4 : 2);
+    compressions[i].mode =
+        (vertices ? GRR_MESHOPT_MODE_ATTRIBUTES : GRR_MESHOPT_MODE_TRIANGLES);
+    compressions[i].filter = GRR_MESHOPT_FILTER_NONE;
+  }
+  assert(Grr_meshoptDecodeAll(compressions, VIEW_COUNT));
+  for (Grr_u32 i = 0; i < VIEW_COUNT; i += 2) {
+    assert(destination[i * 64 + 63] == 48);
+    assert(((Grr_u16 *)(destination + (i + 1) * 64))[5] == 3);
+  }
+
+  // A single malformed view fails the whole decode
+  compressions[VIEW_COUNT - 1].sourceBytes--;
+  assert(!Grr_meshoptDecodeAll(compressions, VIEW_COUNT));
+
+  free(destination);
+  GRR_LOG_INFO("PASSED test_Grr_meshoptDecodeAll\n");
+}
@@ -0,0 +1,15 @@
+#ifndef GRR_TEST_MESHOPT_H
+#define GRR_TEST_MESHOPT_H
+
+#include "logging.h"
+#include "meshopt.h"
+#include <assert.h>
+#include <stdlib.h>
+
+void test_Grr_meshoptDecodeVertexBuffer();
+void test_Grr_meshoptDecodeIndexBuffer();
+void test_Grr_meshoptDecodeIndexSequence();
+void test_Grr_meshoptFilters();
+void test_Grr_meshoptDecodeAll();
+
+#endif
@@ -0,0 +1,51 @@
+#include "test_pacing.h"
+
+void test_Grr_choosePresentMode() {
+  const VkPresentModeKHR fifoOnly[] = {VK_PRESENT_MODE_FIFO_KHR};
+  const VkPresentModeKHR all[] = {
+      VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+      VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+
+  // FIFO is the fallback of every mode
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_MAILBOX, fifoOnly, 1) ==
+         GRR_PRESENT_MODE_FIFO);
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_IMMEDIATE, fifoOnly, 1) ==
+         GRR_PRESENT_MODE_FIFO);
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_FIFO, fifoOnly, 1) ==
+         GRR_PRESENT_MODE_FIFO);
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_COUNT, all, 4) ==
+         GRR_PRESENT_MODE_FIFO);
+
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_MAILBOX, all, 4) ==
+         GRR_PRESENT_MODE_MAILBOX);
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_IMMEDIATE, all, 4) ==
+         GRR_PRESENT_MODE_IMMEDIATE);
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_FIFO_RELAXED, all, 4) ==
+         GRR_PRESENT_MODE_FIFO_RELAXED);
+  assert(Grr_choosePresentMode(GRR_PRESENT_MODE_FIFO_RELAXED, all, 3) ==
+         GRR_PRESENT_MODE_FIFO);
+
+  GRR_LOG_INFO("PASSED test_Grr_choosePresentMode\n");
+}
+
+void test_Grr_nextFrameDeadline() {
+  const Grr_f64 interval = 1.0 / 60.0;
+
+  // On schedule: one interval after the previous deadline
+  assert(fabs(Grr_nextFrameDeadline(1.0, 1.005, interval) - (1.0 + interval)) <
+         1e-12);
+  // Late by less than a frame: the deadline has passed, the schedule is kept
+  assert(fabs(Grr_nextFrameDeadline(1.0, 1.03, interval) - (1.0 + interval)) <
+         1e-12);
+  // Late by more: a new schedule starts now
+  assert(Grr_nextFrameDeadline(1.0, 1.5, interval) == 1.5);
+  assert(Grr_nextFrameDeadline(0.0, 100.0, interval) == 100.0);
+
+  // Deadlines of frames on schedule are evenly spaced
+  Grr_f64 deadline = 10.0;
+  for (Grr_u32 i = 0; i < 60; i++)
+    deadline = Grr_nextFrameDeadline(deadline, deadline, interval);
+  assert(fabs(deadline - 11.0) < 1e-9);
+
+  GRR_LOG_INFO("PASSED test_Grr_nextFrameDeadline\n");
+}
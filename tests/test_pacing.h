@@ -0,0 +1,12 @@
+#ifndef GRR_TEST_PACING_H
+#define GRR_TEST_PACING_H
+
+#include "logging.h"
+#include "pacing.h"
+#include <assert.h>
+#include <math.h>
+
+void test_Grr_choosePresentMode();
+void test_Grr_nextFrameDeadline();
+
+#endif
@@ -0,0 +1,51 @@
+#include "test_pipelinecache.h"
+
+void _test_Grr_writeU32(Grr_byte *bytes, Grr_u32 value) {
+  for (Grr_u32 i = 0; i < 4; i++)
+    bytes[i] = (Grr_byte)(value >> (8 * i));
+}
+
+void test_Grr_isPipelineCacheCompatible() {
+  VkPhysicalDeviceProperties properties = {0};
+  properties.vendorID = 0x106B;
+  properties.deviceID = 0x1A2B3C;
+  for (Grr_u32 i = 0; i < VK_UUID_SIZE; i++)
+    properties.pipelineCacheUUID[i] = (Grr_byte)(i * 7 + 1);
+
+  // Header followed by some driver data
+  Grr_byte bytes[GRR_PIPELINE_CACHE_HEADER_SIZE + 8] = {0};
+  _test_Grr_writeU32(bytes, GRR_PIPELINE_CACHE_HEADER_SIZE);
+  _test_Grr_writeU32(bytes + 4, VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+  _test_Grr_writeU32(bytes + 8, properties.vendorID);
+  _test_Grr_writeU32(bytes + 12, properties.deviceID);
+  memcpy(bytes + 16, properties.pipelineCacheUUID, VK_UUID_SIZE);
+  assert(Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+  assert(Grr_isPipelineCacheCompatible(bytes, GRR_PIPELINE_CACHE_HEADER_SIZE,
+                                       &properties));
+
+  // Missing or truncated data
+  assert(!Grr_isPipelineCacheCompatible(NULL, 0, &properties));
+  assert(!Grr_isPipelineCacheCompatible(
+      bytes, GRR_PIPELINE_CACHE_HEADER_SIZE - 1, &properties));
+
+  // Other device, vendor or driver
+  properties.deviceID++;
+  assert(!Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+  properties.deviceID--;
+  properties.vendorID++;
+  assert(!Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+  properties.vendorID--;
+  properties.pipelineCacheUUID[VK_UUID_SIZE - 1] ^= 1;
+  assert(!Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+  properties.pipelineCacheUUID[VK_UUID_SIZE - 1] ^= 1;
+  assert(Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+
+  // Corrupted header
+  _test_Grr_writeU32(bytes + 4, VK_PIPELINE_CACHE_HEADER_VERSION_ONE + 1);
+  assert(!Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+  _test_Grr_writeU32(bytes + 4, VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+  _test_Grr_writeU32(bytes, sizeof(bytes) + 1);
+  assert(!Grr_isPipelineCacheCompatible(bytes, sizeof(bytes), &properties));
+
+  GRR_LOG_INFO("PASSED test_Grr_isPipelineCacheCompatible\n");
+}
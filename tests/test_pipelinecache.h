@@ -0,0 +1,10 @@
+#ifndef GRR_TEST_PIPELINECACHE_H
+#define GRR_TEST_PIPELINECACHE_H
+
+#include "logging.h"
+#include "pipelinecache.h"
+#include <assert.h>
+
+void test_Grr_isPipelineCacheCompatible();
+
+#endif
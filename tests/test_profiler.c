@@ -0,0 +1,76 @@
+#include "test_profiler.h"
+
+void test_Grr_timestampMilliseconds() {
+  // 1 ns ticks
+  assert(fabs(Grr_timestampMilliseconds(1000, 2501000, 64, 1.0f) - 2.5) <
+         1e-9);
+  // Counters with fewer valid bits wrap
+  assert(fabs(Grr_timestampMilliseconds(0xFFFFFF00ull, 0x100ull, 32, 1.0f) -
+              512e-6) < 1e-12);
+  assert(fabs(Grr_timestampMilliseconds(UINT64_MAX, 999999, 64, 1.0f) - 1.0) <
+         1e-9);
+  // Period in nanoseconds per tick
+  assert(fabs(Grr_timestampMilliseconds(0, 1000, 36, 41.666f) - 0.041666) <
+         1e-6);
+
+  GRR_LOG_INFO("PASSED test_Grr_timestampMilliseconds\n");
+}
+
+void test_Grr_summarizeTimings() {
+  Grr_f32 samples[200] = {0};
+  Grr_f32 scratch[200];
+  GrrTimings timings;
+
+  assert(!Grr_summarizeTimings(samples, 0, scratch, &timings));
+  assert(timings.sampleCount == 0);
+
+  // 100, 99, ..., 1: the last sample is the most recent one
+  for (Grr_u32 i = 0; i < 100; i++)
+    samples[i] = (Grr_f32)(100 - i);
+  assert(Grr_summarizeTimings(samples, 100, scratch, &timings));
+  assert(timings.min == 1.0f);
+  assert(timings.average == 50.5f);
+  assert(timings.p99 == 99.0f);
+  assert(timings.last == 1.0f);
+  assert(timings.sampleCount == 100);
+  assert(samples[0] == 100.0f); // Samples are left unsorted
+
+  // Rare spikes land in the p99 once they are more than 1 in 100
+  for (Grr_u32 i = 0; i < 200; i++)
+    samples[i] = i % 50 == 0 ? 10.0f : 2.0f;
+  assert(Grr_summarizeTimings(samples, 200, scratch, &timings));
+  assert(timings.min == 2.0f);
+  assert(timings.p99 == 10.0f);
+  samples[0] = 2.0f;
+  samples[50] = 2.0f;
+  samples[100] = 2.0f;
+  assert(Grr_summarizeTimings(samples, 200, scratch, &timings));
+  assert(timings.p99 == 2.0f);
+
+  assert(Grr_summarizeTimings(samples, 1, scratch, &timings));
+  assert(timings.min == 2.0f && timings.p99 == 2.0f && timings.last == 2.0f);
+
+  GRR_LOG_INFO("PASSED test_Grr_summarizeTimings\n");
+}
+
+void test_Grr_summarizeHistory() {
+  GrrTimingHistory history = {0};
+  GrrTimings timings;
+  assert(!Grr_summarizeHistory(&history, &timings));
+
+  Grr_recordTiming(&history, 3.0f);
+  Grr_recordTiming(&history, 1.0f);
+  assert(Grr_summarizeHistory(&history, &timings));
+  assert(timings.sampleCount == 2 && timings.last == 1.0f);
+  assert(timings.min == 1.0f && timings.average == 2.0f);
+
+  // Once full, the oldest samples are replaced
+  for (Grr_u32 i = 0; i < GRR_PROFILER_HISTORY + 10; i++)
+    Grr_recordTiming(&history, (Grr_f32)i);
+  assert(Grr_summarizeHistory(&history, &timings));
+  assert(timings.sampleCount == GRR_PROFILER_HISTORY);
+  assert(timings.min == 10.0f);
+  assert(timings.last == (Grr_f32)(GRR_PROFILER_HISTORY + 9));
+
+  GRR_LOG_INFO("PASSED test_Grr_summarizeHistory\n");
+}
@@ -0,0 +1,13 @@
+#ifndef GRR_TEST_PROFILER_H
+#define GRR_TEST_PROFILER_H
+
+#include "logging.h"
+#include "profiler.h"
+#include <assert.h>
+#include <math.h>
+
+void test_Grr_timestampMilliseconds();
+void test_Grr_summarizeTimings();
+void test_Grr_summarizeHistory();
+
+#endif
@@ -0,0 +1,121 @@
+#include "test_quantize.h"
+
+void test_Grr_f32ToF16() {
+  assert(Grr_f32ToF16(0.0f) == 0x0000);
+  assert(Grr_f32ToF16(-0.0f) == 0x8000);
+  assert(Grr_f32ToF16(1.0f) == 0x3C00);
+  assert(Grr_f32ToF16(-2.0f) == 0xC000);
+  assert(Grr_f32ToF16(0.5f) == 0x3800);
+  assert(Grr_f32ToF16(65504.0f) == 0x7BFF);  // Largest half
+  assert(Grr_f32ToF16(1e6f) == 0x7C00);      // Overflow to infinity
+  assert(Grr_f32ToF16(5.96046448e-8f) == 1); // Smallest subnormal
+  for (Grr_f32 f = -4.0f; f <= 4.0f; f += 0.01f)
+    assert(fabsf(Grr_f16ToF32(Grr_f32ToF16(f)) - f) <= 0.002f);
+  GRR_LOG_INFO("PASSED test_Grr_f32ToF16\n");
+}
+
+void test_Grr_octahedralEncode() {
+  // Sweep the sphere, including both hemispheres and the poles
+  Grr_f32 vectors[18 * 36 * 3 + 6];
+  Grr_u32 count = 0;
+  for (Grr_u32 i = 0; i < 18; i++) {
+    for (Grr_u32 j = 0; j < 36; j++) {
+      Grr_f32 theta = (i + 0.5f) * 3.14159265f / 18.0f;
+      Grr_f32 phi = j * 2.0f * 3.14159265f / 36.0f;
+      vectors[count * 3] = sinf(theta) * cosf(phi);
+      vectors[count * 3 + 1] = sinf(theta) * sinf(phi);
+      vectors[count * 3 + 2] = cosf(theta);
+      count++;
+    }
+  }
+  Grr_f32 poles[6] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f};
+  memcpy(&vectors[count * 3], poles, sizeof(poles));
+  count += 2;
+
+  Grr_i16 encoded[18 * 36 * 2 + 4];
+  Grr_octahedralEncode(vectors, 3, count, encoded, 2);
+  for (Grr_u32 i = 0; i < count; i++) {
+    GrrVector3 v;
+    Grr_octahedralDecode(&encoded[i * 2], &v);
+    Grr_f32 dot = v.x * vectors[i * 3] + v.y * vectors[i * 3 + 1] +
+                  v.z * vectors[i * 3 + 2];
+    assert(dot > 0.99999f);
+  }
+  GRR_LOG_INFO("PASSED test_Grr_octahedralEncode\n");
+}
+
+void test_Grr_quantizeVertices() {
+  Grr_f32 positions[] = {-1.0f, 2.0f, 0.5f, 3.0f, -2.0f, 0.5f,
+                         0.0f,  0.0f, 0.5f, 1.0f, 1.0f,  0.5f,
+                         2.5f,  1.5f, 0.5f};
+  Grr_f32 tangents[] = {1.0f, 0.0f, 0.0f, 1.0f,  0.0f, 1.0f, 0.0f, -1.0f,
+                        1.0f, 0.0f, 0.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+                        0.0f, 0.0f, 1.0f, -1.0f};
+  Grr_f32 textureCoordinates[] = {0.0f,  1.0f, 0.25f, 0.75f, 0.5f,
+                                  0.5f,  1.0f, 0.0f,  0.125f, 0.875f};
+  GrrQuantizedVertex vertices[5];
+  GrrVector3 aabbMin, aabbExtent;
+  Grr_quantizeVertices(5, positions, NULL, tangents, textureCoordinates,
+                       vertices, &aabbMin, &aabbExtent);
+
+  assert(sizeof(GrrQuantizedVertex) == 20);
+  assert(aabbMin.x == -1.0f && aabbMin.y == -2.0f && aabbMin.z == 0.5f);
+  assert(aabbExtent.x == 4.0f && aabbExtent.y == 4.0f && aabbExtent.z == 0.0f);
+
+  // Dequantize through the matrix folded into the model matrix
+  GrrMatrix4x4 dequantization;
+  Grr_dequantizationMatrix(&aabbMin, &aabbExtent, &dequantization);
+  for (Grr_u32 i = 0; i < 5; i++) {
+    Grr_f32 q[3];
+    for (Grr_u32 k = 0; k < 3; k++)
+      q[k] = vertices[i].position[k] / 65535.0f;
+    for (Grr_u32 k = 0; k < 3; k++) {
+      Grr_f32 p = dequantization.data[k] * q[0] +
+                  dequantization.data[4 + k] * q[1] +
+                  dequantization.data[8 + k] * q[2] +
+                  dequantization.data[12 + k];
+      assert(fabsf(p - positions[i * 3 + k]) <= 4.0f / 65535.0f);
+    }
+    assert(vertices[i].position[3] ==
+           (tangents[i * 4 + 3] < 0.0f ? 0 : 65535));
+    assert(vertices[i].normal[0] == 0 && vertices[i].normal[1] == 0);
+    assert(Grr_f16ToF32(vertices[i].textureCoordinates[0]) ==
+           textureCoordinates[i * 2]);
+    assert(Grr_f16ToF32(vertices[i].textureCoordinates[1]) ==
+           textureCoordinates[i * 2 + 1]);
+  }
+  GRR_LOG_INFO("PASSED test_Grr_quantizeVertices\n");
+}
+
+void test_Grr_quantizePositions() {
+  Grr_f32 positions[] = {-1.0f, 2.0f, 0.5f, 3.0f, -2.0f, 0.5f,
+                         0.0f,  0.0f, 0.5f, 1.0f, 1.0f,  0.5f,
+                         2.5f,  1.5f, 0.5f};
+  Grr_f32 tangents[] = {1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, -1.0f,
+                        1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, -1.0f,
+                        0.0f, 0.0f, 1.0f, -1.0f};
+  GrrQuantizedPosition quantized[5];
+  GrrQuantizedVertex vertices[5];
+  GrrVector3 aabbMin, aabbExtent, vertexAabbMin, vertexAabbExtent;
+  Grr_quantizePositions(5, positions, &quantized[0].position[0],
+                        sizeof(GrrQuantizedPosition) / sizeof(Grr_u16),
+                        &aabbMin, &aabbExtent);
+  Grr_quantizeVertices(5, positions, NULL, tangents, NULL, vertices,
+                       &vertexAabbMin, &vertexAabbExtent);
+
+  // 8 bytes instead of 12 for f32 positions, same XYZ as whole quantized
+  // vertices
+  assert(sizeof(GrrQuantizedPosition) == 8);
+  assert(aabbMin.x == vertexAabbMin.x && aabbMin.y == vertexAabbMin.y &&
+         aabbMin.z == vertexAabbMin.z);
+  assert(aabbExtent.x == vertexAabbExtent.x &&
+         aabbExtent.y == vertexAabbExtent.y &&
+         aabbExtent.z == vertexAabbExtent.z);
+  for (Grr_u32 i = 0; i < 5; i++) {
+    for (Grr_u32 k = 0; k < 3; k++)
+      assert(quantized[i].position[k] == vertices[i].position[k]);
+    assert(quantized[i].position[3] == 65535);
+    assert(vertices[i].position[3] == 0);
+  }
+  GRR_LOG_INFO("PASSED test_Grr_quantizePositions\n");
+}
@@ -0,0 +1,13 @@
+#ifndef GRR_TEST_QUANTIZE_H
+#define GRR_TEST_QUANTIZE_H
+
+#include "logging.h"
+#include "math/quantize.h"
+#include <assert.h>
+
+void test_Grr_f32ToF16();
+void test_Grr_octahedralEncode();
+void test_Grr_quantizeVertices();
+void test_Grr_quantizePositions();
+
+#endif
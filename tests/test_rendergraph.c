@@ -0,0 +1,241 @@
+#include "test_rendergraph.h"
+
+Grr_bool recordNothing(VkCommandBuffer commandBuffer, void *data) {
+  return true;
+}
+
+const GrrGraphBarrier *graphBarrier(const GrrRenderGraph *graph, Grr_u32 first,
+                                    Grr_u32 count, Grr_u32 resource) {
+  for (Grr_u32 i = first; i < first + count; i++) {
+    if (graph->barriers[i].resource == resource)
+      return &graph->barriers[i];
+  }
+  return NULL;
+}
+
+const GrrGraphBarrier *passBarrier(const GrrRenderGraph *graph, Grr_u32 pass,
+                                   Grr_u32 resource) {
+  return graphBarrier(graph, graph->passes[pass].firstBarrier,
+                      graph->passes[pass].barrierCount, resource);
+}
+
+void test_Grr_aliasTransients() {
+  GrrTransientLifetime lifetimes[4] = {{0}};
+  Grr_u32 slots[4];
+  VkMemoryRequirements slotRequirements[4];
+  // 0 and 1 overlap, 2 starts after both, 3 overlaps 2 but needs other memory
+  lifetimes[0] = (GrrTransientLifetime){0, 1, {1024, 256, 0x3}};
+  lifetimes[1] = (GrrTransientLifetime){1, 2, {4096, 1024, 0x3}};
+  lifetimes[2] = (GrrTransientLifetime){3, 4, {2048, 512, 0x2}};
+  lifetimes[3] = (GrrTransientLifetime){4, 4, {512, 256, 0x4}};
+  assert(Grr_aliasTransients(lifetimes, 4, slots, slotRequirements) == 3);
+  // The largest first: 1 gets the first slot, shared with 2
+  assert(slots[1] == 0 && slots[2] == 0);
+  assert(slots[0] == 1);
+  assert(slots[3] == 2);
+  assert(slotRequirements[0].size == 4096);
+  assert(slotRequirements[0].alignment == 1024);
+  assert(slotRequirements[0].memoryTypeBits == 0x2);
+  assert(slotRequirements[1].size == 1024);
+
+  // Lifetimes ending where the next begins overlap
+  lifetimes[0] = (GrrTransientLifetime){0, 2, {1024, 256, 0x1}};
+  lifetimes[1] = (GrrTransientLifetime){2, 3, {1024, 256, 0x1}};
+  assert(Grr_aliasTransients(lifetimes, 2, slots, slotRequirements) == 2);
+  lifetimes[1].firstPass = 3;
+  assert(Grr_aliasTransients(lifetimes, 2, slots, slotRequirements) == 1);
+  assert(slots[0] == 0 && slots[1] == 0);
+
+  assert(Grr_aliasTransients(lifetimes, 0, slots, slotRequirements) == 0);
+
+  GRR_LOG_INFO("PASSED test_Grr_aliasTransients\n");
+}
+
+void test_Grr_compileRenderGraph() {
+  GrrRenderGraph graph;
+  Grr_initializeRenderGraph(&graph);
+  assert(!Grr_compileRenderGraph(&graph));
+
+  // The passes of a frame with GPU driven draws
+  Grr_u32 color =
+      Grr_addGraphImage(&graph, "color", VK_IMAGE_ASPECT_COLOR_BIT, true);
+  Grr_u32 depth =
+      Grr_addGraphImage(&graph, "depth", VK_IMAGE_ASPECT_DEPTH_BIT, true);
+  Grr_u32 hiZ =
+      Grr_addGraphImage(&graph, "hi-z", VK_IMAGE_ASPECT_COLOR_BIT, false);
+  Grr_u32 indirect = Grr_addGraphBuffer(&graph, "indirect", true);
+  Grr_u32 visibility = Grr_addGraphBuffer(&graph, "visibility", false);
+  VkExtent2D extent = {64, 64};
+  Grr_u32 debug = Grr_addGraphTransientImage(
+      &graph, "debug", extent, VK_FORMAT_R32_SFLOAT,
+      VK_IMAGE_USAGE_STORAGE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+  graph.resources[debug].requirements =
+      (VkMemoryRequirements){16384, 256, 0x1};
+  assert(Grr_setGraphOutput(&graph, color, GRR_GRAPH_ACCESS_PRESENT));
+
+  Grr_u32 cullEarly = Grr_addGraphPass(&graph, "cull early", recordNothing,
+                                       NULL, GRR_GPU_REGION_COUNT, false);
+  assert(Grr_useGraphResource(&graph, cullEarly, indirect,
+                              GRR_GRAPH_ACCESS_TRANSFER_WRITE));
+  assert(Grr_useGraphResource(&graph, cullEarly, indirect,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+  assert(Grr_useGraphResource(&graph, cullEarly, visibility,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+  assert(Grr_useGraphResource(&graph, cullEarly, hiZ,
+                              GRR_GRAPH_ACCESS_COMPUTE_READ));
+  assert(graph.passes[cullEarly].useCount == 3);
+
+  Grr_u32 main = Grr_addGraphPass(&graph, "main", recordNothing, NULL,
+                                  GRR_GPU_REGION_COUNT, false);
+  assert(Grr_useGraphResource(&graph, main, indirect,
+                              GRR_GRAPH_ACCESS_INDIRECT_READ));
+  assert(Grr_useGraphResource(&graph, main, color,
+                              GRR_GRAPH_ACCESS_COLOR_ATTACHMENT));
+  assert(Grr_useGraphResource(&graph, main, depth,
+                              GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT));
+
+  // Nothing reads what it writes
+  Grr_u32 unused = Grr_addGraphPass(&graph, "unused", recordNothing, NULL,
+                                    GRR_GPU_REGION_COUNT, false);
+  assert(Grr_useGraphResource(&graph, unused, depth,
+                              GRR_GRAPH_ACCESS_DEPTH_COMPUTE_READ));
+  assert(Grr_useGraphResource(&graph, unused, debug,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+
+  Grr_u32 build = Grr_addGraphPass(&graph, "hi-z", recordNothing, NULL,
+                                   GRR_GPU_REGION_COUNT, false);
+  assert(Grr_useGraphResource(&graph, build, depth,
+                              GRR_GRAPH_ACCESS_DEPTH_COMPUTE_READ));
+  assert(Grr_useGraphResource(&graph, build, hiZ,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+  // One layout per image and pass
+  assert(!Grr_useGraphResource(&graph, build, depth,
+                               GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT));
+
+  Grr_u32 cullLate = Grr_addGraphPass(&graph, "cull late", recordNothing,
+                                      NULL, GRR_GPU_REGION_COUNT, false);
+  assert(Grr_useGraphResource(&graph, cullLate, hiZ,
+                              GRR_GRAPH_ACCESS_COMPUTE_READ));
+  assert(Grr_useGraphResource(&graph, cullLate, visibility,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+  assert(Grr_useGraphResource(&graph, cullLate, indirect,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+
+  Grr_u32 late = Grr_addGraphPass(&graph, "late", recordNothing, NULL,
+                                  GRR_GPU_REGION_COUNT, false);
+  assert(Grr_useGraphResource(&graph, late, indirect,
+                              GRR_GRAPH_ACCESS_INDIRECT_READ));
+  assert(Grr_useGraphResource(&graph, late, color,
+                              GRR_GRAPH_ACCESS_COLOR_ATTACHMENT));
+  assert(Grr_useGraphResource(&graph, late, depth,
+                              GRR_GRAPH_ACCESS_DEPTH_ATTACHMENT));
+
+  assert(Grr_compileRenderGraph(&graph));
+  assert(graph.passes[unused].culled);
+  assert(graph.passes[unused].barrierCount == 0);
+  assert(!graph.passes[cullEarly].culled && !graph.passes[late].culled);
+  assert(graph.resources[debug].slot == GRR_RENDER_GRAPH_NONE);
+  assert(graph.slotCount == 0);
+  assert(graph.resources[depth].firstPass == main);
+  assert(graph.resources[depth].lastPass == late);
+
+  // Frames wait for the last accesses of the previous one: the hi-z pyramid
+  // was last read by culling, which needs no barrier to read it again
+  assert(graph.passes[cullEarly].barrierCount == 2);
+  assert(passBarrier(&graph, cullEarly, hiZ) == NULL);
+  const GrrGraphBarrier *barrier = passBarrier(&graph, cullEarly, indirect);
+  assert(barrier->srcStages == (VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT));
+  assert(barrier->srcAccess == VK_ACCESS_SHADER_WRITE_BIT);
+  assert(barrier->dstStages == (VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT));
+  barrier = passBarrier(&graph, cullEarly, visibility);
+  assert(barrier->srcAccess == VK_ACCESS_SHADER_WRITE_BIT);
+
+  assert(graph.passes[main].barrierCount == 3);
+  barrier = passBarrier(&graph, main, indirect);
+  assert(barrier->srcAccess ==
+         (VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT));
+  assert(barrier->dstAccess == VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+  barrier = passBarrier(&graph, main, color);
+  assert(barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+  assert(barrier->newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  assert(barrier->srcStages == VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+  barrier = passBarrier(&graph, main, depth);
+  assert(barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+  assert(barrier->srcAccess == VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+  assert(graph.passes[build].barrierCount == 2);
+  barrier = passBarrier(&graph, build, depth);
+  assert(barrier->oldLayout ==
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+  assert(barrier->newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+  barrier = passBarrier(&graph, build, hiZ);
+  assert(barrier->oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+  assert(barrier->newLayout == VK_IMAGE_LAYOUT_GENERAL);
+  assert(barrier->srcStages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  assert(graph.passes[cullLate].barrierCount == 3);
+  assert(graph.passes[late].barrierCount == 3);
+  barrier = passBarrier(&graph, late, depth);
+  assert(barrier->oldLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+  assert(barrier->newLayout ==
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+  // Presented after the last pass
+  assert(graph.outputBarrierCount == 1);
+  barrier = graphBarrier(&graph, graph.outputBarrier, 1, color);
+  assert(barrier->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  assert(barrier->newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+  // Once read, the transient keeps its pass, and shares memory with a
+  // transient of a later pass
+  Grr_u32 blur = Grr_addGraphTransientImage(
+      &graph, "blur", extent, VK_FORMAT_R32_SFLOAT,
+      VK_IMAGE_USAGE_STORAGE_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+  graph.resources[blur].requirements = (VkMemoryRequirements){8192, 256, 0x1};
+  assert(Grr_useGraphResource(&graph, build, debug,
+                              GRR_GRAPH_ACCESS_COMPUTE_READ));
+  assert(Grr_useGraphResource(&graph, cullLate, blur,
+                              GRR_GRAPH_ACCESS_COMPUTE_WRITE));
+  assert(Grr_useGraphResource(&graph, late, blur,
+                              GRR_GRAPH_ACCESS_COMPUTE_READ));
+  assert(Grr_compileRenderGraph(&graph));
+  assert(!graph.passes[unused].culled);
+  assert(graph.slotCount == 1);
+  assert(graph.resources[debug].slot == 0 && graph.resources[blur].slot == 0);
+  assert(graph.slotRequirements[0].size == 16384);
+  // Waits for the reads of the transient before it
+  barrier = passBarrier(&graph, cullLate, blur);
+  assert(barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+  assert(barrier->srcStages & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  // The writes of the transient before it are made available too
+  GrrRenderGraph aliased;
+  Grr_initializeRenderGraph(&aliased);
+  Grr_u32 attachment = Grr_addGraphTransientImage(
+      &aliased, "attachment", extent, VK_FORMAT_R8G8B8A8_UNORM,
+      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+  Grr_u32 copy = Grr_addGraphTransientImage(
+      &aliased, "copy", extent, VK_FORMAT_R8G8B8A8_UNORM,
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+  aliased.resources[attachment].requirements =
+      (VkMemoryRequirements){16384, 256, 0x1};
+  aliased.resources[copy].requirements =
+      (VkMemoryRequirements){16384, 256, 0x1};
+  Grr_u32 draw = Grr_addGraphPass(&aliased, "draw", recordNothing, NULL,
+                                  GRR_GPU_REGION_COUNT, true);
+  assert(Grr_useGraphResource(&aliased, draw, attachment,
+                              GRR_GRAPH_ACCESS_COLOR_ATTACHMENT));
+  Grr_u32 transfer = Grr_addGraphPass(&aliased, "copy", recordNothing, NULL,
+                                      GRR_GPU_REGION_COUNT, true);
+  assert(Grr_useGraphResource(&aliased, transfer, copy,
+                              GRR_GRAPH_ACCESS_TRANSFER_WRITE));
+  assert(Grr_compileRenderGraph(&aliased));
+  assert(aliased.slotCount == 1);
+  barrier = passBarrier(&aliased, transfer, copy);
+  assert(barrier->srcStages & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+  assert(barrier->srcAccess & VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+  GRR_LOG_INFO("PASSED test_Grr_compileRenderGraph\n");
+}
@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_RENDERGRAPH_H
+#define GRR_TEST_RENDERGRAPH_H
+
+#include "logging.h"
+#include "rendergraph.h"
+#include <assert.h>
+
+void test_Grr_aliasTransients();
+void test_Grr_compileRenderGraph();
+
+#endif
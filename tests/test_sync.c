@@ -0,0 +1,43 @@
+#include "test_sync.h"
+
+void test_Grr_advanceTimeline() {
+  GrrTimeline timeline = {0};
+  assert(Grr_timelineReached(&timeline, 0));
+  assert(!Grr_timelineReached(&timeline, 1));
+
+  assert(Grr_advanceTimeline(&timeline, 3) == 3);
+  assert(Grr_timelineReached(&timeline, 2));
+  assert(Grr_timelineReached(&timeline, 3));
+  assert(!Grr_timelineReached(&timeline, 4));
+
+  // Values never go back
+  assert(Grr_advanceTimeline(&timeline, 1) == 3);
+  assert(timeline.completed == 3);
+  assert(Grr_advanceTimeline(&timeline, 10) == 10);
+
+  GRR_LOG_INFO("PASSED test_Grr_advanceTimeline\n");
+}
+
+void test_Grr_mergeTimelineWaits() {
+  assert(Grr_mergeTimelineWaits(NULL, 0) == 0);
+
+  GrrTimelineWait waits[] = {
+      {GRR_QUEUE_TRANSFER, 4, VK_PIPELINE_STAGE_TRANSFER_BIT},
+      {GRR_QUEUE_COMPUTE, 0, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT},
+      {GRR_QUEUE_COMPUTE, 7, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT},
+      {GRR_QUEUE_TRANSFER, 2, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT},
+      {GRR_QUEUE_COMPUTE, 9, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT}};
+  assert(Grr_mergeTimelineWaits(waits, 5) == 2);
+
+  // Largest value and every stage of a queue, in the order of the first wait
+  assert(waits[0].queue == GRR_QUEUE_TRANSFER);
+  assert(waits[0].value == 4);
+  assert(waits[0].stages == (VK_PIPELINE_STAGE_TRANSFER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT));
+  assert(waits[1].queue == GRR_QUEUE_COMPUTE);
+  assert(waits[1].value == 9);
+  assert(waits[1].stages == (VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT));
+
+  GRR_LOG_INFO("PASSED test_Grr_mergeTimelineWaits\n");
+}
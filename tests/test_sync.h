@@ -0,0 +1,11 @@
+#ifndef GRR_TEST_SYNC_H
+#define GRR_TEST_SYNC_H
+
+#include "logging.h"
+#include "sync.h"
+#include <assert.h>
+
+void test_Grr_advanceTimeline();
+void test_Grr_mergeTimelineWaits();
+
+#endif
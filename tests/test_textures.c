@@ -0,0 +1,268 @@
+#include "test_textures.h"
+
+// Reference decoders
+
+void _test_Grr_decodeBC1Block(const Grr_byte *block, Grr_byte *pixels) {
+  Grr_u32 c0 = block[0] | block[1] << 8, c1 = block[2] | block[3] << 8;
+  Grr_i32 palette[4][3];
+  for (Grr_u32 j = 0; j < 2; j++) {
+    Grr_u32 c = (j == 0 ? c0 : c1);
+    Grr_u32 r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+    palette[j][0] = (r << 3) | (r >> 2);
+    palette[j][1] = (g << 2) | (g >> 4);
+    palette[j][2] = (b << 3) | (b >> 2);
+  }
+  for (Grr_u32 k = 0; k < 3; k++) {
+    if (c0 > c1) {
+      palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+      palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+    } else {
+      palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+      palette[3][k] = 0;
+    }
+  }
+  for (Grr_u32 i = 0; i < 16; i++) {
+    Grr_u32 index = (block[4 + i / 4] >> ((i % 4) * 2)) & 3;
+    for (Grr_u32 k = 0; k < 3; k++)
+      pixels[i * 4 + k] = (Grr_byte)palette[index][k];
+    pixels[i * 4 + 3] = 255;
+  }
+}
+
+// Decodes channel values into pixels[i * 4 + channel]
+void _test_Grr_decodeBC4Block(const Grr_byte *block, Grr_u32 channel,
+                              Grr_byte *pixels) {
+  Grr_i32 palette[8] = {block[0], block[1]};
+  for (Grr_u32 j = 2; j < 8; j++)
+    palette[j] = (block[0] > block[1]
+                      ? ((8 - j) * block[0] + (j - 1) * block[1]) / 7
+                      : (j < 6 ? ((6 - j) * block[0] + (j - 1) * block[1]) / 5
+                               : (j == 6 ? 0 : 255)));
+  Grr_u64 bits = 0;
+  for (Grr_u32 i = 0; i < 6; i++)
+    bits |= (Grr_u64)block[2 + i] << (i * 8);
+  for (Grr_u32 i = 0; i < 16; i++)
+    pixels[i * 4 + channel] = (Grr_byte)palette[(bits >> (i * 3)) & 7];
+}
+
+Grr_u32 _test_Grr_getBits(const Grr_byte *block, Grr_u32 *position,
+                          Grr_u32 count) {
+  Grr_u32 value = 0;
+  for (Grr_u32 i = 0; i < count; i++, (*position)++)
+    value |= ((block[*position >> 3] >> (*position & 7)) & 1) << i;
+  return value;
+}
+
+// Mode 6 only
+void _test_Grr_decodeBC7Block(const Grr_byte *block, Grr_byte *pixels) {
+  const Grr_u32 weights[16] = {0,  4,  9,  13, 17, 21, 26, 30,
+                               34, 38, 43, 47, 51, 55, 60, 64};
+  Grr_u32 position = 0;
+  assert(_test_Grr_getBits(block, &position, 7) == 1 << 6);
+  Grr_u32 endpoints[2][4];
+  for (Grr_u32 c = 0; c < 4; c++) {
+    endpoints[0][c] = _test_Grr_getBits(block, &position, 7) << 1;
+    endpoints[1][c] = _test_Grr_getBits(block, &position, 7) << 1;
+  }
+  Grr_u32 p0 = _test_Grr_getBits(block, &position, 1);
+  Grr_u32 p1 = _test_Grr_getBits(block, &position, 1);
+  for (Grr_u32 c = 0; c < 4; c++) {
+    endpoints[0][c] |= p0;
+    endpoints[1][c] |= p1;
+  }
+  for (Grr_u32 i = 0; i < 16; i++) {
+    Grr_u32 w = weights[_test_Grr_getBits(block, &position, i == 0 ? 3 : 4)];
+    for (Grr_u32 c = 0; c < 4; c++)
+      pixels[i * 4 + c] = (Grr_byte)(
+          ((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6);
+  }
+  assert(position == 128);
+}
+
+Grr_u32 _test_Grr_maxError(const Grr_byte *a, const Grr_byte *b,
+                           Grr_u32 count, Grr_u32 channelMask) {
+  Grr_u32 maxError = 0;
+  for (Grr_u32 i = 0; i < count; i++) {
+    if (!(channelMask & (1 << (i % 4))))
+      continue;
+    Grr_u32 error = (Grr_u32)abs((Grr_i32)a[i] - (Grr_i32)b[i]);
+    maxError = (error > maxError ? error : maxError);
+  }
+  return maxError;
+}
+
+// Solid color and a diagonal gradient between two colors
+void _test_Grr_blocks(Grr_byte *solid, Grr_byte *gradient) {
+  const Grr_byte from[4] = {200, 40, 90, 255}, to[4] = {20, 180, 140, 64};
+  for (Grr_u32 i = 0; i < 16; i++) {
+    Grr_u32 t = (i % 4) + (i / 4); // 0..6
+    for (Grr_u32 c = 0; c < 4; c++) {
+      solid[i * 4 + c] = from[c];
+      gradient[i * 4 + c] = (Grr_byte)((from[c] * (6 - t) + to[c] * t) / 6);
+    }
+  }
+}
+
+// Vertical edge: constant columns, black on the left and white on the right
+void _test_Grr_edgeBlock(Grr_byte *edge) {
+  for (Grr_u32 i = 0; i < 16; i++) {
+    for (Grr_u32 c = 0; c < 3; c++)
+      edge[i * 4 + c] = (i % 4 < 2 ? 0 : 255);
+    edge[i * 4 + 3] = 255;
+  }
+}
+
+void test_Grr_encodeBC1Block() {
+  Grr_byte solid[64], gradient[64], edge[64], decoded[64], block[8];
+  _test_Grr_blocks(solid, gradient);
+  _test_Grr_edgeBlock(edge);
+
+  for (Grr_u32 q = GRR_BC_QUALITY_FAST; q <= GRR_BC_QUALITY_HIGH; q++) {
+    Grr_encodeBC1Block(solid, q, block);
+    _test_Grr_decodeBC1Block(block, decoded);
+    assert(_test_Grr_maxError(solid, decoded, 64, 0x7) <= 4);
+
+    // 7 distinct values per channel for 4 palette entries
+    Grr_encodeBC1Block(gradient, q, block);
+    assert((block[0] | block[1] << 8) > (block[2] | block[3] << 8));
+    _test_Grr_decodeBC1Block(block, decoded);
+    assert(_test_Grr_maxError(gradient, decoded, 64, 0x7) <= 32);
+
+    Grr_encodeBC1Block(edge, q, block);
+    _test_Grr_decodeBC1Block(block, decoded);
+    assert(_test_Grr_maxError(edge, decoded, 64, 0x7) <= 4);
+  }
+
+  GRR_LOG_INFO("PASSED test_Grr_encodeBC1Block\n");
+}
+
+void test_Grr_encodeBC4Block() {
+  Grr_byte solid[64], gradient[64], edge[64], decoded[64], block[16];
+  _test_Grr_blocks(solid, gradient);
+  _test_Grr_edgeBlock(edge);
+
+  for (Grr_u32 q = GRR_BC_QUALITY_FAST; q <= GRR_BC_QUALITY_HIGH; q++) {
+    Grr_encodeBC4Block(solid, q, block);
+    _test_Grr_decodeBC4Block(block, 0, decoded);
+    assert(_test_Grr_maxError(solid, decoded, 64, 0x1) == 0);
+
+    Grr_encodeBC4Block(gradient, q, block);
+    _test_Grr_decodeBC4Block(block, 0, decoded);
+    assert(_test_Grr_maxError(gradient, decoded, 64, 0x1) <= 16);
+
+    // BC5: two BC4 blocks, BC3: BC4 alpha then BC1 color
+    Grr_encodeBC5Block(gradient, q, block);
+    _test_Grr_decodeBC4Block(block, 0, decoded);
+    _test_Grr_decodeBC4Block(block + 8, 1, decoded);
+    assert(_test_Grr_maxError(gradient, decoded, 64, 0x3) <= 16);
+
+    Grr_encodeBC3Block(gradient, q, block);
+    _test_Grr_decodeBC1Block(block + 8, decoded);
+    _test_Grr_decodeBC4Block(block, 3, decoded);
+    assert(_test_Grr_maxError(gradient, decoded, 64, 0xF) <= 32);
+
+    Grr_encodeBC4Block(edge, q, block);
+    _test_Grr_decodeBC4Block(block, 0, decoded);
+    assert(_test_Grr_maxError(edge, decoded, 64, 0x1) == 0);
+  }
+
+  GRR_LOG_INFO("PASSED test_Grr_encodeBC4Block\n");
+}
+
+void test_Grr_encodeBC7Block() {
+  Grr_byte solid[64], gradient[64], edge[64], decoded[64], block[16];
+  _test_Grr_blocks(solid, gradient);
+  _test_Grr_edgeBlock(edge);
+
+  for (Grr_u32 q = GRR_BC_QUALITY_FAST; q <= GRR_BC_QUALITY_HIGH; q++) {
+    Grr_encodeBC7Block(solid, q, block);
+    _test_Grr_decodeBC7Block(block, decoded);
+    assert(_test_Grr_maxError(solid, decoded, 64, 0xF) <= 1);
+
+    Grr_encodeBC7Block(gradient, q, block);
+    _test_Grr_decodeBC7Block(block, decoded);
+    assert(_test_Grr_maxError(gradient, decoded, 64, 0xF) <= 8);
+
+    Grr_encodeBC7Block(edge, q, block);
+    _test_Grr_decodeBC7Block(block, decoded);
+    assert(_test_Grr_maxError(edge, decoded, 64, 0xF) <= 1);
+  }
+
+  GRR_LOG_INFO("PASSED test_Grr_encodeBC7Block\n");
+}
+
+void test_Grr_encodeBC() {
+  // 6x5 image: partial blocks repeat the edge texels
+  enum { WIDTH = 6, HEIGHT = 5 };
+  Grr_byte rgba[WIDTH * HEIGHT * 4];
+  for (Grr_u32 i = 0; i < WIDTH * HEIGHT * 4; i++)
+    rgba[i] = (Grr_byte)(i * 7);
+
+  assert(Grr_bcImageBytes(GRR_BC1, WIDTH, HEIGHT) == 4 * 8);
+  assert(Grr_bcImageBytes(GRR_BC7, WIDTH, HEIGHT) == 4 * 16);
+  assert(Grr_bcVkFormat(GRR_BC7, true) == VK_FORMAT_BC7_SRGB_BLOCK);
+  assert(Grr_bcVkFormat(GRR_BC5, true) == VK_FORMAT_BC5_UNORM_BLOCK);
+
+  Grr_byte blocks[4 * 16];
+  Grr_encodeBC(rgba, WIDTH, HEIGHT, GRR_BC7, GRR_BC_QUALITY_FAST, blocks);
+  for (Grr_u32 b = 0; b < 4; b++) {
+    Grr_byte pixels[64], block[16];
+    for (Grr_u32 i = 0; i < 16; i++) {
+      Grr_u32 x = (b % 2) * 4 + i % 4, y = (b / 2) * 4 + i / 4;
+      x = (x < WIDTH ? x : WIDTH - 1);
+      y = (y < HEIGHT ? y : HEIGHT - 1);
+      memcpy(&pixels[i * 4], &rgba[(y * WIDTH + x) * 4], 4);
+    }
+    Grr_encodeBC7Block(pixels, GRR_BC_QUALITY_FAST, block);
+    assert(0 == memcmp(block, blocks + b * 16, 16));
+  }
+
+  GRR_LOG_INFO("PASSED test_Grr_encodeBC\n");
+}
+
+void test_Grr_cookedTexturePath() {
+  char path[32];
+  assert(Grr_cookedTexturePath("./assets/a.png", path, sizeof(path)));
+  assert(0 == strcmp(path, "./assets/a.ktx2"));
+  assert(Grr_cookedTexturePath("./assets.d/a", path, sizeof(path)));
+  assert(0 == strcmp(path, "./assets.d/a.ktx2"));
+  assert(!Grr_cookedTexturePath("./assets/a.png", path, 15));
+
+  GRR_LOG_INFO("PASSED test_Grr_cookedTexturePath\n");
+}
+
+void test_Grr_generateMipChain() {
+  assert(Grr_mipLevelCount(1, 1) == 1);
+  assert(Grr_mipLevelCount(256, 256) == 9);
+  assert(Grr_mipLevelCount(300, 5) == 9);
+
+  // 3x2 image of white, black, white columns: the 1x1 level averages the
+  // first two columns
+  Grr_byte rgba[3 * 2 * 4] = {0};
+  for (Grr_u32 i = 0; i < 6; i++) {
+    Grr_bool white = (i % 3 != 1);
+    memset(&rgba[i * 4], white ? 255 : 0, 3);
+    rgba[i * 4 + 3] = (white ? 255 : 0);
+  }
+
+  Grr_u32 levelCount;
+  size_t levelOffsets[GRR_KTX2_MAX_LEVELS];
+  Grr_byte *chain =
+      Grr_generateMipChain(rgba, 3, 2, true, &levelCount, levelOffsets);
+  assert(NULL != chain && levelCount == 2);
+  assert(levelOffsets[1] == sizeof(rgba));
+  assert(0 == memcmp(chain, rgba, sizeof(rgba)));
+  // Half white in linear space is sRGB 188, alpha stays linear
+  Grr_byte *level1 = chain + levelOffsets[1];
+  assert(abs(level1[0] - 188) <= 1 && level1[1] == level1[0]);
+  assert(abs(level1[3] - 128) <= 1);
+  free(chain);
+
+  Grr_byte checker[2 * 2 * 4] = {255, 255, 255, 255, 0, 0, 0, 0,
+                                 0,   0,   0,   0,   255, 255, 255, 255};
+  Grr_byte linear[4];
+  Grr_downsampleRGBA8(checker, 2, 2, false, linear);
+  assert(abs(linear[0] - 128) <= 1 && abs(linear[3] - 128) <= 1);
+
+  GRR_LOG_INFO("PASSED test_Grr_generateMipChain\n");
+}
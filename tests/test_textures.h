@@ -0,0 +1,15 @@
+#ifndef GRR_TEST_TEXTURES_H
+#define GRR_TEST_TEXTURES_H
+
+#include "logging.h"
+#include "textures.h"
+#include <assert.h>
+
+void test_Grr_encodeBC1Block();
+void test_Grr_encodeBC4Block();
+void test_Grr_encodeBC7Block();
+void test_Grr_encodeBC();
+void test_Grr_cookedTexturePath();
+void test_Grr_generateMipChain();
+
+#endif